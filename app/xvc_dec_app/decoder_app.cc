@@ -191,8 +191,11 @@ void DecoderApp::PrintDecoderSettings() {
   GetLog() << "Output:           " << cli_.output_filename << std::endl;
 }
 
+static void ReleaseNalBytes(void *opaque, const uint8_t *nal_unit) {
+  delete reinterpret_cast<std::vector<uint8_t>*>(opaque);
+}
+
 void DecoderApp::MainDecoderLoop() {
-  std::vector<uint8_t> nal_bytes_;
   xvc_decoded_picture decoded_pic;
   xvc_dec_return_code ret;
   num_pictures_decoded_ = 0;
@@ -225,15 +228,16 @@ void DecoderApp::MainDecoderLoop() {
     }
 
     // Read next Nal Unit from file.
-    nal_bytes_.resize(nal_size);
-    input_stream_.read(reinterpret_cast<char *>(&nal_bytes_[0]), nal_size);
+    std::vector<uint8_t> *nal_bytes = new std::vector<uint8_t>(nal_size);
+    input_stream_.read(reinterpret_cast<char *>(&(*nal_bytes)[0]), nal_size);
     if (static_cast<size_t>(input_stream_.gcount()) < nal_size) {
       std::cerr << "Unable to read nal." << std::endl;
       std::exit(1);
     }
 
-    // Decode next Nal Unit.
-    ret = xvc_api_->decoder_decode_nal(decoder_, &nal_bytes_[0], nal_size, 0);
+    // Decode next Nal Unit, the decoder reads it in place until released.
+    ret = xvc_api_->decoder_decode_nal2(decoder_, &(*nal_bytes)[0], nal_size,
+                                        0, &ReleaseNalBytes, nal_bytes);
     if (ret == XVC_DEC_BITSTREAM_VERSION_LOWER_THAN_SUPPORTED_BY_DECODER) {
       std::cerr << xvc_api_->xvc_dec_get_error_text(ret) << std::endl;
       std::exit(XVC_DEC_BITSTREAM_VERSION_LOWER_THAN_SUPPORTED_BY_DECODER);
@@ -133,6 +133,14 @@ void EncoderApp::ReadArguments(int argc, const char *argv[]) {
       std::stringstream(argv[++i]) >> cli_.qp;
     } else if (arg == "-flat-lambda") {
       std::stringstream(argv[++i]) >> cli_.flat_lambda;
+    } else if (arg == "-rate-control") {
+      std::stringstream(argv[++i]) >> cli_.rate_control_mode;
+    } else if (arg == "-bitrate") {
+      std::stringstream(argv[++i]) >> cli_.bitrate;
+    } else if (arg == "-vbv-maxrate") {
+      std::stringstream(argv[++i]) >> cli_.vbv_max_bitrate;
+    } else if (arg == "-vbv-bufsize") {
+      std::stringstream(argv[++i]) >> cli_.vbv_buffer_size;
     } else if (arg == "-multi-passes") {
       std::stringstream(argv[++i]) >> cli_.multipass_rd;
     } else if (arg == "-speed-mode") {
@@ -352,6 +360,20 @@ EncoderApp::ConfigureApiParams(xvc_encoder_parameters *params) {
   if (cli_.flat_lambda >= 0) {
     params->flat_lambda = cli_.flat_lambda;
   }
+  if (cli_.rate_control_mode != -1) {
+    params->rate_control_mode = cli_.rate_control_mode;
+  } else if (cli_.bitrate > 0) {
+    params->rate_control_mode = 1;
+  }
+  if (cli_.bitrate > 0) {
+    params->bitrate = cli_.bitrate;
+  }
+  if (cli_.vbv_max_bitrate > 0) {
+    params->vbv_max_bitrate = cli_.vbv_max_bitrate;
+  }
+  if (cli_.vbv_buffer_size > 0) {
+    params->vbv_buffer_size = cli_.vbv_buffer_size;
+  }
   if (cli_.speed_mode != -1) {
     params->speed_mode = cli_.speed_mode;
   }
@@ -383,7 +405,12 @@ void EncoderApp::PrintEncoderSettings() {
     << std::endl;
   std::cout << "Bitdepth:         " << params_->input_bitdepth << std::endl;
   std::cout << "Framerate:        " << params_->framerate << std::endl;
-  std::cout << "QP:               " << params_->qp << std::endl;
+  if (params_->rate_control_mode > 0) {
+    std::cout << "Bitrate:          " << params_->bitrate << " kbit/s"
+      << std::endl;
+  } else {
+    std::cout << "QP:               " << params_->qp << std::endl;
+  }
 }
 
 void EncoderApp::MainEncoderLoop() {
@@ -813,6 +840,14 @@ void EncoderApp::PrintUsage() {
   std::cout << "  -beta-offset <-32..31>" << std::endl;
   std::cout << "  -tc-offset <-32..31>" << std::endl;
   std::cout << "  -qp <-64..63> (default: 32)" << std::endl;
+  std::cout << "  -rate-control <0..2>" << std::endl;
+  std::cout << "      0: Constant qp (default)" << std::endl;
+  std::cout << "      1: Variable bitrate (default when bitrate is given)"
+    << std::endl;
+  std::cout << "      2: Constant bitrate" << std::endl;
+  std::cout << "  -bitrate <kbit/s>" << std::endl;
+  std::cout << "  -vbv-maxrate <kbit/s>" << std::endl;
+  std::cout << "  -vbv-bufsize <kbit>" << std::endl;
   std::cout << "  -multi-passes <0..2>" << std::endl;
   std::cout << "      0: Single-pass (default)" << std::endl;
   std::cout << "      1: Single pass with start picture determination"
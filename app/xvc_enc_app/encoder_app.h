@@ -103,6 +103,10 @@ private:
     int tc_offset = std::numeric_limits<int>::min();
     int qp = -1;
     int flat_lambda = -1;
+    int rate_control_mode = -1;
+    int bitrate = 0;
+    int vbv_max_bitrate = 0;
+    int vbv_buffer_size = 0;
     int multipass_rd = 0;
     int speed_mode = -1;
     int tune_mode = -1;
@@ -464,7 +464,8 @@ Ctx& CabacContexts<Ctx>::GetSplitFlagCtx(const CodingUnit &cu,
 }
 
 template<typename Ctx>
-Ctx& CabacContexts<Ctx>::GetIntraPredictorCtx(IntraMode intra_mode) {
+const Ctx&
+CabacContexts<Ctx>::GetIntraPredictorCtx(IntraMode intra_mode) const {
   assert(!restrictions_->disable_ext2_intra_6_predictors);
   static const std::array<uint8_t, kNbrIntraModesExt> kModeToCtxMapExt = {
     1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
@@ -97,7 +97,12 @@ public:
   ContextModel& GetSkipFlagCtx(const CodingUnit &cu);
   ContextModel& GetSplitBinaryCtx(const CodingUnit &cu);
   ContextModel& GetSplitFlagCtx(const CodingUnit &cu, int max_depth);
-  ContextModel& GetIntraPredictorCtx(IntraMode intra_mode);
+  ContextModel& GetIntraPredictorCtx(IntraMode intra_mode) {
+    const CabacContexts *const_this = this;
+    return const_cast<ContextModel&>(
+      const_this->GetIntraPredictorCtx(intra_mode));
+  }
+  const ContextModel& GetIntraPredictorCtx(IntraMode intra_mode) const;
   ContextModel& GetInterDirBiCtx(const CodingUnit &cu);
   ContextModel& GetInterFullpelMvCtx(const CodingUnit &cu);
   ContextModel& GetSubblockCsbfCtx(YuvComponent comp,
@@ -21,20 +21,141 @@
 
 #include "xvc_common_lib/checksum.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 
+#include "xvc_common_lib/utils.h"
 #include "xvc_common_lib/utils_md5.h"
 
 namespace xvc {
 
-void Checksum::HashPicture(const YuvPicture &pic) {
+namespace {
+
+// Crc-16 with polynomial 0x1021 where message bits are shifted in at lsb
+// (msb first) and the picture checksum is flushed by 16 zero bits
+class CrcTables {
+public:
+  // Number of message bytes processed per table lookup iteration
+  static const int kSlices = 8;
+  using Matrix = std::array<uint16_t, 16>;
+
+  CrcTables() {
+    for (int v = 0; v < 256; v++) {
+      uint32_t crc = v;
+      for (int k = 0; k < kSlices + 1; k++) {
+        crc = ShiftZeroBits(crc, 8);
+        zero_bytes_[k][v] = static_cast<uint16_t>(crc);
+      }
+    }
+    for (int i = 0; i < 16; i++) {
+      zero_byte_matrix_[i] = static_cast<uint16_t>(ShiftZeroBits(1 << i, 8));
+    }
+  }
+
+  static const CrcTables& Get() {
+    static const CrcTables tables;
+    return tables;
+  }
+
+  // Register state after shifting in the given byte
+  uint32_t Update(uint32_t crc, uint32_t byte) const {
+    return (((crc << 8) & 0xffff) | byte) ^ zero_bytes_[1][crc >> 8];
+  }
+
+  // Register state after shifting in kSlices bytes, the bytes are extracted
+  // from consecutive samples in little endian order
+  template<int BytesPerSample>
+  uint32_t UpdateSlice(uint32_t crc, const Sample *src) const {
+    uint32_t val =
+      zero_bytes_[kSlices][crc >> 8] ^ zero_bytes_[kSlices - 1][crc & 0xff];
+    for (int i = 0; i < kSlices - 1; i++) {
+      val ^= zero_bytes_[kSlices - 2 - i][GetByte<BytesPerSample>(src, i)];
+    }
+    return val ^ GetByte<BytesPerSample>(src, kSlices - 1);
+  }
+
+  // Register state after shifting in num_bytes zero bytes, used for
+  // combining the crc of consecutive parts of a picture
+  uint32_t ShiftZeroBytes(uint32_t crc, size_t num_bytes) const {
+    Matrix op = zero_byte_matrix_;
+    while (num_bytes) {
+      if (num_bytes & 1) {
+        crc = Multiply(op, crc);
+      }
+      num_bytes >>= 1;
+      if (num_bytes) {
+        Matrix square;
+        for (int i = 0; i < 16; i++) {
+          square[i] = static_cast<uint16_t>(Multiply(op, op[i]));
+        }
+        op = square;
+      }
+    }
+    return crc;
+  }
+
+  uint32_t Finish(uint32_t crc) const {
+    return zero_bytes_[2][crc >> 8] ^ zero_bytes_[1][crc & 0xff];
+  }
+
+private:
+  template<int BytesPerSample>
+  static uint32_t GetByte(const Sample *src, int i) {
+    return (src[i / BytesPerSample] >> (8 * (i % BytesPerSample))) & 0xff;
+  }
+  static uint32_t ShiftZeroBits(uint32_t crc, int num_bits) {
+    for (int bit = 0; bit < num_bits; bit++) {
+      uint32_t crc_msb = (crc >> 15) & 1;
+      crc = ((crc << 1) & 0xffff) ^ (crc_msb * 0x1021);
+    }
+    return crc;
+  }
+  static uint32_t Multiply(const Matrix &mat, uint32_t vec) {
+    uint32_t result = 0;
+    for (int i = 0; vec; i++, vec >>= 1) {
+      if (vec & 1) {
+        result ^= mat[i];
+      }
+    }
+    return result;
+  }
+
+  // zero_bytes_[k][v] is the register v after shifting in k + 1 zero bytes
+  uint16_t zero_bytes_[kSlices + 1][256];
+  Matrix zero_byte_matrix_;
+};
+
+template<int BytesPerSample>
+uint32_t CalculateCrcRows(const CrcTables &tables, const Sample *src,
+                          ptrdiff_t stride, int width, int height) {
+  const int slice_width = CrcTables::kSlices / BytesPerSample;
+  uint32_t crc = 0;
+  for (int y = 0; y < height; y++) {
+    int x = 0;
+    for (; x + slice_width <= width; x += slice_width) {
+      crc = tables.UpdateSlice<BytesPerSample>(crc, src + x);
+    }
+    for (; x < width; x++) {
+      for (int i = 0; i < BytesPerSample; i++) {
+        crc = tables.Update(crc, (src[x] >> (8 * i)) & 0xff);
+      }
+    }
+    src += stride;
+  }
+  return crc;
+}
+
+}   // namespace
+
+void Checksum::HashPicture(const YuvPicture &pic, int num_threads) {
   switch (method_) {
     case Method::kCrc:
-      CalculateCrc(pic, mode_);
+      CalculateCrc(pic, mode_, num_threads);
       break;
 
     case Method::kMd5:
-      CalculateMd5(pic, mode_);
+      CalculateMd5(pic, mode_, num_threads);
       break;
 
     default:
@@ -43,96 +164,102 @@ void Checksum::HashPicture(const YuvPicture &pic) {
   }
 }
 
-void Checksum::CalculateCrc(const YuvPicture &pic, Mode mode) {
+void Checksum::CalculateCrc(const YuvPicture &pic, Mode mode,
+                            int num_threads) {
   assert(mode == Mode::kMinOverhead || mode == Mode::kMaxRobust);
-  int num_components = util::GetNumComponents(pic.GetChromaFormat());
-  uint32_t crcVal = 0xffff;
-
+  const CrcTables &tables = CrcTables::Get();
+  const int num_components = util::GetNumComponents(pic.GetChromaFormat());
+  const int bytes_per_sample = pic.GetBitdepth() > 8 ? 2 : 1;
+  struct Job {
+    YuvComponent comp;
+    int y;
+    int height;
+    uint32_t crc;
+  };
+  // Since the crc is linear each job covers a range of rows hashed from a
+  // zero register, the result is then combined with the preceding rows
+  std::vector<Job> jobs;
+  const int band_height =
+    (pic.GetHeight(YuvComponent::kY) + std::max(1, num_threads) - 1) /
+    std::max(1, num_threads);
   for (int c = 0; c < num_components; c++) {
     YuvComponent comp = YuvComponent(c);
-    if (mode == Mode::kMaxRobust) {
-      crcVal = 0xffff;
+    for (int y = 0; y < pic.GetHeight(comp); y += band_height) {
+      jobs.push_back({ comp, y, std::min(band_height, pic.GetHeight(comp) - y),
+                     0 });
     }
-    auto src = pic.GetSamplePtr(comp, 0, 0);
-    for (int y = 0; y < pic.GetHeight(comp); y++) {
-      for (int x = 0; x < pic.GetWidth(comp); x++) {
-        for (int bit = 0; bit < 8; bit++) {
-          uint32_t crcMsb = (crcVal >> 15) & 1;
-          uint32_t bitVal = (src[x] >> (7 - bit)) & 1;
-          crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-        }
-        if (pic.GetBitdepth() > 8) {
-          for (int bit = 0; bit < 8; bit++) {
-            uint32_t crcMsb = (crcVal >> 15) & 1;
-            uint32_t bitVal = (src[x] >> (15 - bit)) & 1;
-            crcVal = (((crcVal << 1) + bitVal) & 0xffff) ^ (crcMsb * 0x1021);
-          }
-        }
-      }
-      src += pic.GetStride(comp);
+  }
+  util::RunJobs(static_cast<int>(jobs.size()), num_threads, [&](int i) {
+    Job &job = jobs[i];
+    const Sample *src = pic.GetSamplePtr(job.comp, 0, job.y);
+    const ptrdiff_t stride = pic.GetStride(job.comp);
+    const int width = pic.GetWidth(job.comp);
+    job.crc = bytes_per_sample == 2 ?
+      CalculateCrcRows<2>(tables, src, stride, width, job.height) :
+      CalculateCrcRows<1>(tables, src, stride, width, job.height);
+  });
+
+  uint32_t crc = 0xffff;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    const Job &job = jobs[i];
+    if (mode == Mode::kMaxRobust && job.y == 0) {
+      crc = 0xffff;
     }
+    const size_t num_bytes = static_cast<size_t>(job.height) *
+      pic.GetWidth(job.comp) * bytes_per_sample;
+    crc = tables.ShiftZeroBytes(crc, num_bytes) ^ job.crc;
+    const bool last_job_of_comp =
+      i + 1 == jobs.size() || jobs[i + 1].comp != job.comp;
     // For MaxRobust, one checksum value is calculated for each component.
-    if (mode == Mode::kMaxRobust) {
-      for (int bit = 0; bit < 16; bit++) {
-        uint32_t crcMsb = (crcVal >> 15) & 1;
-        crcVal = ((crcVal << 1) & 0xffff) ^ (crcMsb * 0x1021);
-      }
-      hash_.push_back((crcVal >> 8) & 0xff);
-      hash_.push_back(crcVal & 0xff);
+    if (mode == Mode::kMaxRobust && last_job_of_comp) {
+      uint32_t crc_val = tables.Finish(crc);
+      hash_.push_back((crc_val >> 8) & 0xff);
+      hash_.push_back(crc_val & 0xff);
     }
   }
   // For MinOverhead, a single checksum value is calculated for the picture.
   if (mode == Mode::kMinOverhead) {
-    for (int bit = 0; bit < 16; bit++) {
-      uint32_t crcMsb = (crcVal >> 15) & 1;
-      crcVal = ((crcVal << 1) & 0xffff) ^ (crcMsb * 0x1021);
-    }
-    hash_.push_back((crcVal >> 8) & 0xff);
-    hash_.push_back(crcVal & 0xff);
+    uint32_t crc_val = tables.Finish(crc);
+    hash_.push_back((crc_val >> 8) & 0xff);
+    hash_.push_back(crc_val & 0xff);
   }
 }
 
-void Checksum::CalculateMd5(const YuvPicture &pic, Mode mode) {
+void Checksum::CalculateMd5(const YuvPicture &pic, Mode mode,
+                            int num_threads) {
   assert(mode == Mode::kMinOverhead || mode == Mode::kMaxRobust);
-  int num_components = util::GetNumComponents(pic.GetChromaFormat());
-  util::MD5 md5;
-
-  for (int c = 0; c < num_components; c++) {
-    YuvComponent comp = YuvComponent(c);
-    if (mode == Mode::kMaxRobust) {
-      md5.Reset();
-    }
-    auto src = pic.GetSamplePtr(comp, 0, 0);
-    int bitdepth = pic.GetBitdepth();
-    int width = pic.GetWidth(comp);
-    int row = bitdepth == 8 ? width : width << 1;
-    const uint8_t* samples;
-    std::vector<uint8_t> row_buffer;
-    if (bitdepth == 8 && sizeof(Sample) == 2) {
-      row_buffer.resize(width);
-    }
+  const int num_components = util::GetNumComponents(pic.GetChromaFormat());
+  const int bitdepth = pic.GetBitdepth();
+  auto hash_component = [&pic, bitdepth](YuvComponent comp, util::MD5 *md5) {
+    const Sample *src = pic.GetSamplePtr(comp, 0, 0);
+    const int width = pic.GetWidth(comp);
     for (int y = 0; y < pic.GetHeight(comp); y++) {
       if (bitdepth == 8 && sizeof(Sample) == 2) {
-        for (int x = 0; x < width; x++) {
-          row_buffer[x] = static_cast<uint8_t>(src[x]);
-        }
-        samples = reinterpret_cast<const uint8_t*>(&row_buffer[0]);
+        md5->UpdateLowBytes(reinterpret_cast<const uint16_t*>(src), width);
       } else {
-        samples = reinterpret_cast<const uint8_t*>(src);
+        // TODO(Dev) Consider enforcing little endian for high bitdepth yuv
+        md5->Update(reinterpret_cast<const uint8_t*>(src),
+                    width * sizeof(Sample));
       }
-      // TODO(Dev) Consider enforcing little endian for high bitdepth yuv
-      md5.Update(samples, row);
       src += pic.GetStride(comp);
     }
-    // For MaxRobust, one checksum value is calculated for each component.
-    if (mode == Mode::kMaxRobust) {
-      size_t size = hash_.size();
-      hash_.resize(size + 16);
-      md5.Final(&hash_[size]);
-    }
+  };
+
+  // For MaxRobust, one checksum value is calculated for each component.
+  if (mode == Mode::kMaxRobust) {
+    hash_.resize(16 * num_components);
+    util::RunJobs(num_components, num_threads, [&](int c) {
+      util::MD5 md5;
+      hash_component(YuvComponent(c), &md5);
+      md5.Final(&hash_[16 * c]);
+    });
   }
   // For MinOverhead, a single checksum value is calculated for the picture.
   if (mode == Mode::kMinOverhead) {
+    util::MD5 md5;
+    for (int c = 0; c < num_components; c++) {
+      hash_component(YuvComponent(c), &md5);
+    }
     hash_.resize(16);
     md5.Final(&hash_[0]);
   }
@@ -47,12 +47,14 @@ public:
   static const Method kFallbackMethod = Method::kCrc;
 
   Checksum(Method method, Mode mode) : method_(method), mode_(mode) {}
-  void HashPicture(const YuvPicture &pic);
+  // Components are hashed in parallel when num_threads > 1, except for md5
+  // in kMinOverhead mode that can only be calculated sequentially
+  void HashPicture(const YuvPicture &pic, int num_threads = 1);
   std::vector<uint8_t> GetHash() const { return hash_; }
 
 private:
-  void CalculateCrc(const YuvPicture &pic, Mode mode);
-  void CalculateMd5(const YuvPicture &pic, Mode mode);
+  void CalculateCrc(const YuvPicture &pic, Mode mode, int num_threads);
+  void CalculateMd5(const YuvPicture &pic, Mode mode, int num_threads);
 
   const Method method_;
   const Mode mode_;
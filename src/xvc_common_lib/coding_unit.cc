@@ -227,7 +227,7 @@ const CodingUnit* CodingUnit::GetCodingUnit(NeighborDir dir,
 const CodingUnit* CodingUnit::GetCodingUnitAbove() const {
   int posx = pos_x_;
   int posy = pos_y_;
-  if (posy == 0) {
+  if (pic_data_->IsSliceStart(posy)) {
     return nullptr;
   }
   return pic_data_->GetCuAt(cu_tree_, posx, posy - constants::kMinBlockSize);
@@ -245,7 +245,7 @@ const CodingUnit* CodingUnit::GetCodingUnitAboveIfSameCtu() const {
 const CodingUnit* CodingUnit::GetCodingUnitAboveLeft() const {
   int posx = pos_x_;
   int posy = pos_y_;
-  if (posx == 0 || posy == 0) {
+  if (posx == 0 || pic_data_->IsSliceStart(posy)) {
     return nullptr;
   }
   return pic_data_->GetCuAt(cu_tree_, posx - constants::kMinBlockSize,
@@ -255,7 +255,7 @@ const CodingUnit* CodingUnit::GetCodingUnitAboveLeft() const {
 const CodingUnit* CodingUnit::GetCodingUnitAboveCorner() const {
   int right = pos_x_ + width_;
   int posy = pos_y_;
-  if (posy == 0) {
+  if (pic_data_->IsSliceStart(posy)) {
     return nullptr;
   }
   return pic_data_->GetCuAt(cu_tree_, right - constants::kMinBlockSize,
@@ -265,7 +265,7 @@ const CodingUnit* CodingUnit::GetCodingUnitAboveCorner() const {
 const CodingUnit* CodingUnit::GetCodingUnitAboveRight() const {
   int right = pos_x_ + width_;
   int posy = pos_y_;
-  if (posy == 0) {
+  if (pic_data_->IsSliceStart(posy)) {
     return nullptr;
   }
   // Padding in table will guard for y going out-of-bounds
@@ -294,7 +294,7 @@ const CodingUnit* CodingUnit::GetCodingUnitLeftCorner() const {
 const CodingUnit* CodingUnit::GetCodingUnitLeftBelow() const {
   int posx = pos_x_;
   int bottom = pos_y_ + height_;
-  if (posx == 0) {
+  if (posx == 0 || pic_data_->IsSliceStart(bottom)) {
     return nullptr;
   }
   // Padding in table will guard for y going out-of-bounds
@@ -306,7 +306,7 @@ int CodingUnit::GetCuSizeAboveRight(YuvComponent comp) const {
     std::max(pic_data_->GetChromaShiftX(), pic_data_->GetChromaShiftY());
   int posx = pos_x_ + width_;
   int posy = pos_y_ - constants::kMinBlockSize;
-  if (posy < 0) {
+  if (pic_data_->IsSliceStart(pos_y_)) {
     return 0;
   }
   posx -= constants::kMinBlockSize;
@@ -326,8 +326,13 @@ int CodingUnit::GetCuSizeBelowLeft(YuvComponent comp) const {
   if (posx < 0) {
     return 0;
   }
+  // Rows below the current ctu are never available, with slices coded in
+  // parallel they might however already be present in the cu table
+  const int ctu_bottom = (pos_y_ & ~(constants::kCtuSize - 1)) +
+    constants::kCtuSize;
+  const int max_offset = std::min(width_, ctu_bottom - posy);
   posy -= constants::kMinBlockSize;
-  for (int i = width_; i >= 0; i -= constants::kMinBlockSize) {
+  for (int i = max_offset; i >= 0; i -= constants::kMinBlockSize) {
     if (pic_data_->GetCuAt(cu_tree_, posx, posy + i)) {
       return util::IsLuma(comp) ? i : (i >> chroma_shift);
     }
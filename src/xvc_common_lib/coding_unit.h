@@ -148,6 +148,10 @@ public:
 
   // Neighborhood
   bool IsFullyWithinPicture() const;
+  // False at the top of the picture and of each slice
+  bool HasAboveNeighbors() const {
+    return !pic_data_->IsSliceStart(pos_y_);
+  }
   const CodingUnit *GetCodingUnit(NeighborDir dir, MvCorner *mv_corner) const;
   const CodingUnit *GetCodingUnitAbove() const;
   const CodingUnit *GetCodingUnitAboveIfSameCtu() const;
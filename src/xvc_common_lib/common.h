@@ -76,13 +76,17 @@ namespace constants {
 // xvc version
 const uint32_t kXvcCodecIdentifier = 7894627;
 const uint32_t kXvcMajorVersion = 2;
-const uint32_t kXvcMinorVersion = 0;
-static const uint32_t kSupportedOldBitstreamVersions[1][2] = { { 1, 0 } };
+const uint32_t kXvcMinorVersion = 1;
+static const uint32_t kSupportedOldBitstreamVersions[2][2] = {
+  { 1, 0 }, { 2, 0 }
+};
 
 // Picture
 const int kMaxYuvComponents = 3;
 const int kMaxNumPlanes = 2;  // luma and chroma
 const int kMaxNumCuTrees = 2;
+const int kNumSlicesBits = 8;
+const int kEntryPointBitsBits = 5;
 
 // CU limits
 const int kCtuSizeLog2 = 6;
@@ -21,8 +21,13 @@
 
 #include "xvc_common_lib/deblocking_filter.h"
 
+// Some C++11 headers are not allowed by cpplint
+#include <algorithm>
+#include <condition_variable>   // NOLINT
 #include <cstdlib>
 #include <cmath>
+#include <mutex>                // NOLINT
+#include <vector>
 
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/restrictions.h"
@@ -44,35 +49,93 @@ static const std::array<uint8_t, constants::kMaxAllowedQp + 1> kBetaTable = {
   86, 88,
 };
 
-DeblockingFilter::DeblockingFilter(PictureData *pic_data, YuvPicture *rec_pic,
-                 int beta_offset, int tc_offset)
-  : restrictions_(Restrictions::Get()),
+DeblockingFilter::DeblockingFilter(const SimdFunc &simd,
+                                   PictureData *pic_data, YuvPicture *rec_pic,
+                                   int beta_offset, int tc_offset)
+  : simd_(simd),
+  restrictions_(Restrictions::Get()),
   pic_data_(pic_data),
   rec_pic_(rec_pic),
   beta_offset_(beta_offset),
   tc_offset_(tc_offset) {
-}
-
-void DeblockingFilter::DeblockPicture() {
-  bool has_secondary_tree = pic_data_->HasSecondaryCuTree();
-  int num_ctus = pic_data_->GetNumberOfCtu();
-  int subblock_size = kSubblockSizeExt;
   if (restrictions_.disable_ext_deblock_subblock_size_4) {
-    subblock_size = kSubblockSize;
+    subblock_size_ = kSubblockSize;
   }
-  for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
-    DeblockCtu(rsaddr, CuTree::Primary, Direction::kVertical, subblock_size);
-    if (has_secondary_tree) {
-      DeblockCtu(rsaddr, CuTree::Secondary, Direction::kVertical,
-                 kSubblockSize);
+}
+
+void DeblockingFilter::DeblockPicture(
+  int num_threads, const std::function<void(int)> &row_done) {
+  const int num_ctu_x = pic_data_->GetNumCtuX();
+  const int num_ctu_rows = pic_data_->GetNumCtuY();
+  // Filtering of a row modifies the bottom of the row above
+  auto on_row_filtered = [&](int ctu_row) {
+    if (!row_done) {
+      return;
+    }
+    if (ctu_row > 0) {
+      row_done(ctu_row - 1);
+    }
+    if (ctu_row == num_ctu_rows - 1) {
+      row_done(ctu_row);
+    }
+  };
+  num_threads = std::min(num_threads, num_ctu_rows);
+  if (num_threads <= 1) {
+    for (int ctu_row = 0; ctu_row < num_ctu_rows; ctu_row++) {
+      DeblockCtuRow(ctu_row);
+      on_row_filtered(ctu_row);
     }
+    return;
   }
-  for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
-    DeblockCtu(rsaddr, CuTree::Primary, Direction::kHorizontal, subblock_size);
-    if (has_secondary_tree) {
-      DeblockCtu(rsaddr, CuTree::Secondary, Direction::kHorizontal,
-                 kSubblockSize);
+  // The horizontal edges of a ctu only modify samples within its own ctu
+  // column, so a ctu can be filtered as soon as the ctu above it is done
+  std::vector<int> row_progress(num_ctu_rows, 0);
+  int next_row = 0;
+  std::mutex mutex;
+  std::condition_variable progress_cond;
+  auto deblock_rows = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (next_row < num_ctu_rows) {
+      const int row = next_row++;
+      lock.unlock();
+      for (int x = 0; x < num_ctu_x; x++) {
+        DeblockCtuEdges(row * num_ctu_x + x, Direction::kVertical);
+      }
+      lock.lock();
+      for (int x = 0; x < num_ctu_x; x++) {
+        progress_cond.wait(lock, [&]() {
+          return row == 0 || row_progress[row - 1] > x;
+        });
+        lock.unlock();
+        DeblockCtuEdges(row * num_ctu_x + x, Direction::kHorizontal);
+        lock.lock();
+        row_progress[row] = x + 1;
+        progress_cond.notify_all();
+      }
+      lock.unlock();
+      on_row_filtered(row);
+      lock.lock();
     }
+  };
+  util::RunJobs(num_threads, num_threads, [&](int) { deblock_rows(); });
+}
+
+void DeblockingFilter::DeblockCtuRow(int ctu_row) {
+  const int num_ctu_x = pic_data_->GetNumCtuX();
+  const int rsaddr_begin = ctu_row * num_ctu_x;
+  const int rsaddr_end = rsaddr_begin + num_ctu_x;
+  for (int rsaddr = rsaddr_begin; rsaddr < rsaddr_end; rsaddr++) {
+    DeblockCtuEdges(rsaddr, Direction::kVertical);
+  }
+  for (int rsaddr = rsaddr_begin; rsaddr < rsaddr_end; rsaddr++) {
+    DeblockCtuEdges(rsaddr, Direction::kHorizontal);
+  }
+}
+
+void DeblockingFilter::DeblockCtuEdges(int rsaddr, Direction dir) {
+  DeblockCtu(rsaddr, CuTree::Primary, dir, subblock_size_);
+  if (pic_data_->HasSecondaryCuTree()) {
+    DeblockCtu(rsaddr, CuTree::Secondary, dir, kSubblockSize);
   }
 }
 
@@ -246,6 +309,7 @@ void DeblockingFilter::FilterEdgeLuma(int x, int y, Direction dir,
   YuvComponent luma = YuvComponent::kY;
   Sample *src = rec_pic_->GetSamplePtr(luma, x, y);
   ptrdiff_t src_stride = rec_pic_->GetStride(luma);
+  const int dir_idx = dir == Direction::kVertical ? 0 : 1;
   ptrdiff_t offset;
   ptrdiff_t step_size;
 
@@ -264,7 +328,12 @@ void DeblockingFilter::FilterEdgeLuma(int x, int y, Direction dir,
   auto calculate_dq = [&offset](Sample* sample) {
     return std::abs(sample[0] - 2 * sample[offset] + sample[offset * 2]);
   };
-  const int bitdepth_shift = pic_data_->GetBitdepth() - 8;
+  const int bitdepth = pic_data_->GetBitdepth();
+  const int bitdepth_shift = bitdepth - 8;
+  const bool weak_sample_decision =
+    !restrictions_.disable_deblock_weak_sample_decision;
+  const bool weak_two_samples =
+    !restrictions_.disable_deblock_two_samples_weak_filter;
   const int nbr_filter_groups = subblock_size / kFilterGroupSize;
   for (int group_idx = 0; group_idx < nbr_filter_groups; group_idx++) {
     int index_beta = util::Clip3(qp + beta_offset_, 0,
@@ -295,7 +364,8 @@ void DeblockingFilter::FilterEdgeLuma(int x, int y, Direction dir,
       CheckStrongFilter(src + block_offset + step_size * 3, beta, tc, offset);
 
     if (strong_filter && !restrictions_.disable_deblock_strong_filter) {
-      FilterLumaStrong(src + block_offset, step_size, offset, 2 * tc);
+      simd_.filter_luma_strong[dir_idx](src + block_offset, src_stride,
+                                        2 * tc);
     } else {
       if (restrictions_.disable_deblock_weak_filter) {
         continue;
@@ -303,10 +373,11 @@ void DeblockingFilter::FilterEdgeLuma(int x, int y, Direction dir,
       int side_threshold = (beta + (beta >> 1)) >> 3;
       int dp = dp0 + dp3;
       int dq = dq0 + dq3;
-      bool filter_p1 = dp < side_threshold;
-      bool filter_q1 = dq < side_threshold;
-      FilterLumaWeak(src + block_offset, step_size, offset, tc,
-                     filter_p1, filter_q1);
+      bool filter_p1 = weak_two_samples && dp < side_threshold;
+      bool filter_q1 = weak_two_samples && dq < side_threshold;
+      simd_.filter_luma_weak[dir_idx](src + block_offset, src_stride, tc,
+                                      filter_p1, filter_q1,
+                                      weak_sample_decision, bitdepth);
     }
   }
 }
@@ -322,23 +393,46 @@ bool DeblockingFilter::CheckStrongFilter(Sample* src, int beta, int tc,
   return test2 && test3;
 }
 
-void DeblockingFilter::FilterLumaWeak(Sample* src_ptr, ptrdiff_t step_size,
-                                      ptrdiff_t offset, int tc, bool filter_p1,
-                                      bool filter_q1) {
-  const Sample sample_max = (1 << pic_data_->GetBitdepth()) - 1;
+void DeblockingFilter::FilterEdgeChroma(int x, int y, int scale_x, int scale_y,
+                                        Direction dir, int subblock_size,
+                                        int boundary_strength, int qp) {
+  const int bitdepth = pic_data_->GetBitdepth();
+  const int bitdepth_shift = bitdepth - 8;
+  const int index_tc =
+    util::Clip3(qp + tc_offset_ + 2, 0, static_cast<int>(kTcTable.size()));
+  const int tc = kTcTable[index_tc] << bitdepth_shift;
+  const int scaled_subblock_size = dir == Direction::kVertical ?
+    subblock_size >> scale_y : subblock_size >> scale_x;
+  static_assert(kSubblockSize == 8,
+                "Chroma filter assumes luma subblocks are either 4 or 8 long");
+  const int dir_idx = dir == Direction::kVertical ? 0 : 1;
+  for (int c = 1; c < constants::kMaxYuvComponents; c++) {
+    YuvComponent comp = YuvComponent(c);
+    Sample *src = rec_pic_->GetSamplePtr(comp, x, y);
+    ptrdiff_t src_stride = rec_pic_->GetStride(comp);
+    simd_.filter_chroma[dir_idx](scaled_subblock_size, src, src_stride, tc,
+                                 bitdepth);
+  }
+}
+
+template<Direction dir>
+static void FilterLumaWeak_c(Sample *src, ptrdiff_t stride, int tc,
+                             bool filter_p1, bool filter_q1,
+                             bool sample_decision, int bitdepth) {
+  const ptrdiff_t offset = dir == Direction::kVertical ? 1 : stride;
+  const ptrdiff_t step_size = dir == Direction::kVertical ? stride : 1;
+  const Sample sample_max = (1 << bitdepth) - 1;
   int32_t threshold = tc * 10;
   int32_t half_tc = tc >> 1;
-  Sample* src = src_ptr;
 
-  for (int i = 0; i < kFilterGroupSize; i++) {
+  for (int i = 0; i < DeblockingFilter::kFilterGroupSize; i++) {
     Sample p1 = src[-offset * 2];
     Sample p0 = src[-offset];
     Sample q0 = src[0];
     Sample q1 = src[offset];
     int32_t delta = (9 * (q0 - p0) - 3 * (q1 - p1) + 8) >> 4;
 
-    if (std::abs(delta) >= threshold &&
-        !restrictions_.disable_deblock_weak_sample_decision) {
+    if (std::abs(delta) >= threshold && sample_decision) {
       src += step_size;
       continue;
     }
@@ -347,30 +441,30 @@ void DeblockingFilter::FilterLumaWeak(Sample* src_ptr, ptrdiff_t step_size,
     src[-offset] = util::ClipBD(p0 + delta, sample_max);
     src[0] = util::ClipBD(q0 - delta, sample_max);
 
-    if (!restrictions_.disable_deblock_two_samples_weak_filter) {
-      if (filter_p1) {
-        Sample p2 = src[-offset * 3];
-        int32_t delta_p1 = util::Clip3(
-          ((((p2 + p0 + 1) >> 1) - p1 + delta) >> 1), -half_tc, half_tc);
-        src[-offset * 2] = util::ClipBD(p1 + delta_p1, sample_max);
-      }
-      if (filter_q1) {
-        Sample q2 = src[offset * 2];
-        int32_t delta_q1 = util::Clip3(
-          ((((q2 + q0 + 1) >> 1) - q1 - delta) >> 1), -half_tc, half_tc);
-        src[offset] = util::ClipBD(q1 + delta_q1, sample_max);
-      }
+    if (filter_p1) {
+      Sample p2 = src[-offset * 3];
+      int32_t delta_p1 = util::Clip3(
+        ((((p2 + p0 + 1) >> 1) - p1 + delta) >> 1), -half_tc, half_tc);
+      src[-offset * 2] = util::ClipBD(p1 + delta_p1, sample_max);
+    }
+    if (filter_q1) {
+      Sample q2 = src[offset * 2];
+      int32_t delta_q1 = util::Clip3(
+        ((((q2 + q0 + 1) >> 1) - q1 - delta) >> 1), -half_tc, half_tc);
+      src[offset] = util::ClipBD(q1 + delta_q1, sample_max);
     }
     src += step_size;
   }
 }
 
-void DeblockingFilter::FilterLumaStrong(Sample* src, ptrdiff_t step_size,
-                                        ptrdiff_t offset, int tc2) {
+template<Direction dir>
+static void FilterLumaStrong_c(Sample *src, ptrdiff_t stride, int tc2) {
+  const ptrdiff_t offset = dir == Direction::kVertical ? 1 : stride;
+  const ptrdiff_t step_size = dir == Direction::kVertical ? stride : 1;
   auto clip_sample_3 = [](int value, int min, int max) {
     return static_cast<Sample>(util::Clip3(value, min, max));
   };
-  for (int i = 0; i < kFilterGroupSize; i++) {
+  for (int i = 0; i < DeblockingFilter::kFilterGroupSize; i++) {
     Sample p3 = src[-offset * 4];
     Sample p2 = src[-offset * 3];
     Sample p1 = src[-offset * 2];
@@ -400,43 +494,13 @@ void DeblockingFilter::FilterLumaStrong(Sample* src, ptrdiff_t step_size,
   }
 }
 
-void DeblockingFilter::FilterEdgeChroma(int x, int y, int scale_x, int scale_y,
-                                        Direction dir, int subblock_size,
-                                        int boundary_strength, int qp) {
-  const int bitdepth_shift = pic_data_->GetBitdepth() - 8;
-  const int index_tc =
-    util::Clip3(qp + tc_offset_ + 2, 0, static_cast<int>(kTcTable.size()));
-  const int tc = kTcTable[index_tc] << bitdepth_shift;
-  const int scaled_subblock_size = dir == Direction::kVertical ?
-    subblock_size >> scale_y : subblock_size >> scale_x;
-  static_assert(kSubblockSize == 8,
-                "Chroma filter assumes luma subblocks are either 4 or 8 long");
-  auto filter_chroma =
-    scaled_subblock_size == 2 ? &DeblockingFilter::FilterChroma<2> :
-    (scaled_subblock_size == 4 ? &DeblockingFilter::FilterChroma<4> :
-     &DeblockingFilter::FilterChroma<8>);
-  for (int c = 1; c < constants::kMaxYuvComponents; c++) {
-    YuvComponent comp = YuvComponent(c);
-    Sample *src = rec_pic_->GetSamplePtr(comp, x, y);
-    ptrdiff_t src_stride = rec_pic_->GetStride(comp);
-    ptrdiff_t offset;
-    ptrdiff_t step_size;
-    if (dir == Direction::kVertical) {
-      offset = 1;
-      step_size = src_stride;
-    } else {
-      offset = src_stride;
-      step_size = 1;
-    }
-    (this->*filter_chroma)(src, step_size, offset, tc);
-  }
-}
-
-template<int FilterGroupSize>
-void DeblockingFilter::FilterChroma(Sample* src, ptrdiff_t step_size,
-                                    ptrdiff_t offset, int tc) {
-  const Sample sample_max = (1 << pic_data_->GetBitdepth()) - 1;
-  for (int i = 0; i < FilterGroupSize; i++) {
+template<Direction dir>
+static void FilterChroma_c(int num_lines, Sample *src, ptrdiff_t stride,
+                           int tc, int bitdepth) {
+  const ptrdiff_t offset = dir == Direction::kVertical ? 1 : stride;
+  const ptrdiff_t step_size = dir == Direction::kVertical ? stride : 1;
+  const Sample sample_max = (1 << bitdepth) - 1;
+  for (int i = 0; i < num_lines; i++) {
     Sample p1 = src[-offset * 2];
     Sample p0 = src[-offset];
     Sample q0 = src[0];
@@ -449,4 +513,13 @@ void DeblockingFilter::FilterChroma(Sample* src, ptrdiff_t step_size,
   }
 }
 
+DeblockingFilter::SimdFunc::SimdFunc() {
+  filter_luma_weak[0] = &FilterLumaWeak_c<Direction::kVertical>;
+  filter_luma_weak[1] = &FilterLumaWeak_c<Direction::kHorizontal>;
+  filter_luma_strong[0] = &FilterLumaStrong_c<Direction::kVertical>;
+  filter_luma_strong[1] = &FilterLumaStrong_c<Direction::kHorizontal>;
+  filter_chroma[0] = &FilterChroma_c<Direction::kVertical>;
+  filter_chroma[1] = &FilterChroma_c<Direction::kHorizontal>;
+}
+
 }   // namespace xvc
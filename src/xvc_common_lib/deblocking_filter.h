@@ -22,6 +22,8 @@
 #ifndef XVC_COMMON_LIB_DEBLOCKING_FILTER_H_
 #define XVC_COMMON_LIB_DEBLOCKING_FILTER_H_
 
+#include <functional>
+
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/picture_data.h"
 #include "xvc_common_lib/yuv_pic.h"
@@ -35,18 +37,31 @@ enum class Direction {
 
 class DeblockingFilter {
 public:
-  DeblockingFilter(PictureData *pic_data, YuvPicture *rec_pic,
-                   int beta_offset, int tc_offset);
-  void DeblockPicture();
+  struct SimdFunc;
+  // Number of samples to filter in parallel
+  static const int kFilterGroupSize = 4;
+
+  DeblockingFilter(const SimdFunc &simd, PictureData *pic_data,
+                   YuvPicture *rec_pic, int beta_offset, int tc_offset);
+  // Filters all ctu rows, using up to num_threads threads working on
+  // different ctu rows in a wavefront. The optional row_done callback is
+  // invoked from the filtering threads once a ctu row will not be modified
+  // any further, rows above it are then also final.
+  void DeblockPicture(int num_threads = 1,
+                      const std::function<void(int)> &row_done = nullptr);
+  // Filters all edges of one ctu row. Vertical edges only modify samples
+  // inside the row while horizontal edges also modify the bottom samples of
+  // the row above, so rows must be filtered in order and row r is only
+  // final after row r + 1 has been filtered.
+  void DeblockCtuRow(int ctu_row);
 
 private:
   // Controls at what level filter decisions are made at
   static const int kSubblockSize = 8;
   static const int kSubblockSizeExt = 4;
   static const int kChromaFilterResolution = 8;
-  // Number of samples to filter in parallel
-  static const int kFilterGroupSize = 4;
 
+  void DeblockCtuEdges(int rsaddr, Direction dir);
   void DeblockCtu(int rsaddr, CuTree cu_tree, Direction dir,
                   int subblock_size);
   int GetBoundaryStrength(const CodingUnit &cu_p, const CodingUnit &cu_q,
@@ -54,22 +69,32 @@ private:
   void FilterEdgeLuma(int x, int y, Direction dir, int subblock_size,
                       int boundary_strength, int qp);
   bool CheckStrongFilter(Sample *src, int beta, int tc, ptrdiff_t offset);
-  void FilterLumaWeak(Sample *src_ptr, ptrdiff_t step_size,
-                      ptrdiff_t offset, int tc, bool filter_p1,
-                      bool filter_q1);
-  void FilterLumaStrong(Sample *src_ptr, ptrdiff_t step_size,
-                        ptrdiff_t offset, int tc);
   void FilterEdgeChroma(int x, int y, int scale_x, int scale_y, Direction dir,
                         int subblock_size, int boundary_strength, int qp);
-  template<int FilterGroupSize>
-  void FilterChroma(Sample *src_ptr, ptrdiff_t step_size,
-                    ptrdiff_t offset, int tc2);
 
+  const SimdFunc &simd_;
   const Restrictions &restrictions_;
   PictureData *pic_data_;
   YuvPicture *rec_pic_;
   int beta_offset_ = 0;
   int tc_offset_ = 0;
+  int subblock_size_ = kSubblockSizeExt;
+};
+
+struct DeblockingFilter::SimdFunc {
+  // 0: vertical edge, 1: horizontal edge
+  static const int kNumDirections = 2;
+  SimdFunc();
+  // Filters kFilterGroupSize lines across a luma edge
+  void(*filter_luma_weak[kNumDirections])(Sample *src, ptrdiff_t stride,
+                                          int tc, bool filter_p1,
+                                          bool filter_q1, bool sample_decision,
+                                          int bitdepth);
+  void(*filter_luma_strong[kNumDirections])(Sample *src, ptrdiff_t stride,
+                                            int tc2);
+  // Filters 2, 4 or 8 lines across a chroma edge
+  void(*filter_chroma[kNumDirections])(int num_lines, Sample *src,
+                                       ptrdiff_t stride, int tc, int bitdepth);
 };
 
 }   // namespace xvc
@@ -22,6 +22,7 @@
 #include "xvc_common_lib/inter_prediction.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cstdlib>
 #include <limits>
 #include <type_traits>
@@ -137,7 +138,7 @@ InterPrediction::InterPrediction(const SimdFunc &simd,
                                  const YuvPicture &rec_pic, int bitdepth)
   : simd_(simd),
   restrictions_(Restrictions::Get()),
-  rec_pic_(rec_pic),
+  rec_pic_(&rec_pic),
   bitdepth_(bitdepth) {
 }
 
@@ -1089,11 +1090,11 @@ void InterPrediction::MotionCompAffine(const CodingUnit &cu, YuvComponent comp,
     get_subblock_size(mv[0], mv[2], height, ref_pic.GetSizeShiftY(comp));
   // TODO(PH) ClipMv inlined for performance, consider using lambda instead?
   const int mv_max_x =
-    (rec_pic_.GetWidth(luma) - cu.GetPosX(luma) + 8 - 1) * mv_scale;
+    (rec_pic_->GetWidth(luma) - cu.GetPosX(luma) + 8 - 1) * mv_scale;
   const int mv_min_x =
     (-constants::kMaxBlockSize - cu.GetPosX(luma) - 8 + 1) * mv_scale;
   const int mv_max_y =
-    (rec_pic_.GetHeight(luma) - cu.GetPosY(luma) + 8 - 1) * mv_scale;
+    (rec_pic_->GetHeight(luma) - cu.GetPosY(luma) + 8 - 1) * mv_scale;
   const int mv_min_y =
     (-constants::kMaxBlockSize - cu.GetPosY(luma) - 8 + 1) * mv_scale;
   const int delta_mv_hor_x = ((mv[1].x - mv[0].x) * (1 << kAffinePrec)) / width;
@@ -1103,8 +1104,20 @@ void InterPrediction::MotionCompAffine(const CodingUnit &cu, YuvComponent comp,
   MotionVector mv_hor(mv[0].x * (1 << kAffinePrec),
                       mv[0].y * (1 << kAffinePrec));
   MotionVector mv_ver = mv_hor;
+  const bool high_prec = !restrictions_.disable_ext2_inter_high_precision_mv;
+  auto get_filter = [comp, high_prec](int frac) {
+    if (util::IsLuma(comp)) {
+      return high_prec ? &kLumaFilterHighPrec[frac][0] : &kLumaFilter[frac][0];
+    }
+    return high_prec ?
+      &kChromaFilterHighPrec[frac][0] : &kChromaFilter[frac][0];
+  };
 
+  // All subblocks in a row are filtered by one kernel invocation
+  std::array<AffineSubblock, constants::kMaxBlockSize / 2> subblocks;
+  assert(width / subblock_width <= static_cast<int>(subblocks.size()));
   for (int subblock_y = 0; subblock_y < height; subblock_y += subblock_height) {
+    int num_blocks = 0;
     for (int subblock_x = 0; subblock_x < width; subblock_x += subblock_width) {
       const int mv_x =
         util::Clip3((mv_hor.x + delta_mv_hor_x * (subblock_width >> 1) +
@@ -1118,15 +1131,17 @@ void InterPrediction::MotionCompAffine(const CodingUnit &cu, YuvComponent comp,
       const int mv_full_y = mv_y >> mv_shift_y;
       const int frac_x = mv_x & ((1 << mv_shift_x) - 1);
       const int frac_y = mv_y & ((1 << mv_shift_y) - 1);
-      SampleBufferConst ref_buffer =
-        ref_pic.GetSampleBuffer(comp, pos_x + subblock_x + mv_full_x,
-                                pos_y + subblock_y + mv_full_y);
-      PredBuffer block_buffer = pred_buffer->Offset(subblock_x, subblock_y);
-      MotionCompUniPred(subblock_width, subblock_height, comp, ref_buffer,
-                        frac_x, frac_y, &block_buffer);
+      AffineSubblock &subblock = subblocks[num_blocks++];
+      subblock.ref = ref_pic.GetSamplePtr(comp, pos_x + subblock_x + mv_full_x,
+                                          pos_y + subblock_y + mv_full_y);
+      subblock.filter_hor = get_filter(frac_x);
+      subblock.filter_ver = get_filter(frac_y);
       mv_hor.x += delta_mv_hor_x * subblock_width;
       mv_hor.y += delta_mv_hor_y * subblock_width;
     }
+    PredBuffer row_buffer = pred_buffer->Offset(0, subblock_y);
+    MotionCompAffineRow(comp, num_blocks, subblock_width, subblock_height,
+                        &subblocks[0], ref_pic.GetStride(comp), &row_buffer);
 
     mv_ver.x += delta_mv_ver_x * subblock_height;
     mv_ver.y += delta_mv_ver_y * subblock_height;
@@ -1134,6 +1149,32 @@ void InterPrediction::MotionCompAffine(const CodingUnit &cu, YuvComponent comp,
   }
 }
 
+void
+InterPrediction::MotionCompAffineRow(YuvComponent comp, int num_blocks,
+                                     int block_width, int block_height,
+                                     const AffineSubblock *blocks,
+                                     ptrdiff_t ref_stride,
+                                     SampleBuffer *pred_buffer) {
+  const int lc = util::IsLuma(comp) ? 0 : 1;
+  const int i = block_width > 2;
+  simd_.affine_sample[lc][i](num_blocks, block_width, block_height, bitdepth_,
+                             blocks, ref_stride, pred_buffer->GetDataPtr(),
+                             pred_buffer->GetStride());
+}
+
+void
+InterPrediction::MotionCompAffineRow(YuvComponent comp, int num_blocks,
+                                     int block_width, int block_height,
+                                     const AffineSubblock *blocks,
+                                     ptrdiff_t ref_stride,
+                                     DataBuffer<int16_t> *pred_buffer) {
+  const int lc = util::IsLuma(comp) ? 0 : 1;
+  const int i = block_width > 2;
+  simd_.affine_short[lc][i](num_blocks, block_width, block_height, bitdepth_,
+                            blocks, ref_stride, pred_buffer->GetDataPtr(),
+                            pred_buffer->GetStride());
+}
+
 void
 InterPrediction::MotionCompUniPred(int width, int height, YuvComponent comp,
                                    const SampleBufferConst &ref_buffer,
@@ -1383,6 +1424,24 @@ static void FilterVerShortShort(int width, int height, int bitdepth,
   }
 }
 
+template<int N>
+static void FilterVerShortT(int width, int height, int bitdepth,
+                            const int16_t *filter,
+                            const int16_t *src, ptrdiff_t src_stride,
+                            Sample *dst, ptrdiff_t dst_stride) {
+  FilterVerShortSample<N>(width, height, bitdepth, filter, src, src_stride,
+                          dst, dst_stride);
+}
+
+template<int N>
+static void FilterVerShortT(int width, int height, int bitdepth,
+                            const int16_t *filter,
+                            const int16_t *src, ptrdiff_t src_stride,
+                            int16_t *dst, ptrdiff_t dst_stride) {
+  FilterVerShortShort<N>(width, height, bitdepth, filter, src, src_stride,
+                         dst, dst_stride);
+}
+
 void InterPrediction::FilterLuma(int width, int height, int frac_x, int frac_y,
                                  const Sample *ref, ptrdiff_t ref_stride,
                                  Sample *pred, ptrdiff_t pred_stride) {
@@ -1563,11 +1622,11 @@ InterPrediction::LocalIlluminationComp(const CodingUnit &cu, YuvComponent comp,
     MotionVector::kPrecisionShift + ref_pic.GetSizeShiftY(comp);
   const int width = cu.GetWidth(comp);
   const int height = cu.GetHeight(comp);
-  const Sample max_val = (1 << rec_pic_.GetBitdepth()) - 1;
+  const Sample max_val = (1 << rec_pic_->GetBitdepth()) - 1;
   const MotionVector mv_fullpel((mv_x + (1 << (shift_x - 1))) >> shift_x,
     (mv_y + (1 << (shift_y - 1))) >> shift_y);
   SampleBufferConst rec_buffer =
-    rec_pic_.GetSampleBuffer(comp, cu.GetPosX(comp), cu.GetPosY(comp));
+    rec_pic_->GetSampleBuffer(comp, cu.GetPosX(comp), cu.GetPosY(comp));
 
   LicParams params = DeriveLicParams(cu, comp, mv_fullpel, ref_pic, rec_buffer);
   pred_buffer->AddLinearModel(width, height, *pred_buffer, params.scale,
@@ -1698,6 +1757,47 @@ MergeCandidate InterPrediction::GetMergeCandidateFromCu(const CodingUnit &cu,
   return cand;
 }
 
+// Always filters in both directions since a zero phase filter pass is exact,
+// the result is identical to the separate copy, horizontal and vertical paths
+template<int N, typename DstT>
+static void AffineMotionComp_c(int num_blocks, int block_width,
+                               int block_height, int bitdepth,
+                               const InterPrediction::AffineSubblock *blocks,
+                               ptrdiff_t ref_stride,
+                               DstT *pred, ptrdiff_t pred_stride) {
+  int16_t temp[constants::kMaxBlockSize * (constants::kMaxBlockSize + N - 1)];
+  const ptrdiff_t temp_offset = (N / 2 - 1) * block_width;
+  for (int i = 0; i < num_blocks; i++) {
+    const InterPrediction::AffineSubblock &block = blocks[i];
+    FilterHorSampleShort<N>(block_width, block_height + N - 1, bitdepth,
+                            block.filter_hor,
+                            block.ref - (N / 2 - 1) * ref_stride, ref_stride,
+                            temp, block_width);
+    FilterVerShortT<N>(block_width, block_height, bitdepth, block.filter_ver,
+                       temp + temp_offset, block_width,
+                       pred + i * block_width, pred_stride);
+  }
+}
+
+static void AffineGradient_c(int width, int height,
+                             const Sample *src, ptrdiff_t src_stride,
+                             int16_t *grad_hor, int16_t *grad_ver,
+                             ptrdiff_t grad_stride) {
+  for (int y = 1; y < height - 1; y++) {
+    const Sample *above = src + (y - 1) * src_stride;
+    const Sample *center = src + y * src_stride;
+    const Sample *below = src + (y + 1) * src_stride;
+    for (int x = 1; x < width - 1; x++) {
+      grad_hor[y * grad_stride + x] = static_cast<int16_t>(
+        (above[x + 1] - above[x - 1]) + 2 * (center[x + 1] - center[x - 1]) +
+        (below[x + 1] - below[x - 1]));
+      grad_ver[y * grad_stride + x] = static_cast<int16_t>(
+        (below[x - 1] + 2 * below[x] + below[x + 1]) -
+        (above[x - 1] + 2 * above[x] + above[x + 1]));
+    }
+  }
+}
+
 InterPrediction::SimdFunc::SimdFunc() {
   add_avg[0] = &AddAvg_c;
   add_avg[1] = &AddAvg_c;
@@ -1715,6 +1815,13 @@ InterPrediction::SimdFunc::SimdFunc() {
   filter_v_short_sample[1] = &FilterVerShortSample<kNumTapsChroma>;
   filter_v_short_short[0] = &FilterVerShortShort<kNumTapsLuma>;
   filter_v_short_short[1] = &FilterVerShortShort<kNumTapsChroma>;
+  for (int i = 0; i < kSize; i++) {
+    affine_sample[0][i] = &AffineMotionComp_c<kNumTapsLuma, Sample>;
+    affine_sample[1][i] = &AffineMotionComp_c<kNumTapsChroma, Sample>;
+    affine_short[0][i] = &AffineMotionComp_c<kNumTapsLuma, int16_t>;
+    affine_short[1][i] = &AffineMotionComp_c<kNumTapsChroma, int16_t>;
+  }
+  affine_gradient = &AffineGradient_c;
 }
 
 }   // namespace xvc
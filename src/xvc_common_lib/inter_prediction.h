@@ -62,9 +62,16 @@ public:
   static const int kInternalOffset = 1 << (kInternalPrecision - 1);
   static const int kMergeLevelShift = 2;
   struct SimdFunc;
+  // Reference position and filter phases of one affine subblock
+  struct AffineSubblock {
+    const Sample *ref;
+    const int16_t *filter_hor;
+    const int16_t *filter_ver;
+  };
 
   InterPrediction(const SimdFunc &simd, const YuvPicture &rec_pic,
                   int bitdepth);
+  void SetRecPic(const YuvPicture &rec_pic) { rec_pic_ = &rec_pic; }
   InterPredictorList GetMvpList(const CodingUnit &cu, RefPicList ref_list,
                                 int ref_idx);
   AffinePredictorList GetMvpListAffine(const CodingUnit &cu,
@@ -125,6 +132,14 @@ private:
                         const YuvPicture &ref_pic,
                         const MotionVector3 &mv,
                         PredBuffer *pred_buffer);
+  void MotionCompAffineRow(YuvComponent comp, int num_blocks,
+                           int block_width, int block_height,
+                           const AffineSubblock *blocks, ptrdiff_t ref_stride,
+                           SampleBuffer *pred_buffer);
+  void MotionCompAffineRow(YuvComponent comp, int num_blocks,
+                           int block_width, int block_height,
+                           const AffineSubblock *blocks, ptrdiff_t ref_stride,
+                           DataBuffer<int16_t> *pred_buffer);
   void MotionCompUniPred(int width, int height, YuvComponent comp,
                          const SampleBufferConst &ref_buffer,
                          int frac_x, int frac_y,
@@ -167,7 +182,7 @@ private:
 
   const InterPrediction::SimdFunc &simd_;
   const Restrictions &restrictions_;
-  const YuvPicture &rec_pic_;    // current picture, used for template matching
+  const YuvPicture *rec_pic_;    // current picture, used for template matching
   std::array<int16_t, kBufSize> filter_buffer_;
   std::array<std::array<int16_t, constants::kMaxBlockSamples>, 2> bipred_temp_;
   int bitdepth_;
@@ -213,6 +228,24 @@ struct InterPrediction::SimdFunc {
                                    const int16_t *filter,
                                    const int16_t *src, ptrdiff_t src_stride,
                                    int16_t *dst, ptrdiff_t dst_stride);
+  // Separable filtering of a row of equally sized affine subblocks, each
+  // with its own reference position and filter phases
+  void(*affine_sample[kLC][kSize])(int num_blocks, int block_width,
+                                   int block_height, int bitdepth,
+                                   const AffineSubblock *blocks,
+                                   ptrdiff_t ref_stride,
+                                   Sample *pred, ptrdiff_t pred_stride);
+  void(*affine_short[kLC][kSize])(int num_blocks, int block_width,
+                                  int block_height, int bitdepth,
+                                  const AffineSubblock *blocks,
+                                  ptrdiff_t ref_stride,
+                                  int16_t *pred, ptrdiff_t pred_stride);
+  // Sobel gradients scaled by 8 for the samples not on the block border,
+  // used by affine motion estimation
+  void(*affine_gradient)(int width, int height,
+                         const Sample *src, ptrdiff_t src_stride,
+                         int16_t *grad_hor, int16_t *grad_ver,
+                         ptrdiff_t grad_stride);
 };
 
 template<>
@@ -71,8 +71,9 @@ struct IntraPrediction::LmParams {
   int shift;
 };
 
-IntraPrediction::IntraPrediction(int bitdepth)
-  : restrictions_(Restrictions::Get()),
+IntraPrediction::IntraPrediction(const SimdFunc &simd, int bitdepth)
+  : simd_(simd),
+  restrictions_(Restrictions::Get()),
   bitdepth_(bitdepth),
   temp_pred_buffer_(constants::kMaxBlockSize + kDownscaleLumaPadding,
                     constants::kMaxBlockSize + kDownscaleLumaPadding) {
@@ -99,8 +100,9 @@ void IntraPrediction::Predict(IntraMode intra_mode, const CodingUnit &cu,
   const bool post_filter = util::IsLuma(comp) && width <= 16 && height <= 16;
   switch (intra_mode) {
     case IntraMode::kPlanar:
-      PlanarPred(width, height, ref_samples, kRefSampleStride_,
-                 out_ptr, out_stride);
+      simd_.planar_pred[width >= 4](width, height,
+                                    ref_samples, kRefSampleStride_,
+                                    out_ptr, out_stride);
       break;
 
     case IntraMode::kDc:
@@ -139,9 +141,9 @@ IntraPrediction::FillReferenceState(const CodingUnit &cu, YuvComponent comp,
 
   // TODO(Dev) optimize decoder by skipping filtering depending on intra mode
   if (util::IsLuma(comp)) {
-    FilterRefSamples(cu.GetWidth(comp), cu.GetHeight(comp),
-                     &ref_state->ref_samples[0], &ref_state->ref_filtered[0],
-                     kRefSampleStride_);
+    simd_.filter_ref_samples(cu.GetWidth(comp), cu.GetHeight(comp),
+                             &ref_state->ref_samples[0],
+                             &ref_state->ref_filtered[0], kRefSampleStride_);
   }
 }
 
@@ -398,30 +400,6 @@ IntraPrediction::PredIntraDC(int width, int height, bool dc_filter,
   }
 }
 
-void
-IntraPrediction::PlanarPred(int width, int height,
-                            const Sample *ref_samples, ptrdiff_t ref_stride,
-                            Sample *output_buffer, ptrdiff_t output_stride) {
-  const int width_log2 = util::SizeToLog2(width);
-  const int height_log2 = util::SizeToLog2(height);
-  const Sample *above = ref_samples + 1;
-  const Sample *left = ref_samples + ref_stride;
-  Sample topRight = ref_samples[1 + width];
-  Sample bottomLeft = left[height];
-  int shift = width_log2 + height_log2 + 1;
-  int offset = 1 << (shift - 1);
-
-  for (int y = 0; y < height; y++) {
-    for (int x = 0; x < width; x++) {
-      int hor = (height - 1 - y) * above[x] + (y + 1) * bottomLeft;
-      int ver = (width - 1 - x) * left[y] + (x + 1) * topRight;
-      int pred = ((hor << width_log2) + (ver << height_log2) + offset) >> shift;
-      output_buffer[x] = static_cast<Sample>(pred);
-    }
-    output_buffer += output_stride;
-  }
-}
-
 void
 IntraPrediction::AngularPred(int width, int height, IntraMode dir_mode,
                              bool filter,
@@ -497,23 +475,8 @@ IntraPrediction::AngularPred(int width, int height, IntraMode dir_mode,
     }
 
     // Finally generate the prediction
-    int angle_sum = 0;
-    for (int y = 0; y < height; y++) {
-      angle_sum += angle;
-      int offset = angle_sum >> 5;
-      int interpolate_weight = angle_sum & 31;
-      if (interpolate_weight) {
-        for (int x = 0; x < width; x++) {
-          output_buffer[y * output_stride + x] = static_cast<Sample>(
-            ((32 - interpolate_weight) * ref_line[offset + x] +
-             interpolate_weight * ref_line[offset + x + 1] + 16) >> 5);
-        }
-      } else {
-        for (int x = 0; x < width; x++) {
-          output_buffer[y * output_stride + x] = ref_line[offset + x];
-        }
-      }
-    }
+    simd_.angular_pred[width >= 4](width, height, angle, ref_line,
+                                   output_buffer, output_stride);
     if (filter && std::abs(angle) <= 1 &&
         !restrictions_.disable_ext2_intra_67_modes &&
         !restrictions_.disable_intra_ver_hor_post_filter) {
@@ -594,7 +557,7 @@ IntraPrediction::DeriveLmParams(const CodingUnit &cu, YuvComponent comp,
   static const int kModelPrecisionShift = 7;
   const int width = cu.GetWidth(comp);
   const int height = cu.GetHeight(comp);
-  const bool has_above = cu.GetPosY(YuvComponent::kY) > 0;
+  const bool has_above = cu.HasAboveNeighbors();
   const bool has_left = cu.GetPosX(YuvComponent::kY) > 0;
   if (!has_above && !has_left) {
     return LmParams{ 0, 1 << (bitdepth_ - 1), 0 };
@@ -689,16 +652,16 @@ IntraPrediction::NeighborState
 IntraPrediction::DetermineNeighbors(const CodingUnit &cu, YuvComponent comp) {
   NeighborState neighbors;
   int x = cu.GetPosX(comp);
-  int y = cu.GetPosY(comp);
+  bool has_above = cu.HasAboveNeighbors();
   if (x > 0) {
     neighbors.has_left = true;
     neighbors.has_below_left = cu.GetCuSizeBelowLeft(comp);
   }
-  if (y > 0) {
+  if (has_above) {
     neighbors.has_above = true;
     neighbors.has_above_right = cu.GetCuSizeAboveRight(comp);
   }
-  if (x > 0 && y > 0) {
+  if (x > 0 && has_above) {
     neighbors.has_above_left = true;
   }
   return neighbors;
@@ -847,35 +810,12 @@ void IntraPrediction::ComputeRefSamples(int width, int height,
   }
 }
 
-void IntraPrediction::FilterRefSamples(int width, int height,
-                                       const Sample *src_ref, Sample *dst_ref,
-                                       ptrdiff_t stride) {
-  Sample above_left = src_ref[0];
-  dst_ref[0] = ((above_left << 1) + src_ref[1] + src_ref[stride] + 2) >> 2;
-
-  // above
-  for (int x = 1; x < width + height; x++) {
-    dst_ref[x] =
-      ((src_ref[x] << 1) + src_ref[x - 1] + src_ref[x + 1] + 2) >> 2;
-  }
-  dst_ref[width + height] = src_ref[width + height];
-
-  // left
-  dst_ref[stride] =
-    ((src_ref[stride] << 1) + above_left + src_ref[stride + 1] + 2) >> 2;
-  for (int y = 1; y < height + width; y++) {
-    dst_ref[stride + y] = ((src_ref[stride + y] << 1) + src_ref[stride + y - 1]
-                           + src_ref[stride + y + 1] + 2) >> 2;
-  }
-  dst_ref[stride + height + width - 1] = src_ref[stride + height + width - 1];
-}
-
 void IntraPrediction::RescaleLuma(const CodingUnit &cu,
                                   int src_width, int src_height,
                                   const SampleBufferConst &src_buffer,
                                   int out_width, int out_height,
                                   SampleBuffer *out_buffer) {
-  const bool has_above = cu.GetPosY(YuvComponent::kY) > 0;
+  const bool has_above = cu.HasAboveNeighbors();
   const bool has_left = cu.GetPosX(YuvComponent::kY) > 0;
   const ptrdiff_t src_stride = src_buffer.GetStride();
   const ptrdiff_t out_stride = out_buffer->GetStride();
@@ -953,4 +893,80 @@ void IntraPrediction::RescaleLuma(const CodingUnit &cu,
   }
 }
 
+static void PlanarPred_c(int width, int height,
+                         const Sample *ref_samples, ptrdiff_t ref_stride,
+                         Sample *output_buffer, ptrdiff_t output_stride) {
+  const int width_log2 = util::SizeToLog2(width);
+  const int height_log2 = util::SizeToLog2(height);
+  const Sample *above = ref_samples + 1;
+  const Sample *left = ref_samples + ref_stride;
+  Sample topRight = ref_samples[1 + width];
+  Sample bottomLeft = left[height];
+  int shift = width_log2 + height_log2 + 1;
+  int offset = 1 << (shift - 1);
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int hor = (height - 1 - y) * above[x] + (y + 1) * bottomLeft;
+      int ver = (width - 1 - x) * left[y] + (x + 1) * topRight;
+      int pred = ((hor << width_log2) + (ver << height_log2) + offset) >> shift;
+      output_buffer[x] = static_cast<Sample>(pred);
+    }
+    output_buffer += output_stride;
+  }
+}
+
+static void AngularPred_c(int width, int height, int angle,
+                          const Sample *ref_line,
+                          Sample *output_buffer, ptrdiff_t output_stride) {
+  int angle_sum = 0;
+  for (int y = 0; y < height; y++) {
+    angle_sum += angle;
+    int offset = angle_sum >> 5;
+    int interpolate_weight = angle_sum & 31;
+    if (interpolate_weight) {
+      for (int x = 0; x < width; x++) {
+        output_buffer[y * output_stride + x] = static_cast<Sample>(
+          ((32 - interpolate_weight) * ref_line[offset + x] +
+           interpolate_weight * ref_line[offset + x + 1] + 16) >> 5);
+      }
+    } else {
+      for (int x = 0; x < width; x++) {
+        output_buffer[y * output_stride + x] = ref_line[offset + x];
+      }
+    }
+  }
+}
+
+static void FilterRefSamples_c(int width, int height,
+                               const Sample *src_ref, Sample *dst_ref,
+                               ptrdiff_t stride) {
+  Sample above_left = src_ref[0];
+  dst_ref[0] = ((above_left << 1) + src_ref[1] + src_ref[stride] + 2) >> 2;
+
+  // above
+  for (int x = 1; x < width + height; x++) {
+    dst_ref[x] =
+      ((src_ref[x] << 1) + src_ref[x - 1] + src_ref[x + 1] + 2) >> 2;
+  }
+  dst_ref[width + height] = src_ref[width + height];
+
+  // left
+  dst_ref[stride] =
+    ((src_ref[stride] << 1) + above_left + src_ref[stride + 1] + 2) >> 2;
+  for (int y = 1; y < height + width; y++) {
+    dst_ref[stride + y] = ((src_ref[stride + y] << 1) + src_ref[stride + y - 1]
+                           + src_ref[stride + y + 1] + 2) >> 2;
+  }
+  dst_ref[stride + height + width - 1] = src_ref[stride + height + width - 1];
+}
+
+IntraPrediction::SimdFunc::SimdFunc() {
+  angular_pred[0] = &AngularPred_c;
+  angular_pred[1] = &AngularPred_c;
+  planar_pred[0] = &PlanarPred_c;
+  planar_pred[1] = &PlanarPred_c;
+  filter_ref_samples = &FilterRefSamples_c;
+}
+
 }   // namespace xvc
@@ -43,7 +43,8 @@ public:
     std::array<Sample, kRefSampleStride_ * 2> ref_filtered;
   };
 
-  explicit IntraPrediction(int bitdepth);
+  struct SimdFunc;
+  IntraPrediction(const SimdFunc &simd, int bitdepth);
   void Predict(IntraMode intra_mode, const CodingUnit &cu, YuvComponent comp,
                const RefState &ref_state, const YuvPicture &rec_pic,
                SampleBuffer *output_buffer);
@@ -64,9 +65,6 @@ private:
   void PredIntraDC(int width, int height, bool dc_filter,
                    const Sample *ref_samples, ptrdiff_t ref_stride,
                    Sample *output_buffer, ptrdiff_t output_stride);
-  void PlanarPred(int width, int height,
-                  const Sample *ref_samples, ptrdiff_t ref_stride,
-                  Sample *output_buffer, ptrdiff_t output_stride);
   void AngularPred(int width, int height, IntraMode mode, bool filter,
                    const Sample *ref_samples, ptrdiff_t ref_stride,
                    Sample *output_buffer, ptrdiff_t output_stride);
@@ -80,17 +78,32 @@ private:
                          const NeighborState &neighbors,
                          const Sample *input, ptrdiff_t input_stride,
                          Sample *output, ptrdiff_t output_stride);
-  void FilterRefSamples(int width, int height, const Sample *src_ref,
-                        Sample *dst_ref, ptrdiff_t stride);
   void RescaleLuma(const CodingUnit &cu, int src_width, int src_height,
                      const SampleBufferConst &src_buffer,
                      int out_width, int out_height, SampleBuffer *out_buffer);
 
-  const Restrictions restrictions_;
+  const SimdFunc &simd_;
+  const Restrictions &restrictions_;
   int bitdepth_;
   SampleBufferStorage temp_pred_buffer_;
 };
 
+struct IntraPrediction::SimdFunc {
+  // 0: width <= 2, 1: width >= 4
+  static const int kSize = 2;
+
+  SimdFunc();
+  // Interpolation between reference samples for angular modes
+  void(*angular_pred[kSize])(int width, int height, int angle,
+                             const Sample *ref_line,
+                             Sample *output_buffer, ptrdiff_t output_stride);
+  void(*planar_pred[kSize])(int width, int height,
+                            const Sample *ref_samples, ptrdiff_t ref_stride,
+                            Sample *output_buffer, ptrdiff_t output_stride);
+  void(*filter_ref_samples)(int width, int height, const Sample *src_ref,
+                            Sample *dst_ref, ptrdiff_t stride);
+};
+
 }   // namespace xvc
 
 #endif  // XVC_COMMON_LIB_INTRA_PREDICTION_H_
@@ -61,6 +61,7 @@ PictureData::PictureData(ChromaFormat chroma_format, int width, int height,
     std::fill(cu_pic_table_[tree_idx].begin(),
               cu_pic_table_[tree_idx].end(), nullptr);
   }
+  InitSlices(1);
 }
 
 PictureData::~PictureData() {
@@ -87,6 +88,7 @@ void PictureData::Init(const SegmentHeader &segment, const Qp &pic_qp,
 
   // CU structure
   max_binary_split_depth_ = segment.max_binary_split_depth;
+  InitSlices(GetNumSlices(segment));
 
   // Setup Qp
   pic_qp_.reset(new Qp(pic_qp));
@@ -134,6 +136,27 @@ void PictureData::Init(const SegmentHeader &segment, const Qp &pic_qp,
     pic_type == PicturePredictionType::kBi;
 }
 
+void PictureData::SetMaxParallelCtuRows(int num_rows) {
+  int num_coeff_rows = 1;
+  while (num_coeff_rows < num_rows) {
+    num_coeff_rows <<= 1;
+  }
+  if (num_coeff_rows != ctu_coeff_->GetNumCtuRows()) {
+    ctu_coeff_.reset(new CoeffCtuBuffer(chroma_shift_x_, chroma_shift_y_,
+                                        num_coeff_rows));
+  }
+  cu_alloc_thread_safe_ = num_rows > 1;
+}
+
+void PictureData::InitSlices(int num_slices) {
+  slice_ctu_rows_.resize(num_slices + 1);
+  slice_start_.assign(ctu_num_y_ + 1, 0);
+  for (int slice = 0; slice <= num_slices; slice++) {
+    slice_ctu_rows_[slice] = slice * ctu_num_y_ / num_slices;
+    slice_start_[slice_ctu_rows_[slice]] = 1;
+  }
+}
+
 CodingUnit* PictureData::SetCtu(CuTree cu_tree, int rsaddr, CodingUnit *cu) {
   if (ctu_rs_list_[static_cast<int>(cu_tree)][rsaddr] == cu) {
     return nullptr;
@@ -156,6 +179,10 @@ CodingUnit *PictureData::CreateCu(CuTree cu_tree, int depth, int posx,
   if (posx >= pic_width_ || posy >= pic_height_) {
     return nullptr;
   }
+  std::unique_lock<std::mutex> lock(cu_alloc_mutex_, std::defer_lock);
+  if (cu_alloc_thread_safe_) {
+    lock.lock();
+  }
   CodingUnit *cu;
   if (!cu_alloc_free_list_.empty()) {
     cu = cu_alloc_free_list_.back();
@@ -180,9 +207,17 @@ CodingUnit *PictureData::CreateCu(CuTree cu_tree, int depth, int posx,
 }
 
 void PictureData::ReleaseCu(CodingUnit *cu) {
+  std::unique_lock<std::mutex> lock(cu_alloc_mutex_, std::defer_lock);
+  if (cu_alloc_thread_safe_) {
+    lock.lock();
+  }
+  ReleaseCuRecursive(cu);
+}
+
+void PictureData::ReleaseCuRecursive(CodingUnit *cu) {
   for (CodingUnit *sub_cu : cu->GetSubCu()) {
     if (sub_cu) {
-      ReleaseCu(sub_cu);
+      ReleaseCuRecursive(sub_cu);
     }
   }
   cu_alloc_free_list_.push_back(cu);
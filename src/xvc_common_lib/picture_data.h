@@ -22,7 +22,9 @@
 #ifndef XVC_COMMON_LIB_PICTURE_DATA_H_
 #define XVC_COMMON_LIB_PICTURE_DATA_H_
 
+#include <algorithm>
 #include <memory>
+#include <mutex>    // NOLINT
 #include <vector>
 
 #include "xvc_common_lib/picture_types.h"
@@ -42,6 +44,8 @@ public:
 
   void Init(const SegmentHeader &segment, const Qp &pic_qp,
             bool recalculate_lambda);
+  // Allows num_rows ctu rows to be coded concurrently, must be set before Init
+  void SetMaxParallelCtuRows(int num_rows);
 
   // General
   PicturePredictionType GetPredictionType() const;
@@ -97,6 +101,23 @@ public:
   int GetNumberOfCtu() const {
     return static_cast<int>(ctu_rs_list_[0].size());
   }
+  int GetNumCtuX() const { return ctu_num_x_; }
+  int GetNumCtuY() const { return ctu_num_y_; }
+  // Slices are ranges of ctu rows, slice num_slices ends at last ctu row
+  int GetNumSlices() const {
+    return static_cast<int>(slice_ctu_rows_.size()) - 1;
+  }
+  int GetSliceFirstCtuRow(int slice) const { return slice_ctu_rows_[slice]; }
+  // Number of slices that will be used for a segment, at most one per row
+  int GetNumSlices(const SegmentHeader &segment) const {
+    return util::Clip3(segment.num_slices, 1, std::max(1, ctu_num_y_));
+  }
+  // True if posy is the first luma row of a slice (or the row after the
+  // picture), anything above is then unavailable for prediction
+  bool IsSliceStart(int posy) const {
+    return (posy & (constants::kCtuSize - 1)) == 0 &&
+      slice_start_[posy >> constants::kCtuSizeLog2];
+  }
   const CodingUnit* GetCuAt(CuTree cu_tree, int posx, int posy) const {
     ptrdiff_t cu_idx = (posy / constants::kMinBlockSize) * cu_pic_stride_ +
       (posx / constants::kMinBlockSize);
@@ -157,7 +178,9 @@ public:
 private:
   bool DetermineForceBipredL1MvdZero();
   RefPicList DetermineTmvpRefList(int *tmvp_ref_idx);
+  void InitSlices(int num_slices);
   void AllocateAllCtu(CuTree cu_tree);
+  void ReleaseCuRecursive(CodingUnit *cu);
 
   std::array<std::vector<CodingUnit*>,
     constants::kMaxNumCuTrees> ctu_rs_list_;
@@ -169,7 +192,11 @@ private:
   std::vector<CodingUnit*> cu_alloc_free_list_;
   // Chunks of allocated memory, the inner arrays are static and never resized
   std::vector<std::vector<CodingUnit>> cu_alloc_buffers_;
-  // Holds coefficients for a single ctu, then reused for next one
+  // Only needed when multiple ctu rows are coded concurrently
+  std::mutex cu_alloc_mutex_;
+  bool cu_alloc_thread_safe_ = false;
+  // Holds coefficients for a single ctu (per ctu row being coded in parallel),
+  // then reused for next one
   std::unique_ptr<CoeffCtuBuffer> ctu_coeff_;
   ptrdiff_t cu_pic_stride_;
   int pic_width_;
@@ -182,6 +209,8 @@ private:
   int num_cu_trees_;
   int ctu_num_x_;
   int ctu_num_y_;
+  std::vector<int> slice_ctu_rows_;
+  std::vector<uint8_t> slice_start_;
   int cu_alloc_batch_size_;
   size_t cu_alloc_list_index_ = 0;
   size_t cu_alloc_item_index_ = 0;
@@ -91,16 +91,9 @@ double Qp::GetChromaDistWeight(int qp, ChromaFormat chroma_format,
   return pow(2.0, -comp_qp_offset / 3.0);
 }
 
-void Quantize::Inverse(YuvComponent comp, const Qp &qp, int width, int height,
-                       int bitdepth, const Coeff *in, ptrdiff_t in_stride,
-                       Coeff *out, ptrdiff_t out_stride) {
-  const bool size_rounding_bias =
-    (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
-  const int transform_shift = GetTransformShift(width, height, bitdepth);
-  const int shift = kIQuantShift - transform_shift +
-    (size_rounding_bias ? 8 : 0);
-  const int scale = qp.GetInvScale(comp) * (size_rounding_bias ? 181 : 1);
-
+static void InverseQuant_c(int scale, int shift, int width, int height,
+                           const Coeff *in, ptrdiff_t in_stride,
+                           Coeff *out, ptrdiff_t out_stride) {
   if (shift > 0) {
     int offset = (1 << (shift - 1));
     for (int y = 0; y < height; y++) {
@@ -124,10 +117,65 @@ void Quantize::Inverse(YuvComponent comp, const Qp &qp, int width, int height,
   }
 }
 
+static int ForwardQuant_c(int scale, int shift, int64_t offset,
+                          int width, int height,
+                          const Coeff *in, ptrdiff_t in_stride,
+                          Coeff *out, ptrdiff_t out_stride,
+                          Coeff *delta, ptrdiff_t delta_stride) {
+  int num_non_zero = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      int sign = in[x] < 0 ? -1 : 1;
+      int64_t abs_coeff = std::abs(in[x]);
+      int level = static_cast<int>(((abs_coeff * scale) + offset) >> shift);
+      num_non_zero += level != 0;
+      int coeff =
+        util::Clip3(level * sign, constants::kInt16Min, constants::kInt16Max);
+      out[x] = static_cast<Coeff>(coeff);
+      delta[x] = static_cast<Coeff>(((abs_coeff * scale) -
+        (static_cast<int64_t>(level) << shift)) >> (shift - 8));
+    }
+    in += in_stride;
+    delta += delta_stride;
+    out += out_stride;
+  }
+  return num_non_zero;
+}
+
+Quantize::SimdFunc::SimdFunc() {
+  for (int i = 0; i < kSize; i++) {
+    inverse[i] = &InverseQuant_c;
+    forward[i] = &ForwardQuant_c;
+  }
+}
+
+void Quantize::Inverse(YuvComponent comp, const Qp &qp, int width, int height,
+                       int bitdepth, const Coeff *in, ptrdiff_t in_stride,
+                       Coeff *out, ptrdiff_t out_stride) {
+  const int shift = GetInverseShift(width, height, bitdepth);
+  const int scale = GetInverseScale(comp, qp, width, height);
+  simd_.inverse[util::SizeToLog2(width) - 1](scale, shift, width, height,
+                                             in, in_stride, out, out_stride);
+}
+
 int Quantize::GetTransformShift(int width, int height, int bitdepth) {
   const int tr_size_log2 =
     (util::SizeToLog2(width) + util::SizeToLog2(height)) >> 1;
   return constants::kMaxTrDynamicRange - bitdepth - tr_size_log2;
 }
 
+int Quantize::GetInverseShift(int width, int height, int bitdepth) {
+  const bool size_rounding_bias =
+    (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
+  const int transform_shift = GetTransformShift(width, height, bitdepth);
+  return kIQuantShift - transform_shift + (size_rounding_bias ? 8 : 0);
+}
+
+int Quantize::GetInverseScale(YuvComponent comp, const Qp &qp, int width,
+                              int height) {
+  const bool size_rounding_bias =
+    (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
+  return qp.GetInvScale(comp) * (size_rounding_bias ? 181 : 1);
+}
+
 }   // namespace xvc
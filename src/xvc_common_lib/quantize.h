@@ -85,13 +85,41 @@ private:
 
 class Quantize {
 public:
+  struct SimdFunc;
   static const int kQuantShift = 14;
   static const int kIQuantShift = 6;
 
+  explicit Quantize(const SimdFunc &simd) : simd_(simd) {}
   void Inverse(YuvComponent comp, const Qp &qp, int width, int height,
                int bitdepth, const Coeff *in, ptrdiff_t in_stride, Coeff *out,
                ptrdiff_t out_stride);
   static int GetTransformShift(int width, int height, int bitdepth);
+  // Inverse quantization parameters, a negative shift is a left shift
+  static int GetInverseShift(int width, int height, int bitdepth);
+  static int GetInverseScale(YuvComponent comp, const Qp &qp, int width,
+                             int height);
+
+private:
+  const SimdFunc &simd_;
+};
+
+struct Quantize::SimdFunc {
+  // Indexed by log2(width) - 1, i.e. 0: 2, 1: 4, ... 5: 64
+  static const int kSize = 6;
+
+  SimdFunc();
+  // Dequantization with clipping to 16 bits, left shift when shift <= 0
+  void(*inverse[kSize])(int scale, int shift, int width, int height,
+                        const Coeff *in, ptrdiff_t in_stride,
+                        Coeff *out, ptrdiff_t out_stride);
+  // Quantization of the coefficient magnitude with the given rounding offset,
+  // also outputs the rounding error scaled to 8 bits for sign hiding.
+  // Returns the number of non-zero levels.
+  int(*forward[kSize])(int scale, int shift, int64_t offset,
+                       int width, int height,
+                       const Coeff *in, ptrdiff_t in_stride,
+                       Coeff *out, ptrdiff_t out_stride,
+                       Coeff *delta, ptrdiff_t delta_stride);
 };
 
 }   // namespace xvc
@@ -59,6 +59,10 @@ public:
     return ref_list == RefPicList::kL0 ?
       l0_[ref_idx].orig_pic.get() : l1_[ref_idx].orig_pic.get();
   }
+  const PictureData* GetRefPicData(RefPicList ref_list, int ref_idx) const {
+    return ref_list == RefPicList::kL0 ?
+      l0_[ref_idx].data.get() : l1_[ref_idx].data.get();
+  }
   PicNum GetRefPoc(RefPicList ref_list, int ref_idx) const {
     return (ref_list == RefPicList::kL0) ? l0_[ref_idx].poc : l1_[ref_idx].poc;
   }
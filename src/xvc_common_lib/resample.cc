@@ -22,6 +22,7 @@
 #include "xvc_common_lib/resample.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <vector>
 #include <limits>
@@ -93,7 +94,7 @@ void Resampler::ConvertFrom(const PictureFormat &src_format,
 
 void Resampler::ConvertTo(const YuvPicture &src_pic,
                           const PictureFormat &out_fmt,
-                          std::vector<uint8_t> *out_bytes) {
+                          std::vector<uint8_t> *out_bytes, int num_threads) {
   if (src_pic.GetWidth(YuvComponent::kY) == 0 ||
       src_pic.GetHeight(YuvComponent::kY) == 0) {
     out_bytes->clear();
@@ -119,24 +120,10 @@ void Resampler::ConvertTo(const YuvPicture &src_pic,
       out_fmt.height != src_height_nopad ||
       (out_fmt.chroma_format != src_pic.GetChromaFormat() &&
        out_fmt.chroma_format != ChromaFormat::kMonochrome)) {
-    CopyToWithResize(src_pic, out_fmt, dst_bitdepth, out8);
+    CopyToWithResize(src_pic, out_fmt, dst_bitdepth, num_threads, out8);
     if (out_fmt.chroma_format == ChromaFormat::kArgb) {
-      uint16_t *out16 = reinterpret_cast<uint16_t*>(out8);
-      if (out_fmt.bitdepth > 8) {
-        ConvertColorSpace<uint16_t>(&(*out_bytes)[0], out_fmt.width,
-                                    out_fmt.height, out16, out_fmt.bitdepth,
-                                    out_fmt.color_matrix);
-      } else {
-        if (out_fmt.color_matrix == ColorMatrix::kUndefined ||
-            out_fmt.color_matrix == ColorMatrix::k709) {
-          ConvertColorSpace8bit709(&(*out_bytes)[0], out_fmt.width,
-                                   out_fmt.height, out16);
-        } else {
-          ConvertColorSpace<uint8_t>(&(*out_bytes)[0], out_fmt.width,
-                                     out_fmt.height, out16, out_fmt.bitdepth,
-                                     out_fmt.color_matrix);
-        }
-      }
+      ConvertColorSpace(out_fmt, reinterpret_cast<uint16_t*>(out8),
+                        num_threads, &(*out_bytes)[0]);
     }
   } else {
     // Basic conversion or copy without resolution or color space change
@@ -340,15 +327,26 @@ Resampler::CopyToBytesWithShift(YuvComponent comp, const YuvPicture &src_pic,
 
 void Resampler::CopyToWithResize(const YuvPicture &src_pic,
                                  const PictureFormat &out_fmt,
-                                 int dst_bitdepth, uint8_t *out8) const {
+                                 int dst_bitdepth, int num_threads,
+                                 uint8_t *out8) const {
   const ChromaFormat src_chroma_fmt = src_pic.GetChromaFormat();
   const int src_bitdepth = src_pic.GetBitdepth();
   const int num_components_out = util::GetNumComponents(out_fmt.chroma_format);
 
   // Resampling is performed if resolution or chroma format is different
   const int sample_size = (dst_bitdepth > 8 ? 2 : 1);
+  std::array<uint8_t*, constants::kMaxYuvComponents> comp_out8;
   for (int c = 0; c < num_components_out; c++) {
     const YuvComponent comp = YuvComponent(c);
+    comp_out8[c] = out8;
+    out8 += util::ScaleSizeX(out_fmt.width, out_fmt.chroma_format, comp) *
+      util::ScaleSizeY(out_fmt.height, out_fmt.chroma_format, comp) *
+      sample_size;
+  }
+  // Components are written to separate output planes and resized in parallel
+  util::RunJobs(num_components_out, num_threads, [&](int c) {
+    const YuvComponent comp = YuvComponent(c);
+    uint8_t *dst8 = comp_out8[c];
     const Sample *src_sample = src_pic.GetSamplePtr(comp, 0, 0);
     const uint8_t *src8 = reinterpret_cast<const uint8_t*>(src_sample);
     const int dst_width =
@@ -361,117 +359,76 @@ void Resampler::CopyToWithResize(const YuvPicture &src_pic,
       const ptrdiff_t src_stride = src_pic.GetStride(comp);
       const ptrdiff_t dst_stride = dst_width;
       if (dst_width == src_width && dst_height == src_height) {
-        CopyToBytesWithShift(comp, src_pic, dst_bitdepth, out_fmt.dither, out8);
+        CopyToBytesWithShift(comp, src_pic, dst_bitdepth, out_fmt.dither, dst8);
       } else if (comp != YuvComponent::kY &&
                  dst_width == 2 * src_width &&
                  dst_height == 2 * src_height) {
         if (dst_bitdepth > 8) {
           resample::BilinearResample<Sample, uint16_t>
-            (out8, dst_width, dst_height, dst_stride, dst_bitdepth,
+            (dst8, dst_width, dst_height, dst_stride, dst_bitdepth,
              src8, src_width, src_height, src_stride, src_bitdepth);
         } else {
           resample::BilinearResample<Sample, uint8_t>
-            (out8, dst_width, dst_height, dst_stride, dst_bitdepth,
+            (dst8, dst_width, dst_height, dst_stride, dst_bitdepth,
              src8, src_width, src_height, src_stride, src_bitdepth);
         }
       } else if (dst_bitdepth > 8) {
         resample::Resample<Sample, uint16_t>
-          (out8, dst_width, dst_height, dst_stride, dst_bitdepth,
+          (dst8, dst_width, dst_height, dst_stride, dst_bitdepth,
            src8, src_width, src_height, src_stride, src_bitdepth);
       } else {
         resample::Resample<Sample, uint8_t>
-          (out8, dst_width, dst_height, dst_stride, dst_bitdepth,
+          (dst8, dst_width, dst_height, dst_stride, dst_bitdepth,
            src8, src_width, src_height, src_stride, src_bitdepth);
       }
     } else {
       // When monochrome is converted to a chroma format with chroma
       // components, all chroma samples are set to same value
-      std::memset(out8, 1 << (out_fmt.bitdepth - 1),
+      std::memset(dst8, 1 << (out_fmt.bitdepth - 1),
                   dst_width * dst_height * sample_size);
     }
-    out8 += dst_width * dst_height * sample_size;
-  }
-}
-
-template <typename T>
-void Resampler::ConvertColorSpace(uint8_t *out, int width, int height,
-                                  const uint16_t *src, int bitdepth,
-                                  ColorMatrix color_matrix) const {
-  const int size = width * height;
-  const uint16_t *s0 = src;
-  const uint16_t *s1 = src + size;
-  const uint16_t *s2 = src + 2 * size;
-  const Sample sample_max = (1 << bitdepth) - 1;
-  const int shift = 10 + kColorConversionBitdepth - bitdepth;
-  T *dst = reinterpret_cast<T*>(out);
-
-  static const std::array<std::array<std::array<int, 3>, 3>, 4> kM = { {
-    { {  // Default, same as BT.709
-      { 1192, 0, 1877 },
-  { 1192, -223, -558 },
-  { 1192, 2212, 0 }
-      } },
-  { {  // BT.601
-    { 1192, 0, 1671 },
-  { 1192, -410, -851 },
-  { 1192, 2112, 0 }
-    } },
-  { {  // BT.709
-    { 1192, 0, 1877 },
-  { 1192, -223, -558 },
-  { 1192, 2212, 0 }
-    } },
-  { {  // BT.2020
-    { 1192, 0, 1758 },
-  { 1192, -196, -681 },
-  { 1192, 2243, 0 }
-    } },
-    } };
-  const unsigned int k = static_cast<int>(color_matrix);
-  assert(k < kM.size());
-
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++) {
-      int c = *s0++ - (16 << (kColorConversionBitdepth - 8));
-      int d = *s1++ - (128 << (kColorConversionBitdepth - 8));
-      int e = *s2++ - (128 << (kColorConversionBitdepth - 8));
-      dst[0] = static_cast<T>(
-        util::ClipBD((kM[k][0][0] * c + kM[k][0][2] * e) >> shift, sample_max));
-      dst[1] = static_cast<T>(
-        util::ClipBD((kM[k][1][0] * c + kM[k][1][1] * d + kM[k][1][2] * e)
-                     >> shift, sample_max));
-      dst[2] = static_cast<T>(
-        util::ClipBD((kM[k][2][0] * c + kM[k][2][1] * d) >> shift, sample_max));
-      dst[3] = static_cast<T>(sample_max);
-      dst += 4;
-    }
-  }
+  });
 }
 
-void Resampler::ConvertColorSpace8bit709(uint8_t *dst, int width, int height,
-                                         const uint16_t *src) const {
-  const int size = width * height;
-  const uint16_t *s0 = src;
-  const uint16_t *s1 = src + size;
-  const uint16_t *s2 = src + 2 * size;
-  const Sample sample_max = 255;
-  const int shift = kColorConversionBitdepth + 2;
-
-  for (int i = 0; i < height; i++) {
-    for (int j = 0; j < width; j++) {
-      const int c = 1192 * (*s0++ - (16 << (kColorConversionBitdepth - 8)));
-      const int d = *s1++ - (128 << (kColorConversionBitdepth - 8));
-      const int e = *s2++ - (128 << (kColorConversionBitdepth - 8));
-      dst[0] = static_cast<uint8_t>(
-        util::ClipBD((c + 1877 * e) >> shift, sample_max));
-      dst[1] = static_cast<uint8_t>(
-        util::ClipBD((c - 223 * d - 558 * e) >> shift, sample_max));
-      dst[2] = static_cast<uint8_t>(
-        util::ClipBD((c + 2212 * d) >> shift, sample_max));
-      dst[3] = static_cast<uint8_t>(sample_max);
-      dst += 4;
+void Resampler::ConvertColorSpace(const PictureFormat &out_fmt,
+                                  const uint16_t *src, int num_threads,
+                                  uint8_t *out8) const {
+  // Yuv to rgb coefficients indexed by color matrix
+  static const int16_t kYuvToRgb[4][3 * 3] = {
+    // Default, same as BT.709
+    { 1192, 0, 1877, 1192, -223, -558, 1192, 2212, 0 },
+    // BT.601
+    { 1192, 0, 1671, 1192, -410, -851, 1192, 2112, 0 },
+    // BT.709
+    { 1192, 0, 1877, 1192, -223, -558, 1192, 2212, 0 },
+    // BT.2020
+    { 1192, 0, 1758, 1192, -196, -681, 1192, 2243, 0 },
+  };
+  const unsigned int k = static_cast<int>(out_fmt.color_matrix);
+  assert(k < sizeof(kYuvToRgb) / sizeof(kYuvToRgb[0]));
+  const int width = out_fmt.width;
+  const int height = out_fmt.height;
+  const ptrdiff_t plane_size = width * height;
+  // Each job converts a band of consecutive rows
+  num_threads = std::max(1, num_threads);
+  const int rows_per_job = (height + num_threads - 1) / num_threads;
+  const int num_jobs = (height + rows_per_job - 1) / rows_per_job;
+  util::RunJobs(num_jobs, num_threads, [&](int job) {
+    const int y = job * rows_per_job;
+    const int num_rows = std::min(rows_per_job, height - y);
+    const uint16_t *src_y = src + y * width;
+    const uint16_t *src_u = src_y + plane_size;
+    const uint16_t *src_v = src_y + 2 * plane_size;
+    if (out_fmt.bitdepth > 8) {
+      uint16_t *out16 = reinterpret_cast<uint16_t*>(out8) + 4 * y * width;
+      simd_.yuv_to_argb_short(width, num_rows, out_fmt.bitdepth, kYuvToRgb[k],
+                              src_y, src_u, src_v, width, out16, 4 * width);
+    } else {
+      simd_.yuv_to_argb_byte(width, num_rows, out_fmt.bitdepth, kYuvToRgb[k],
+                             src_y, src_u, src_v, width,
+                             out8 + 4 * y * width, 4 * width);
     }
-  }
+  });
 }
 
 static void CopySampleToByte(int width, int height,
@@ -556,6 +513,34 @@ static void UpshiftSampleToShort(int width, int height, int shift,
   }
 }
 
+template<typename T>
+static void YuvToArgb(int width, int height, int out_bitdepth,
+                      const int16_t *matrix, const uint16_t *src_y,
+                      const uint16_t *src_u, const uint16_t *src_v,
+                      ptrdiff_t src_stride, T *out, ptrdiff_t out_stride) {
+  const int bitdepth = Resampler::kColorConversionBitdepth;
+  const int sample_max = (1 << out_bitdepth) - 1;
+  const int shift = 10 + bitdepth - out_bitdepth;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const int c = src_y[x] - (16 << (bitdepth - 8));
+      const int d = src_u[x] - (128 << (bitdepth - 8));
+      const int e = src_v[x] - (128 << (bitdepth - 8));
+      for (int i = 0; i < 3; i++) {
+        const int val = matrix[3 * i + 0] * c + matrix[3 * i + 1] * d +
+          matrix[3 * i + 2] * e;
+        out[4 * x + i] =
+          static_cast<T>(util::Clip3<int>(val >> shift, 0, sample_max));
+      }
+      out[4 * x + 3] = static_cast<T>(sample_max);
+    }
+    src_y += src_stride;
+    src_u += src_stride;
+    src_v += src_stride;
+    out += out_stride;
+  }
+}
+
 Resampler::SimdFunc::SimdFunc() {
   copy_sample_byte = &CopySampleToByte;
   copy_sample_short = &CopySampleToShort;
@@ -564,6 +549,8 @@ Resampler::SimdFunc::SimdFunc() {
   downshift_sample_short[0] = &DownshiftSampleFast<uint16_t>;
   downshift_sample_short[1] = &DownshiftSampleDither<uint16_t>;
   upshift_sample_short = &UpshiftSampleToShort;
+  yuv_to_argb_byte = &YuvToArgb<uint8_t>;
+  yuv_to_argb_short = &YuvToArgb<uint16_t>;
 }
 
 namespace resample {
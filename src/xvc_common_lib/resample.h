@@ -42,11 +42,13 @@ public:
   void ConvertFrom(const PictureFormat &src_format,
                    const PicPlanes &input_planes,
                    YuvPicture *out_pic);
+  // Resizing and color conversion are split over num_threads threads
   void ConvertTo(const YuvPicture &src_pic, const PictureFormat &output_format,
-                 std::vector<uint8_t> *out_bytes);
+                 std::vector<uint8_t> *out_bytes, int num_threads = 1);
+  // Bitdepth of the 4:4:4 samples that are converted to argb
+  static const int kColorConversionBitdepth = 12;
 
 private:
-  static const int kColorConversionBitdepth = 12;
   const uint8_t*
     CopyFromBytesFast(YuvComponent comp, const uint8_t *input_bytes,
                       ptrdiff_t input_stride, int input_bitdepth,
@@ -64,13 +66,11 @@ private:
                                 uint8_t *out8) const;
   void CopyToWithResize(const YuvPicture &src_pic,
                         const PictureFormat &output_format,
-                        int dst_bitdepth, uint8_t *out8) const;
-  template <typename T>
-  void ConvertColorSpace(uint8_t *dst, int width, int height,
-                         const uint16_t *src, int bitdepth,
-                         ColorMatrix color_matrix) const;
-  void ConvertColorSpace8bit709(uint8_t *dst, int width, int height,
-                                const uint16_t *src) const;
+                        int dst_bitdepth, int num_threads,
+                        uint8_t *out8) const;
+  void ConvertColorSpace(const PictureFormat &output_format,
+                         const uint16_t *src, int num_threads,
+                         uint8_t *out8) const;
 
   const SimdFunc &simd_;
   std::vector<uint8_t> tmp_bytes_;
@@ -96,6 +96,17 @@ struct Resampler::SimdFunc {
   void(*upshift_sample_short)(int width, int height, int shift,
                               const Sample *src, ptrdiff_t src_stride,
                               uint16_t *out, ptrdiff_t out_stride);
+  // Matrix holds the 3x3 yuv to rgb coefficients in row major order
+  void(*yuv_to_argb_byte)(int width, int height, int out_bitdepth,
+                          const int16_t *matrix, const uint16_t *src_y,
+                          const uint16_t *src_u, const uint16_t *src_v,
+                          ptrdiff_t src_stride,
+                          uint8_t *out, ptrdiff_t out_stride);
+  void(*yuv_to_argb_short)(int width, int height, int out_bitdepth,
+                           const int16_t *matrix, const uint16_t *src_y,
+                           const uint16_t *src_u, const uint16_t *src_v,
+                           ptrdiff_t src_stride,
+                           uint16_t *out, ptrdiff_t out_stride);
 };
 
 // TODO(PH) Refactor into Resampler class
@@ -149,6 +149,17 @@ public:
       disable_ext2_cabac_alt_residual_ctx;
   }
 
+  bool GetAnyRestrictions() const {
+    return GetIntraRestrictions() ||
+      GetInterRestrictions() ||
+      GetTransformRestrictions() ||
+      GetCabacRestrictions() ||
+      GetDeblockRestrictions() ||
+      GetHighLevelRestrictions() ||
+      GetExtRestrictions() ||
+      GetExt2Restrictions();
+  }
+
   bool disable_intra_ref_padding = false;
   bool disable_intra_ref_sample_filter = false;
   bool disable_intra_dc_post_filter = false;
@@ -240,6 +251,8 @@ private:
   friend class Decoder;
   friend class ThreadDecoder;
   friend class ThreadEncoder;
+  friend class PictureEncoder;
+  friend class PictureDecoder;
   static thread_local Restrictions instance;
   static Restrictions& GetRW() { return instance; }
 
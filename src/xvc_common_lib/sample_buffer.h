@@ -23,8 +23,10 @@
 #define XVC_COMMON_LIB_SAMPLE_BUFFER_H_
 
 #include <array>
+#include <cassert>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/utils.h"
@@ -204,19 +206,30 @@ public:
 
 class CoeffCtuBuffer {
 public:
-  CoeffCtuBuffer(int chroma_shift_x, int chroma_shift_y) :
-    // For getting relative position within CTU
+  // Holds coefficients for one ctu in each of num_ctu_rows consecutive ctu
+  // rows, allowing that many ctu rows to be processed concurrently
+  CoeffCtuBuffer(int chroma_shift_x, int chroma_shift_y,
+                 int num_ctu_rows = 1) :
+    num_ctu_rows_(num_ctu_rows),
+    // For getting relative position within CTU (and ctu row slot)
     pos_mask_x_({ { constants::kMaxBlockSize - 1,
                 (constants::kMaxBlockSize >> chroma_shift_x) - 1,
                 (constants::kMaxBlockSize >> chroma_shift_x) - 1 } }),
-    pos_mask_y_({ { constants::kMaxBlockSize - 1,
-                (constants::kMaxBlockSize >> chroma_shift_y) - 1,
-                (constants::kMaxBlockSize >> chroma_shift_y) - 1 } }) {
+    pos_mask_y_({ { num_ctu_rows * constants::kMaxBlockSize - 1,
+                ((num_ctu_rows * constants::kMaxBlockSize) >>
+                 chroma_shift_y) - 1,
+                ((num_ctu_rows * constants::kMaxBlockSize) >>
+                 chroma_shift_y) - 1 } }) {
+    assert((num_ctu_rows & (num_ctu_rows - 1)) == 0);
+    for (auto &storage : comp_storage_) {
+      storage.resize(num_ctu_rows * constants::kMaxBlockSize * kStride);
+    }
   }
   CoeffCtuBuffer(const CoeffCtuBuffer&) = delete;
   CoeffCtuBuffer(const CoeffCtuBuffer&&) = delete;
   CoeffCtuBuffer& operator=(const CoeffCtuBuffer&) = delete;
 
+  int GetNumCtuRows() const { return num_ctu_rows_; }
   CoeffBuffer GetBuffer(YuvComponent comp, int posx, int posy) {
     posx = posx & pos_mask_x_[static_cast<int>(comp)];
     posy = posy & pos_mask_y_[static_cast<int>(comp)];
@@ -233,10 +246,10 @@ public:
 
 private:
   static const int kStride = constants::kMaxBlockSize;
+  const int num_ctu_rows_;
   std::array<int, constants::kMaxYuvComponents> pos_mask_x_;
   std::array<int, constants::kMaxYuvComponents> pos_mask_y_;
-  std::array<std::array<Coeff, constants::kMaxBlockSamples * kStride>,
-    constants::kMaxYuvComponents> comp_storage_;
+  std::array<std::vector<Coeff>, constants::kMaxYuvComponents> comp_storage_;
 };
 
 }   // namespace xvc
@@ -48,6 +48,9 @@ struct SegmentHeader {
                                 PicNum sub_gop_length);
   static double GetFramerate(int max_tid, int bitstream_ticks,
                              PicNum sub_gop_length);
+  static bool HasSlices(uint32_t major_version, uint32_t minor_version) {
+    return major_version > 2 || (major_version == 2 && minor_version >= 1);
+  }
   void SetWidth(int output_width) {
     output_pic_width_ = output_width;
     internal_pic_width_ = constants::kMinCuSize *
@@ -96,6 +99,8 @@ struct SegmentHeader {
   DeblockingMode deblocking_mode = DeblockingMode::kDisabled;
   int beta_offset = 0;
   int tc_offset = 0;
+  // Number of independently decodable slices of ctu rows in each picture
+  int num_slices = 1;
   Restrictions restrictions;
 
 private:
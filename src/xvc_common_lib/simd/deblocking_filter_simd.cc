@@ -0,0 +1,370 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#include "xvc_common_lib/simd/deblocking_filter_simd.h"
+
+#ifdef XVC_ARCH_X86
+#include <smmintrin.h>  // SSE4.1
+#endif  // XVC_ARCH_X86
+
+#include <cstring>
+#include <type_traits>
+
+#include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/deblocking_filter.h"
+
+#ifdef _MSC_VER
+#define __attribute__(SPEC)
+#endif  // _MSC_VER
+
+#ifdef XVC_ARCH_X86
+// Formatting helper
+#define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
+#endif  // XVC_ARCH_X86
+
+namespace xvc {
+namespace simd {
+
+#ifdef XVC_ARCH_X86
+// All filtering is made with 32-bit lanes, one lane for each of the
+// kFilterGroupSize lines that are filtered together
+static_assert(DeblockingFilter::kFilterGroupSize == 4,
+              "Filter group shall match the number of 32-bit lanes");
+
+// Loads 2 or 4 consecutive samples as 32-bit values
+__attribute__((target("sse4.1")))
+static inline __m128i LoadSamplesEpi32(const Sample *src, int num) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    int32_t val = 0;
+    std::memcpy(&val, src, sizeof(Sample) * num);
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(val));
+  }
+  if (num == 4) {
+    return _mm_cvtepu16_epi32(_mm_loadl_epi64(CAST_M128_CONST(src)));
+  }
+  int32_t val;
+  std::memcpy(&val, src, sizeof(val));
+  return _mm_cvtepu16_epi32(_mm_cvtsi32_si128(val));
+}
+
+// Stores 2 or 4 (non-negative) 32-bit values as consecutive samples
+__attribute__((target("sse4.1")))
+static inline void StoreSamplesEpi32(__m128i val, Sample *dst, int num) {
+  __m128i packed = _mm_packus_epi32(val, val);
+  if (std::is_same<Sample, uint8_t>::value) {
+    int32_t out = _mm_cvtsi128_si32(_mm_packus_epi16(packed, packed));
+    std::memcpy(dst, &out, sizeof(Sample) * num);
+  } else if (num == 4) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), packed);
+  } else {
+    int32_t out = _mm_cvtsi128_si32(packed);
+    std::memcpy(dst, &out, sizeof(out));
+  }
+}
+
+// Loads 8 consecutive samples as 16-bit values
+__attribute__((target("sse4.1")))
+static inline __m128i LoadSamples8(const Sample *src) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    return _mm_cvtepu8_epi16(_mm_loadl_epi64(CAST_M128_CONST(src)));
+  }
+  return _mm_loadu_si128(CAST_M128_CONST(src));
+}
+
+// Stores 8 16-bit values as consecutive samples
+__attribute__((target("sse4.1")))
+static inline void StoreSamples8(__m128i val, Sample *dst) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst),
+                     _mm_packus_epi16(val, val));
+  } else {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), val);
+  }
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i Clip3(__m128i val, __m128i min, __m128i max) {
+  return _mm_min_epi32(_mm_max_epi32(val, min), max);
+}
+
+// Loads the 8 samples across a vertical edge (p3 to q3) for 4 lines
+// and returns them transposed as one vector per sample position
+__attribute__((target("sse4.1")))
+static inline void LoadVerticalEdge(const Sample *src, ptrdiff_t stride,
+                                    __m128i *out) {
+  __m128i r0 = LoadSamples8(src - 4);
+  __m128i r1 = LoadSamples8(src - 4 + stride);
+  __m128i r2 = LoadSamples8(src - 4 + stride * 2);
+  __m128i r3 = LoadSamples8(src - 4 + stride * 3);
+  __m128i t0 = _mm_unpacklo_epi16(r0, r1);
+  __m128i t1 = _mm_unpacklo_epi16(r2, r3);
+  __m128i t2 = _mm_unpackhi_epi16(r0, r1);
+  __m128i t3 = _mm_unpackhi_epi16(r2, r3);
+  // Each vector holds two sample positions for all 4 lines
+  __m128i u[4] = {
+    _mm_unpacklo_epi32(t0, t1), _mm_unpackhi_epi32(t0, t1),
+    _mm_unpacklo_epi32(t2, t3), _mm_unpackhi_epi32(t2, t3)
+  };
+  for (int i = 0; i < 4; i++) {
+    out[2 * i] = _mm_cvtepu16_epi32(u[i]);
+    out[2 * i + 1] = _mm_cvtepu16_epi32(_mm_srli_si128(u[i], 8));
+  }
+}
+
+// Inverse of LoadVerticalEdge
+__attribute__((target("sse4.1")))
+static inline void StoreVerticalEdge(const __m128i *in, Sample *dst,
+                                     ptrdiff_t stride) {
+  __m128i u0 = _mm_packus_epi32(in[0], in[1]);
+  __m128i u1 = _mm_packus_epi32(in[2], in[3]);
+  __m128i u2 = _mm_packus_epi32(in[4], in[5]);
+  __m128i u3 = _mm_packus_epi32(in[6], in[7]);
+  __m128i v0 = _mm_unpacklo_epi16(u0, u1);
+  __m128i v1 = _mm_unpackhi_epi16(u0, u1);
+  __m128i v2 = _mm_unpacklo_epi16(u2, u3);
+  __m128i v3 = _mm_unpackhi_epi16(u2, u3);
+  __m128i w0 = _mm_unpacklo_epi16(v0, v1);
+  __m128i w1 = _mm_unpackhi_epi16(v0, v1);
+  __m128i w2 = _mm_unpacklo_epi16(v2, v3);
+  __m128i w3 = _mm_unpackhi_epi16(v2, v3);
+  StoreSamples8(_mm_unpacklo_epi64(w0, w2), dst - 4);
+  StoreSamples8(_mm_unpackhi_epi64(w0, w2), dst - 4 + stride);
+  StoreSamples8(_mm_unpacklo_epi64(w1, w3), dst - 4 + stride * 2);
+  StoreSamples8(_mm_unpackhi_epi64(w1, w3), dst - 4 + stride * 3);
+}
+
+// Filters samples p3 to q3 given in s[0] to s[7]
+__attribute__((target("sse4.1")))
+static inline void LumaStrong(__m128i *s, int tc2) {
+  const __m128i p3 = s[0], p2 = s[1], p1 = s[2], p0 = s[3];
+  const __m128i q0 = s[4], q1 = s[5], q2 = s[6], q3 = s[7];
+  const __m128i vtc2 = _mm_set1_epi32(tc2);
+  const __m128i c2 = _mm_set1_epi32(2);
+  const __m128i c4 = _mm_set1_epi32(4);
+  const __m128i p0q0 = _mm_add_epi32(p0, q0);
+  const __m128i sum_p = _mm_add_epi32(_mm_add_epi32(p2, p1), p0q0);
+  const __m128i sum_q = _mm_add_epi32(_mm_add_epi32(q2, q1), p0q0);
+  __m128i np2 = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(p3, p2), 1), sum_p);
+  np2 = _mm_srai_epi32(_mm_add_epi32(np2, c4), 3);
+  __m128i np1 = _mm_srai_epi32(_mm_add_epi32(sum_p, c2), 2);
+  __m128i np0 = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(p1, p0q0), 1),
+                              _mm_add_epi32(p2, q1));
+  np0 = _mm_srai_epi32(_mm_add_epi32(np0, c4), 3);
+  __m128i nq0 = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(q1, p0q0), 1),
+                              _mm_add_epi32(q2, p1));
+  nq0 = _mm_srai_epi32(_mm_add_epi32(nq0, c4), 3);
+  __m128i nq1 = _mm_srai_epi32(_mm_add_epi32(sum_q, c2), 2);
+  __m128i nq2 = _mm_add_epi32(_mm_slli_epi32(_mm_add_epi32(q3, q2), 1), sum_q);
+  nq2 = _mm_srai_epi32(_mm_add_epi32(nq2, c4), 3);
+  s[1] = Clip3(np2, _mm_sub_epi32(p2, vtc2), _mm_add_epi32(p2, vtc2));
+  s[2] = Clip3(np1, _mm_sub_epi32(p1, vtc2), _mm_add_epi32(p1, vtc2));
+  s[3] = Clip3(np0, _mm_sub_epi32(p0, vtc2), _mm_add_epi32(p0, vtc2));
+  s[4] = Clip3(nq0, _mm_sub_epi32(q0, vtc2), _mm_add_epi32(q0, vtc2));
+  s[5] = Clip3(nq1, _mm_sub_epi32(q1, vtc2), _mm_add_epi32(q1, vtc2));
+  s[6] = Clip3(nq2, _mm_sub_epi32(q2, vtc2), _mm_add_epi32(q2, vtc2));
+}
+
+// Filters samples p2 to q2 given in s[1] to s[6]
+__attribute__((target("sse4.1")))
+static inline void LumaWeak(__m128i *s, int tc, bool filter_p1,
+                            bool filter_q1, bool sample_decision,
+                            int bitdepth) {
+  const __m128i p2 = s[1], p1 = s[2], p0 = s[3];
+  const __m128i q0 = s[4], q1 = s[5], q2 = s[6];
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i sample_max = _mm_set1_epi32((1 << bitdepth) - 1);
+  const __m128i vtc = _mm_set1_epi32(tc);
+  const __m128i neg_tc = _mm_set1_epi32(-tc);
+  const __m128i one = _mm_set1_epi32(1);
+  __m128i diff0 = _mm_sub_epi32(q0, p0);
+  __m128i diff1 = _mm_sub_epi32(q1, p1);
+  // 9 * (q0 - p0) - 3 * (q1 - p1)
+  __m128i delta =
+    _mm_sub_epi32(_mm_add_epi32(_mm_slli_epi32(diff0, 3), diff0),
+                  _mm_add_epi32(_mm_slli_epi32(diff1, 1), diff1));
+  delta = _mm_srai_epi32(_mm_add_epi32(delta, _mm_set1_epi32(8)), 4);
+  __m128i mask = _mm_set1_epi32(-1);
+  if (sample_decision) {
+    mask = _mm_cmplt_epi32(_mm_abs_epi32(delta), _mm_set1_epi32(tc * 10));
+  }
+  delta = Clip3(delta, neg_tc, vtc);
+  __m128i np0 = Clip3(_mm_add_epi32(p0, delta), zero, sample_max);
+  __m128i nq0 = Clip3(_mm_sub_epi32(q0, delta), zero, sample_max);
+  s[3] = _mm_blendv_epi8(p0, np0, mask);
+  s[4] = _mm_blendv_epi8(q0, nq0, mask);
+  const __m128i half_tc = _mm_set1_epi32(tc >> 1);
+  const __m128i neg_half_tc = _mm_set1_epi32(-(tc >> 1));
+  if (filter_p1) {
+    __m128i avg = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(p2, p0), one), 1);
+    __m128i delta_p1 =
+      _mm_srai_epi32(_mm_add_epi32(_mm_sub_epi32(avg, p1), delta), 1);
+    delta_p1 = Clip3(delta_p1, neg_half_tc, half_tc);
+    __m128i np1 = Clip3(_mm_add_epi32(p1, delta_p1), zero, sample_max);
+    s[2] = _mm_blendv_epi8(p1, np1, mask);
+  }
+  if (filter_q1) {
+    __m128i avg = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(q2, q0), one), 1);
+    __m128i delta_q1 =
+      _mm_srai_epi32(_mm_sub_epi32(_mm_sub_epi32(avg, q1), delta), 1);
+    delta_q1 = Clip3(delta_q1, neg_half_tc, half_tc);
+    __m128i nq1 = Clip3(_mm_add_epi32(q1, delta_q1), zero, sample_max);
+    s[5] = _mm_blendv_epi8(q1, nq1, mask);
+  }
+}
+
+// Filters samples p0 and q0 given p1, p0, q0, q1 in s[0] to s[3]
+__attribute__((target("sse4.1")))
+static inline void Chroma(__m128i *s, int tc, int bitdepth) {
+  const __m128i p1 = s[0], p0 = s[1], q0 = s[2], q1 = s[3];
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i sample_max = _mm_set1_epi32((1 << bitdepth) - 1);
+  __m128i delta = _mm_add_epi32(_mm_slli_epi32(_mm_sub_epi32(q0, p0), 2),
+                                _mm_sub_epi32(p1, q1));
+  delta = _mm_srai_epi32(_mm_add_epi32(delta, _mm_set1_epi32(4)), 3);
+  delta = Clip3(delta, _mm_set1_epi32(-tc), _mm_set1_epi32(tc));
+  s[1] = Clip3(_mm_add_epi32(p0, delta), zero, sample_max);
+  s[2] = Clip3(_mm_sub_epi32(q0, delta), zero, sample_max);
+}
+
+__attribute__((target("sse4.1")))
+static void FilterLumaWeakVerSse4(Sample *src, ptrdiff_t stride, int tc,
+                                  bool filter_p1, bool filter_q1,
+                                  bool sample_decision, int bitdepth) {
+  __m128i s[8];
+  LoadVerticalEdge(src, stride, s);
+  LumaWeak(s, tc, filter_p1, filter_q1, sample_decision, bitdepth);
+  StoreVerticalEdge(s, src, stride);
+}
+
+__attribute__((target("sse4.1")))
+static void FilterLumaWeakHorSse4(Sample *src, ptrdiff_t stride, int tc,
+                                  bool filter_p1, bool filter_q1,
+                                  bool sample_decision, int bitdepth) {
+  __m128i s[8];
+  for (int i = 1; i < 7; i++) {
+    s[i] = LoadSamplesEpi32(src + (i - 4) * stride, 4);
+  }
+  LumaWeak(s, tc, filter_p1, filter_q1, sample_decision, bitdepth);
+  for (int i = 2; i < 6; i++) {
+    StoreSamplesEpi32(s[i], src + (i - 4) * stride, 4);
+  }
+}
+
+__attribute__((target("sse4.1")))
+static void FilterLumaStrongVerSse4(Sample *src, ptrdiff_t stride, int tc2) {
+  __m128i s[8];
+  LoadVerticalEdge(src, stride, s);
+  LumaStrong(s, tc2);
+  StoreVerticalEdge(s, src, stride);
+}
+
+__attribute__((target("sse4.1")))
+static void FilterLumaStrongHorSse4(Sample *src, ptrdiff_t stride, int tc2) {
+  __m128i s[8];
+  for (int i = 0; i < 8; i++) {
+    s[i] = LoadSamplesEpi32(src + (i - 4) * stride, 4);
+  }
+  LumaStrong(s, tc2);
+  for (int i = 1; i < 7; i++) {
+    StoreSamplesEpi32(s[i], src + (i - 4) * stride, 4);
+  }
+}
+
+__attribute__((target("sse4.1")))
+static void FilterChromaVerSse4(int num_lines, Sample *src, ptrdiff_t stride,
+                                int tc, int bitdepth) {
+  for (int line = 0; line < num_lines; line += 4) {
+    const int num = num_lines - line < 4 ? num_lines - line : 4;
+    // Samples p1 to q1 as 16-bit values, one line per row
+    __m128i r[4];
+    for (int i = 0; i < 4; i++) {
+      r[i] = i >= num ? _mm_setzero_si128() :
+        LoadSamplesEpi32(src + i * stride - 2, 4);
+      r[i] = _mm_packus_epi32(r[i], r[i]);
+    }
+    __m128i t0 = _mm_unpacklo_epi16(r[0], r[1]);
+    __m128i t1 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i u0 = _mm_unpacklo_epi32(t0, t1);
+    __m128i u1 = _mm_unpackhi_epi32(t0, t1);
+    __m128i s[4] = {
+      _mm_cvtepu16_epi32(u0), _mm_cvtepu16_epi32(_mm_srli_si128(u0, 8)),
+      _mm_cvtepu16_epi32(u1), _mm_cvtepu16_epi32(_mm_srli_si128(u1, 8))
+    };
+    Chroma(s, tc, bitdepth);
+    // Interleave p0 and q0 so that each line is a pair of samples
+    __m128i out = _mm_packus_epi32(_mm_unpacklo_epi32(s[1], s[2]),
+                                   _mm_unpackhi_epi32(s[1], s[2]));
+    Sample pairs[8];
+    StoreSamples8(out, pairs);
+    for (int i = 0; i < num; i++) {
+      std::memcpy(src + i * stride - 1, pairs + 2 * i, 2 * sizeof(Sample));
+    }
+    src += 4 * stride;
+  }
+}
+
+__attribute__((target("sse4.1")))
+static void FilterChromaHorSse4(int num_lines, Sample *src, ptrdiff_t stride,
+                                int tc, int bitdepth) {
+  for (int line = 0; line < num_lines; line += 4) {
+    const int num = num_lines - line < 4 ? num_lines - line : 4;
+    __m128i s[4];
+    for (int i = 0; i < 4; i++) {
+      s[i] = LoadSamplesEpi32(src + (i - 2) * stride, num);
+    }
+    Chroma(s, tc, bitdepth);
+    StoreSamplesEpi32(s[1], src - stride, num);
+    StoreSamplesEpi32(s[2], src, num);
+    src += 4;
+  }
+}
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_ARM
+void DeblockingFilterSimd::Register(const std::set<CpuCapability> &caps,
+                                    xvc::SimdFunctions *simd_functions) {
+}
+#endif  // XVC_ARCH_ARM
+
+#ifdef XVC_ARCH_X86
+void DeblockingFilterSimd::Register(const std::set<CpuCapability> &caps,
+                                    xvc::SimdFunctions *simd_functions) {
+  DeblockingFilter::SimdFunc &deblock = simd_functions->deblocking_filter;
+  if (caps.find(CpuCapability::kSse4_1) != caps.end()) {
+    deblock.filter_luma_weak[0] = &FilterLumaWeakVerSse4;
+    deblock.filter_luma_weak[1] = &FilterLumaWeakHorSse4;
+    deblock.filter_luma_strong[0] = &FilterLumaStrongVerSse4;
+    deblock.filter_luma_strong[1] = &FilterLumaStrongHorSse4;
+    deblock.filter_chroma[0] = &FilterChromaVerSse4;
+    deblock.filter_chroma[1] = &FilterChromaHorSse4;
+  }
+}
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_MIPS
+void DeblockingFilterSimd::Register(const std::set<CpuCapability> &caps,
+                                    xvc::SimdFunctions *simd_functions) {
+}
+#endif  // XVC_ARCH_MIPS
+
+}   // namespace simd
+}   // namespace xvc
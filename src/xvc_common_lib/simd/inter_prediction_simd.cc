@@ -22,12 +22,21 @@
 #include "xvc_common_lib/simd/inter_prediction_simd.h"
 
 #ifdef XVC_ARCH_X86
-#include <emmintrin.h>  // SSE2
+#if __GNUC__  == 4 && __GNUC_MINOR__  <= 8 && not defined(__AVX2__)
+#define USE_AVX2 0  // gcc 4.8 requires -mavx2 before defining __m256i
+#else
+#define USE_AVX2 1
+#endif
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_X86
+#include <immintrin.h>  // AVX2
 #endif  // XVC_ARCH_X86
 #ifdef XVC_HAVE_NEON
 #include <arm_neon.h>
 #endif  // XVC_HAVE_NEON
 
+#include <cstring>
 #include <type_traits>
 
 #include "xvc_common_lib/simd_functions.h"
@@ -40,6 +49,7 @@
 #ifdef XVC_ARCH_X86
 // Formatting helper
 #define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
+#define CAST_M256_CONST(VAL) reinterpret_cast<const __m256i*>((VAL))
 #endif  // XVC_ARCH_X86
 
 namespace xvc {
@@ -1244,6 +1254,494 @@ void FilterVerChromaNeon(int width, int height, int bitdepth,
 }
 #endif  // XVC_HAVE_NEON
 
+#if defined(XVC_ARCH_X86) && USE_AVX2
+// Loads 16 consecutive samples widened to 16 bits
+template<typename SrcT>
+__attribute__((target("avx2")))
+static inline __m256i LoadRow16Avx2(const SrcT *src) {
+  if (std::is_same<SrcT, uint8_t>::value) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(CAST_M128_CONST(src)));
+  }
+  return _mm256_loadu_si256(CAST_M256_CONST(src));
+}
+
+// Stores 16 samples with optional clipping to the sample range
+template<typename DstT, bool Clip>
+__attribute__((target("avx2")))
+static inline void StoreRow16Avx2(__m256i sum, const __m256i &min,
+                                  const __m256i &max, DstT *dst) {
+  if (!Clip) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), sum);
+  } else if (std::is_same<DstT, uint8_t>::value) {
+    // Pack within lanes and then move the upper lane result down
+    __m256i out8 = _mm256_packus_epi16(sum, sum);
+    __m256i out = _mm256_permute4x64_epi64(out8, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm256_castsi256_si128(out));
+  } else {
+    __m256i out = _mm256_max_epi16(min, _mm256_min_epi16(sum, max));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), out);
+  }
+}
+
+// Multiplies two sample vectors with a pair of filter taps, the result is
+// 32-bit sums for samples 0-3, 8-11 (lo) and 4-7, 12-15 (hi)
+__attribute__((target("avx2")))
+static inline void FilterPairAvx2(__m256i a, __m256i b, __m256i vfilter,
+                                  __m256i *sum_lo, __m256i *sum_hi) {
+  __m256i ab_lo = _mm256_unpacklo_epi16(a, b);
+  __m256i ab_hi = _mm256_unpackhi_epi16(a, b);
+  *sum_lo = _mm256_add_epi32(*sum_lo, _mm256_madd_epi16(ab_lo, vfilter));
+  *sum_hi = _mm256_add_epi32(*sum_hi, _mm256_madd_epi16(ab_hi, vfilter));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i FilterRoundAvx2(__m256i sum_lo, __m256i sum_hi,
+                                      __m256i voffset, int shift) {
+  __m256i out_lo = _mm256_srai_epi32(_mm256_add_epi32(sum_lo, voffset), shift);
+  __m256i out_hi = _mm256_srai_epi32(_mm256_add_epi32(sum_hi, voffset), shift);
+  // Lane wise pack restores sample order since unpack was also lane wise
+  return _mm256_packs_epi32(out_lo, out_hi);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i FilterPairCoeffAvx2(const int16_t *filter) {
+  return _mm256_set1_epi32((filter[0] & 0xFFFF) |
+                           (static_cast<uint16_t>(filter[1]) << 16));
+}
+
+__attribute__((target("avx2")))
+static void AddAvgAvx2(int width, int height,
+                       int offset, int shift, int bitdepth,
+                       const int16_t *src1, intptr_t stride1,
+                       const int16_t *src2, intptr_t stride2,
+                       Sample *dst, intptr_t dst_stride) {
+  const int width16 = width & ~15;
+  if (width16 != width) {
+    AddAvgSse2(width - width16, height, offset, shift, bitdepth,
+               src1 + width16, stride1, src2 + width16, stride2,
+               dst + width16, dst_stride);
+  }
+  const __m256i voffset = _mm256_set1_epi16(static_cast<int16_t>(offset));
+  const __m256i min = _mm256_set1_epi16(0);
+  const __m256i max = _mm256_set1_epi16((1 << bitdepth) - 1);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i s1 = _mm256_loadu_si256(CAST_M256_CONST(src1 + x));
+      __m256i s2 = _mm256_loadu_si256(CAST_M256_CONST(src2 + x));
+      __m256i sum = _mm256_srai_epi16(
+        _mm256_adds_epi16(_mm256_add_epi16(s1, s2), voffset), shift);
+      StoreRow16Avx2<Sample, true>(sum, min, max, dst + x);
+    }
+    src1 += stride1;
+    src2 += stride2;
+    dst += dst_stride;
+  }
+}
+
+__attribute__((target("avx2")))
+static void FilterCopyBipredAvx2(int width, int height,
+                                 int16_t offset, int shift,
+                                 const Sample *ref, ptrdiff_t ref_stride,
+                                 int16_t *dst, ptrdiff_t dst_stride) {
+  const int width16 = width & ~15;
+  if (width16 != width) {
+    FilterCopyBipredSse2(width - width16, height, offset, shift,
+                         ref + width16, ref_stride, dst + width16, dst_stride);
+  }
+  const __m256i voffset = _mm256_set1_epi16(offset);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i s1 = LoadRow16Avx2(ref + x);
+      __m256i out = _mm256_sub_epi16(_mm256_slli_epi16(s1, shift), voffset);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), out);
+    }
+    ref += ref_stride;
+    dst += dst_stride;
+  }
+}
+
+template<typename DstT, bool Clip>
+__attribute__((target("avx2")))
+static
+void FilterHorSampleTLumaAvx2(int width, int height, int bitdepth,
+                              const int16_t *filter,
+                              const Sample *src, ptrdiff_t src_stride,
+                              DstT *dst, ptrdiff_t dst_stride) {
+  const int width16 = width & ~15;
+  if (width16 != width) {
+    FilterHorSampleTLumaSse2<DstT, Clip>(width - width16, height, bitdepth,
+                                         filter, src + width16, src_stride,
+                                         dst + width16, dst_stride);
+  }
+  const int shift = InterPrediction::GetFilterShift<Sample, Clip>(bitdepth);
+  const int offset = InterPrediction::GetFilterOffset<Sample, Clip>(shift);
+  static_assert(InterPrediction::kNumTapsLuma == 8, "8 tap filter");
+  const __m256i voffset = _mm256_set1_epi32(static_cast<int32_t>(offset));
+  const __m256i vfilter01 = FilterPairCoeffAvx2(filter + 0);
+  const __m256i vfilter23 = FilterPairCoeffAvx2(filter + 2);
+  const __m256i vfilter45 = FilterPairCoeffAvx2(filter + 4);
+  const __m256i vfilter67 = FilterPairCoeffAvx2(filter + 6);
+  const __m256i min = _mm256_set1_epi16(0);
+  const __m256i max = _mm256_set1_epi16((1 << bitdepth) - 1);
+
+  src -= InterPrediction::kNumTapsLuma / 2 - 1;
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i sum_lo = _mm256_setzero_si256();
+      __m256i sum_hi = _mm256_setzero_si256();
+      FilterPairAvx2(LoadRow16Avx2(src + x + 0), LoadRow16Avx2(src + x + 1),
+                     vfilter01, &sum_lo, &sum_hi);
+      FilterPairAvx2(LoadRow16Avx2(src + x + 2), LoadRow16Avx2(src + x + 3),
+                     vfilter23, &sum_lo, &sum_hi);
+      FilterPairAvx2(LoadRow16Avx2(src + x + 4), LoadRow16Avx2(src + x + 5),
+                     vfilter45, &sum_lo, &sum_hi);
+      FilterPairAvx2(LoadRow16Avx2(src + x + 6), LoadRow16Avx2(src + x + 7),
+                     vfilter67, &sum_lo, &sum_hi);
+      __m256i sum = FilterRoundAvx2(sum_lo, sum_hi, voffset, shift);
+      StoreRow16Avx2<DstT, Clip>(sum, min, max, dst + x);
+    }
+    src += src_stride;
+    dst += dst_stride;
+  }
+}
+
+template<typename DstT, bool Clip>
+__attribute__((target("avx2")))
+static
+void FilterHorSampleTChromaAvx2(int width, int height, int bitdepth,
+                                const int16_t *filter,
+                                const Sample *src, ptrdiff_t src_stride,
+                                DstT *dst, ptrdiff_t dst_stride) {
+  const int width16 = width & ~15;
+  if (width16 != width) {
+    FilterHorSampleTChromaSse2<DstT, Clip>(width - width16, height, bitdepth,
+                                           filter, src + width16, src_stride,
+                                           dst + width16, dst_stride);
+  }
+  const int shift = InterPrediction::GetFilterShift<Sample, Clip>(bitdepth);
+  const int offset = InterPrediction::GetFilterOffset<Sample, Clip>(shift);
+  static_assert(InterPrediction::kNumTapsChroma == 4, "4 tap filter");
+  const __m256i voffset = _mm256_set1_epi32(static_cast<int32_t>(offset));
+  const __m256i vfilter01 = FilterPairCoeffAvx2(filter + 0);
+  const __m256i vfilter23 = FilterPairCoeffAvx2(filter + 2);
+  const __m256i min = _mm256_set1_epi16(0);
+  const __m256i max = _mm256_set1_epi16((1 << bitdepth) - 1);
+
+  src -= InterPrediction::kNumTapsChroma / 2 - 1;
+
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i sum_lo = _mm256_setzero_si256();
+      __m256i sum_hi = _mm256_setzero_si256();
+      FilterPairAvx2(LoadRow16Avx2(src + x + 0), LoadRow16Avx2(src + x + 1),
+                     vfilter01, &sum_lo, &sum_hi);
+      FilterPairAvx2(LoadRow16Avx2(src + x + 2), LoadRow16Avx2(src + x + 3),
+                     vfilter23, &sum_lo, &sum_hi);
+      __m256i sum = FilterRoundAvx2(sum_lo, sum_hi, voffset, shift);
+      StoreRow16Avx2<DstT, Clip>(sum, min, max, dst + x);
+    }
+    src += src_stride;
+    dst += dst_stride;
+  }
+}
+
+template<typename SrcT, typename DstT, bool Clip>
+__attribute__((target("avx2")))
+static
+void FilterVerLumaAvx2(int width, int height, int bitdepth,
+                       const int16_t *filter,
+                       const SrcT *src, ptrdiff_t src_stride,
+                       DstT *dst, ptrdiff_t dst_stride) {
+  const int width16 = width & ~15;
+  if (width16 != width) {
+    FilterVerLumaSse2<SrcT, DstT, Clip>(width - width16, height, bitdepth,
+                                        filter, src + width16, src_stride,
+                                        dst + width16, dst_stride);
+  }
+  const int shift = InterPrediction::GetFilterShift<SrcT, Clip>(bitdepth);
+  const int offset = InterPrediction::GetFilterOffset<SrcT, Clip>(shift);
+  static_assert(InterPrediction::kNumTapsLuma == 8, "8 tap filter");
+  const __m256i voffset = _mm256_set1_epi32(static_cast<int32_t>(offset));
+  const __m256i vfilter01 = FilterPairCoeffAvx2(filter + 0);
+  const __m256i vfilter23 = FilterPairCoeffAvx2(filter + 2);
+  const __m256i vfilter45 = FilterPairCoeffAvx2(filter + 4);
+  const __m256i vfilter67 = FilterPairCoeffAvx2(filter + 6);
+  const __m256i min = _mm256_set1_epi16(0);
+  const __m256i max = _mm256_set1_epi16((1 << bitdepth) - 1);
+
+  src -= (InterPrediction::kNumTapsLuma / 2 - 1) * src_stride;
+
+  for (int x = 0; x < width16; x += 16) {
+    // Sliding window of input rows so that each row is only loaded once
+    const SrcT *src_col = src + x;
+    DstT *dst_col = dst + x;
+    __m256i row0 = LoadRow16Avx2(src_col + 0 * src_stride);
+    __m256i row1 = LoadRow16Avx2(src_col + 1 * src_stride);
+    __m256i row2 = LoadRow16Avx2(src_col + 2 * src_stride);
+    __m256i row3 = LoadRow16Avx2(src_col + 3 * src_stride);
+    __m256i row4 = LoadRow16Avx2(src_col + 4 * src_stride);
+    __m256i row5 = LoadRow16Avx2(src_col + 5 * src_stride);
+    __m256i row6 = LoadRow16Avx2(src_col + 6 * src_stride);
+    for (int y = 0; y < height; y++) {
+      __m256i row7 = LoadRow16Avx2(src_col + 7 * src_stride);
+      __m256i sum_lo = _mm256_setzero_si256();
+      __m256i sum_hi = _mm256_setzero_si256();
+      FilterPairAvx2(row0, row1, vfilter01, &sum_lo, &sum_hi);
+      FilterPairAvx2(row2, row3, vfilter23, &sum_lo, &sum_hi);
+      FilterPairAvx2(row4, row5, vfilter45, &sum_lo, &sum_hi);
+      FilterPairAvx2(row6, row7, vfilter67, &sum_lo, &sum_hi);
+      __m256i sum = FilterRoundAvx2(sum_lo, sum_hi, voffset, shift);
+      StoreRow16Avx2<DstT, Clip>(sum, min, max, dst_col);
+      row0 = row1;
+      row1 = row2;
+      row2 = row3;
+      row3 = row4;
+      row4 = row5;
+      row5 = row6;
+      row6 = row7;
+      src_col += src_stride;
+      dst_col += dst_stride;
+    }
+  }
+}
+
+template<typename SrcT, typename DstT, bool Clip>
+__attribute__((target("avx2")))
+static
+void FilterVerChromaAvx2(int width, int height, int bitdepth,
+                         const int16_t *filter,
+                         const SrcT *src, ptrdiff_t src_stride,
+                         DstT *dst, ptrdiff_t dst_stride) {
+  const int width16 = width & ~15;
+  if (width16 != width) {
+    FilterVerChromaSse2<SrcT, DstT, Clip>(width - width16, height, bitdepth,
+                                          filter, src + width16, src_stride,
+                                          dst + width16, dst_stride);
+  }
+  const int shift = InterPrediction::GetFilterShift<SrcT, Clip>(bitdepth);
+  const int offset = InterPrediction::GetFilterOffset<SrcT, Clip>(shift);
+  static_assert(InterPrediction::kNumTapsChroma == 4, "4 tap filter");
+  const __m256i voffset = _mm256_set1_epi32(static_cast<int32_t>(offset));
+  const __m256i vfilter01 = FilterPairCoeffAvx2(filter + 0);
+  const __m256i vfilter23 = FilterPairCoeffAvx2(filter + 2);
+  const __m256i min = _mm256_set1_epi16(0);
+  const __m256i max = _mm256_set1_epi16((1 << bitdepth) - 1);
+
+  src -= (InterPrediction::kNumTapsChroma / 2 - 1) * src_stride;
+
+  for (int x = 0; x < width16; x += 16) {
+    const SrcT *src_col = src + x;
+    DstT *dst_col = dst + x;
+    __m256i row0 = LoadRow16Avx2(src_col + 0 * src_stride);
+    __m256i row1 = LoadRow16Avx2(src_col + 1 * src_stride);
+    __m256i row2 = LoadRow16Avx2(src_col + 2 * src_stride);
+    for (int y = 0; y < height; y++) {
+      __m256i row3 = LoadRow16Avx2(src_col + 3 * src_stride);
+      __m256i sum_lo = _mm256_setzero_si256();
+      __m256i sum_hi = _mm256_setzero_si256();
+      FilterPairAvx2(row0, row1, vfilter01, &sum_lo, &sum_hi);
+      FilterPairAvx2(row2, row3, vfilter23, &sum_lo, &sum_hi);
+      __m256i sum = FilterRoundAvx2(sum_lo, sum_hi, voffset, shift);
+      StoreRow16Avx2<DstT, Clip>(sum, min, max, dst_col);
+      row0 = row1;
+      row1 = row2;
+      row2 = row3;
+      src_col += src_stride;
+      dst_col += dst_stride;
+    }
+  }
+}
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
+#ifdef XVC_ARCH_X86
+// Loads N samples (4 or 8) widened to 16 bits, upper lanes are zero for N=4
+template<int N>
+__attribute__((target("sse4.1")))
+static __m128i LoadSamplesSse4(const Sample *src) {
+#if XVC_HIGH_BITDEPTH
+  return N == 8 ? _mm_loadu_si128(CAST_M128_CONST(src)) :
+    _mm_loadl_epi64(CAST_M128_CONST(src));
+#else
+  if (N == 8) {
+    return _mm_cvtepu8_epi16(_mm_loadl_epi64(CAST_M128_CONST(src)));
+  }
+  int32_t val;
+  std::memcpy(&val, src, sizeof(val));
+  return _mm_cvtepu8_epi16(_mm_cvtsi32_si128(val));
+#endif
+}
+
+template<typename DstT>
+__attribute__((target("sse4.1")))
+static void StoreAffine4Sse4(__m128i sum, __m128i max, DstT *dst) {
+  __m128i out = _mm_packs_epi32(sum, sum);
+  if (std::is_same<DstT, int16_t>::value) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), out);
+    return;
+  }
+#if XVC_HIGH_BITDEPTH
+  out = _mm_max_epi16(_mm_min_epi16(out, max), _mm_setzero_si128());
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), out);
+#else
+  int32_t val = _mm_cvtsi128_si32(_mm_packus_epi16(out, out));
+  std::memcpy(dst, &val, sizeof(val));
+#endif
+}
+
+// Each subblock is filtered 4 columns at a time, the horizontal pass keeps
+// the intermediate rows in registers instead of a filter buffer
+template<int N, typename DstT>
+__attribute__((target("sse4.1")))
+static void AffineMotionCompSse4(int num_blocks, int block_width,
+                                 int block_height, int bitdepth,
+                                 const InterPrediction::AffineSubblock *blocks,
+                                 ptrdiff_t ref_stride,
+                                 DstT *pred, ptrdiff_t pred_stride) {
+  constexpr bool kClip = !std::is_same<DstT, int16_t>::value;
+  const int shift_h = InterPrediction::GetFilterShift<Sample, false>(bitdepth);
+  const __m128i offset_h =
+    _mm_set1_epi32(InterPrediction::GetFilterOffset<Sample, false>(shift_h));
+  const int shift_v = InterPrediction::GetFilterShift<int16_t, kClip>(bitdepth);
+  const __m128i offset_v =
+    _mm_set1_epi32(InterPrediction::GetFilterOffset<int16_t, kClip>(shift_v));
+  const __m128i max = _mm_set1_epi16(static_cast<int16_t>((1 << bitdepth) - 1));
+  const int num_rows = block_height + N - 1;
+  __m128i temp[constants::kMaxBlockSize + N - 1];
+
+  for (int i = 0; i < num_blocks; i++) {
+    const InterPrediction::AffineSubblock &block = blocks[i];
+    const __m128i filter_h = N == 8 ?
+      _mm_loadu_si128(CAST_M128_CONST(block.filter_hor)) :
+      _mm_loadl_epi64(CAST_M128_CONST(block.filter_hor));
+    const int16_t *filter = block.filter_ver;
+    __m128i filter_v[N / 2];
+    for (int k = 0; k < N / 2; k++) {
+      filter_v[k] = _mm_unpacklo_epi16(_mm_set1_epi16(filter[2 * k]),
+                                       _mm_set1_epi16(filter[2 * k + 1]));
+    }
+    const Sample *src_block =
+      block.ref - (N / 2 - 1) * ref_stride - (N / 2 - 1);
+    for (int x = 0; x < block_width; x += 4) {
+      const Sample *src = src_block + x;
+      for (int y = 0; y < num_rows; y++) {
+        __m128i sum0 = _mm_madd_epi16(LoadSamplesSse4<N>(src + 0), filter_h);
+        __m128i sum1 = _mm_madd_epi16(LoadSamplesSse4<N>(src + 1), filter_h);
+        __m128i sum2 = _mm_madd_epi16(LoadSamplesSse4<N>(src + 2), filter_h);
+        __m128i sum3 = _mm_madd_epi16(LoadSamplesSse4<N>(src + 3), filter_h);
+        __m128i sum = _mm_hadd_epi32(_mm_hadd_epi32(sum0, sum1),
+                                     _mm_hadd_epi32(sum2, sum3));
+        sum = _mm_srai_epi32(_mm_add_epi32(sum, offset_h), shift_h);
+        temp[y] = _mm_packs_epi32(sum, sum);
+        src += ref_stride;
+      }
+      DstT *dst = pred + i * block_width + x;
+      for (int y = 0; y < block_height; y++) {
+        __m128i sum = offset_v;
+        for (int k = 0; k < N / 2; k++) {
+          __m128i rows = _mm_unpacklo_epi16(temp[y + 2 * k],
+                                            temp[y + 2 * k + 1]);
+          sum = _mm_add_epi32(sum, _mm_madd_epi16(rows, filter_v[k]));
+        }
+        StoreAffine4Sse4(_mm_srai_epi32(sum, shift_v), max, dst);
+        dst += pred_stride;
+      }
+    }
+  }
+}
+
+// Loads N samples (4 or 8) widened to 16 bits
+template<int N>
+__attribute__((target("sse2")))
+static __m128i LoadGradientSse2(const Sample *src) {
+#if XVC_HIGH_BITDEPTH
+  return N == 8 ? _mm_loadu_si128(CAST_M128_CONST(src)) :
+    _mm_loadl_epi64(CAST_M128_CONST(src));
+#else
+  __m128i val;
+  if (N == 8) {
+    val = _mm_loadl_epi64(CAST_M128_CONST(src));
+  } else {
+    int32_t val32;
+    std::memcpy(&val32, src, sizeof(val32));
+    val = _mm_cvtsi32_si128(val32);
+  }
+  return _mm_unpacklo_epi8(val, _mm_setzero_si128());
+#endif
+}
+
+template<int N>
+__attribute__((target("sse2")))
+static void AffineGradientNSse2(const Sample *src, ptrdiff_t src_stride,
+                                int16_t *grad_hor, int16_t *grad_ver) {
+  const __m128i a0 = LoadGradientSse2<N>(src - src_stride - 1);
+  const __m128i a1 = LoadGradientSse2<N>(src - src_stride);
+  const __m128i a2 = LoadGradientSse2<N>(src - src_stride + 1);
+  const __m128i b0 = LoadGradientSse2<N>(src - 1);
+  const __m128i b2 = LoadGradientSse2<N>(src + 1);
+  const __m128i c0 = LoadGradientSse2<N>(src + src_stride - 1);
+  const __m128i c1 = LoadGradientSse2<N>(src + src_stride);
+  const __m128i c2 = LoadGradientSse2<N>(src + src_stride + 1);
+  const __m128i b_diff = _mm_sub_epi16(b2, b0);
+  __m128i hor = _mm_add_epi16(_mm_sub_epi16(a2, a0), _mm_sub_epi16(c2, c0));
+  hor = _mm_add_epi16(hor, _mm_add_epi16(b_diff, b_diff));
+  const __m128i above = _mm_add_epi16(_mm_add_epi16(a0, a2),
+                                      _mm_add_epi16(a1, a1));
+  const __m128i below = _mm_add_epi16(_mm_add_epi16(c0, c2),
+                                      _mm_add_epi16(c1, c1));
+  const __m128i ver = _mm_sub_epi16(below, above);
+  if (N == 8) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(grad_hor), hor);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(grad_ver), ver);
+  } else {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(grad_hor), hor);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(grad_ver), ver);
+  }
+}
+
+// The last group of each row overlaps the previous one when the number of
+// inner samples is not a multiple of the group size
+__attribute__((target("sse2")))
+static void AffineGradientSse2(int width, int height,
+                               const Sample *src, ptrdiff_t src_stride,
+                               int16_t *grad_hor, int16_t *grad_ver,
+                               ptrdiff_t grad_stride) {
+  const int inner_width = width - 2;
+  for (int y = 1; y < height - 1; y++) {
+    const Sample *src_row = src + y * src_stride + 1;
+    int16_t *hor_row = grad_hor + y * grad_stride + 1;
+    int16_t *ver_row = grad_ver + y * grad_stride + 1;
+    if (inner_width >= 8) {
+      for (int x = 0; x < inner_width - 8; x += 8) {
+        AffineGradientNSse2<8>(src_row + x, src_stride, hor_row + x,
+                               ver_row + x);
+      }
+      const int x = inner_width - 8;
+      AffineGradientNSse2<8>(src_row + x, src_stride, hor_row + x,
+                             ver_row + x);
+    } else if (inner_width >= 4) {
+      const int x = inner_width - 4;
+      AffineGradientNSse2<4>(src_row, src_stride, hor_row, ver_row);
+      AffineGradientNSse2<4>(src_row + x, src_stride, hor_row + x,
+                             ver_row + x);
+    } else {
+      for (int x = 0; x < inner_width; x++) {
+        const Sample *above = src_row + x - src_stride;
+        const Sample *center = src_row + x;
+        const Sample *below = src_row + x + src_stride;
+        hor_row[x] = static_cast<int16_t>(
+          (above[1] - above[-1]) + 2 * (center[1] - center[-1]) +
+          (below[1] - below[-1]));
+        ver_row[x] = static_cast<int16_t>(
+          (below[-1] + 2 * below[0] + below[1]) -
+          (above[-1] + 2 * above[0] + above[1]));
+      }
+    }
+  }
+}
+#endif  // XVC_ARCH_X86
+
 #ifdef XVC_ARCH_ARM
 void InterPredictionSimd::Register(const std::set<CpuCapability> &caps,
                                    xvc::SimdFunctions *simd_functions) {
@@ -1288,7 +1786,35 @@ void InterPredictionSimd::Register(const std::set<CpuCapability> &caps,
     ip.filter_v_short_sample[1] = &FilterVerChromaSse2<int16_t, Sample, true>;
     ip.filter_v_short_short[0] = &FilterVerLumaSse2<int16_t, int16_t, false>;
     ip.filter_v_short_short[1] = &FilterVerChromaSse2<int16_t, int16_t, false>;
+    ip.affine_gradient = &AffineGradientSse2;
+  }
+  if (caps.find(CpuCapability::kSse4_1) != caps.end()) {
+    const int kLuma = InterPrediction::kNumTapsLuma;
+    const int kChroma = InterPrediction::kNumTapsChroma;
+    ip.affine_sample[0][1] = &AffineMotionCompSse4<kLuma, Sample>;
+    ip.affine_sample[1][1] = &AffineMotionCompSse4<kChroma, Sample>;
+    ip.affine_short[0][1] = &AffineMotionCompSse4<kLuma, int16_t>;
+    ip.affine_short[1][1] = &AffineMotionCompSse4<kChroma, int16_t>;
+  }
+#if USE_AVX2
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    ip.add_avg[1] = &AddAvgAvx2;
+    ip.filter_copy_bipred[1] = &FilterCopyBipredAvx2;
+    ip.filter_h_sample_sample[0] = &FilterHorSampleTLumaAvx2<Sample, true>;
+    ip.filter_h_sample_sample[1] = &FilterHorSampleTChromaAvx2<Sample, true>;
+    ip.filter_h_sample_short[0] = &FilterHorSampleTLumaAvx2<int16_t, false>;
+    ip.filter_h_sample_short[1] = &FilterHorSampleTChromaAvx2<int16_t, false>;
+    ip.filter_v_sample_sample[0] = &FilterVerLumaAvx2<Sample, Sample, true>;
+    ip.filter_v_sample_sample[1] = &FilterVerChromaAvx2<Sample, Sample, true>;
+    ip.filter_v_sample_short[0] = &FilterVerLumaAvx2<Sample, int16_t, false>;
+    ip.filter_v_sample_short[1] = &FilterVerChromaAvx2<Sample, int16_t, false>;
+    ip.filter_v_short_sample[0] = &FilterVerLumaAvx2<int16_t, Sample, true>;
+    ip.filter_v_short_sample[1] = &FilterVerChromaAvx2<int16_t, Sample, true>;
+    ip.filter_v_short_short[0] = &FilterVerLumaAvx2<int16_t, int16_t, false>;
+    ip.filter_v_short_short[1] =
+      &FilterVerChromaAvx2<int16_t, int16_t, false>;
   }
+#endif  // USE_AVX2
 }
 #endif  // XVC_ARCH_X86
 
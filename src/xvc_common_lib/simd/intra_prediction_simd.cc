@@ -0,0 +1,380 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#include "xvc_common_lib/simd/intra_prediction_simd.h"
+
+#ifdef XVC_ARCH_X86
+#if __GNUC__  == 4 && __GNUC_MINOR__  <= 8 && not defined(__AVX2__)
+#define USE_AVX2 0  // gcc 4.8 requires -mavx2 before defining __m256i
+#else
+#define USE_AVX2 1
+#endif
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_X86
+#include <immintrin.h>  // AVX2
+#endif  // XVC_ARCH_X86
+#ifdef XVC_HAVE_NEON
+#include <arm_neon.h>
+#endif  // XVC_HAVE_NEON
+
+#include <cstring>
+#include <type_traits>
+
+#include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/intra_prediction.h"
+#include "xvc_common_lib/utils.h"
+
+#ifdef _MSC_VER
+#define __attribute__(SPEC)
+#endif  // _MSC_VER
+
+#ifdef XVC_ARCH_X86
+// Formatting helper
+#define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
+#define CAST_M256_CONST(VAL) reinterpret_cast<const __m256i*>((VAL))
+#endif  // XVC_ARCH_X86
+
+namespace xvc {
+namespace simd {
+
+#ifdef XVC_ARCH_X86
+// Loads 8 samples as 16-bit values
+__attribute__((target("sse2")))
+static inline __m128i LoadSamples8Sse2(const Sample *src) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    return _mm_unpacklo_epi8(_mm_loadl_epi64(CAST_M128_CONST(src)),
+                             _mm_setzero_si128());
+  }
+  return _mm_loadu_si128(CAST_M128_CONST(src));
+}
+
+// Loads 4 samples as 16-bit values in the lower half
+__attribute__((target("sse2")))
+static inline __m128i LoadSamples4Sse2(const Sample *src) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    int32_t val;
+    std::memcpy(&val, src, sizeof(val));
+    return _mm_unpacklo_epi8(_mm_cvtsi32_si128(val), _mm_setzero_si128());
+  }
+  return _mm_loadl_epi64(CAST_M128_CONST(src));
+}
+
+// Stores 8 (non-negative) 16-bit values as samples
+__attribute__((target("sse2")))
+static inline void StoreSamples8Sse2(__m128i val, Sample *dst) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst),
+                     _mm_packus_epi16(val, val));
+  } else {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), val);
+  }
+}
+
+// Stores 4 (non-negative) 16-bit values from the lower half as samples
+__attribute__((target("sse2")))
+static inline void StoreSamples4Sse2(__m128i val, Sample *dst) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    int32_t out = _mm_cvtsi128_si32(_mm_packus_epi16(val, val));
+    std::memcpy(dst, &out, sizeof(out));
+  } else {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), val);
+  }
+}
+
+// Weighted average of two sample vectors with weights summing to 32
+__attribute__((target("sse2")))
+static inline __m128i InterpolateSse2(__m128i a, __m128i b, __m128i weights) {
+  const __m128i round = _mm_set1_epi32(16);
+  __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weights);
+  __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weights);
+  lo = _mm_srai_epi32(_mm_add_epi32(lo, round), 5);
+  hi = _mm_srai_epi32(_mm_add_epi32(hi, round), 5);
+  return _mm_packs_epi32(lo, hi);
+}
+
+__attribute__((target("sse2")))
+static void AngularPredSse2(int width, int height, int angle,
+                            const Sample *ref_line,
+                            Sample *output_buffer, ptrdiff_t output_stride) {
+  int angle_sum = 0;
+  for (int y = 0; y < height; y++) {
+    angle_sum += angle;
+    const Sample *ref = ref_line + (angle_sum >> 5);
+    const int interpolate_weight = angle_sum & 31;
+    if (!interpolate_weight) {
+      std::memcpy(output_buffer, ref, sizeof(Sample) * width);
+      output_buffer += output_stride;
+      continue;
+    }
+    const __m128i weights =
+      _mm_set1_epi32((32 - interpolate_weight) | (interpolate_weight << 16));
+    if (width == 4) {
+      __m128i out = InterpolateSse2(LoadSamples4Sse2(ref),
+                                    LoadSamples4Sse2(ref + 1), weights);
+      StoreSamples4Sse2(out, output_buffer);
+    } else {
+      for (int x = 0; x < width; x += 8) {
+        __m128i out = InterpolateSse2(LoadSamples8Sse2(ref + x),
+                                      LoadSamples8Sse2(ref + x + 1), weights);
+        StoreSamples8Sse2(out, output_buffer + x);
+      }
+    }
+    output_buffer += output_stride;
+  }
+}
+
+__attribute__((target("sse2")))
+static void PlanarPredSse2(int width, int height,
+                           const Sample *ref_samples, ptrdiff_t ref_stride,
+                           Sample *output_buffer, ptrdiff_t output_stride) {
+  const int width_log2 = util::SizeToLog2(width);
+  const int height_log2 = util::SizeToLog2(height);
+  const Sample *above = ref_samples + 1;
+  const Sample *left = ref_samples + ref_stride;
+  const int top_right = ref_samples[1 + width];
+  const int bottom_left = left[height];
+  const int shift = width_log2 + height_log2 + 1;
+  const __m128i offset = _mm_set1_epi32(1 << (shift - 1));
+  const __m128i vbottom_left = _mm_set1_epi16(static_cast<int16_t>(bottom_left));
+  // Horizontal weights (width - 1 - x, x + 1) interleaved per x
+  __m128i weights_x[constants::kMaxBlockSize / 4];
+  for (int x = 0; x < width; x += 4) {
+    weights_x[x / 4] = _mm_setr_epi16(
+      static_cast<int16_t>(width - 1 - x), static_cast<int16_t>(x + 1),
+      static_cast<int16_t>(width - 2 - x), static_cast<int16_t>(x + 2),
+      static_cast<int16_t>(width - 3 - x), static_cast<int16_t>(x + 3),
+      static_cast<int16_t>(width - 4 - x), static_cast<int16_t>(x + 4));
+  }
+  // Returns prediction for 4 samples as 32-bit values
+  auto planar_4 = [&](__m128i above4, __m128i weights_y, __m128i left_tr,
+                      int x) __attribute__((target("sse2"))) {
+    __m128i hor = _mm_madd_epi16(_mm_unpacklo_epi16(above4, vbottom_left),
+                                 weights_y);
+    __m128i ver = _mm_madd_epi16(left_tr, weights_x[x / 4]);
+    __m128i sum = _mm_add_epi32(_mm_slli_epi32(hor, width_log2),
+                                _mm_slli_epi32(ver, height_log2));
+    return _mm_srai_epi32(_mm_add_epi32(sum, offset), shift);
+  };  // NOLINT
+
+  for (int y = 0; y < height; y++) {
+    const __m128i weights_y = _mm_set1_epi32((height - 1 - y) |
+                                             ((y + 1) << 16));
+    const __m128i left_tr = _mm_set1_epi32(left[y] | (top_right << 16));
+    if (width == 4) {
+      __m128i out = planar_4(LoadSamples4Sse2(above), weights_y, left_tr, 0);
+      StoreSamples4Sse2(_mm_packs_epi32(out, out), output_buffer);
+    } else {
+      for (int x = 0; x < width; x += 8) {
+        __m128i above8 = LoadSamples8Sse2(above + x);
+        __m128i lo = planar_4(above8, weights_y, left_tr, x);
+        __m128i hi = planar_4(_mm_unpackhi_epi64(above8, above8), weights_y,
+                              left_tr, x + 4);
+        StoreSamples8Sse2(_mm_packs_epi32(lo, hi), output_buffer + x);
+      }
+    }
+    output_buffer += output_stride;
+  }
+}
+
+// Applies [1 2 1] filter on samples 1 to length - 1 of a line
+__attribute__((target("sse2")))
+static void FilterRefLineSse2(int length, const Sample *src, Sample *dst) {
+  const __m128i round = _mm_set1_epi16(2);
+  int x = 1;
+  for (; x + 8 <= length; x += 8) {
+    __m128i left = LoadSamples8Sse2(src + x - 1);
+    __m128i center = LoadSamples8Sse2(src + x);
+    __m128i right = LoadSamples8Sse2(src + x + 1);
+    __m128i sum = _mm_add_epi16(_mm_add_epi16(left, right),
+                                _mm_add_epi16(_mm_slli_epi16(center, 1),
+                                              round));
+    StoreSamples8Sse2(_mm_srli_epi16(sum, 2), dst + x);
+  }
+  for (; x < length; x++) {
+    dst[x] = ((src[x] << 1) + src[x - 1] + src[x + 1] + 2) >> 2;
+  }
+}
+
+__attribute__((target("sse2")))
+static void FilterRefSamplesSse2(int width, int height,
+                                 const Sample *src_ref, Sample *dst_ref,
+                                 ptrdiff_t stride) {
+  const Sample above_left = src_ref[0];
+  dst_ref[0] = ((above_left << 1) + src_ref[1] + src_ref[stride] + 2) >> 2;
+
+  // above
+  FilterRefLineSse2(width + height, src_ref, dst_ref);
+  dst_ref[width + height] = src_ref[width + height];
+
+  // left
+  dst_ref[stride] =
+    ((src_ref[stride] << 1) + above_left + src_ref[stride + 1] + 2) >> 2;
+  FilterRefLineSse2(width + height - 1, src_ref + stride, dst_ref + stride);
+  dst_ref[stride + height + width - 1] = src_ref[stride + height + width - 1];
+}
+#endif  // XVC_ARCH_X86
+
+#if defined(XVC_ARCH_X86) && USE_AVX2
+// Loads 16 samples as 16-bit values
+__attribute__((target("avx2")))
+static inline __m256i LoadSamples16Avx2(const Sample *src) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(CAST_M128_CONST(src)));
+  }
+  return _mm256_loadu_si256(CAST_M256_CONST(src));
+}
+
+// Stores 16 (non-negative) 16-bit values as samples
+__attribute__((target("avx2")))
+static inline void StoreSamples16Avx2(__m256i val, Sample *dst) {
+  if (std::is_same<Sample, uint8_t>::value) {
+    __m256i packed = _mm256_packus_epi16(val, val);
+    packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),
+                     _mm256_castsi256_si128(packed));
+  } else {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), val);
+  }
+}
+
+__attribute__((target("avx2")))
+static void AngularPredAvx2(int width, int height, int angle,
+                            const Sample *ref_line,
+                            Sample *output_buffer, ptrdiff_t output_stride) {
+  if (width < 16) {
+    AngularPredSse2(width, height, angle, ref_line,
+                    output_buffer, output_stride);
+    return;
+  }
+  const __m256i round = _mm256_set1_epi32(16);
+  int angle_sum = 0;
+  for (int y = 0; y < height; y++) {
+    angle_sum += angle;
+    const Sample *ref = ref_line + (angle_sum >> 5);
+    const int interpolate_weight = angle_sum & 31;
+    if (!interpolate_weight) {
+      std::memcpy(output_buffer, ref, sizeof(Sample) * width);
+      output_buffer += output_stride;
+      continue;
+    }
+    const __m256i weights =
+      _mm256_set1_epi32((32 - interpolate_weight) | (interpolate_weight << 16));
+    for (int x = 0; x < width; x += 16) {
+      __m256i a = LoadSamples16Avx2(ref + x);
+      __m256i b = LoadSamples16Avx2(ref + x + 1);
+      // Lane wise unpack and pack keeps the sample order
+      __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), weights);
+      __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), weights);
+      lo = _mm256_srai_epi32(_mm256_add_epi32(lo, round), 5);
+      hi = _mm256_srai_epi32(_mm256_add_epi32(hi, round), 5);
+      StoreSamples16Avx2(_mm256_packs_epi32(lo, hi), output_buffer + x);
+    }
+    output_buffer += output_stride;
+  }
+}
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
+#ifdef XVC_HAVE_NEON
+static void AngularPredNeon(int width, int height, int angle,
+                            const Sample *ref_line,
+                            Sample *output_buffer, ptrdiff_t output_stride) {
+  int angle_sum = 0;
+  for (int y = 0; y < height; y++) {
+    angle_sum += angle;
+    const Sample *ref = ref_line + (angle_sum >> 5);
+    const int interpolate_weight = angle_sum & 31;
+    if (!interpolate_weight) {
+      std::memcpy(output_buffer, ref, sizeof(Sample) * width);
+      output_buffer += output_stride;
+      continue;
+    }
+#if XVC_HIGH_BITDEPTH
+    const uint16_t w0 = static_cast<uint16_t>(32 - interpolate_weight);
+    const uint16_t w1 = static_cast<uint16_t>(interpolate_weight);
+    for (int x = 0; x < width; x += 4) {
+      uint32x4_t sum = vmull_n_u16(vld1_u16(ref + x), w0);
+      sum = vmlal_n_u16(sum, vld1_u16(ref + x + 1), w1);
+      vst1_u16(output_buffer + x, vrshrn_n_u32(sum, 5));
+    }
+#else
+    const uint8x8_t w0 = vdup_n_u8(static_cast<uint8_t>(32 -
+                                                        interpolate_weight));
+    const uint8x8_t w1 = vdup_n_u8(static_cast<uint8_t>(interpolate_weight));
+    if (width == 4) {
+      for (int x = 0; x < 4; x++) {
+        output_buffer[x] = static_cast<Sample>(
+          ((32 - interpolate_weight) * ref[x] +
+           interpolate_weight * ref[x + 1] + 16) >> 5);
+      }
+    } else {
+      for (int x = 0; x < width; x += 8) {
+        uint16x8_t sum = vmull_u8(vld1_u8(ref + x), w0);
+        sum = vmlal_u8(sum, vld1_u8(ref + x + 1), w1);
+        vst1_u8(output_buffer + x, vrshrn_n_u16(sum, 5));
+      }
+    }
+#endif
+    output_buffer += output_stride;
+  }
+}
+#endif  // XVC_HAVE_NEON
+
+#ifdef XVC_ARCH_ARM
+void IntraPredictionSimd::Register(const std::set<CpuCapability> &caps,
+                                   xvc::SimdFunctions *simd_functions) {
+#ifdef XVC_HAVE_NEON
+  IntraPrediction::SimdFunc &intra = simd_functions->intra_prediction;
+  if (caps.find(CpuCapability::kNeon) != caps.end()) {
+    intra.angular_pred[1] = &AngularPredNeon;
+  }
+#endif  // XVC_HAVE_NEON
+}
+#endif  // XVC_ARCH_ARM
+
+#ifdef XVC_ARCH_X86
+void IntraPredictionSimd::Register(const std::set<CpuCapability> &caps,
+                                   xvc::SimdFunctions *simd_functions) {
+  IntraPrediction::SimdFunc &intra = simd_functions->intra_prediction;
+  if (caps.find(CpuCapability::kSse2) != caps.end()) {
+    intra.angular_pred[1] = &AngularPredSse2;
+    intra.planar_pred[1] = &PlanarPredSse2;
+    intra.filter_ref_samples = &FilterRefSamplesSse2;
+  }
+#if USE_AVX2
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    intra.angular_pred[1] = &AngularPredAvx2;
+    intra.planar_pred[1] = &PlanarPredSse2;
+    intra.filter_ref_samples = &FilterRefSamplesSse2;
+  }
+#endif  // USE_AVX2
+}
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_MIPS
+void IntraPredictionSimd::Register(const std::set<CpuCapability> &caps,
+                                   xvc::SimdFunctions *simd_functions) {
+}
+#endif  // XVC_ARCH_MIPS
+
+}   // namespace simd
+}   // namespace xvc
@@ -0,0 +1,370 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include "xvc_common_lib/simd/quantize_simd.h"
+
+#ifdef XVC_ARCH_X86
+#if __GNUC__  == 4 && __GNUC_MINOR__  <= 8 && not defined(__AVX2__)
+#define USE_AVX2 0  // gcc 4.8 requires -mavx2 before defining __m256i
+#else
+#define USE_AVX2 1
+#endif
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_X86
+#include <immintrin.h>    // AVX2
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_HAVE_NEON
+#include <arm_neon.h>
+#endif  // XVC_HAVE_NEON
+
+#include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/simd_functions.h"
+
+#ifdef _MSC_VER
+#define __attribute__(SPEC)
+#endif  // _MSC_VER
+
+#ifdef XVC_ARCH_X86
+// Formatting helper
+#define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
+#define CAST_M128(VAL) reinterpret_cast<__m128i*>((VAL))
+#endif  // XVC_ARCH_X86
+
+namespace xvc {
+namespace simd {
+
+// Both shift directions are handled without branching by using a zero
+// shift (and zero offset) for the unused direction.
+// The forward quantization rounding error is computed with a positive bias of
+// 2^shift so that only logical 64-bit shifts are needed, i.e.
+// (r - offset) >> (shift - 8) == ((r - offset + 2^shift) >> (shift - 8)) - 256
+
+#ifdef XVC_ARCH_X86
+__attribute__((target("sse4.1")))
+static __m128i InverseQuant4Sse4(__m128i coeff, __m128i scale,
+                                 __m128i offset, __m128i left_shift,
+                                 __m128i right_shift) {
+  __m128i val = _mm_mullo_epi32(coeff, scale);
+  val = _mm_sll_epi32(val, left_shift);
+  val = _mm_add_epi32(val, offset);
+  return _mm_sra_epi32(val, right_shift);
+}
+
+template<int N>
+__attribute__((target("sse4.1")))
+static void InverseQuantSse4(int scale, int shift, int width, int height,
+                             const Coeff *in, ptrdiff_t in_stride,
+                             Coeff *out, ptrdiff_t out_stride) {
+  const __m128i vscale = _mm_set1_epi32(scale);
+  const __m128i voffset = _mm_set1_epi32(shift > 0 ? 1 << (shift - 1) : 0);
+  const __m128i left_shift = _mm_cvtsi32_si128(shift > 0 ? 0 : -shift);
+  const __m128i right_shift = _mm_cvtsi32_si128(shift > 0 ? shift : 0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += N) {
+      if (N == 4) {
+        __m128i coeff = _mm_loadl_epi64(CAST_M128_CONST(in + x));
+        __m128i val =
+          InverseQuant4Sse4(_mm_cvtepi16_epi32(coeff), vscale, voffset,
+                            left_shift, right_shift);
+        _mm_storel_epi64(CAST_M128(out + x), _mm_packs_epi32(val, val));
+      } else {
+        __m128i coeff = _mm_loadu_si128(CAST_M128_CONST(in + x));
+        __m128i lo =
+          InverseQuant4Sse4(_mm_cvtepi16_epi32(coeff), vscale, voffset,
+                            left_shift, right_shift);
+        __m128i hi =
+          InverseQuant4Sse4(_mm_cvtepi16_epi32(_mm_srli_si128(coeff, 8)),
+                            vscale, voffset, left_shift, right_shift);
+        _mm_storeu_si128(CAST_M128(out + x), _mm_packs_epi32(lo, hi));
+      }
+    }
+    in += in_stride;
+    out += out_stride;
+  }
+}
+
+__attribute__((target("sse4.1")))
+static __m128i ForwardQuant4Sse4(__m128i coeff, __m128i scale,
+                                 __m128i offset, __m128i shift,
+                                 __m128i rem_mask, __m128i rem_bias,
+                                 __m128i rem_shift, __m128i *num_non_zero,
+                                 __m128i *delta) {
+  const __m128i abs_coeff = _mm_cvtepu16_epi32(_mm_abs_epi16(coeff));
+  __m128i even = _mm_add_epi64(_mm_mul_epu32(abs_coeff, scale), offset);
+  __m128i odd = _mm_add_epi64(
+    _mm_mul_epu32(_mm_srli_epi64(abs_coeff, 32), scale), offset);
+  __m128i level = _mm_blend_epi16(
+    _mm_srl_epi64(even, shift),
+    _mm_slli_epi64(_mm_srl_epi64(odd, shift), 32), 0xCC);
+  even = _mm_add_epi64(_mm_and_si128(even, rem_mask), rem_bias);
+  odd = _mm_add_epi64(_mm_and_si128(odd, rem_mask), rem_bias);
+  __m128i rem = _mm_blend_epi16(
+    _mm_srl_epi64(even, rem_shift),
+    _mm_slli_epi64(_mm_srl_epi64(odd, rem_shift), 32), 0xCC);
+  *delta = _mm_sub_epi32(rem, _mm_set1_epi32(256));
+  *num_non_zero = _mm_sub_epi32(
+    *num_non_zero, _mm_cmpgt_epi32(level, _mm_setzero_si128()));
+  return _mm_sign_epi32(level, _mm_cvtepi16_epi32(coeff));
+}
+
+template<int N>
+__attribute__((target("sse4.1")))
+static int ForwardQuantSse4(int scale, int shift, int64_t offset,
+                            int width, int height,
+                            const Coeff *in, ptrdiff_t in_stride,
+                            Coeff *out, ptrdiff_t out_stride,
+                            Coeff *delta, ptrdiff_t delta_stride) {
+  const __m128i vscale = _mm_set1_epi32(scale);
+  const __m128i voffset = _mm_set1_epi64x(offset);
+  const __m128i vshift = _mm_cvtsi32_si128(shift);
+  const __m128i rem_mask = _mm_set1_epi64x((1ll << shift) - 1);
+  const __m128i rem_bias = _mm_set1_epi64x((1ll << shift) - offset);
+  const __m128i rem_shift = _mm_cvtsi32_si128(shift - 8);
+  __m128i num_non_zero = _mm_setzero_si128();
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += N) {
+      if (N == 4) {
+        __m128i coeff = _mm_loadl_epi64(CAST_M128_CONST(in + x));
+        __m128i rem;
+        __m128i level =
+          ForwardQuant4Sse4(coeff, vscale, voffset, vshift, rem_mask, rem_bias,
+                            rem_shift, &num_non_zero, &rem);
+        _mm_storel_epi64(CAST_M128(out + x), _mm_packs_epi32(level, level));
+        _mm_storel_epi64(CAST_M128(delta + x), _mm_packs_epi32(rem, rem));
+      } else {
+        __m128i coeff = _mm_loadu_si128(CAST_M128_CONST(in + x));
+        __m128i rem_lo, rem_hi;
+        __m128i lo =
+          ForwardQuant4Sse4(coeff, vscale, voffset, vshift, rem_mask, rem_bias,
+                            rem_shift, &num_non_zero, &rem_lo);
+        __m128i hi =
+          ForwardQuant4Sse4(_mm_srli_si128(coeff, 8), vscale, voffset, vshift,
+                            rem_mask, rem_bias, rem_shift, &num_non_zero,
+                            &rem_hi);
+        _mm_storeu_si128(CAST_M128(out + x), _mm_packs_epi32(lo, hi));
+        _mm_storeu_si128(CAST_M128(delta + x), _mm_packs_epi32(rem_lo, rem_hi));
+      }
+    }
+    in += in_stride;
+    out += out_stride;
+    delta += delta_stride;
+  }
+  num_non_zero = _mm_add_epi32(num_non_zero, _mm_srli_si128(num_non_zero, 8));
+  num_non_zero = _mm_add_epi32(num_non_zero, _mm_srli_si128(num_non_zero, 4));
+  return _mm_cvtsi128_si32(num_non_zero);
+}
+#endif  // XVC_ARCH_X86
+
+#if defined(XVC_ARCH_X86) && USE_AVX2
+__attribute__((target("avx2")))
+static __m128i PackClip16Avx2(__m256i val) {
+  return _mm256_castsi256_si128(
+    _mm256_permute4x64_epi64(_mm256_packs_epi32(val, val), 0x08));
+}
+
+__attribute__((target("avx2")))
+static void InverseQuantAvx2(int scale, int shift, int width, int height,
+                             const Coeff *in, ptrdiff_t in_stride,
+                             Coeff *out, ptrdiff_t out_stride) {
+  const __m256i vscale = _mm256_set1_epi32(scale);
+  const __m256i voffset = _mm256_set1_epi32(shift > 0 ? 1 << (shift - 1) : 0);
+  const __m128i left_shift = _mm_cvtsi32_si128(shift > 0 ? 0 : -shift);
+  const __m128i right_shift = _mm_cvtsi32_si128(shift > 0 ? shift : 0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += 8) {
+      __m256i val = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128(CAST_M128_CONST(in + x)));
+      val = _mm256_mullo_epi32(val, vscale);
+      val = _mm256_sll_epi32(val, left_shift);
+      val = _mm256_add_epi32(val, voffset);
+      val = _mm256_sra_epi32(val, right_shift);
+      _mm_storeu_si128(CAST_M128(out + x), PackClip16Avx2(val));
+    }
+    in += in_stride;
+    out += out_stride;
+  }
+}
+
+__attribute__((target("avx2")))
+static int ForwardQuantAvx2(int scale, int shift, int64_t offset,
+                            int width, int height,
+                            const Coeff *in, ptrdiff_t in_stride,
+                            Coeff *out, ptrdiff_t out_stride,
+                            Coeff *delta, ptrdiff_t delta_stride) {
+  const __m256i vscale = _mm256_set1_epi32(scale);
+  const __m256i voffset = _mm256_set1_epi64x(offset);
+  const __m128i vshift = _mm_cvtsi32_si128(shift);
+  const __m256i rem_mask = _mm256_set1_epi64x((1ll << shift) - 1);
+  const __m256i rem_bias = _mm256_set1_epi64x((1ll << shift) - offset);
+  const __m128i rem_shift = _mm_cvtsi32_si128(shift - 8);
+  const __m256i rem_sub = _mm256_set1_epi32(256);
+  __m256i num_non_zero = _mm256_setzero_si256();
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += 8) {
+      const __m128i coeff = _mm_loadu_si128(CAST_M128_CONST(in + x));
+      const __m256i abs_coeff =
+        _mm256_cvtepu16_epi32(_mm_abs_epi16(coeff));
+      __m256i even =
+        _mm256_add_epi64(_mm256_mul_epu32(abs_coeff, vscale), voffset);
+      __m256i odd = _mm256_add_epi64(
+        _mm256_mul_epu32(_mm256_srli_epi64(abs_coeff, 32), vscale), voffset);
+      __m256i level = _mm256_blend_epi32(
+        _mm256_srl_epi64(even, vshift),
+        _mm256_slli_epi64(_mm256_srl_epi64(odd, vshift), 32), 0xAA);
+      even = _mm256_add_epi64(_mm256_and_si256(even, rem_mask), rem_bias);
+      odd = _mm256_add_epi64(_mm256_and_si256(odd, rem_mask), rem_bias);
+      __m256i rem = _mm256_blend_epi32(
+        _mm256_srl_epi64(even, rem_shift),
+        _mm256_slli_epi64(_mm256_srl_epi64(odd, rem_shift), 32), 0xAA);
+      num_non_zero = _mm256_sub_epi32(
+        num_non_zero, _mm256_cmpgt_epi32(level, _mm256_setzero_si256()));
+      level = _mm256_sign_epi32(level, _mm256_cvtepi16_epi32(coeff));
+      _mm_storeu_si128(CAST_M128(out + x), PackClip16Avx2(level));
+      _mm_storeu_si128(CAST_M128(delta + x),
+                       PackClip16Avx2(_mm256_sub_epi32(rem, rem_sub)));
+    }
+    in += in_stride;
+    out += out_stride;
+    delta += delta_stride;
+  }
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(num_non_zero),
+                              _mm256_extracti128_si256(num_non_zero, 1));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+  return _mm_cvtsi128_si32(sum);
+}
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
+#ifdef XVC_HAVE_NEON
+static void InverseQuantNeon(int scale, int shift, int width, int height,
+                             const Coeff *in, ptrdiff_t in_stride,
+                             Coeff *out, ptrdiff_t out_stride) {
+  const int32x4_t voffset = vdupq_n_s32(shift > 0 ? 1 << (shift - 1) : 0);
+  const int32x4_t left_shift = vdupq_n_s32(shift > 0 ? 0 : -shift);
+  const int32x4_t right_shift = vdupq_n_s32(shift > 0 ? -shift : 0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += 4) {
+      int32x4_t val = vmovl_s16(vld1_s16(in + x));
+      val = vmulq_n_s32(val, scale);
+      val = vshlq_s32(val, left_shift);
+      val = vaddq_s32(val, voffset);
+      val = vshlq_s32(val, right_shift);
+      vst1_s16(out + x, vqmovn_s32(val));
+    }
+    in += in_stride;
+    out += out_stride;
+  }
+}
+
+static int ForwardQuantNeon(int scale, int shift, int64_t offset,
+                            int width, int height,
+                            const Coeff *in, ptrdiff_t in_stride,
+                            Coeff *out, ptrdiff_t out_stride,
+                            Coeff *delta, ptrdiff_t delta_stride) {
+  const uint32x2_t vscale = vdup_n_u32(static_cast<uint32_t>(scale));
+  const uint64x2_t voffset = vdupq_n_u64(static_cast<uint64_t>(offset));
+  const int64x2_t vshift = vdupq_n_s64(-shift);
+  const uint64x2_t rem_mask = vdupq_n_u64((1ull << shift) - 1);
+  const uint64x2_t rem_bias =
+    vdupq_n_u64((1ull << shift) - static_cast<uint64_t>(offset));
+  const int64x2_t rem_shift = vdupq_n_s64(8 - shift);
+  const int32x4_t rem_sub = vdupq_n_s32(256);
+  uint32x4_t num_non_zero = vdupq_n_u32(0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x += 4) {
+      const int32x4_t coeff = vmovl_s16(vld1_s16(in + x));
+      const uint32x4_t abs_coeff = vreinterpretq_u32_s32(vabsq_s32(coeff));
+      uint64x2_t lo =
+        vaddq_u64(vmull_u32(vget_low_u32(abs_coeff), vscale), voffset);
+      uint64x2_t hi =
+        vaddq_u64(vmull_u32(vget_high_u32(abs_coeff), vscale), voffset);
+      int32x4_t level = vreinterpretq_s32_u32(
+        vcombine_u32(vmovn_u64(vshlq_u64(lo, vshift)),
+                     vmovn_u64(vshlq_u64(hi, vshift))));
+      lo = vaddq_u64(vandq_u64(lo, rem_mask), rem_bias);
+      hi = vaddq_u64(vandq_u64(hi, rem_mask), rem_bias);
+      int32x4_t rem = vreinterpretq_s32_u32(
+        vcombine_u32(vmovn_u64(vshlq_u64(lo, rem_shift)),
+                     vmovn_u64(vshlq_u64(hi, rem_shift))));
+      num_non_zero = vsubq_u32(num_non_zero, vcgtq_s32(level, vdupq_n_s32(0)));
+      level = vbslq_s32(vcltq_s32(coeff, vdupq_n_s32(0)), vnegq_s32(level),
+                        level);
+      vst1_s16(out + x, vqmovn_s32(level));
+      vst1_s16(delta + x, vqmovn_s32(vsubq_s32(rem, rem_sub)));
+    }
+    in += in_stride;
+    out += out_stride;
+    delta += delta_stride;
+  }
+  uint32x2_t sum = vadd_u32(vget_low_u32(num_non_zero),
+                            vget_high_u32(num_non_zero));
+  return static_cast<int>(vget_lane_u32(vpadd_u32(sum, sum), 0));
+}
+#endif  // XVC_HAVE_NEON
+
+#ifdef XVC_ARCH_ARM
+void QuantizeSimd::Register(const std::set<CpuCapability> &caps,
+                            xvc::SimdFunctions *simd_functions) {
+#ifdef XVC_HAVE_NEON
+  if (caps.find(CpuCapability::kNeon) != caps.end()) {
+    Quantize::SimdFunc &quant = simd_functions->quantize;
+    for (int i = 1; i < Quantize::SimdFunc::kSize; i++) {
+      quant.inverse[i] = &InverseQuantNeon;
+      quant.forward[i] = &ForwardQuantNeon;
+    }
+  }
+#endif  // XVC_HAVE_NEON
+}
+#endif  // XVC_ARCH_ARM
+
+#ifdef XVC_ARCH_X86
+void QuantizeSimd::Register(const std::set<CpuCapability> &caps,
+                            xvc::SimdFunctions *simd_functions) {
+  Quantize::SimdFunc &quant = simd_functions->quantize;
+  if (caps.find(CpuCapability::kSse4_1) != caps.end()) {
+    quant.inverse[1] = &InverseQuantSse4<4>;
+    quant.forward[1] = &ForwardQuantSse4<4>;
+    for (int i = 2; i < Quantize::SimdFunc::kSize; i++) {
+      quant.inverse[i] = &InverseQuantSse4<8>;
+      quant.forward[i] = &ForwardQuantSse4<8>;
+    }
+  }
+#if USE_AVX2
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    for (int i = 2; i < Quantize::SimdFunc::kSize; i++) {
+      quant.inverse[i] = &InverseQuantAvx2;
+      quant.forward[i] = &ForwardQuantAvx2;
+    }
+  }
+#endif  // USE_AVX2
+}
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_MIPS
+void QuantizeSimd::Register(const std::set<CpuCapability> &caps,
+                            xvc::SimdFunctions *simd_functions) {
+}
+#endif  // XVC_ARCH_MIPS
+
+}   // namespace simd
+}   // namespace xvc
@@ -21,6 +21,14 @@
 
 #include "xvc_common_lib/simd/resampler_simd.h"
 
+#ifdef XVC_ARCH_X86
+#if __GNUC__  == 4 && __GNUC_MINOR__  <= 8 && not defined(__AVX2__)
+#define USE_AVX2 0  // gcc 4.8 requires -mavx2 before defining __m256i
+#else
+#define USE_AVX2 1
+#endif
+#endif  // XVC_ARCH_X86
+
 #ifdef XVC_ARCH_X86
 #include <immintrin.h>    // AVX2
 #endif  // XVC_ARCH_X86
@@ -33,6 +41,7 @@
 
 #include "xvc_common_lib/simd_functions.h"
 #include "xvc_common_lib/resample.h"
+#include "xvc_common_lib/utils.h"
 
 #ifdef _MSC_VER
 #define __attribute__(SPEC)
@@ -41,6 +50,7 @@
 #ifdef XVC_ARCH_X86
 // Formatting helper
 #define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
+#define CAST_M256_CONST(VAL) reinterpret_cast<const __m256i*>((VAL))
 #endif  // XVC_ARCH_X86
 
 namespace xvc {
@@ -216,15 +226,381 @@ void DownshiftSampleToByteDitherSse2(int width, int height, int shift,
 #endif  // XVC_HIGH_BITDEPTH
 #endif  // XVC_ARCH_X86
 
+#if defined(XVC_ARCH_X86) && USE_AVX2
+#if XVC_HIGH_BITDEPTH
+// Saturates 16 words to bytes and stores them in order
+__attribute__((target("avx2")))
+static inline void StorePackedBytesAvx2(__m256i v, uint8_t *out) {
+  __m256i v8 = _mm256_packus_epi16(v, v);
+  __m256i vout = _mm256_permute4x64_epi64(v8, _MM_SHUFFLE(3, 1, 2, 0));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                   _mm256_castsi256_si128(vout));
+}
+
+__attribute__((target("avx2")))
+static void CopySampleToByteAvx2(int width, int height,
+                                 const Sample *src, ptrdiff_t src_stride,
+                                 uint8_t *out, ptrdiff_t out_stride) {
+  const int width16 = width & ~15;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i s16 = _mm256_loadu_si256(CAST_M256_CONST(src + x));
+      StorePackedBytesAvx2(s16, out + x);
+    }
+    if ((width & 15) != 0) {
+      for (int x = width16; x < width; x++) {
+        out[x] = static_cast<uint8_t>(src[x]);
+      }
+    }
+    src += src_stride;
+    out += out_stride;
+  }
+}
+
+__attribute__((target("avx2")))
+static
+void DownshiftSampleToByteFastAvx2(int width, int height, int shift,
+                                   int out_bitdepth,
+                                   const Sample *src, ptrdiff_t src_stride,
+                                   uint8_t *out, ptrdiff_t out_stride) {
+  const int width16 = width & ~15;
+  const int add = 1 << (shift - 1);
+  const __m256i vadd = _mm256_set1_epi16(static_cast<int16_t>(add));
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i vsrc = _mm256_loadu_si256(CAST_M256_CONST(src + x));
+      __m256i vtmp = _mm256_srai_epi16(_mm256_adds_epi16(vsrc, vadd), shift);
+      StorePackedBytesAvx2(vtmp, out + x);
+    }
+    if ((width & 15) != 0) {
+      for (int x = width16; x < width; x++) {
+        out[x] = static_cast<uint8_t>((src[x] + add) >> shift);
+      }
+    }
+    src += src_stride;
+    out += out_stride;
+  }
+}
+
+__attribute__((target("avx2")))
+static
+void DownshiftSampleToByteDitherAvx2(int width, int height, int shift,
+                                     int out_bitdepth,
+                                     const Sample *src, ptrdiff_t src_stride,
+                                     uint8_t *out, ptrdiff_t out_stride) {
+  const int width16 = width & ~15;
+  const int mask = (1 << shift) - 1;
+  const __m256i vmask = _mm256_set1_epi16(static_cast<int16_t>(mask));
+  __m256i vsum = _mm256_setzero_si256();
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      __m256i vsrc = _mm256_loadu_si256(CAST_M256_CONST(src + x));
+      vsum = _mm256_adds_epi16(vsum, vsrc);
+      StorePackedBytesAvx2(_mm256_srai_epi16(vsum, shift), out + x);
+      vsum = _mm256_and_si256(vsum, vmask);
+    }
+    if ((width & 15) != 0) {
+      int sample = 0;
+      for (int x = width16; x < width; x++) {
+        sample += src[x];
+        out[x] = static_cast<uint8_t>(sample >> shift);
+        sample &= mask;
+      }
+    }
+    src += src_stride;
+    out += out_stride;
+  }
+}
+#endif  // XVC_HIGH_BITDEPTH
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
+#if defined(XVC_ARCH_X86) || defined(XVC_HAVE_NEON)
+// Converts the remaining pixels of a row that are not a full vector wide
+template<typename T>
+static void YuvToArgbRowTail(int x, int width, int out_bitdepth,
+                             const int16_t *matrix, const uint16_t *src_y,
+                             const uint16_t *src_u, const uint16_t *src_v,
+                             T *out) {
+  const int bitdepth = Resampler::kColorConversionBitdepth;
+  const int sample_max = (1 << out_bitdepth) - 1;
+  const int shift = 10 + bitdepth - out_bitdepth;
+  for (; x < width; x++) {
+    const int c = src_y[x] - (16 << (bitdepth - 8));
+    const int d = src_u[x] - (128 << (bitdepth - 8));
+    const int e = src_v[x] - (128 << (bitdepth - 8));
+    for (int i = 0; i < 3; i++) {
+      const int val = matrix[3 * i + 0] * c + matrix[3 * i + 1] * d +
+        matrix[3 * i + 2] * e;
+      out[4 * x + i] =
+        static_cast<T>(util::Clip3<int>(val >> shift, 0, sample_max));
+    }
+    out[4 * x + 3] = static_cast<T>(sample_max);
+  }
+}
+
+// The vector kernels keep the converted values in 16 bits, which holds for
+// output bitdepths up to the color conversion bitdepth
+static int GetYuvToArgbVectorWidth(int width, int out_bitdepth,
+                                   int vector_size) {
+  return out_bitdepth <= Resampler::kColorConversionBitdepth ?
+    width & ~(vector_size - 1) : 0;
+}
+#endif  // XVC_ARCH_X86 || XVC_HAVE_NEON
+
+#ifdef XVC_HAVE_NEON
+static void StoreArgbNeon(int16x8_t r, int16x8_t g, int16x8_t b, int16x8_t a,
+                          uint8_t *out) {
+  uint8x8x4_t argb;
+  argb.val[0] = vqmovun_s16(r);
+  argb.val[1] = vqmovun_s16(g);
+  argb.val[2] = vqmovun_s16(b);
+  argb.val[3] = vqmovun_s16(a);
+  vst4_u8(out, argb);
+}
+
+static void StoreArgbNeon(int16x8_t r, int16x8_t g, int16x8_t b, int16x8_t a,
+                          uint16_t *out) {
+  uint16x8x4_t argb;
+  argb.val[0] = vreinterpretq_u16_s16(r);
+  argb.val[1] = vreinterpretq_u16_s16(g);
+  argb.val[2] = vreinterpretq_u16_s16(b);
+  argb.val[3] = vreinterpretq_u16_s16(a);
+  vst4q_u16(out, argb);
+}
+
+template<typename T>
+static void YuvToArgbNeon(int width, int height, int out_bitdepth,
+                          const int16_t *matrix, const uint16_t *src_y,
+                          const uint16_t *src_u, const uint16_t *src_v,
+                          ptrdiff_t src_stride, T *out, ptrdiff_t out_stride) {
+  const int bitdepth = Resampler::kColorConversionBitdepth;
+  const int width8 = GetYuvToArgbVectorWidth(width, out_bitdepth, 8);
+  const int32x4_t vshift = vdupq_n_s32(-(10 + bitdepth - out_bitdepth));
+  const int16x8_t y_offset = vdupq_n_s16(16 << (bitdepth - 8));
+  const int16x8_t uv_offset = vdupq_n_s16(128 << (bitdepth - 8));
+  const int16x8_t vmax = vdupq_n_s16((1 << out_bitdepth) - 1);
+  const int16x8_t zero = vdupq_n_s16(0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width8; x += 8) {
+      const int16x8_t c =
+        vsubq_s16(vreinterpretq_s16_u16(vld1q_u16(src_y + x)), y_offset);
+      const int16x8_t d =
+        vsubq_s16(vreinterpretq_s16_u16(vld1q_u16(src_u + x)), uv_offset);
+      const int16x8_t e =
+        vsubq_s16(vreinterpretq_s16_u16(vld1q_u16(src_v + x)), uv_offset);
+      int16x8_t rgb[3];
+      for (int i = 0; i < 3; i++) {
+        int32x4_t lo = vmull_n_s16(vget_low_s16(c), matrix[3 * i + 0]);
+        lo = vmlal_n_s16(lo, vget_low_s16(d), matrix[3 * i + 1]);
+        lo = vmlal_n_s16(lo, vget_low_s16(e), matrix[3 * i + 2]);
+        int32x4_t hi = vmull_n_s16(vget_high_s16(c), matrix[3 * i + 0]);
+        hi = vmlal_n_s16(hi, vget_high_s16(d), matrix[3 * i + 1]);
+        hi = vmlal_n_s16(hi, vget_high_s16(e), matrix[3 * i + 2]);
+        const int16x8_t val = vcombine_s16(vqmovn_s32(vshlq_s32(lo, vshift)),
+                                           vqmovn_s32(vshlq_s32(hi, vshift)));
+        rgb[i] = vminq_s16(vmaxq_s16(val, zero), vmax);
+      }
+      StoreArgbNeon(rgb[0], rgb[1], rgb[2], vmax, out + 4 * x);
+    }
+    YuvToArgbRowTail(width8, width, out_bitdepth, matrix, src_y, src_u, src_v,
+                     out);
+    src_y += src_stride;
+    src_u += src_stride;
+    src_v += src_stride;
+    out += out_stride;
+  }
+}
+#endif  // XVC_HAVE_NEON
+
+#ifdef XVC_ARCH_X86
+__attribute__((target("sse2")))
+static void StoreArgbSse2(__m128i r, __m128i g, __m128i b, __m128i a,
+                          uint8_t *out) {
+  const __m128i rg = _mm_packus_epi16(r, g);
+  const __m128i ba = _mm_packus_epi16(b, a);
+  const __m128i rg_mix = _mm_unpacklo_epi8(rg, _mm_srli_si128(rg, 8));
+  const __m128i ba_mix = _mm_unpacklo_epi8(ba, _mm_srli_si128(ba, 8));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                   _mm_unpacklo_epi16(rg_mix, ba_mix));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16),
+                   _mm_unpackhi_epi16(rg_mix, ba_mix));
+}
+
+__attribute__((target("sse2")))
+static void StoreArgbSse2(__m128i r, __m128i g, __m128i b, __m128i a,
+                          uint16_t *out) {
+  const __m128i rg_lo = _mm_unpacklo_epi16(r, g);
+  const __m128i rg_hi = _mm_unpackhi_epi16(r, g);
+  const __m128i ba_lo = _mm_unpacklo_epi16(b, a);
+  const __m128i ba_hi = _mm_unpackhi_epi16(b, a);
+  __m128i *out128 = reinterpret_cast<__m128i*>(out);
+  _mm_storeu_si128(out128 + 0, _mm_unpacklo_epi32(rg_lo, ba_lo));
+  _mm_storeu_si128(out128 + 1, _mm_unpackhi_epi32(rg_lo, ba_lo));
+  _mm_storeu_si128(out128 + 2, _mm_unpacklo_epi32(rg_hi, ba_hi));
+  _mm_storeu_si128(out128 + 3, _mm_unpackhi_epi32(rg_hi, ba_hi));
+}
+
+// Each output is formed by two multiply-adds, one with the (y, u) pairs and
+// one with v, since the coefficients are 16 bits but the sums are not
+template<typename T>
+__attribute__((target("sse2")))
+static void YuvToArgbSse2(int width, int height, int out_bitdepth,
+                          const int16_t *matrix, const uint16_t *src_y,
+                          const uint16_t *src_u, const uint16_t *src_v,
+                          ptrdiff_t src_stride, T *out, ptrdiff_t out_stride) {
+  const int bitdepth = Resampler::kColorConversionBitdepth;
+  const int width8 = GetYuvToArgbVectorWidth(width, out_bitdepth, 8);
+  const int shift = 10 + bitdepth - out_bitdepth;
+  const __m128i y_offset = _mm_set1_epi16(16 << (bitdepth - 8));
+  const __m128i uv_offset = _mm_set1_epi16(128 << (bitdepth - 8));
+  const __m128i vmax =
+    _mm_set1_epi16(static_cast<int16_t>((1 << out_bitdepth) - 1));
+  const __m128i zero = _mm_setzero_si128();
+  __m128i coeff_yu[3];
+  __m128i coeff_v[3];
+  for (int i = 0; i < 3; i++) {
+    coeff_yu[i] = _mm_unpacklo_epi16(_mm_set1_epi16(matrix[3 * i + 0]),
+                                     _mm_set1_epi16(matrix[3 * i + 1]));
+    coeff_v[i] = _mm_unpacklo_epi16(_mm_set1_epi16(matrix[3 * i + 2]), zero);
+  }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width8; x += 8) {
+      const __m128i c =
+        _mm_sub_epi16(_mm_loadu_si128(CAST_M128_CONST(src_y + x)), y_offset);
+      const __m128i d =
+        _mm_sub_epi16(_mm_loadu_si128(CAST_M128_CONST(src_u + x)), uv_offset);
+      const __m128i e =
+        _mm_sub_epi16(_mm_loadu_si128(CAST_M128_CONST(src_v + x)), uv_offset);
+      const __m128i cd_lo = _mm_unpacklo_epi16(c, d);
+      const __m128i cd_hi = _mm_unpackhi_epi16(c, d);
+      const __m128i e_lo = _mm_unpacklo_epi16(e, zero);
+      const __m128i e_hi = _mm_unpackhi_epi16(e, zero);
+      __m128i rgb[3];
+      for (int i = 0; i < 3; i++) {
+        __m128i lo = _mm_add_epi32(_mm_madd_epi16(cd_lo, coeff_yu[i]),
+                                   _mm_madd_epi16(e_lo, coeff_v[i]));
+        __m128i hi = _mm_add_epi32(_mm_madd_epi16(cd_hi, coeff_yu[i]),
+                                   _mm_madd_epi16(e_hi, coeff_v[i]));
+        const __m128i val = _mm_packs_epi32(_mm_srai_epi32(lo, shift),
+                                            _mm_srai_epi32(hi, shift));
+        rgb[i] = _mm_max_epi16(_mm_min_epi16(val, vmax), zero);
+      }
+      StoreArgbSse2(rgb[0], rgb[1], rgb[2], vmax, out + 4 * x);
+    }
+    YuvToArgbRowTail(width8, width, out_bitdepth, matrix, src_y, src_u, src_v,
+                     out);
+    src_y += src_stride;
+    src_u += src_stride;
+    src_v += src_stride;
+    out += out_stride;
+  }
+}
+#endif  // XVC_ARCH_X86
+
+#if defined(XVC_ARCH_X86) && USE_AVX2
+__attribute__((target("avx2")))
+static void StoreArgbAvx2(__m256i r, __m256i g, __m256i b, __m256i a,
+                          uint8_t *out) {
+  const __m256i rg = _mm256_packus_epi16(r, g);
+  const __m256i ba = _mm256_packus_epi16(b, a);
+  const __m256i rg_mix = _mm256_unpacklo_epi8(rg, _mm256_srli_si256(rg, 8));
+  const __m256i ba_mix = _mm256_unpacklo_epi8(ba, _mm256_srli_si256(ba, 8));
+  // Each 128-bit lane holds pixels 0-3 and 4-7 of its half of the vector
+  const __m256i out0 = _mm256_unpacklo_epi16(rg_mix, ba_mix);
+  const __m256i out1 = _mm256_unpackhi_epi16(rg_mix, ba_mix);
+  __m256i *out256 = reinterpret_cast<__m256i*>(out);
+  _mm256_storeu_si256(out256 + 0, _mm256_permute2x128_si256(out0, out1, 0x20));
+  _mm256_storeu_si256(out256 + 1, _mm256_permute2x128_si256(out0, out1, 0x31));
+}
+
+__attribute__((target("avx2")))
+static void StoreArgbAvx2(__m256i r, __m256i g, __m256i b, __m256i a,
+                          uint16_t *out) {
+  const __m256i rg_lo = _mm256_unpacklo_epi16(r, g);
+  const __m256i rg_hi = _mm256_unpackhi_epi16(r, g);
+  const __m256i ba_lo = _mm256_unpacklo_epi16(b, a);
+  const __m256i ba_hi = _mm256_unpackhi_epi16(b, a);
+  // Each 128-bit lane holds two pixels, lanes are reordered when stored
+  const __m256i out0 = _mm256_unpacklo_epi32(rg_lo, ba_lo);
+  const __m256i out1 = _mm256_unpackhi_epi32(rg_lo, ba_lo);
+  const __m256i out2 = _mm256_unpacklo_epi32(rg_hi, ba_hi);
+  const __m256i out3 = _mm256_unpackhi_epi32(rg_hi, ba_hi);
+  __m256i *out256 = reinterpret_cast<__m256i*>(out);
+  _mm256_storeu_si256(out256 + 0, _mm256_permute2x128_si256(out0, out1, 0x20));
+  _mm256_storeu_si256(out256 + 1, _mm256_permute2x128_si256(out2, out3, 0x20));
+  _mm256_storeu_si256(out256 + 2, _mm256_permute2x128_si256(out0, out1, 0x31));
+  _mm256_storeu_si256(out256 + 3, _mm256_permute2x128_si256(out2, out3, 0x31));
+}
+
+template<typename T>
+__attribute__((target("avx2")))
+static void YuvToArgbAvx2(int width, int height, int out_bitdepth,
+                          const int16_t *matrix, const uint16_t *src_y,
+                          const uint16_t *src_u, const uint16_t *src_v,
+                          ptrdiff_t src_stride, T *out, ptrdiff_t out_stride) {
+  const int bitdepth = Resampler::kColorConversionBitdepth;
+  const int width16 = GetYuvToArgbVectorWidth(width, out_bitdepth, 16);
+  const int shift = 10 + bitdepth - out_bitdepth;
+  const __m256i y_offset = _mm256_set1_epi16(16 << (bitdepth - 8));
+  const __m256i uv_offset = _mm256_set1_epi16(128 << (bitdepth - 8));
+  const __m256i vmax =
+    _mm256_set1_epi16(static_cast<int16_t>((1 << out_bitdepth) - 1));
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i coeff_yu[3];
+  __m256i coeff_v[3];
+  for (int i = 0; i < 3; i++) {
+    coeff_yu[i] = _mm256_unpacklo_epi16(_mm256_set1_epi16(matrix[3 * i + 0]),
+                                        _mm256_set1_epi16(matrix[3 * i + 1]));
+    coeff_v[i] =
+      _mm256_unpacklo_epi16(_mm256_set1_epi16(matrix[3 * i + 2]), zero);
+  }
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width16; x += 16) {
+      const __m256i c = _mm256_sub_epi16(
+        _mm256_loadu_si256(CAST_M256_CONST(src_y + x)), y_offset);
+      const __m256i d = _mm256_sub_epi16(
+        _mm256_loadu_si256(CAST_M256_CONST(src_u + x)), uv_offset);
+      const __m256i e = _mm256_sub_epi16(
+        _mm256_loadu_si256(CAST_M256_CONST(src_v + x)), uv_offset);
+      const __m256i cd_lo = _mm256_unpacklo_epi16(c, d);
+      const __m256i cd_hi = _mm256_unpackhi_epi16(c, d);
+      const __m256i e_lo = _mm256_unpacklo_epi16(e, zero);
+      const __m256i e_hi = _mm256_unpackhi_epi16(e, zero);
+      __m256i rgb[3];
+      for (int i = 0; i < 3; i++) {
+        __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(cd_lo, coeff_yu[i]),
+                                      _mm256_madd_epi16(e_lo, coeff_v[i]));
+        __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(cd_hi, coeff_yu[i]),
+                                      _mm256_madd_epi16(e_hi, coeff_v[i]));
+        const __m256i val = _mm256_packs_epi32(_mm256_srai_epi32(lo, shift),
+                                               _mm256_srai_epi32(hi, shift));
+        rgb[i] = _mm256_max_epi16(_mm256_min_epi16(val, vmax), zero);
+      }
+      StoreArgbAvx2(rgb[0], rgb[1], rgb[2], vmax, out + 4 * x);
+    }
+    YuvToArgbRowTail(width16, width, out_bitdepth, matrix, src_y, src_u,
+                     src_v, out);
+    src_y += src_stride;
+    src_u += src_stride;
+    src_v += src_stride;
+    out += out_stride;
+  }
+}
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
 #ifdef XVC_ARCH_ARM
 void ResamplerSimd::Register(const std::set<CpuCapability> &caps,
                              xvc::SimdFunctions *simd_functions) {
-#if XVC_HAVE_NEON && XVC_HIGH_BITDEPTH
+#ifdef XVC_HAVE_NEON
   if (caps.find(CpuCapability::kNeon) != caps.end()) {
     Resampler::SimdFunc &simd = simd_functions->resampler;
+#if XVC_HIGH_BITDEPTH
     simd.copy_sample_byte = &CopySampleToByteNeon;
     simd.downshift_sample_byte[0] = &DownshiftSampleToByteFastNeon;
     simd.downshift_sample_byte[1] = &DownshiftSampleToByteDitherNeon;
+#endif  // XVC_HIGH_BITDEPTH
+    simd.yuv_to_argb_byte = &YuvToArgbNeon<uint8_t>;
+    simd.yuv_to_argb_short = &YuvToArgbNeon<uint16_t>;
   }
 #endif  // XVC_HAVE_NEON
 }
@@ -233,14 +609,27 @@ void ResamplerSimd::Register(const std::set<CpuCapability> &caps,
 #ifdef XVC_ARCH_X86
 void ResamplerSimd::Register(const std::set<CpuCapability> &caps,
                              xvc::SimdFunctions *simd_functions) {
-#if XVC_HIGH_BITDEPTH
   Resampler::SimdFunc &simd = simd_functions->resampler;
   if (caps.find(CpuCapability::kSse2) != caps.end()) {
+#if XVC_HIGH_BITDEPTH
     simd.copy_sample_byte = &CopySampleToByteSse2;
     simd.downshift_sample_byte[0] = &DownshiftSampleToByteFastSse2;
     simd.downshift_sample_byte[1] = &DownshiftSampleToByteDitherSse2;
+#endif  // XVC_HIGH_BITDEPTH
+    simd.yuv_to_argb_byte = &YuvToArgbSse2<uint8_t>;
+    simd.yuv_to_argb_short = &YuvToArgbSse2<uint16_t>;
   }
+#if USE_AVX2
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+#if XVC_HIGH_BITDEPTH
+    simd.copy_sample_byte = &CopySampleToByteAvx2;
+    simd.downshift_sample_byte[0] = &DownshiftSampleToByteFastAvx2;
+    simd.downshift_sample_byte[1] = &DownshiftSampleToByteDitherAvx2;
 #endif  // XVC_HIGH_BITDEPTH
+    simd.yuv_to_argb_byte = &YuvToArgbAvx2<uint8_t>;
+    simd.yuv_to_argb_short = &YuvToArgbAvx2<uint16_t>;
+  }
+#endif  // USE_AVX2
 }
 #endif  // XVC_ARCH_X86
 
@@ -0,0 +1,515 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#include "xvc_common_lib/simd/transform_simd.h"
+
+#ifdef XVC_ARCH_X86
+#if __GNUC__  == 4 && __GNUC_MINOR__  <= 8 && not defined(__AVX2__)
+#define USE_AVX2 0  // gcc 4.8 requires -mavx2 before defining __m256i
+#else
+#define USE_AVX2 1
+#endif
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_X86
+#include <immintrin.h>    // AVX2
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_HAVE_NEON
+#include <arm_neon.h>
+#endif  // XVC_HAVE_NEON
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/transform.h"
+#include "xvc_common_lib/transform_data.h"
+
+#ifdef _MSC_VER
+#define __attribute__(SPEC)
+#endif  // _MSC_VER
+
+#ifdef XVC_ARCH_X86
+// Formatting helper
+#define CAST_M128_CONST(VAL) reinterpret_cast<const __m128i*>((VAL))
+#define CAST_M256_CONST(VAL) reinterpret_cast<const __m256i*>((VAL))
+#endif  // XVC_ARCH_X86
+
+namespace xvc {
+namespace simd {
+
+static const int kTransformHighPrecisionShift = 2;  // 8 bits instead of 6
+
+// All kernels below are straight matrix multiplications. For dct-2 this gives
+// the exact same result as the partial butterfly since the sums are computed
+// without intermediate rounding and the dct-2 matrices are symmetric.
+template<int N>
+static const int16_t* GetDct2Matrix(bool high_prec, int *shift) {
+  switch (N) {
+    case 4:
+      return high_prec ? &TransformData::kDct2Transform4High[0][0] :
+        &TransformData::kDct2Transform4[0][0];
+    case 8:
+      return high_prec ? &TransformData::kDct2Transform8High[0][0] :
+        &TransformData::kDct2Transform8[0][0];
+    case 16:
+      return high_prec ? &TransformData::kDct2Transform16High[0][0] :
+        &TransformData::kDct2Transform16[0][0];
+    case 32:
+      return high_prec ? &TransformData::kDct2Transform32High[0][0] :
+        &TransformData::kDct2Transform32[0][0];
+    default:
+      // Only high precision matrices supported
+      *shift += !high_prec ? kTransformHighPrecisionShift : 0;
+      return &TransformData::kDct2Transform64High[0][0];
+  }
+}
+
+// Number of input rows and output values used by the inverse (in_rows) and
+// forward (out_rows) transform, highest frequencies of 64 are always zero
+template<int N>
+struct TransformDim {
+  static const int kInRows = N < constants::kTransformZeroOutMinSize ?
+    N : constants::kTransformZeroOutMinSize;
+};
+
+// All matrices of size N that the kernels are called with
+template<int N>
+static int GetTransformMatrices(const int16_t **matrices) {
+  int num = 0;
+  switch (N) {
+    case 4:
+      matrices[num++] = &TransformData::kDct2Transform4[0][0];
+      matrices[num++] = &TransformData::kDct2Transform4High[0][0];
+      matrices[num++] = TransformData::kDct5Transform4High;
+      matrices[num++] = TransformData::kDct8Transform4High;
+      matrices[num++] = TransformData::kDst1Transform4High;
+      matrices[num++] = TransformData::kDst7Transform4High;
+      break;
+    case 8:
+      matrices[num++] = &TransformData::kDct2Transform8[0][0];
+      matrices[num++] = &TransformData::kDct2Transform8High[0][0];
+      matrices[num++] = TransformData::kDct5Transform8High;
+      matrices[num++] = TransformData::kDct8Transform8High;
+      matrices[num++] = TransformData::kDst1Transform8High;
+      matrices[num++] = TransformData::kDst7Transform8High;
+      break;
+    case 16:
+      matrices[num++] = &TransformData::kDct2Transform16[0][0];
+      matrices[num++] = &TransformData::kDct2Transform16High[0][0];
+      matrices[num++] = TransformData::kDct5Transform16High;
+      matrices[num++] = TransformData::kDct8Transform16High;
+      matrices[num++] = TransformData::kDst1Transform16High;
+      matrices[num++] = TransformData::kDst7Transform16High;
+      break;
+    case 32:
+      matrices[num++] = &TransformData::kDct2Transform32[0][0];
+      matrices[num++] = &TransformData::kDct2Transform32High[0][0];
+      matrices[num++] = TransformData::kDct5Transform32High;
+      matrices[num++] = TransformData::kDct8Transform32High;
+      matrices[num++] = TransformData::kDst1Transform32High;
+      matrices[num++] = TransformData::kDst7Transform32High;
+      break;
+    default:
+      matrices[num++] = &TransformData::kDct2Transform64High[0][0];
+      matrices[num++] = TransformData::kDct5Transform64High;
+      matrices[num++] = TransformData::kDct8Transform64High;
+      matrices[num++] = TransformData::kDst1Transform64High;
+      matrices[num++] = TransformData::kDst7Transform64High;
+      break;
+  }
+  return num;
+}
+
+// Rearranges the matrix into rows of the coefficients needed for each input
+// value. If interleaved the coefficient pairs (k, k + 1) needed for output x
+// are adjacent instead, allowing a single madd per pair of input values.
+// Inverse: out[x] = sum(m[k * N + x] * in[k]) for k < in_rows, x < N
+// Forward: out[x] = sum(m[x * N + k] * in[k]) for k < N, x < out_rows
+template<int N, bool Inverse, bool Interleave>
+static void RearrangeMatrix(const int16_t *matrix, int16_t *rearranged) {
+  const int num_k = Inverse ? TransformDim<N>::kInRows : N;
+  const int num_x = Inverse ? N : TransformDim<N>::kInRows;
+  const int k_step = Interleave ? 2 : 1;
+  for (int k = 0; k < num_k; k += k_step) {
+    for (int x = 0; x < num_x; x++) {
+      for (int i = 0; i < k_step; i++) {
+        *rearranged++ = Inverse ?
+          matrix[(k + i) * N + x] : matrix[x * N + k + i];
+      }
+    }
+  }
+}
+
+// Rearranged copies of all matrices of size N, built once on first use so
+// that the transform kernels do not have to rearrange the matrix per call
+template<int N, bool Inverse, bool Interleave>
+class RearrangedMatrices {
+public:
+  static const int16_t* Get(const int16_t *matrix) {
+    static const RearrangedMatrices matrices;
+    for (int i = 0; i < matrices.num_matrices_; i++) {
+      if (matrices.source_[i] == matrix) {
+        return matrices.rearranged_[i];
+      }
+    }
+    assert(0);
+    return nullptr;
+  }
+
+private:
+  static const int kMaxNumMatrices = 6;
+  static const int kSize = TransformDim<N>::kInRows * N;
+
+  RearrangedMatrices() : num_matrices_(GetTransformMatrices<N>(source_)) {
+    for (int i = 0; i < num_matrices_; i++) {
+      RearrangeMatrix<N, Inverse, Interleave>(source_[i], rearranged_[i]);
+    }
+  }
+
+  alignas(32) int16_t rearranged_[kMaxNumMatrices][kSize];
+  const int16_t *source_[kMaxNumMatrices];
+  int num_matrices_;
+};
+
+template<int N, bool Inverse>
+static int32_t GetInputPair(const Coeff *in, ptrdiff_t in_stride, int k) {
+  const ptrdiff_t step = Inverse ? in_stride : 1;
+  return static_cast<uint16_t>(in[k * step]) |
+    (static_cast<uint32_t>(static_cast<uint16_t>(in[(k + 1) * step])) << 16);
+}
+
+template<int N, bool Inverse>
+static void ZeroOutLines(int lines, int tx_lines,
+                         Coeff *out, ptrdiff_t out_stride) {
+  if (Inverse) {
+    for (int y = tx_lines; y < lines; y++) {
+      std::memset(out + y * out_stride, 0, sizeof(Coeff) * N);
+    }
+    return;
+  }
+  const int out_rows = TransformDim<N>::kInRows;
+  if (tx_lines < lines) {
+    for (int y = 0; y < out_rows; y++) {
+      std::memset(out + y * out_stride + tx_lines, 0,
+                  sizeof(Coeff) * (lines - tx_lines));
+    }
+  }
+  for (int y = out_rows; y < N; y++) {
+    std::memset(out + y * out_stride, 0, sizeof(Coeff) * lines);
+  }
+}
+
+#ifdef XVC_ARCH_X86
+template<int N, bool Inverse>
+__attribute__((target("sse2")))
+static void MatrixTransformSse2(int shift, int lines, bool zero_out,
+                                const int16_t *matrix,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride) {
+  static_assert(N >= 4, "4 outputs per madd");
+  const int num_k = Inverse ? TransformDim<N>::kInRows : N;
+  const int num_x = Inverse ? N : TransformDim<N>::kInRows;
+  const int num_groups = num_x / 4;
+  const int tx_lines = zero_out ?
+    std::min(lines, constants::kTransformZeroOutMinSize) : lines;
+  const int16_t *interleaved =
+    RearrangedMatrices<N, Inverse, true>::Get(matrix);
+  alignas(16) int32_t sums[num_x];
+  const __m128i vadd = _mm_set1_epi32(1 << (shift - 1));
+
+  for (int y = 0; y < tx_lines; y++) {
+    const Coeff *line_in = Inverse ? in + y : in + y * in_stride;
+    Coeff *line_out = Inverse ? out + y * out_stride : out + y;
+    __m128i acc[num_groups];
+    for (int g = 0; g < num_groups; g++) {
+      acc[g] = _mm_setzero_si128();
+    }
+    for (int k = 0; k < num_k; k += 2) {
+      const __m128i vin =
+        _mm_set1_epi32(GetInputPair<N, Inverse>(line_in, in_stride, k));
+      const int16_t *m = &interleaved[k * num_x];
+      for (int g = 0; g < num_groups; g++) {
+        __m128i vm = _mm_load_si128(CAST_M128_CONST(m + g * 8));
+        acc[g] = _mm_add_epi32(acc[g], _mm_madd_epi16(vm, vin));
+      }
+    }
+    for (int g = 0; g < num_groups; g++) {
+      acc[g] = _mm_srai_epi32(_mm_add_epi32(acc[g], vadd), shift);
+    }
+    if (Inverse) {
+      // Saturating pack equals clipping to 16 bits
+      if (num_groups == 1) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(line_out),
+                         _mm_packs_epi32(acc[0], acc[0]));
+      }
+      for (int g = 0; g + 1 < num_groups; g += 2) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(line_out + g * 4),
+                         _mm_packs_epi32(acc[g], acc[g + 1]));
+      }
+    } else {
+      // Output is transposed, no clipping is done in forward direction
+      for (int g = 0; g < num_groups; g++) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(sums + g * 4), acc[g]);
+      }
+      for (int x = 0; x < num_x; x++) {
+        line_out[x * out_stride] = static_cast<Coeff>(sums[x]);
+      }
+    }
+  }
+  ZeroOutLines<N, Inverse>(lines, tx_lines, out, out_stride);
+}
+
+template<int N, bool Inverse>
+__attribute__((target("sse2")))
+static void Dct2Sse2(int shift, int lines, bool high_prec, bool zero_out,
+                     const Coeff *in, ptrdiff_t in_stride,
+                     Coeff *out, ptrdiff_t out_stride) {
+  const int16_t *matrix = GetDct2Matrix<N>(high_prec, &shift);
+  MatrixTransformSse2<N, Inverse>(shift, lines, zero_out, matrix,
+                                  in, in_stride, out, out_stride);
+}
+#endif  // XVC_ARCH_X86
+
+#if defined(XVC_ARCH_X86) && USE_AVX2
+template<int N, bool Inverse>
+__attribute__((target("avx2")))
+static void MatrixTransformAvx2(int shift, int lines, bool zero_out,
+                                const int16_t *matrix,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride) {
+  static_assert(N >= 8, "8 outputs per madd");
+  const int num_k = Inverse ? TransformDim<N>::kInRows : N;
+  const int num_x = Inverse ? N : TransformDim<N>::kInRows;
+  const int num_groups = num_x / 8;
+  const int tx_lines = zero_out ?
+    std::min(lines, constants::kTransformZeroOutMinSize) : lines;
+  const int16_t *interleaved =
+    RearrangedMatrices<N, Inverse, true>::Get(matrix);
+  alignas(32) int32_t sums[num_x];
+  const __m256i vadd = _mm256_set1_epi32(1 << (shift - 1));
+
+  for (int y = 0; y < tx_lines; y++) {
+    const Coeff *line_in = Inverse ? in + y : in + y * in_stride;
+    Coeff *line_out = Inverse ? out + y * out_stride : out + y;
+    __m256i acc[num_groups];
+    for (int g = 0; g < num_groups; g++) {
+      acc[g] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < num_k; k += 2) {
+      const __m256i vin =
+        _mm256_set1_epi32(GetInputPair<N, Inverse>(line_in, in_stride, k));
+      const int16_t *m = &interleaved[k * num_x];
+      for (int g = 0; g < num_groups; g++) {
+        __m256i vm = _mm256_load_si256(CAST_M256_CONST(m + g * 16));
+        acc[g] = _mm256_add_epi32(acc[g], _mm256_madd_epi16(vm, vin));
+      }
+    }
+    for (int g = 0; g < num_groups; g++) {
+      acc[g] = _mm256_srai_epi32(_mm256_add_epi32(acc[g], vadd), shift);
+    }
+    if (Inverse) {
+      // Lane wise pack followed by permute to restore output order
+      if (num_groups == 1) {
+        __m256i packed = _mm256_packs_epi32(acc[0], acc[0]);
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(line_out),
+                         _mm256_castsi256_si128(packed));
+      }
+      for (int g = 0; g + 1 < num_groups; g += 2) {
+        __m256i packed = _mm256_packs_epi32(acc[g], acc[g + 1]);
+        packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(line_out + g * 8),
+                            packed);
+      }
+    } else {
+      for (int g = 0; g < num_groups; g++) {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums + g * 8), acc[g]);
+      }
+      for (int x = 0; x < num_x; x++) {
+        line_out[x * out_stride] = static_cast<Coeff>(sums[x]);
+      }
+    }
+  }
+  ZeroOutLines<N, Inverse>(lines, tx_lines, out, out_stride);
+}
+
+template<int N, bool Inverse>
+__attribute__((target("avx2")))
+static void Dct2Avx2(int shift, int lines, bool high_prec, bool zero_out,
+                     const Coeff *in, ptrdiff_t in_stride,
+                     Coeff *out, ptrdiff_t out_stride) {
+  const int16_t *matrix = GetDct2Matrix<N>(high_prec, &shift);
+  MatrixTransformAvx2<N, Inverse>(shift, lines, zero_out, matrix,
+                                  in, in_stride, out, out_stride);
+}
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
+#ifdef XVC_HAVE_NEON
+template<int N, bool Inverse>
+static void MatrixTransformNeon(int shift, int lines, bool zero_out,
+                                const int16_t *matrix,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride) {
+  static_assert(N >= 4, "4 outputs per multiply");
+  const int num_k = Inverse ? TransformDim<N>::kInRows : N;
+  const int num_x = Inverse ? N : TransformDim<N>::kInRows;
+  const int num_groups = num_x / 4;
+  const int tx_lines = zero_out ?
+    std::min(lines, constants::kTransformZeroOutMinSize) : lines;
+  const int32x4_t vshift = vdupq_n_s32(-shift);
+  // Rows of coefficients needed for each input value, m[k * num_x + x]
+  const int16_t *m_rows = RearrangedMatrices<N, Inverse, false>::Get(matrix);
+
+  for (int y = 0; y < tx_lines; y++) {
+    const Coeff *line_in = Inverse ? in + y : in + y * in_stride;
+    Coeff *line_out = Inverse ? out + y * out_stride : out + y;
+    int32x4_t acc[num_groups];
+    for (int g = 0; g < num_groups; g++) {
+      acc[g] = vdupq_n_s32(0);
+    }
+    for (int k = 0; k < num_k; k++) {
+      const int16_t val = line_in[k * (Inverse ? in_stride : 1)];
+      const int16_t *m = &m_rows[k * num_x];
+      for (int g = 0; g < num_groups; g++) {
+        acc[g] = vmlal_n_s16(acc[g], vld1_s16(m + g * 4), val);
+      }
+    }
+    for (int g = 0; g < num_groups; g++) {
+      // Rounding shift right
+      int32x4_t sum = vrshlq_s32(acc[g], vshift);
+      if (Inverse) {
+        vst1_s16(line_out + g * 4, vqmovn_s32(sum));
+      } else {
+        int16_t tmp[4];
+        vst1_s16(tmp, vmovn_s32(sum));
+        for (int i = 0; i < 4; i++) {
+          line_out[(g * 4 + i) * out_stride] = tmp[i];
+        }
+      }
+    }
+  }
+  ZeroOutLines<N, Inverse>(lines, tx_lines, out, out_stride);
+}
+
+template<int N, bool Inverse>
+static void Dct2Neon(int shift, int lines, bool high_prec, bool zero_out,
+                     const Coeff *in, ptrdiff_t in_stride,
+                     Coeff *out, ptrdiff_t out_stride) {
+  const int16_t *matrix = GetDct2Matrix<N>(high_prec, &shift);
+  MatrixTransformNeon<N, Inverse>(shift, lines, zero_out, matrix,
+                                  in, in_stride, out, out_stride);
+}
+#endif  // XVC_HAVE_NEON
+
+#ifdef XVC_ARCH_ARM
+void TransformSimd::Register(const std::set<CpuCapability> &caps,
+                             xvc::SimdFunctions *simd_functions) {
+#ifdef XVC_HAVE_NEON
+  if (caps.find(CpuCapability::kNeon) != caps.end()) {
+    InverseTransform::SimdFunc &inv = simd_functions->inv_transform;
+    ForwardTransform::SimdFunc &fwd = simd_functions->fwd_transform;
+    inv.dct2[1] = &Dct2Neon<4, true>;
+    inv.dct2[2] = &Dct2Neon<8, true>;
+    inv.dct2[3] = &Dct2Neon<16, true>;
+    inv.dct2[4] = &Dct2Neon<32, true>;
+    inv.dct2[5] = &Dct2Neon<64, true>;
+    inv.matrix[1] = &MatrixTransformNeon<4, true>;
+    inv.matrix[2] = &MatrixTransformNeon<8, true>;
+    inv.matrix[3] = &MatrixTransformNeon<16, true>;
+    inv.matrix[4] = &MatrixTransformNeon<32, true>;
+    inv.matrix[5] = &MatrixTransformNeon<64, true>;
+    fwd.dct2[1] = &Dct2Neon<4, false>;
+    fwd.dct2[2] = &Dct2Neon<8, false>;
+    fwd.dct2[3] = &Dct2Neon<16, false>;
+    fwd.dct2[4] = &Dct2Neon<32, false>;
+    fwd.dct2[5] = &Dct2Neon<64, false>;
+    fwd.matrix[1] = &MatrixTransformNeon<4, false>;
+    fwd.matrix[2] = &MatrixTransformNeon<8, false>;
+    fwd.matrix[3] = &MatrixTransformNeon<16, false>;
+    fwd.matrix[4] = &MatrixTransformNeon<32, false>;
+    fwd.matrix[5] = &MatrixTransformNeon<64, false>;
+  }
+#endif  // XVC_HAVE_NEON
+}
+#endif  // XVC_ARCH_ARM
+
+#ifdef XVC_ARCH_X86
+void TransformSimd::Register(const std::set<CpuCapability> &caps,
+                             xvc::SimdFunctions *simd_functions) {
+  InverseTransform::SimdFunc &inv = simd_functions->inv_transform;
+  ForwardTransform::SimdFunc &fwd = simd_functions->fwd_transform;
+  if (caps.find(CpuCapability::kSse2) != caps.end()) {
+    inv.dct2[1] = &Dct2Sse2<4, true>;
+    inv.dct2[2] = &Dct2Sse2<8, true>;
+    inv.dct2[3] = &Dct2Sse2<16, true>;
+    inv.dct2[4] = &Dct2Sse2<32, true>;
+    inv.dct2[5] = &Dct2Sse2<64, true>;
+    inv.matrix[1] = &MatrixTransformSse2<4, true>;
+    inv.matrix[2] = &MatrixTransformSse2<8, true>;
+    inv.matrix[3] = &MatrixTransformSse2<16, true>;
+    inv.matrix[4] = &MatrixTransformSse2<32, true>;
+    inv.matrix[5] = &MatrixTransformSse2<64, true>;
+    fwd.dct2[1] = &Dct2Sse2<4, false>;
+    fwd.dct2[2] = &Dct2Sse2<8, false>;
+    fwd.dct2[3] = &Dct2Sse2<16, false>;
+    fwd.dct2[4] = &Dct2Sse2<32, false>;
+    fwd.dct2[5] = &Dct2Sse2<64, false>;
+    fwd.matrix[1] = &MatrixTransformSse2<4, false>;
+    fwd.matrix[2] = &MatrixTransformSse2<8, false>;
+    fwd.matrix[3] = &MatrixTransformSse2<16, false>;
+    fwd.matrix[4] = &MatrixTransformSse2<32, false>;
+    fwd.matrix[5] = &MatrixTransformSse2<64, false>;
+  }
+#if USE_AVX2
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    inv.dct2[2] = &Dct2Avx2<8, true>;
+    inv.dct2[3] = &Dct2Avx2<16, true>;
+    inv.dct2[4] = &Dct2Avx2<32, true>;
+    inv.dct2[5] = &Dct2Avx2<64, true>;
+    inv.matrix[2] = &MatrixTransformAvx2<8, true>;
+    inv.matrix[3] = &MatrixTransformAvx2<16, true>;
+    inv.matrix[4] = &MatrixTransformAvx2<32, true>;
+    inv.matrix[5] = &MatrixTransformAvx2<64, true>;
+    fwd.dct2[2] = &Dct2Avx2<8, false>;
+    fwd.dct2[3] = &Dct2Avx2<16, false>;
+    fwd.dct2[4] = &Dct2Avx2<32, false>;
+    fwd.dct2[5] = &Dct2Avx2<64, false>;
+    fwd.matrix[2] = &MatrixTransformAvx2<8, false>;
+    fwd.matrix[3] = &MatrixTransformAvx2<16, false>;
+    fwd.matrix[4] = &MatrixTransformAvx2<32, false>;
+    fwd.matrix[5] = &MatrixTransformAvx2<64, false>;
+  }
+#endif  // USE_AVX2
+}
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_MIPS
+void TransformSimd::Register(const std::set<CpuCapability> &caps,
+                             xvc::SimdFunctions *simd_functions) {
+}
+#endif  // XVC_ARCH_MIPS
+
+}   // namespace simd
+}   // namespace xvc
@@ -0,0 +1,205 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include "xvc_common_lib/simd/yuv_pic_simd.h"
+
+#ifdef XVC_ARCH_X86
+#if __GNUC__  == 4 && __GNUC_MINOR__  <= 8 && not defined(__AVX2__)
+#define USE_AVX2 0  // gcc 4.8 requires -mavx2 before defining __m256i
+#else
+#define USE_AVX2 1
+#endif
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_X86
+#include <immintrin.h>    // AVX2
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_HAVE_NEON
+#include <arm_neon.h>
+#endif  // XVC_HAVE_NEON
+
+#include "xvc_common_lib/simd_functions.h"
+#include "xvc_common_lib/yuv_pic.h"
+
+#ifdef _MSC_VER
+#define __attribute__(SPEC)
+#endif  // _MSC_VER
+
+#ifdef XVC_ARCH_X86
+// Formatting helper
+#define CAST_M128(VAL) reinterpret_cast<__m128i*>((VAL))
+#define CAST_M256(VAL) reinterpret_cast<__m256i*>((VAL))
+#endif  // XVC_ARCH_X86
+
+namespace xvc {
+namespace simd {
+
+// Fills the padding with whole vectors, the last vector on each side
+// overlaps the previous one unless the padding is a multiple of the vector
+// length. Padding narrower than one vector is filled sample by sample.
+static void PadRowsNarrow(int width, int height, int pad, Sample *rows,
+                          ptrdiff_t stride) {
+  for (int y = 0; y < height; y++) {
+    for (int x = 1; x <= pad; x++) {
+      rows[-x] = rows[0];
+      rows[width - 1 + x] = rows[width - 1];
+    }
+    rows += stride;
+  }
+}
+
+#ifdef XVC_ARCH_X86
+__attribute__((target("sse2")))
+static __m128i BroadcastSse2(Sample val) {
+#if XVC_HIGH_BITDEPTH
+  return _mm_set1_epi16(static_cast<int16_t>(val));
+#else
+  return _mm_set1_epi8(static_cast<char>(val));
+#endif
+}
+
+__attribute__((target("sse2")))
+static void PadRowsSse2(int width, int height, int pad, Sample *rows,
+                        ptrdiff_t stride) {
+  const int kN = sizeof(__m128i) / sizeof(Sample);
+  if (pad < kN) {
+    PadRowsNarrow(width, height, pad, rows, stride);
+    return;
+  }
+  for (int y = 0; y < height; y++) {
+    const __m128i left = BroadcastSse2(rows[0]);
+    const __m128i right = BroadcastSse2(rows[width - 1]);
+    Sample *left_pad = rows - pad;
+    Sample *right_pad = rows + width;
+    for (int x = 0; x < pad - kN; x += kN) {
+      _mm_storeu_si128(CAST_M128(left_pad + x), left);
+      _mm_storeu_si128(CAST_M128(right_pad + x), right);
+    }
+    _mm_storeu_si128(CAST_M128(rows - kN), left);
+    _mm_storeu_si128(CAST_M128(right_pad + pad - kN), right);
+    rows += stride;
+  }
+}
+#endif  // XVC_ARCH_X86
+
+#if defined(XVC_ARCH_X86) && USE_AVX2
+__attribute__((target("avx2")))
+static __m256i BroadcastAvx2(Sample val) {
+#if XVC_HIGH_BITDEPTH
+  return _mm256_set1_epi16(static_cast<int16_t>(val));
+#else
+  return _mm256_set1_epi8(static_cast<char>(val));
+#endif
+}
+
+__attribute__((target("avx2")))
+static void PadRowsAvx2(int width, int height, int pad, Sample *rows,
+                        ptrdiff_t stride) {
+  const int kN = sizeof(__m256i) / sizeof(Sample);
+  if (pad < kN) {
+    PadRowsSse2(width, height, pad, rows, stride);
+    return;
+  }
+  for (int y = 0; y < height; y++) {
+    const __m256i left = BroadcastAvx2(rows[0]);
+    const __m256i right = BroadcastAvx2(rows[width - 1]);
+    Sample *left_pad = rows - pad;
+    Sample *right_pad = rows + width;
+    for (int x = 0; x < pad - kN; x += kN) {
+      _mm256_storeu_si256(CAST_M256(left_pad + x), left);
+      _mm256_storeu_si256(CAST_M256(right_pad + x), right);
+    }
+    _mm256_storeu_si256(CAST_M256(rows - kN), left);
+    _mm256_storeu_si256(CAST_M256(right_pad + pad - kN), right);
+    rows += stride;
+  }
+}
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
+#ifdef XVC_HAVE_NEON
+static void PadRowsNeon(int width, int height, int pad, Sample *rows,
+                        ptrdiff_t stride) {
+  const int kN = 16 / sizeof(Sample);
+  if (pad < kN) {
+    PadRowsNarrow(width, height, pad, rows, stride);
+    return;
+  }
+  for (int y = 0; y < height; y++) {
+    Sample *left_pad = rows - pad;
+    Sample *right_pad = rows + width;
+#if XVC_HIGH_BITDEPTH
+    const uint16x8_t left = vdupq_n_u16(rows[0]);
+    const uint16x8_t right = vdupq_n_u16(rows[width - 1]);
+    for (int x = 0; x < pad - kN; x += kN) {
+      vst1q_u16(left_pad + x, left);
+      vst1q_u16(right_pad + x, right);
+    }
+    vst1q_u16(rows - kN, left);
+    vst1q_u16(right_pad + pad - kN, right);
+#else
+    const uint8x16_t left = vdupq_n_u8(rows[0]);
+    const uint8x16_t right = vdupq_n_u8(rows[width - 1]);
+    for (int x = 0; x < pad - kN; x += kN) {
+      vst1q_u8(left_pad + x, left);
+      vst1q_u8(right_pad + x, right);
+    }
+    vst1q_u8(rows - kN, left);
+    vst1q_u8(right_pad + pad - kN, right);
+#endif
+    rows += stride;
+  }
+}
+#endif  // XVC_HAVE_NEON
+
+#ifdef XVC_ARCH_ARM
+void YuvPicSimd::Register(const std::set<CpuCapability> &caps,
+                          xvc::SimdFunctions *simd_functions) {
+#ifdef XVC_HAVE_NEON
+  if (caps.find(CpuCapability::kNeon) != caps.end()) {
+    simd_functions->yuv_picture.pad_rows = &PadRowsNeon;
+  }
+#endif  // XVC_HAVE_NEON
+}
+#endif  // XVC_ARCH_ARM
+
+#ifdef XVC_ARCH_X86
+void YuvPicSimd::Register(const std::set<CpuCapability> &caps,
+                          xvc::SimdFunctions *simd_functions) {
+  if (caps.find(CpuCapability::kSse2) != caps.end()) {
+    simd_functions->yuv_picture.pad_rows = &PadRowsSse2;
+  }
+#if USE_AVX2
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    simd_functions->yuv_picture.pad_rows = &PadRowsAvx2;
+  }
+#endif  // USE_AVX2
+}
+#endif  // XVC_ARCH_X86
+
+#ifdef XVC_ARCH_MIPS
+void YuvPicSimd::Register(const std::set<CpuCapability> &caps,
+                          xvc::SimdFunctions *simd_functions) {
+}
+#endif  // XVC_ARCH_MIPS
+
+}   // namespace simd
+}   // namespace xvc
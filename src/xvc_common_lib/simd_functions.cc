@@ -22,8 +22,13 @@
 #include "xvc_common_lib/simd_functions.h"
 
 #if defined(XVC_ARCH_ARM) || defined(XVC_ARCH_X86) || defined(XVC_ARCH_MIPS)
+#include "xvc_common_lib/simd/deblocking_filter_simd.h"
 #include "xvc_common_lib/simd/inter_prediction_simd.h"
+#include "xvc_common_lib/simd/intra_prediction_simd.h"
+#include "xvc_common_lib/simd/quantize_simd.h"
 #include "xvc_common_lib/simd/resampler_simd.h"
+#include "xvc_common_lib/simd/transform_simd.h"
+#include "xvc_common_lib/simd/yuv_pic_simd.h"
 #endif
 
 namespace xvc {
@@ -31,8 +36,13 @@ namespace xvc {
 SimdFunctions::SimdFunctions(const std::set<CpuCapability> &capabilities)
   : inter_prediction() {
 #if defined(XVC_ARCH_ARM) || defined(XVC_ARCH_X86) || defined(XVC_ARCH_MIPS)
+  simd::DeblockingFilterSimd::Register(capabilities, this);
   simd::InterPredictionSimd::Register(capabilities, this);
+  simd::IntraPredictionSimd::Register(capabilities, this);
+  simd::QuantizeSimd::Register(capabilities, this);
   simd::ResamplerSimd::Register(capabilities, this);
+  simd::TransformSimd::Register(capabilities, this);
+  simd::YuvPicSimd::Register(capabilities, this);
 #endif
 }
 
@@ -26,16 +26,27 @@
 
 #include "xvc_common_lib/common.h"
 #include "xvc_common_lib/simd_cpu.h"
+#include "xvc_common_lib/deblocking_filter.h"
 #include "xvc_common_lib/inter_prediction.h"
+#include "xvc_common_lib/intra_prediction.h"
+#include "xvc_common_lib/quantize.h"
 #include "xvc_common_lib/resample.h"
+#include "xvc_common_lib/transform.h"
+#include "xvc_common_lib/yuv_pic.h"
 
 namespace xvc {
 
 struct SimdFunctions {
   explicit SimdFunctions(const std::set<CpuCapability> &capabilities);
 
+  DeblockingFilter::SimdFunc deblocking_filter;
   InterPrediction::SimdFunc inter_prediction;
+  IntraPrediction::SimdFunc intra_prediction;
   Resampler::SimdFunc resampler;
+  InverseTransform::SimdFunc inv_transform;
+  ForwardTransform::SimdFunc fwd_transform;
+  Quantize::SimdFunc quantize;
+  YuvPicture::SimdFunc yuv_picture;
 };
 
 }   // namespace xvc
@@ -75,8 +75,9 @@ std::array<std::array<uint8_t, 16>, 3> TransformHelper::kScanCoeff4x4 = { {
   { 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15 },
 } };
 
-InverseTransform::InverseTransform(int bitdepth)
-  : restrictions_(Restrictions::Get()),
+InverseTransform::InverseTransform(const SimdFunc &simd, int bitdepth)
+  : simd_(simd),
+  restrictions_(Restrictions::Get()),
   bitdepth_(bitdepth) {
 }
 
@@ -245,35 +246,9 @@ void InverseTransform::InvDct2(int size, int shift, int lines,
                                bool high_prec, bool zero_out,
                                const Coeff *in, ptrdiff_t in_stride,
                                Coeff *out, ptrdiff_t out_stride) {
-  switch (size) {
-    case 2:
-      InvDct2Transform2(shift, lines, high_prec, zero_out,
-                        in, in_stride, out, out_stride);
-      break;
-    case 4:
-      InvDct2Transform4(shift, lines, high_prec, zero_out,
-                        in, in_stride, out, out_stride);
-      break;
-    case 8:
-      InvDct2Transform8(shift, lines, high_prec, zero_out,
-                        in, in_stride, out, out_stride);
-      break;
-    case 16:
-      InvDct2Transform16(shift, lines, high_prec, zero_out,
-                         in, in_stride, out, out_stride);
-      break;
-    case 32:
-      InvDct2Transform32(shift, lines, high_prec, zero_out,
-                         in, in_stride, out, out_stride);
-      break;
-    case 64:
-      InvDct2Transform64(shift, lines, high_prec, zero_out,
-                         in, in_stride, out, out_stride);
-      break;
-    default:
-      assert(0);
-      break;
-  }
+  assert(size >= 2 && size <= 64);
+  simd_.dct2[util::SizeToLog2(size) - 1](shift, lines, high_prec, zero_out,
+                                         in, in_stride, out, out_stride);
 }
 
 void InverseTransform::InvDct2Dc(int height, int width,
@@ -298,24 +273,24 @@ void InverseTransform::InvDct5(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      InvGenericTransformN<4>(shift, lines, zero_out, kDct5Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDct5Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      InvGenericTransformN<8>(shift, lines, zero_out, kDct5Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDct5Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      InvGenericTransformN<16>(shift, lines, zero_out, kDct5Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDct5Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      InvGenericTransformN<32>(shift, lines, zero_out, kDct5Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDct5Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      InvGenericTransformN<64>(shift, lines, zero_out, kDct5Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDct5Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -331,24 +306,24 @@ void InverseTransform::InvDct8(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      InvGenericTransformN<4>(shift, lines, zero_out, kDct8Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDct8Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      InvGenericTransformN<8>(shift, lines, zero_out, kDct8Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDct8Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      InvGenericTransformN<16>(shift, lines, zero_out, kDct8Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDct8Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      InvGenericTransformN<32>(shift, lines, zero_out, kDct8Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDct8Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      InvGenericTransformN<64>(shift, lines, zero_out, kDct8Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDct8Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -364,24 +339,24 @@ void InverseTransform::InvDst1(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      InvGenericTransformN<4>(shift, lines, zero_out, kDst1Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDst1Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      InvGenericTransformN<8>(shift, lines, zero_out, kDst1Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDst1Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      InvGenericTransformN<16>(shift, lines, zero_out, kDst1Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDst1Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      InvGenericTransformN<32>(shift, lines, zero_out, kDst1Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDst1Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      InvGenericTransformN<64>(shift, lines, zero_out, kDst1Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDst1Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -397,24 +372,24 @@ void InverseTransform::InvDst7(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      InvGenericTransformN<4>(shift, lines, zero_out, kDst7Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDst7Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      InvGenericTransformN<8>(shift, lines, zero_out, kDst7Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDst7Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      InvGenericTransformN<16>(shift, lines, zero_out, kDst7Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDst7Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      InvGenericTransformN<32>(shift, lines, zero_out, kDst7Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDst7Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      InvGenericTransformN<64>(shift, lines, zero_out, kDst7Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDst7Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -835,7 +810,7 @@ InverseTransform::InvDct2Transform64(int shift, int lines,
 template<int N>
 void
 InverseTransform::InvGenericTransformN(int shift, int lines, bool zero_out,
-                                       const Coeff(&kMatrix)[N * N],
+                                       const Coeff *kMatrix,
                                        const Coeff *in, ptrdiff_t in_stride,
                                        Coeff *out, ptrdiff_t out_stride) {
   const int add = 1 << (shift - 1);
@@ -861,8 +836,9 @@ InverseTransform::InvGenericTransformN(int shift, int lines, bool zero_out,
   }
 }
 
-ForwardTransform::ForwardTransform(int bitdepth)
-  : restrictions_(Restrictions::Get()),
+ForwardTransform::ForwardTransform(const SimdFunc &simd, int bitdepth)
+  : simd_(simd),
+  restrictions_(Restrictions::Get()),
   bitdepth_(bitdepth) {
 }
 
@@ -1020,35 +996,9 @@ void ForwardTransform::FwdDct2(int size, int shift, int lines,
                                bool high_prec, bool zero_out,
                                const Coeff *in, ptrdiff_t in_stride,
                                Coeff *out, ptrdiff_t out_stride) {
-  switch (size) {
-    case 2:
-      FwdDct2Transform2(shift, lines, high_prec, zero_out,
-                        in, in_stride, out, out_stride);
-      break;
-    case 4:
-      FwdDct2Transform4(shift, lines, high_prec, zero_out,
-                        in, in_stride, out, out_stride);
-      break;
-    case 8:
-      FwdDct2Transform8(shift, lines, high_prec, zero_out,
-                        in, in_stride, out, out_stride);
-      break;
-    case 16:
-      FwdDct2Transform16(shift, lines, high_prec, zero_out,
-                         in, in_stride, out, out_stride);
-      break;
-    case 32:
-      FwdDct2Transform32(shift, lines, high_prec, zero_out,
-                         in, in_stride, out, out_stride);
-      break;
-    case 64:
-      FwdDct2Transform64(shift, lines, high_prec, zero_out,
-                         in, in_stride, out, out_stride);
-      break;
-    default:
-      assert(0);
-      break;
-  }
+  assert(size >= 2 && size <= 64);
+  simd_.dct2[util::SizeToLog2(size) - 1](shift, lines, high_prec, zero_out,
+                                         in, in_stride, out, out_stride);
 }
 
 void ForwardTransform::FwdDct5(int size, int shift, int lines,
@@ -1059,24 +1009,24 @@ void ForwardTransform::FwdDct5(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      FwdGenericTransformN<4>(shift, lines, zero_out, kDct5Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDct5Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      FwdGenericTransformN<8>(shift, lines, zero_out, kDct5Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDct5Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      FwdGenericTransformN<16>(shift, lines, zero_out, kDct5Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDct5Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      FwdGenericTransformN<32>(shift, lines, zero_out, kDct5Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDct5Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      FwdGenericTransformN<64>(shift, lines, zero_out, kDct5Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDct5Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -1092,24 +1042,24 @@ void ForwardTransform::FwdDct8(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      FwdGenericTransformN<4>(shift, lines, zero_out, kDct8Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDct8Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      FwdGenericTransformN<8>(shift, lines, zero_out, kDct8Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDct8Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      FwdGenericTransformN<16>(shift, lines, zero_out, kDct8Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDct8Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      FwdGenericTransformN<32>(shift, lines, zero_out, kDct8Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDct8Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      FwdGenericTransformN<64>(shift, lines, zero_out, kDct8Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDct8Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -1125,24 +1075,24 @@ void ForwardTransform::FwdDst1(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      FwdGenericTransformN<4>(shift, lines, zero_out, kDst1Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDst1Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      FwdGenericTransformN<8>(shift, lines, zero_out, kDst1Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDst1Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      FwdGenericTransformN<16>(shift, lines, zero_out, kDst1Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDst1Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      FwdGenericTransformN<32>(shift, lines, zero_out, kDst1Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDst1Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      FwdGenericTransformN<64>(shift, lines, zero_out, kDst1Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDst1Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -1158,24 +1108,24 @@ void ForwardTransform::FwdDst7(int size, int shift, int lines,
   shift += !high_prec ? kTransformHighPrecisionShift : 0;
   switch (size) {
     case 4:
-      FwdGenericTransformN<4>(shift, lines, zero_out, kDst7Transform4High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[1](shift, lines, zero_out, kDst7Transform4High,
+                      in, in_stride, out, out_stride);
       break;
     case 8:
-      FwdGenericTransformN<8>(shift, lines, zero_out, kDst7Transform8High,
-                              in, in_stride, out, out_stride);
+      simd_.matrix[2](shift, lines, zero_out, kDst7Transform8High,
+                      in, in_stride, out, out_stride);
       break;
     case 16:
-      FwdGenericTransformN<16>(shift, lines, zero_out, kDst7Transform16High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[3](shift, lines, zero_out, kDst7Transform16High,
+                      in, in_stride, out, out_stride);
       break;
     case 32:
-      FwdGenericTransformN<32>(shift, lines, zero_out, kDst7Transform32High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[4](shift, lines, zero_out, kDst7Transform32High,
+                      in, in_stride, out, out_stride);
       break;
     case 64:
-      FwdGenericTransformN<64>(shift, lines, zero_out, kDst7Transform64High,
-                               in, in_stride, out, out_stride);
+      simd_.matrix[5](shift, lines, zero_out, kDst7Transform64High,
+                      in, in_stride, out, out_stride);
       break;
     default:
       assert(0);
@@ -1580,7 +1530,7 @@ ForwardTransform::FwdDct2Transform64(int shift, int lines,
 template<int N>
 void
 ForwardTransform::FwdGenericTransformN(int shift, int lines, bool zero_out,
-                                       const Coeff(&kMatrix)[N * N],
+                                       const Coeff *kMatrix,
                                        const Coeff *in, ptrdiff_t in_stride,
                                        Coeff *out, ptrdiff_t out_stride) {
   const int add = 1 << (shift - 1);
@@ -1611,6 +1561,36 @@ ForwardTransform::FwdGenericTransformN(int shift, int lines, bool zero_out,
   }
 }
 
+InverseTransform::SimdFunc::SimdFunc() {
+  dct2[0] = &InvDct2Transform2;
+  dct2[1] = &InvDct2Transform4;
+  dct2[2] = &InvDct2Transform8;
+  dct2[3] = &InvDct2Transform16;
+  dct2[4] = &InvDct2Transform32;
+  dct2[5] = &InvDct2Transform64;
+  matrix[0] = nullptr;
+  matrix[1] = &InvGenericTransformN<4>;
+  matrix[2] = &InvGenericTransformN<8>;
+  matrix[3] = &InvGenericTransformN<16>;
+  matrix[4] = &InvGenericTransformN<32>;
+  matrix[5] = &InvGenericTransformN<64>;
+}
+
+ForwardTransform::SimdFunc::SimdFunc() {
+  dct2[0] = &FwdDct2Transform2;
+  dct2[1] = &FwdDct2Transform4;
+  dct2[2] = &FwdDct2Transform8;
+  dct2[3] = &FwdDct2Transform16;
+  dct2[4] = &FwdDct2Transform32;
+  dct2[5] = &FwdDct2Transform64;
+  matrix[0] = nullptr;
+  matrix[1] = &FwdGenericTransformN<4>;
+  matrix[2] = &FwdGenericTransformN<8>;
+  matrix[3] = &FwdGenericTransformN<16>;
+  matrix[4] = &FwdGenericTransformN<32>;
+  matrix[5] = &FwdGenericTransformN<64>;
+}
+
 ScanOrder TransformHelper::DetermineScanOrder(const CodingUnit &cu,
                                               YuvComponent comp) {
   static const int kSizeThreshold = 16;
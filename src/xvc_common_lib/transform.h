@@ -40,7 +40,8 @@ enum class ScanOrder : int {
 
 class InverseTransform : public TransformData {
 public:
-  explicit InverseTransform(int bitdepth);
+  struct SimdFunc;
+  InverseTransform(const SimdFunc &simd, int bitdepth);
   void Transform(const CodingUnit &cu, YuvComponent comp,
                  const CoeffBuffer &in_buffer, ResidualBuffer *out_buffer);
   void TransformSkip(int width, int height,
@@ -69,36 +70,37 @@ private:
   void InvDst7(int size, int shift, int lines, bool high_prec, bool zero_out,
                const Coeff *in, ptrdiff_t in_stride,
                Coeff *out, ptrdiff_t out_stride);
-  void InvDct2Transform2(int shift, int lines,
-                         bool high_prec, bool zero_out,
-                         const Coeff *in, ptrdiff_t in_stride,
-                         Coeff *out, ptrdiff_t out_stride);
-  void InvDct2Transform4(int shift, int lines,
-                         bool high_prec, bool zero_out,
-                         const Coeff *in, ptrdiff_t in_stride,
-                         Coeff *out, ptrdiff_t out_stride);
-  void InvDct2Transform8(int shift, int lines,
-                         bool high_prec, bool zero_out,
-                         const Coeff *in, ptrdiff_t in_stride,
-                         Coeff *out, ptrdiff_t out_stride);
-  void InvDct2Transform16(int shift, int lines,
-                          bool high_prec, bool zero_out,
-                          const Coeff *in, ptrdiff_t in_stride,
-                          Coeff *out, ptrdiff_t out_stride);
-  void InvDct2Transform32(int shift, int lines,
-                          bool high_prec, bool zero_out,
-                          const Coeff *in, ptrdiff_t in_stride,
-                          Coeff *out, ptrdiff_t out_stride);
-  void InvDct2Transform64(int shift, int lines,
-                          bool high_prec, bool zero_out,
-                          const Coeff *in, ptrdiff_t in_stride,
-                          Coeff *out, ptrdiff_t out_stride);
+  static void InvDct2Transform2(int shift, int lines,
+                                bool high_prec, bool zero_out,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride);
+  static void InvDct2Transform4(int shift, int lines,
+                                bool high_prec, bool zero_out,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride);
+  static void InvDct2Transform8(int shift, int lines,
+                                bool high_prec, bool zero_out,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride);
+  static void InvDct2Transform16(int shift, int lines,
+                                 bool high_prec, bool zero_out,
+                                 const Coeff *in, ptrdiff_t in_stride,
+                                 Coeff *out, ptrdiff_t out_stride);
+  static void InvDct2Transform32(int shift, int lines,
+                                 bool high_prec, bool zero_out,
+                                 const Coeff *in, ptrdiff_t in_stride,
+                                 Coeff *out, ptrdiff_t out_stride);
+  static void InvDct2Transform64(int shift, int lines,
+                                 bool high_prec, bool zero_out,
+                                 const Coeff *in, ptrdiff_t in_stride,
+                                 Coeff *out, ptrdiff_t out_stride);
   template<int N>
-  void InvGenericTransformN(int shift, int lines, bool zero_out,
-                            const Coeff(&kMatrix)[N * N],
-                            const Coeff *in, ptrdiff_t in_stride,
-                            Coeff *out, ptrdiff_t out_stride);
+  static void InvGenericTransformN(int shift, int lines, bool zero_out,
+                                   const Coeff *kMatrix,
+                                   const Coeff *in, ptrdiff_t in_stride,
+                                   Coeff *out, ptrdiff_t out_stride);
 
+  const SimdFunc &simd_;
   const Restrictions &restrictions_;
   int bitdepth_;
   std::array<Coeff, kBufferStride_ * kBufferStride_> coeff_temp_;
@@ -106,7 +108,8 @@ private:
 
 class ForwardTransform : public TransformData {
 public:
-  explicit ForwardTransform(int bitdepth);
+  struct SimdFunc;
+  ForwardTransform(const SimdFunc &simd, int bitdepth);
   void Transform(const CodingUnit &cu, YuvComponent comp,
                  const ResidualBuffer &in_buffer, CoeffBuffer *out_buffer);
   void TransformSkip(int width, int height,
@@ -132,41 +135,74 @@ private:
   void FwdPartialDst4(int shift, bool high_prec,
                       const Coeff *in, ptrdiff_t in_stride,
                       Coeff *out, ptrdiff_t out_stride);
-  void FwdDct2Transform2(int shift, int lines,
-                         bool high_prec, bool zero_out,
-                         const Coeff *in, ptrdiff_t in_stride,
-                         Coeff *out, ptrdiff_t out_stride);
-  void FwdDct2Transform4(int shift, int lines,
-                         bool high_prec, bool zero_out,
-                         const Coeff *in, ptrdiff_t in_stride,
-                         Coeff *out, ptrdiff_t out_stride);
-  void FwdDct2Transform8(int shift, int lines,
-                         bool high_prec, bool zero_out,
-                         const Coeff *in, ptrdiff_t in_stride,
-                         Coeff *out, ptrdiff_t out_stride);
-  void FwdDct2Transform16(int shift, int lines,
-                          bool high_prec, bool zero_out,
-                          const Coeff *in, ptrdiff_t in_stride,
-                          Coeff *out, ptrdiff_t out_stride);
-  void FwdDct2Transform32(int shift, int lines,
-                          bool high_prec, bool zero_out,
-                          const Coeff *in, ptrdiff_t in_stride,
-                          Coeff *out, ptrdiff_t out_stride);
-  void FwdDct2Transform64(int shift, int lines,
-                          bool high_prec, bool zero_out,
-                          const Coeff *in, ptrdiff_t in_stride,
-                          Coeff *out, ptrdiff_t out_stride);
+  static void FwdDct2Transform2(int shift, int lines,
+                                bool high_prec, bool zero_out,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride);
+  static void FwdDct2Transform4(int shift, int lines,
+                                bool high_prec, bool zero_out,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride);
+  static void FwdDct2Transform8(int shift, int lines,
+                                bool high_prec, bool zero_out,
+                                const Coeff *in, ptrdiff_t in_stride,
+                                Coeff *out, ptrdiff_t out_stride);
+  static void FwdDct2Transform16(int shift, int lines,
+                                 bool high_prec, bool zero_out,
+                                 const Coeff *in, ptrdiff_t in_stride,
+                                 Coeff *out, ptrdiff_t out_stride);
+  static void FwdDct2Transform32(int shift, int lines,
+                                 bool high_prec, bool zero_out,
+                                 const Coeff *in, ptrdiff_t in_stride,
+                                 Coeff *out, ptrdiff_t out_stride);
+  static void FwdDct2Transform64(int shift, int lines,
+                                 bool high_prec, bool zero_out,
+                                 const Coeff *in, ptrdiff_t in_stride,
+                                 Coeff *out, ptrdiff_t out_stride);
   template<int N>
-  void FwdGenericTransformN(int shift, int lines, bool zero_out,
-                            const Coeff(&kMatrix)[N * N],
-                            const Coeff *in, ptrdiff_t in_stride,
-                            Coeff *out, ptrdiff_t out_stride);
+  static void FwdGenericTransformN(int shift, int lines, bool zero_out,
+                                   const Coeff *kMatrix,
+                                   const Coeff *in, ptrdiff_t in_stride,
+                                   Coeff *out, ptrdiff_t out_stride);
 
+  const SimdFunc &simd_;
   const Restrictions &restrictions_;
   int bitdepth_;
   std::array<Coeff, kBufferStride_ * kBufferStride_> coeff_temp_;
 };
 
+struct InverseTransform::SimdFunc {
+  // Indexed by log2(size) - 1, i.e. 0: 2, 1: 4, ... 5: 64
+  static const int kSize = 6;
+
+  SimdFunc();
+  // Partial butterfly DCT-2
+  void(*dct2[kSize])(int shift, int lines, bool high_prec, bool zero_out,
+                     const Coeff *in, ptrdiff_t in_stride,
+                     Coeff *out, ptrdiff_t out_stride);
+  // Matrix multiplication for DCT-5, DCT-8, DST-1 and DST-7 (not size 2)
+  void(*matrix[kSize])(int shift, int lines, bool zero_out,
+                       const int16_t *kMatrix,
+                       const Coeff *in, ptrdiff_t in_stride,
+                       Coeff *out, ptrdiff_t out_stride);
+};
+
+struct ForwardTransform::SimdFunc {
+  // Indexed by log2(size) - 1, i.e. 0: 2, 1: 4, ... 5: 64
+  static const int kSize = 6;
+
+  SimdFunc();
+  // Partial butterfly DCT-2
+  void(*dct2[kSize])(int shift, int lines, bool high_prec, bool zero_out,
+                     const Coeff *in, ptrdiff_t in_stride,
+                     Coeff *out, ptrdiff_t out_stride);
+  // Matrix multiplication for DCT-5, DCT-8, DST-1 and DST-7 (not size 2)
+  void(*matrix[kSize])(int shift, int lines, bool zero_out,
+                       const int16_t *kMatrix,
+                       const Coeff *in, ptrdiff_t in_stride,
+                       Coeff *out, ptrdiff_t out_stride);
+};
+
 class TransformHelper {
 public:
   static const std::array<uint8_t, 128> kLastPosGroupIdx;
@@ -21,10 +21,115 @@
 
 #include "xvc_common_lib/utils.h"
 
+#include <atomic>
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>                // NOLINT
+#include <thread>               // NOLINT
+#include <vector>
+
 namespace xvc {
 
 namespace util {
 
+namespace {
+
+// The jobs of one call to RunJobs, shared with the helper threads joining in
+struct JobBatch {
+  JobBatch(int jobs, const std::function<void(int)> &job_func)
+    : num_jobs(jobs), func(job_func) {
+  }
+  // Runs jobs until all have been claimed, jobs are claimed in index order
+  void Run() {
+    int job;
+    while ((job = next_job.fetch_add(1)) < num_jobs) {
+      std::exception_ptr job_exception;
+      try {
+        func(job);
+      } catch (...) {
+        job_exception = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (job_exception && !exception) {
+        exception = job_exception;
+      }
+      if (++num_done == num_jobs) {
+        done_cond.notify_all();
+      }
+    }
+  }
+
+  const int num_jobs;
+  const std::function<void(int)> &func;
+  std::atomic<int> next_job = { 0 };
+  std::mutex mutex;
+  std::condition_variable done_cond;
+  int num_done = 0;
+  std::exception_ptr exception;
+};
+
+// Helper threads are created on demand and kept for all later calls
+class JobPool {
+public:
+  static JobPool& Get() {
+    static JobPool pool;
+    return pool;
+  }
+  ~JobPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    for (std::thread &thread : threads_) {
+      thread.join();
+    }
+  }
+  // Lets up to num_helpers threads join in on the batch
+  void Post(const std::shared_ptr<JobBatch> &batch, int num_helpers) {
+    num_helpers = std::min(num_helpers, kMaxNumThreads);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (static_cast<int>(threads_.size()) < num_helpers) {
+        threads_.emplace_back([this]() { WorkerMain(); });
+      }
+      for (int i = 0; i < num_helpers; i++) {
+        batches_.push_back(batch);
+      }
+    }
+    cond_.notify_all();
+  }
+
+private:
+  static const int kMaxNumThreads = 64;
+  void WorkerMain() {
+    while (true) {
+      std::shared_ptr<JobBatch> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this]() { return stop_ || !batches_.empty(); });
+        if (stop_) {
+          return;
+        }
+        batch = std::move(batches_.front());
+        batches_.pop_front();
+      }
+      // Does nothing if the calling thread already has claimed all jobs
+      batch->Run();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::shared_ptr<JobBatch>> batches_;
+  std::vector<std::thread> threads_;
+  bool stop_ = false;
+};
+
+}   // namespace
+
 // TODO(dev) this should really be a lookup table
 int SizeToLog2(int size) {
   int log2 = 1;
@@ -146,6 +251,27 @@ int ScaleChromaY(int size, ChromaFormat chroma_format) {
   }
 }
 
+void RunJobs(int num_jobs, int num_threads,
+             const std::function<void(int)> &func) {
+  const int num_helpers = std::min(num_threads, num_jobs) - 1;
+  if (num_helpers <= 0) {
+    for (int job = 0; job < num_jobs; job++) {
+      func(job);
+    }
+    return;
+  }
+  // The calling thread always runs jobs itself, so every claimed job is being
+  // run even if all helper threads are busy with other batches
+  std::shared_ptr<JobBatch> batch = std::make_shared<JobBatch>(num_jobs, func);
+  JobPool::Get().Post(batch, num_helpers);
+  batch->Run();
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->done_cond.wait(lock, [&]() { return batch->num_done == num_jobs; });
+  if (batch->exception) {
+    std::rethrow_exception(batch->exception);
+  }
+}
+
 }  // namespace util
 
 }  // namespace xvc
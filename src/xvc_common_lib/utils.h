@@ -24,6 +24,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 
 #include "xvc_common_lib/common.h"
 
@@ -96,6 +97,14 @@ inline int GetNumComponents(ChromaFormat chroma_fmt) {
   return chroma_fmt == ChromaFormat::kMonochrome ? 1 : 3;
 }
 
+// Calls func(job) for each job, spreading the jobs over num_threads threads.
+// The calling thread runs jobs together with up to num_threads - 1 threads
+// from a persistent pool. Jobs are started in index order, so a job may wait
+// for the progress of jobs with a lower index. The first exception thrown by
+// a job is rethrown once all jobs have finished.
+void RunJobs(int num_jobs, int num_threads,
+             const std::function<void(int)> &func);
+
 }   // namespace util
 
 }   // namespace xvc
@@ -21,6 +21,7 @@
 
 #include "xvc_common_lib/utils_md5.h"
 
+#include <algorithm>
 #include <cstring>
 
 namespace xvc {
@@ -94,6 +95,32 @@ void MD5::Update(const uint8_t *buf, uint32_t len) {
   std::memcpy(state_, buf, len);
 }
 
+void MD5::UpdateLowBytes(const uint16_t *buf, uint32_t len) {
+  uint32_t t = bits_[0];
+  if ((bits_[0] = t + (len << 3)) < t) {
+    bits_[1]++;   // Carry
+  }
+  bits_[1] += len >> 29;
+
+  // Values are narrowed directly into the 64-byte block
+  uint8_t *block = reinterpret_cast<uint8_t*>(state_);
+  t = (t >> 3) & 0x3f;
+  while (len > 0) {
+    uint32_t n = std::min(64 - t, len);
+    for (uint32_t i = 0; i < n; i++) {
+      block[t + i] = static_cast<uint8_t>(buf[i]);
+    }
+    buf += n;
+    len -= n;
+    t += n;
+    if (t == 64) {
+      ByteReverse(state_, 16);
+      MD5Transform(buf_, state_);
+      t = 0;
+    }
+  }
+}
+
 void MD5::Final(uint8_t digest[16]) {
   // Number of bytes mod 64
   uint32_t count = (bits_[0] >> 3) & 0x3F;
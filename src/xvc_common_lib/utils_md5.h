@@ -32,6 +32,8 @@ public:
   MD5();
   void Reset();
   void Update(const uint8_t *buf, uint32_t len);
+  // Same as Update with the bytes given by the low byte of each value
+  void UpdateLowBytes(const uint16_t *buf, uint32_t len);
   void Final(uint8_t digest[16]);
 
 private:
@@ -0,0 +1,88 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include "xvc_common_lib/work_scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace xvc {
+
+void WorkScheduler::Add(JobId job, const std::vector<JobId> &dependencies,
+                        int priority) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert(graph_.find(job) == graph_.end());
+  Node &node = graph_[job];
+  node.priority = priority;
+  for (JobId dependency : dependencies) {
+    auto it = graph_.find(dependency);
+    if (it != graph_.end() && dependency != job) {
+      it->second.dependents.push_back(job);
+      node.num_pending++;
+    }
+  }
+  if (node.num_pending == 0) {
+    PushReady({ job, priority });
+  }
+}
+
+WorkScheduler::JobId WorkScheduler::Take() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ready_cond_.wait(lock, [this] { return !running_ || !ready_jobs_.empty(); });
+  if (!running_) {
+    return nullptr;
+  }
+  JobId job = ready_jobs_.front().job;
+  ready_jobs_.pop_front();
+  return job;
+}
+
+void WorkScheduler::Release(JobId job) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = graph_.find(job);
+  assert(it != graph_.end());
+  for (JobId dependent : it->second.dependents) {
+    Node &node = graph_[dependent];
+    if (--node.num_pending == 0) {
+      PushReady({ dependent, node.priority });
+    }
+  }
+  graph_.erase(it);
+}
+
+void WorkScheduler::Stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  running_ = false;
+  ready_cond_.notify_all();
+}
+
+void WorkScheduler::PushReady(const ReadyJob &ready_job) {
+  // Keep queue sorted on priority, first in first out for equal priority
+  auto it = std::upper_bound(ready_jobs_.begin(), ready_jobs_.end(),
+                             ready_job.priority,
+                             [](int priority, const ReadyJob &other) {
+    return priority < other.priority;
+  });
+  ready_jobs_.insert(it, ready_job);
+  ready_cond_.notify_one();
+}
+
+}   // namespace xvc
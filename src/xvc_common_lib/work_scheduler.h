@@ -0,0 +1,77 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#ifndef XVC_COMMON_LIB_WORK_SCHEDULER_H_
+#define XVC_COMMON_LIB_WORK_SCHEDULER_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <condition_variable>   // NOLINT
+#include <deque>
+#include <mutex>                // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace xvc {
+
+// Dependency graph scheduler for picture level threading. Every job keeps a
+// count of unresolved dependencies and a list of its dependents, so resolving
+// a job only touches the jobs waiting for it. Jobs are picture sized, so all
+// workers share one ready queue under the same lock as the graph, and always
+// take the ready job with the lowest priority value.
+class WorkScheduler {
+public:
+  using JobId = const void*;
+
+  // Dependencies that are unknown or already released are seen as resolved.
+  // Ready jobs with a lower priority value are taken first, first in first
+  // out for equal priority.
+  void Add(JobId job, const std::vector<JobId> &dependencies, int priority);
+  // Blocks until a job is ready, returns nullptr when stopped
+  JobId Take();
+  // Resolves the job as a dependency, one idle worker is woken up for each
+  // dependent that became ready
+  void Release(JobId job);
+  void Stop();
+
+private:
+  struct Node {
+    int num_pending = 0;
+    int priority = 0;
+    std::vector<JobId> dependents;
+  };
+  struct ReadyJob {
+    JobId job;
+    int priority;
+  };
+  // Must be called with mutex_ held
+  void PushReady(const ReadyJob &ready_job);
+
+  std::mutex mutex_;
+  std::condition_variable ready_cond_;
+  std::unordered_map<JobId, Node> graph_;
+  // Sorted on priority
+  std::deque<ReadyJob> ready_jobs_;
+  bool running_ = true;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_COMMON_LIB_WORK_SCHEDULER_H_
@@ -21,6 +21,7 @@
 
 #include "xvc_common_lib/yuv_pic.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -116,37 +117,58 @@ void YuvPicture::CopyToSameBitdepth(std::vector<uint8_t> *out_bytes) const {
 }
 
 void YuvPicture::PadBorder() {
+  PadBorderRows(SimdFunc(), 0, height_[0]);
+}
+
+void YuvPicture::PadBorder(const SimdFunc &simd) {
+  PadBorderRows(simd, 0, height_[0]);
+}
+
+void YuvPicture::PadBorderRows(const SimdFunc &simd, int luma_y_begin,
+                               int luma_y_end) {
   if (width_[0] == 0 && height_[0] == 0) {
     return;
   }
   for (int c = 0; c < constants::kMaxYuvComponents; c++) {
     int offset_x = static_cast<int>((stride_[c] - width_[c]) >> 1);
     int offset_y = static_cast<int>((total_height_[c] - height_[c]) >> 1);
-    // Top
-    Sample *row = comp_pel_[c];
-    for (int y = -offset_y; y < 0; y++) {
-      std::memcpy(row + y * stride_[c], row, width_[c] * sizeof(Sample));
-    }
-    // Bottom
-    row += (height_[c] - 1) * stride_[c];
-    for (int y = 1; y <= offset_y; y++) {
-      std::memcpy(row + y * stride_[c], row, width_[c] * sizeof(Sample));
-    }
+    int y_begin = luma_y_begin >> shifty_[c];
+    int y_end = luma_y_end >= height_[0] ?
+      height_[c] : (luma_y_end >> shifty_[c]);
     // Left & right
-    row = comp_pel_[c] - offset_y * stride_[c];
-    for (int y = 0; y < total_height_[c]; y++) {
-      Sample left = row[0];
-      // TODO(Dev) Replace with memset for bitdepth=8
-      for (int x = -offset_x; x < 0; x++) {
-        row[x] = left;
+    Sample *row = comp_pel_[c] + y_begin * stride_[c];
+    if (y_end > y_begin) {
+      simd.pad_rows(width_[c], y_end - y_begin, offset_x, row, stride_[c]);
+    }
+    // Top (including corners)
+    const ptrdiff_t padded_width = stride_[c];
+    if (y_begin == 0) {
+      row = comp_pel_[c] - offset_x;
+      for (int y = -offset_y; y < 0; y++) {
+        std::memcpy(row + y * stride_[c], row, padded_width * sizeof(Sample));
       }
-      Sample right = row[width_[c] - 1];
-      for (int x = 0; x < offset_x; x++) {
-        row[width_[c] + x] = right;
+    }
+    // Bottom (including corners)
+    if (y_end == height_[c]) {
+      row = comp_pel_[c] + (height_[c] - 1) * stride_[c] - offset_x;
+      for (int y = 1; y <= offset_y; y++) {
+        std::memcpy(row + y * stride_[c], row, padded_width * sizeof(Sample));
       }
-      row += stride_[c];
     }
   }
 }
 
+static void PadRows_c(int width, int height, int pad, Sample *rows,
+                      ptrdiff_t stride) {
+  for (int y = 0; y < height; y++) {
+    std::fill(rows - pad, rows, rows[0]);
+    std::fill(rows + width, rows + width + pad, rows[width - 1]);
+    rows += stride;
+  }
+}
+
+YuvPicture::SimdFunc::SimdFunc()
+  : pad_rows(&PadRows_c) {
+}
+
 }   // namespace xvc
@@ -51,6 +51,8 @@ struct PictureFormat {
 
 class YuvPicture {
 public:
+  struct SimdFunc;
+
   YuvPicture(const PictureFormat &pic_fmt, bool padding,
              int crop_width, int crop_height)
     : YuvPicture(pic_fmt.chroma_format, pic_fmt.width, pic_fmt.height,
@@ -87,6 +89,11 @@ public:
   }
   void CopyToSameBitdepth(std::vector<uint8_t> *pic_bytes) const;
   void PadBorder();
+  void PadBorder(const SimdFunc &simd);
+  // Pads left and right border of luma rows [luma_y_begin, luma_y_end) and
+  // corresponding chroma rows. Top and bottom border is padded when the
+  // range includes the first and last row respectively.
+  void PadBorderRows(const SimdFunc &simd, int luma_y_begin, int luma_y_end);
 
 private:
   ChromaFormat chroma_format_;
@@ -103,6 +110,14 @@ private:
   Sample *comp_pel_[constants::kMaxYuvComponents];
 };
 
+struct YuvPicture::SimdFunc {
+  SimdFunc();
+  // Repeats the first and last sample of each row pad times to the left and
+  // right of the row
+  void(*pad_rows)(int width, int height, int pad, Sample *rows,
+                  ptrdiff_t stride);
+};
+
 }   // namespace xvc
 
 #endif  // XVC_COMMON_LIB_YUV_PIC_H_
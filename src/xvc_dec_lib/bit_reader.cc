@@ -29,67 +29,78 @@
 namespace xvc {
 
 size_t BitReader::GetPosition() const {
-  assert(bit_mask_ == 0x80);
-  return consumed_;
-}
-
-int BitReader::ReadBit() {
-  int val = buffer_[consumed_] & bit_mask_;
-  bit_mask_ >>= 1;
-  if (!bit_mask_) {
-    bit_mask_ = 0x80;
-    assert(consumed_ < length_);
-    if (consumed_ < length_) {
-      consumed_++;
-    }
-  }
-  return val ? 1 : 0;
-}
-
-uint32_t BitReader::ReadBits(int num_bits) {
-  uint32_t bits = 0;
-  while (num_bits) {
-    bits |= ReadBit() << (num_bits - 1);
-    num_bits--;
-  }
-  return bits;
+  assert(!(cache_bits_ & 7));
+  return consumed_ - (cache_bits_ >> 3);
 }
 
 void BitReader::SkipBits() {
-  if (bit_mask_ != 0x80) {
-    bit_mask_ = 0x80;
-    assert(consumed_ < length_);
-    if (consumed_ < length_) {
-      consumed_++;
-    }
-  }
-}
-
-uint8_t BitReader::ReadByte() {
-  assert(consumed_ < length_);
-  if (consumed_ >= length_) {
-    throw std::runtime_error("corrupt bitstream");
-  }
-  return buffer_[consumed_++];
+  const int num_bits = cache_bits_ & 7;
+  cache_ <<= num_bits;
+  cache_bits_ -= num_bits;
 }
 
 void BitReader::ReadBytes(uint8_t *bytes, size_t len) {
-  assert(consumed_ < length_);
+  assert(!(cache_bits_ & 7));
+  while (len > 0 && cache_bits_ > 0) {
+    *bytes++ = ReadByte();
+    len--;
+  }
   assert(consumed_ + len <= length_);
   size_t tocopy = std::min(len, length_ - consumed_);
   std::memcpy(bytes, &buffer_[consumed_], tocopy);
   consumed_ += tocopy;
 }
 
+void BitReader::SkipBytes(size_t len) {
+  const size_t position = GetPosition() + len;
+  if (position > length_) {
+    overrun_ = true;
+  }
+  consumed_ = std::min(position, length_);
+  cache_ = 0;
+  cache_bits_ = 0;
+}
+
 void BitReader::Rewind(int num_bits) {
-  while (num_bits--) {
-    bit_mask_ <<= 1;
-    if (bit_mask_ == 0x100) {
-      bit_mask_ = 0x1;
-      assert(consumed_ > 0);
-      --consumed_;
+  const size_t bit_position = consumed_ * 8 - cache_bits_;
+  assert(bit_position >= static_cast<size_t>(num_bits));
+  const size_t new_position = bit_position - num_bits;
+  consumed_ = new_position >> 3;
+  cache_ = 0;
+  cache_bits_ = 0;
+  ReadBits(static_cast<int>(new_position & 7));
+}
+
+void BitReader::Refill() {
+  if (consumed_ + sizeof(cache_) <= length_) {
+    // Load whole bytes for all free space in the cache at once
+    const uint8_t *src = buffer_ + consumed_;
+    uint64_t val = 0;
+    for (size_t i = 0; i < sizeof(val); i++) {
+      val = (val << 8) | src[i];
     }
+    const int num_bytes = (kCacheBits - cache_bits_) >> 3;
+    val &= ~static_cast<uint64_t>(0) << (kCacheBits - num_bytes * 8);
+    cache_ |= val >> cache_bits_;
+    cache_bits_ += num_bytes * 8;
+    consumed_ += num_bytes;
+    return;
+  }
+  while (cache_bits_ <= kCacheBits - 8 && consumed_ < length_) {
+    cache_ |= static_cast<uint64_t>(buffer_[consumed_++]) <<
+      (kCacheBits - 8 - cache_bits_);
+    cache_bits_ += 8;
   }
 }
 
+uint32_t BitReader::ReadBitsOverrun(int num_bits) {
+  overrun_ = true;
+  uint32_t bits = cache_bits_ == 0 ? 0 :
+    static_cast<uint32_t>(cache_ >> (kCacheBits - cache_bits_)) <<
+    (num_bits - cache_bits_);
+  cache_ = 0;
+  cache_bits_ = 0;
+  return bits;
+}
+
 }   // namespace xvc
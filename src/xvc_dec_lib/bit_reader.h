@@ -22,7 +22,9 @@
 #ifndef XVC_DEC_LIB_BIT_READER_H_
 #define XVC_DEC_LIB_BIT_READER_H_
 
+#include <cassert>
 #include <fstream>
+#include <stdexcept>
 #include <vector>
 
 #include "xvc_common_lib/common.h"
@@ -35,21 +37,62 @@ public:
     : buffer_(buffer), length_(length) {
   }
 
+  // Returns number of bytes read, only valid at byte aligned positions
   size_t GetPosition() const;
-  int ReadBit();
-  uint32_t ReadBits(int num_bits);
+  // Returns pointer to next unread byte, only valid at byte aligned positions
+  const uint8_t* GetBytePtr() const { return buffer_ + GetPosition(); }
+  size_t GetRemainingBytes() const { return length_ - GetPosition(); }
+  int ReadBit() { return static_cast<int>(ReadBits(1)); }
+  // Reads up to 32 bits, bits read past the end of the buffer are zero
+  uint32_t ReadBits(int num_bits) {
+    assert(num_bits >= 0 && num_bits <= 32);
+    if (cache_bits_ < num_bits) {
+      Refill();
+      if (cache_bits_ < num_bits) {
+        return ReadBitsOverrun(num_bits);
+      }
+    }
+    // Shifted in two steps to also be defined for zero bits
+    uint32_t bits = static_cast<uint32_t>((cache_ >> 1) >> (63 - num_bits));
+    cache_ <<= num_bits;
+    cache_bits_ -= num_bits;
+    return bits;
+  }
   void SkipBits();
-  uint8_t ReadByte();
+  // Reads one byte, only valid at byte aligned positions
+  uint8_t ReadByte() {
+    assert(!(cache_bits_ & 7));
+    if (cache_bits_ > 0) {
+      uint8_t byte = static_cast<uint8_t>(cache_ >> 56);
+      cache_ <<= 8;
+      cache_bits_ -= 8;
+      return byte;
+    }
+    assert(consumed_ < length_);
+    if (consumed_ >= length_) {
+      throw std::runtime_error("corrupt bitstream");
+    }
+    return buffer_[consumed_++];
+  }
   void ReadBytes(uint8_t *bytes, size_t len);
+  // Skips whole bytes, only valid at byte aligned positions
+  void SkipBytes(size_t len);
   void Rewind(int num_bits);
+  // True if any read has been made past the end of the buffer
+  bool IsOverrun() const { return overrun_; }
 
 private:
+  static const int kCacheBits = 64;
   void Refill();
+  uint32_t ReadBitsOverrun(int num_bits);
 
-  int bit_mask_ = 0x80;
+  // Unread bits are kept msb aligned in the cache
+  uint64_t cache_ = 0;
+  int cache_bits_ = 0;
   size_t consumed_ = 0;
   const uint8_t *buffer_ = nullptr;
   size_t length_ = 0;
+  bool overrun_ = false;
 };
 
 }   // namespace xvc
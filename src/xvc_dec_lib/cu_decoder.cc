@@ -21,6 +21,7 @@
 
 #include "xvc_dec_lib/cu_decoder.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "xvc_common_lib/restrictions.h"
@@ -30,53 +31,66 @@ namespace xvc {
 
 CuDecoder::CuDecoder(const SimdFunctions &simd, YuvPicture *decoded_pic,
                      PictureData *pic_data)
-  : min_pel_(0),
+  : bitdepth_(decoded_pic->GetBitdepth()),
+  min_pel_(0),
   max_pel_((1 << decoded_pic->GetBitdepth()) - 1),
-  decoded_pic_(*decoded_pic),
-  pic_data_(*pic_data),
+  decoded_pic_(decoded_pic),
+  pic_data_(pic_data),
   inter_pred_(simd.inter_prediction, *decoded_pic, decoded_pic->GetBitdepth()),
-  intra_pred_(decoded_pic->GetBitdepth()),
-  inv_transform_(decoded_pic->GetBitdepth()),
-  quantize_(),
+  intra_pred_(simd.intra_prediction, decoded_pic->GetBitdepth()),
+  inv_transform_(simd.inv_transform, decoded_pic->GetBitdepth()),
+  quantize_(simd.quantize),
   cu_reader_(pic_data, intra_pred_),
   temp_pred_(kBufferStride_, constants::kMaxBlockSize),
   temp_resi_(kBufferStride_, constants::kMaxBlockSize),
   temp_coeff_(kBufferStride_, constants::kMaxBlockSize) {
 }
 
-void CuDecoder::DecodeCtu(int rsaddr, SyntaxReader *reader) {
+void CuDecoder::StartPicture(YuvPicture *decoded_pic, PictureData *pic_data) {
+  assert(decoded_pic->GetBitdepth() == bitdepth_);
+  decoded_pic_ = decoded_pic;
+  pic_data_ = pic_data;
+  inter_pred_.SetRecPic(*decoded_pic);
+  cu_reader_.SetPictureData(pic_data);
+  ref_progress_ = nullptr;
+}
+
+template<typename Reader>
+void CuDecoder::DecodeCtu(int rsaddr, Reader *reader) {
   ReadCtu(rsaddr, reader);
 
-  CodingUnit *ctu = pic_data_.GetCtu(CuTree::Primary, rsaddr);
-  pic_data_.ClearMarkCuInPic(ctu);
+  CodingUnit *ctu = pic_data_->GetCtu(CuTree::Primary, rsaddr);
+  pic_data_->ClearMarkCuInPic(ctu);
   DecompressCu(ctu);
-  if (pic_data_.HasSecondaryCuTree()) {
-    CodingUnit *ctu2 = pic_data_.GetCtu(CuTree::Secondary, rsaddr);
-    pic_data_.ClearMarkCuInPic(ctu2);
+  if (pic_data_->HasSecondaryCuTree()) {
+    CodingUnit *ctu2 = pic_data_->GetCtu(CuTree::Secondary, rsaddr);
+    pic_data_->ClearMarkCuInPic(ctu2);
     DecompressCu(ctu2);
   }
 }
 
-void CuDecoder::ReadCtu(int rsaddr, SyntaxReader * reader) {
-  CodingUnit *ctu = pic_data_.GetCtu(CuTree::Primary, rsaddr);
+template<typename Reader>
+void CuDecoder::ReadCtu(int rsaddr, Reader *reader) {
+  CodingUnit *ctu = pic_data_->GetCtu(CuTree::Primary, rsaddr);
   bool read_delta_qp = cu_reader_.ReadCtu(ctu, reader);
-  if (pic_data_.HasSecondaryCuTree()) {
-    CodingUnit *ctu2 = pic_data_.GetCtu(CuTree::Secondary, rsaddr);
+  if (pic_data_->HasSecondaryCuTree()) {
+    CodingUnit *ctu2 = pic_data_->GetCtu(CuTree::Secondary, rsaddr);
     read_delta_qp |= cu_reader_.ReadCtu(ctu2, reader);
   }
-  int qp = pic_data_.GetPicQp()->GetQpRaw(YuvComponent::kY);
-  if (pic_data_.GetAdaptiveQp() > 0 && read_delta_qp) {
+  int qp = pic_data_->GetPicQp()->GetQpRaw(YuvComponent::kY);
+  if (pic_data_->GetAdaptiveQp() > 0 && read_delta_qp) {
     int predicted_qp = ctu->GetPredictedQp();
-    qp = reader->ReadQp(predicted_qp, qp, pic_data_.GetAdaptiveQp());
-  } else if (pic_data_.GetAdaptiveQp() == 2) {
+    qp = reader->ReadQp(predicted_qp, qp, pic_data_->GetAdaptiveQp());
+  } else if (pic_data_->GetAdaptiveQp() == 2) {
     qp = ctu->GetPredictedQp();
   }
   ctu->SetQp(qp);
-  if (pic_data_.HasSecondaryCuTree()) {
-    CodingUnit *ctu2 = pic_data_.GetCtu(CuTree::Secondary, rsaddr);
+  if (pic_data_->HasSecondaryCuTree()) {
+    CodingUnit *ctu2 = pic_data_->GetCtu(CuTree::Secondary, rsaddr);
     ctu2->SetQp(qp);
   }
-  if (Restrictions::Get().disable_ext_implicit_last_ctu) {
+  if (Reader::kRestricted &&
+      Restrictions::Get().disable_ext_implicit_last_ctu) {
     if (reader->ReadEndOfSlice()) {
       assert(0);
     }
@@ -92,8 +106,8 @@ void CuDecoder::DecompressCu(CodingUnit *cu) {
       }
     }
   } else {
-    pic_data_.MarkUsedInPic(cu);
-    for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
+    pic_data_->MarkUsedInPic(cu);
+    for (YuvComponent comp : pic_data_->GetComponents(cu->GetCuTree())) {
       DecompressComponent(cu, comp, cu->GetQp());
     }
   }
@@ -106,14 +120,20 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
   int width = cu->GetWidth(comp);
   int height = cu->GetHeight(comp);
   bool cbf = cu->GetCbf(comp);
-  SampleBuffer dec_buffer = decoded_pic_.GetSampleBuffer(comp, cu_x, cu_y);
+  SampleBuffer dec_buffer = decoded_pic_->GetSampleBuffer(comp, cu_x, cu_y);
   SampleBuffer &pred_buffer = cbf ? temp_pred_ : dec_buffer;
 
   // Predict
   if (cu->IsIntra()) {
     PredictIntra(*cu, comp, &pred_buffer);
   } else {
+    if (ref_progress_) {
+      WaitForRefDecoded(*cu);
+    }
     inter_pred_.CalculateMV(cu);
+    if (ref_progress_) {
+      WaitForRefReconstructed(*cu);
+    }
     inter_pred_.MotionCompensation(*cu, comp, &pred_buffer);
   }
   if (!cbf) {
@@ -122,7 +142,7 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
 
   // Dequant
   CoeffBuffer cu_coeff_buf = cu->GetCoeff(comp);
-  quantize_.Inverse(comp, qp, width, height, decoded_pic_.GetBitdepth(),
+  quantize_.Inverse(comp, qp, width, height, decoded_pic_->GetBitdepth(),
                     cu_coeff_buf.GetDataPtr(), cu_coeff_buf.GetStride(),
                     temp_coeff_.GetDataPtr(), temp_coeff_.GetStride());
 
@@ -137,13 +157,65 @@ void CuDecoder::DecompressComponent(CodingUnit *cu, YuvComponent comp,
   dec_buffer.AddClip(width, height, temp_pred_, temp_resi_, min_pel_, max_pel_);
 }
 
+void CuDecoder::WaitForRefDecoded(const CodingUnit &cu) const {
+  // Temporal mv prediction only accesses the collocated ctu row
+  const int ctu_row = cu.GetPosY(YuvComponent::kY) >> constants::kCtuSizeLog2;
+  for (const auto &ref_list_progress : *ref_progress_) {
+    for (const DecodeProgress *progress : ref_list_progress) {
+      if (progress) {
+        progress->WaitForDecodedRows(ctu_row + 1);
+      }
+    }
+  }
+}
+
+void CuDecoder::WaitForRefReconstructed(const CodingUnit &cu) const {
+  const int pic_height = decoded_pic_->GetHeight(YuvComponent::kY);
+  const int cu_bottom =
+    cu.GetPosY(YuvComponent::kY) + cu.GetHeight(YuvComponent::kY);
+  for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+    const RefPicList ref_list = static_cast<RefPicList>(i);
+    if (!cu.HasMv(ref_list)) {
+      continue;
+    }
+    const DecodeProgress *progress =
+      (*ref_progress_)[i][cu.GetRefIdx(ref_list)];
+    if (!progress) {
+      continue;
+    }
+    // Corner mvs bound the sub-block mvs for affine
+    int mv_y = cu.GetMv(ref_list, MvCorner::kUpLeft).y;
+    mv_y = std::max(mv_y, cu.GetMv(ref_list, MvCorner::kUpRight).y);
+    mv_y = std::max(mv_y, cu.GetMv(ref_list, MvCorner::kDownLeft).y);
+    mv_y = std::max(mv_y, cu.GetMv(ref_list, MvCorner::kDownRight).y);
+    const int ref_bottom = cu_bottom + kRefRowMargin +
+      ((mv_y + MotionVector::kScale - 1) >> MotionVector::kPrecisionShift);
+    int num_rows = progress->GetNumCtuRows();
+    if (ref_bottom < pic_height) {
+      const int ctu_row = std::max(0, ref_bottom) >> constants::kCtuSizeLog2;
+      num_rows = std::min(num_rows, ctu_row + 1);
+    }
+    progress->WaitForReconstructedRows(num_rows);
+  }
+}
+
 void CuDecoder::PredictIntra(const CodingUnit &cu, YuvComponent comp,
                              SampleBuffer *pred_buffer) {
   const IntraMode intra_mode = cu.GetIntraMode(comp);
   IntraPrediction::RefState ref_state;
-  intra_pred_.FillReferenceState(cu, comp, decoded_pic_, &ref_state);
-  intra_pred_.Predict(intra_mode, cu, comp, ref_state, decoded_pic_,
+  intra_pred_.FillReferenceState(cu, comp, *decoded_pic_, &ref_state);
+  intra_pred_.Predict(intra_mode, cu, comp, ref_state, *decoded_pic_,
                       pred_buffer);
 }
 
+template void
+CuDecoder::DecodeCtu(int rsaddr,
+                     SyntaxReaderCabac<ContextModelStatic, true> *reader);
+template void
+CuDecoder::DecodeCtu(int rsaddr,
+                     SyntaxReaderCabac<ContextModelDynamic, true> *reader);
+template void
+CuDecoder::DecodeCtu(int rsaddr,
+                     SyntaxReaderCabac<ContextModelDynamic, false> *reader);
+
 }   // namespace xvc
@@ -22,6 +22,7 @@
 #ifndef XVC_DEC_LIB_CU_DECODER_H_
 #define XVC_DEC_LIB_CU_DECODER_H_
 
+#include <array>
 #include <vector>
 
 #include "xvc_common_lib/sample_buffer.h"
@@ -33,28 +34,50 @@
 #include "xvc_common_lib/transform.h"
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_dec_lib/cu_reader.h"
+#include "xvc_dec_lib/decode_progress.h"
 #include "xvc_dec_lib/syntax_reader.h"
 
 namespace xvc {
 
 class CuDecoder {
 public:
+  // Decode progress of each reference picture, indexed by [ref_list][ref_idx]
+  using RefDecodeProgress =
+    std::array<std::vector<const DecodeProgress*>,
+               static_cast<int>(RefPicList::kTotalNumber)>;
+
   CuDecoder(const SimdFunctions &simd, YuvPicture *decoded_pic,
             PictureData *picture_data);
-  void DecodeCtu(int rsaddr, SyntaxReader *reader);
+  // Rebinds the decoder to a new picture of the same bitdepth, all buffers
+  // are kept so that one decoder can be reused for many pictures
+  void StartPicture(YuvPicture *decoded_pic, PictureData *pic_data);
+  int GetBitdepth() const { return bitdepth_; }
+  template<typename Reader>
+  void DecodeCtu(int rsaddr, Reader *reader);
+  // Enables waiting for reference pictures that are still being decoded
+  void SetRefDecodeProgress(const RefDecodeProgress *ref_progress) {
+    ref_progress_ = ref_progress;
+  }
 
 private:
   static const ptrdiff_t kBufferStride_ = constants::kMaxBlockSize;
-  void ReadCtu(int rsaddr, SyntaxReader *reader);
+  // Extra luma rows below the motion compensated block that must be available
+  // in the reference picture, covers interpolation filter taps and rounding
+  static const int kRefRowMargin = 8;
+  void WaitForRefDecoded(const CodingUnit &cu) const;
+  void WaitForRefReconstructed(const CodingUnit &cu) const;
+  template<typename Reader>
+  void ReadCtu(int rsaddr, Reader *reader);
   void DecompressCu(CodingUnit *cu);
   void DecompressComponent(CodingUnit *cu, YuvComponent comp, const Qp &qp);
   void PredictIntra(const CodingUnit &cu, YuvComponent comp,
                     SampleBuffer *pred_buffer);
 
+  const int bitdepth_;
   const Sample min_pel_;
   const Sample max_pel_;
-  YuvPicture &decoded_pic_;
-  PictureData &pic_data_;
+  YuvPicture *decoded_pic_;
+  PictureData *pic_data_;
   InterPrediction inter_pred_;
   IntraPrediction intra_pred_;
   InverseTransform inv_transform_;
@@ -63,6 +86,7 @@ private:
   SampleBufferStorage temp_pred_;
   ResidualBufferStorage temp_resi_;
   CoeffBufferStorage temp_coeff_;
+  const RefDecodeProgress *ref_progress_ = nullptr;
 };
 
 }   // namespace xvc
@@ -32,8 +32,16 @@ CuReader::CuReader(PictureData *pic_data, const IntraPrediction &intra_pred)
   intra_pred_(intra_pred) {
 }
 
+template<typename Reader>
+bool CuReader::ReadCtu(CodingUnit *cu, Reader *reader) {
+  ctu_has_coeffs_ = false;
+  ReadCu(cu, SplitRestriction::kNone, reader);
+  return ctu_has_coeffs_;
+}
+
+template<typename Reader>
 void CuReader::ReadCu(CodingUnit *cu, SplitRestriction split_restriction,
-                      SyntaxReader *reader) {
+                      Reader *reader) {
   SplitType split = ReadSplit(cu, split_restriction, reader);
   if (split != SplitType::kNone) {
     cu->Split(split);
@@ -54,9 +62,10 @@ void CuReader::ReadCu(CodingUnit *cu, SplitRestriction split_restriction,
   }
 }
 
+template<typename Reader>
 SplitType
 CuReader::ReadSplit(CodingUnit *cu, SplitRestriction split_restriction,
-                    SyntaxReader *reader) {
+                    Reader *reader) {
   SplitType split = SplitType::kNone;
   int binary_depth = cu->GetBinaryDepth();
   int max_depth = pic_data_->GetMaxDepth(cu->GetCuTree());
@@ -75,8 +84,9 @@ CuReader::ReadSplit(CodingUnit *cu, SplitRestriction split_restriction,
   return split;
 }
 
+template<typename Reader>
 void CuReader::ReadComponent(CodingUnit *cu, YuvComponent comp,
-                             SyntaxReader *reader) {
+                             Reader *reader) {
   if (util::IsLuma(comp)) {
     if (!pic_data_->IsIntraPic()) {
       bool skip_flag = reader->ReadSkipFlag(*cu);
@@ -93,7 +103,8 @@ void CuReader::ReadComponent(CodingUnit *cu, YuvComponent comp,
       cu->SetPredMode(PredictionMode::kIntra);
       cu->SetSkipFlag(false);
     }
-    if (restrictions_.disable_ext_implicit_partition_type) {
+    if (Reader::kRestricted &&
+        restrictions_.disable_ext_implicit_partition_type) {
       PartitionType partition_type = reader->ReadPartitionType(*cu);
       cu->SetPartitionType(partition_type);
     }
@@ -110,8 +121,9 @@ void CuReader::ReadComponent(CodingUnit *cu, YuvComponent comp,
   ReadResidualData(cu, comp, reader);
 }
 
+template<typename Reader>
 void CuReader::ReadIntraPrediction(CodingUnit *cu, YuvComponent comp,
-                                   SyntaxReader *reader) {
+                                   Reader *reader) {
   if (util::IsLuma(comp)) {
     IntraPredictorLuma mpm = intra_pred_.GetPredictorLuma(*cu);
     IntraMode intra_mode = reader->ReadIntraMode(mpm);
@@ -122,15 +134,17 @@ void CuReader::ReadIntraPrediction(CodingUnit *cu, YuvComponent comp,
     IntraPredictorChroma chroma_pred =
       intra_pred_.GetPredictorsChroma(luma_mode);
     IntraChromaMode chroma_mode = IntraChromaMode::kDmChroma;
-    if (!restrictions_.disable_intra_chroma_predictor) {
+    if (!(Reader::kRestricted &&
+          restrictions_.disable_intra_chroma_predictor)) {
       chroma_mode = reader->ReadIntraChromaMode(chroma_pred);
     }
     cu->SetIntraModeChroma(chroma_mode);
   }
 }
 
+template<typename Reader>
 void CuReader::ReadInterPrediction(CodingUnit *cu, YuvComponent comp,
-                                   SyntaxReader *reader) {
+                                   Reader *reader) {
   if (util::IsLuma(comp)) {
     bool merge = reader->ReadMergeFlag();
     cu->SetMergeFlag(merge);
@@ -179,8 +193,9 @@ void CuReader::ReadInterPrediction(CodingUnit *cu, YuvComponent comp,
   }
 }
 
+template<typename Reader>
 void CuReader::ReadMergePrediction(CodingUnit *cu, YuvComponent comp,
-                                   SyntaxReader *reader) {
+                                   Reader *reader) {
   if (cu->CanAffineMerge()) {
     cu->SetUseAffine(reader->ReadAffineFlag(*cu, true));
   }
@@ -191,8 +206,9 @@ void CuReader::ReadMergePrediction(CodingUnit *cu, YuvComponent comp,
   }
 }
 
+template<typename Reader>
 void CuReader::ReadResidualData(CodingUnit *cu, YuvComponent comp,
-                                SyntaxReader *reader) {
+                                Reader *reader) {
   bool cbf = ReadCbfInvariant(cu, comp, reader);
   CoeffBuffer cu_coeff_buf = cu->GetCoeff(comp);
   // coefficient parsing is sparse so zero out in any case
@@ -203,8 +219,9 @@ void CuReader::ReadResidualData(CodingUnit *cu, YuvComponent comp,
   }
 }
 
+template<typename Reader>
 void CuReader::ReadResidualDataInternal(CodingUnit *cu, YuvComponent comp,
-                                        SyntaxReader *reader) const {
+                                        Reader *reader) const {
   CoeffBuffer cu_coeff_buf = cu->GetCoeff(comp);
   bool use_transform_select = false;
   if (util::IsLuma(comp)) {
@@ -229,10 +246,12 @@ void CuReader::ReadResidualDataInternal(CodingUnit *cu, YuvComponent comp,
   cu->SetDcCoeffOnly(comp, num_coeff == 1 && *cu_coeff_buf.GetDataPtr());
 }
 
+template<typename Reader>
 bool CuReader::ReadCbfInvariant(CodingUnit *cu, YuvComponent comp,
-                                SyntaxReader *reader) const {
+                                Reader *reader) const {
   if (cu->IsInter() &&
-    (!cu->GetMergeFlag() || restrictions_.disable_inter_skip_mode)) {
+    (!cu->GetMergeFlag() ||
+     (Reader::kRestricted && restrictions_.disable_inter_skip_mode))) {
     if (util::IsLuma(comp)) {
       const bool root_cbf = reader->ReadRootCbf();
       cu->SetRootCbf(root_cbf);
@@ -258,13 +277,14 @@ bool CuReader::ReadCbfInvariant(CodingUnit *cu, YuvComponent comp,
     bool cbf_v = reader->ReadCbf(*cu, YuvComponent::kU);
     cu->SetCbf(YuvComponent::kU, cbf_u);
     cu->SetCbf(YuvComponent::kV, cbf_v);
-    if (cbf_u || cbf_v || restrictions_.disable_transform_root_cbf) {
+    if (cbf_u || cbf_v ||
+        (Reader::kRestricted && restrictions_.disable_transform_root_cbf)) {
       cbf = reader->ReadCbf(*cu, comp);
     } else {
       // implicitly signaled through root cbf
       cbf = true;
     }
-    if (restrictions_.disable_inter_skip_mode &&
+    if (Reader::kRestricted && restrictions_.disable_inter_skip_mode &&
         cu->GetMergeFlag() && !cbf && !cbf_u && !cbf_v) {
       cu->SetSkipFlag(true);
     }
@@ -275,6 +295,16 @@ bool CuReader::ReadCbfInvariant(CodingUnit *cu, YuvComponent comp,
   return cbf;
 }
 
+template bool
+CuReader::ReadCtu(CodingUnit *cu,
+                  SyntaxReaderCabac<ContextModelStatic, true> *reader);
+template bool
+CuReader::ReadCtu(CodingUnit *cu,
+                  SyntaxReaderCabac<ContextModelDynamic, true> *reader);
+template bool
+CuReader::ReadCtu(CodingUnit *cu,
+                  SyntaxReaderCabac<ContextModelDynamic, false> *reader);
+
 }   // namespace xvc
 
 
@@ -28,33 +28,42 @@
 
 namespace xvc {
 
+// The syntax elements are read through the concrete syntax reader type given
+// as template argument so that no virtual dispatch is needed per element.
 class CuReader {
 public:
   CuReader(PictureData *pic_data, const IntraPrediction &intra_pred);
-  bool ReadCtu(CodingUnit *cu, SyntaxReader *reader) {
-    ctu_has_coeffs_ = false;
-    ReadCu(cu, SplitRestriction::kNone, reader);
-    return ctu_has_coeffs_;
-  }
+  void SetPictureData(PictureData *pic_data) { pic_data_ = pic_data; }
+  template<typename Reader>
+  bool ReadCtu(CodingUnit *cu, Reader *reader);
 
 private:
+  template<typename Reader>
   void ReadCu(CodingUnit *cu, SplitRestriction split_restrict,
-              SyntaxReader *reader);
+              Reader *reader);
+  template<typename Reader>
   SplitType ReadSplit(CodingUnit *cu, SplitRestriction split_restriction,
-                      SyntaxReader *reader);
-  void ReadComponent(CodingUnit *cu, YuvComponent comp, SyntaxReader *reader);
+                      Reader *reader);
+  template<typename Reader>
+  void ReadComponent(CodingUnit *cu, YuvComponent comp, Reader *reader);
+  template<typename Reader>
   void ReadIntraPrediction(CodingUnit *cu, YuvComponent comp,
-                           SyntaxReader *reader);
+                           Reader *reader);
+  template<typename Reader>
   void ReadInterPrediction(CodingUnit *cu, YuvComponent comp,
-                           SyntaxReader *reader);
+                           Reader *reader);
+  template<typename Reader>
   void ReadMergePrediction(CodingUnit *cu, YuvComponent comp,
-                           SyntaxReader *reader);
+                           Reader *reader);
+  template<typename Reader>
   void ReadResidualData(CodingUnit *cu, YuvComponent comp,
-                        SyntaxReader *reader);
+                        Reader *reader);
+  template<typename Reader>
   void ReadResidualDataInternal(CodingUnit *cu, YuvComponent comp,
-                                SyntaxReader *reader) const;
+                                Reader *reader) const;
+  template<typename Reader>
   bool ReadCbfInvariant(CodingUnit *cu, YuvComponent comp,
-                        SyntaxReader *reader) const;
+                        Reader *reader) const;
 
   const Restrictions &restrictions_;
   PictureData *pic_data_;
@@ -0,0 +1,92 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#ifndef XVC_DEC_LIB_DECODE_PROGRESS_H_
+#define XVC_DEC_LIB_DECODE_PROGRESS_H_
+
+// Some C++11 headers are not allowed by cpplint
+#include <atomic>
+#include <condition_variable>   // NOLINT
+#include <mutex>                // NOLINT
+
+namespace xvc {
+
+// Ctu row progress of a picture being decoded, used for letting pictures
+// that depend on it start decoding before it is fully reconstructed.
+// Decoded rows have their coding unit data available (for tmvp) while
+// reconstructed rows have final samples (deblocked and border padded).
+class DecodeProgress {
+public:
+  void Reset(int num_ctu_rows) {
+    num_ctu_rows_ = num_ctu_rows;
+    decoded_rows_.store(0, std::memory_order_relaxed);
+    reconstructed_rows_.store(0, std::memory_order_relaxed);
+    started_.store(false, std::memory_order_relaxed);
+  }
+  void SetStarted() { started_.store(true, std::memory_order_release); }
+  bool IsStarted() const { return started_.load(std::memory_order_acquire); }
+  int GetNumCtuRows() const { return num_ctu_rows_; }
+  int GetDecodedRows() const {
+    return decoded_rows_.load(std::memory_order_acquire);
+  }
+  int GetReconstructedRows() const {
+    return reconstructed_rows_.load(std::memory_order_acquire);
+  }
+  void SetDecodedRows(int num_rows) {
+    Publish(&decoded_rows_, num_rows);
+  }
+  void SetReconstructedRows(int num_rows) {
+    Publish(&reconstructed_rows_, num_rows);
+  }
+  void WaitForDecodedRows(int num_rows) const {
+    Wait(decoded_rows_, num_rows);
+  }
+  void WaitForReconstructedRows(int num_rows) const {
+    Wait(reconstructed_rows_, num_rows);
+  }
+
+private:
+  void Publish(std::atomic<int> *counter, int num_rows) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counter->store(num_rows, std::memory_order_release);
+    cond_.notify_all();
+  }
+  void Wait(const std::atomic<int> &counter, int num_rows) const {
+    if (counter.load(std::memory_order_acquire) >= num_rows) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [&counter, num_rows] {
+      return counter.load(std::memory_order_acquire) >= num_rows;
+    });
+  }
+
+  int num_ctu_rows_ = 0;
+  std::atomic<int> decoded_rows_ = { 0 };
+  std::atomic<int> reconstructed_rows_ = { 0 };
+  std::atomic<bool> started_ = { false };
+  mutable std::mutex mutex_;
+  mutable std::condition_variable cond_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_DEC_LIB_DECODE_PROGRESS_H_
@@ -21,13 +21,18 @@
 
 #include "xvc_dec_lib/decoder.h"
 
+#include <algorithm>
 #include <cassert>
 #include <limits>
+#include <mutex>    // NOLINT
+#include <thread>   // NOLINT
+#include <unordered_set>
 
 #include "xvc_common_lib/reference_list_sorter.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/utils.h"
+#include "xvc_dec_lib/cu_decoder.h"
 #include "xvc_dec_lib/segment_header_reader.h"
 #include "xvc_dec_lib/thread_decoder.h"
 
@@ -35,6 +40,22 @@ namespace xvc {
 
 constexpr size_t Decoder::kInvalidNal;
 
+namespace {
+
+// Picture references may outlive the decoder that returned them, so the
+// outstanding references are tracked for all decoder instances
+struct PictureRefRegistry {
+  std::mutex mutex;
+  std::unordered_set<const xvc_decoded_picture*> pictures;
+};
+
+PictureRefRegistry& GetPictureRefRegistry() {
+  static PictureRefRegistry registry;
+  return registry;
+}
+
+}   // namespace
+
 Decoder::Decoder(int num_threads)
   : curr_segment_header_(std::make_shared<SegmentHeader>()),
   prev_segment_header_(std::make_shared<SegmentHeader>()),
@@ -42,6 +63,8 @@ Decoder::Decoder(int num_threads)
   if (num_threads != 0) {
     thread_decoder_ =
       std::unique_ptr<ThreadDecoder>(new ThreadDecoder(num_threads));
+    slice_threads_ = num_threads > 0 ? num_threads :
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
   }
 }
 
@@ -53,8 +76,13 @@ Decoder::~Decoder() {
 
 size_t Decoder::DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
                           int64_t user_data) {
+  NalUnit nal(nal_unit, nal_unit_size);
+  return DecodeNal(&nal, user_data);
+}
+
+size_t Decoder::DecodeNal(NalUnit *nal_unit, int64_t user_data) {
   // Nal header parsing
-  BitReader bit_reader(nal_unit, nal_unit_size);
+  BitReader bit_reader(nal_unit->GetData(), nal_unit->GetSize());
   NalUnitType nal_unit_type;
   if (!ParseNalUnitHeader(&bit_reader, &nal_unit_type, accept_xvc_bit_zero_)) {
     return kInvalidNal;
@@ -76,7 +104,7 @@ size_t Decoder::DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
   }
   if (nal_unit_type >= NalUnitType::kIntraPicture &&
       nal_unit_type <= NalUnitType::kReservedPictureType10) {
-    return DecodePictureNal(nal_unit, nal_unit_size, user_data, &bit_reader);
+    return DecodePictureNal(nal_unit, user_data, &bit_reader);
   }
   return kInvalidNal;   // unknown nal type
 }
@@ -179,8 +207,9 @@ size_t Decoder::DecodeSegmentHeaderNal(BitReader *bit_reader) {
   return bit_reader->GetPosition();
 }
 
-size_t Decoder::DecodePictureNal(const uint8_t * nal_unit, size_t nal_unit_size,
-                                 int64_t user_data, BitReader *bit_reader) {
+size_t Decoder::DecodePictureNal(NalUnit *nal_unit, int64_t user_data,
+                                 BitReader *bit_reader) {
+  const size_t nal_unit_size = nal_unit->GetSize();
   // All picture types are decoded using the same process.
   // First, the buffer flag is checked to see if the picture
   // should be decoded or buffered.
@@ -203,12 +232,12 @@ size_t Decoder::DecodePictureNal(const uint8_t * nal_unit, size_t nal_unit_size,
   enforce_sliding_window_ = true;
   num_pics_in_buffer_++;
 
-  NalUnitPtr nal_element(new std::vector<uint8_t>(&nal_unit[0], &nal_unit[0]
-                                                  + nal_unit_size));
+  // Only copied if the application does not keep the nal unit alive
+  nal_unit->Retain();
   if (buffer_flag == 0 && num_tail_pics_ > 0) {
-    nal_buffer_.push_front({ std::move(nal_element), user_data });
+    nal_buffer_.emplace_front(std::move(*nal_unit), user_data);
   } else {
-    nal_buffer_.push_back({ std::move(nal_element), user_data });
+    nal_buffer_.emplace_back(std::move(*nal_unit), user_data);
   }
   if (state_ == State::kSegmentHeaderDecoded) {
     state_ = State::kPicDecoded;
@@ -227,8 +256,8 @@ size_t Decoder::DecodePictureNal(const uint8_t * nal_unit, size_t nal_unit_size,
 }
 
 void
-Decoder::DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data) {
-  BitReader pic_bit_reader(&(*nal)[0], nal->size());
+Decoder::DecodeOneBufferedNal(NalUnit &&nal, int64_t user_data) {
+  BitReader pic_bit_reader(nal.GetData(), nal.GetSize());
   std::shared_ptr<SegmentHeader> segment_header = curr_segment_header_;
   std::shared_ptr<SegmentHeader> prev_segment_header = prev_segment_header_;
 
@@ -295,7 +324,7 @@ Decoder::DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data) {
 
   // Setup poc and output status on main thread
   pic_dec->Init(*segment_header, pic_header, std::move(ref_pic_list),
-                output_pic_format_, user_data);
+                output_pic_format_, packed_output_, user_data);
 
   // Special handling of inter dependency ref counting for lowest layer
   if (pic_header.tid == 0) {
@@ -324,7 +353,8 @@ Decoder::DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data) {
   } else {
     // Synchronous decode
     bool success = pic_dec->Decode(*segment_header, *prev_segment_header,
-                                   &pic_bit_reader, true);
+                                   &pic_bit_reader, true, nullptr,
+                                   &cu_decoder_);
     OnPictureDecoded(pic_dec, success, inter_dependencies);
   }
 }
@@ -362,16 +392,77 @@ void Decoder::FlushBufferedNalUnits() {
 }
 
 bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
-  // Prevent outputing pictures if non are available
-  // otherwise reference pictures might be corrupted
-  if (!HasPictureReadyForOutput()) {
-    output_pic->size = 0;
-    output_pic->bytes = nullptr;
-    for (int c = 0; c < constants::kMaxYuvComponents; c++) {
+  SetPackedOutput(true);
+  std::shared_ptr<PictureDecoder> pic_dec = GetNextOutputPicture();
+  if (!pic_dec) {
+    SetOutputBytes(std::vector<uint8_t>(), output_pic);
+    return false;
+  }
+  SetOutputStats(pic_dec, output_pic);
+  // TODO(PH) Potential dangerous race-condition, the output_pic->bytes will
+  // be modified concurrently when pic_dec is assigned a new nal to decode,
+  // so we don't do that until next call to 'decoder_decode_nal'
+  SetOutputBytes(*pic_dec->GetOutputPictureBytes(), output_pic);
+  return true;
+}
+
+xvc_decoded_picture* Decoder::GetDecodedPictureRef() {
+  SetPackedOutput(false);
+  std::shared_ptr<PictureDecoder> pic_dec = GetNextOutputPicture();
+  if (!pic_dec) {
+    return nullptr;
+  }
+  OutputPictureRef *output_pic = new OutputPictureRef();
+  {
+    PictureRefRegistry &registry = GetPictureRefRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.pictures.insert(output_pic);
+  }
+  SetOutputStats(pic_dec, output_pic);
+  if (!pic_dec->HasDirectOutput()) {
+    output_pic->pic_bytes = pic_dec->GetOutputPictureBytes();
+    SetOutputBytes(*output_pic->pic_bytes, output_pic);
+    return output_pic;
+  }
+  // Expose the planes of the reconstructed picture without any copy
+  std::shared_ptr<const YuvPicture> rec_pic = pic_dec->GetRecPic();
+  output_pic->rec_pic = rec_pic;
+  output_pic->bytes = nullptr;
+  output_pic->size = 0;
+  const int num_components =
+    util::GetNumComponents(output_pic_format_.chroma_format);
+  for (int c = 0; c < constants::kMaxYuvComponents; c++) {
+    const YuvComponent comp = YuvComponent(c);
+    if (c < num_components) {
+      output_pic->planes[c] =
+        reinterpret_cast<const char *>(rec_pic->GetSamplePtr(comp, 0, 0));
+      output_pic->stride[c] =
+        static_cast<int>(rec_pic->GetStride(comp) * sizeof(Sample));
+    } else {
       output_pic->planes[c] = nullptr;
       output_pic->stride[c] = 0;
     }
-    return false;
+  }
+  return output_pic;
+}
+
+bool Decoder::ReleasePicture(xvc_decoded_picture *dec_pic) {
+  PictureRefRegistry &registry = GetPictureRefRegistry();
+  {
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (!registry.pictures.erase(dec_pic)) {
+      return false;
+    }
+  }
+  delete static_cast<OutputPictureRef*>(dec_pic);
+  return true;
+}
+
+std::shared_ptr<PictureDecoder> Decoder::GetNextOutputPicture() {
+  // Prevent outputing pictures if non are available
+  // otherwise reference pictures might be corrupted
+  if (!HasPictureReadyForOutput()) {
+    return nullptr;
   }
 
   // Find the picture with lowest poc that has not been output.
@@ -386,13 +477,7 @@ bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
     }
   }
   if (!pic_dec) {
-    output_pic->size = 0;
-    output_pic->bytes = nullptr;
-    for (int c = 0; c < constants::kMaxYuvComponents; c++) {
-      output_pic->planes[c] = nullptr;
-      output_pic->stride[c] = 0;
-    }
-    return false;
+    return nullptr;
   }
 
   // Wait for picture to finish decoding
@@ -405,40 +490,22 @@ bool Decoder::GetDecodedPicture(xvc_decoded_picture *output_pic) {
   }
 
   pic_dec->SetOutputStatus(OutputStatus::kHasBeenOutput);
-  SetOutputStats(pic_dec, output_pic);
-  const int sample_size = output_pic_format_.bitdepth == 8 ? 1 : 2;
-  // TODO(PH) Potential dangerous race-condition, the output_pic->bytes will
-  // be modified concurrently when pic_dec is assigned a new nal to decode,
-  // so we don't do that until next call to 'decoder_decode_nal'
-  const std::vector<uint8_t> &output_pic_bytes =
-    pic_dec->GetOutputPictureBytes();
-  output_pic->size = output_pic_bytes.size();
-  output_pic->bytes = output_pic_bytes.empty() ? nullptr :
-    reinterpret_cast<const char *>(&output_pic_bytes[0]);
-  output_pic->planes[0] = output_pic->bytes;
-  output_pic->stride[0] = output_pic_format_.width * sample_size;
-  output_pic->planes[1] =
-    output_pic->planes[0] + output_pic->stride[0] * output_pic_format_.height;
-  output_pic->stride[1] =
-    util::ScaleChromaX(output_pic_format_.width,
-                       output_pic_format_.chroma_format) * sample_size;
-  output_pic->planes[2] = output_pic->planes[1] + output_pic->stride[1] *
-    util::ScaleChromaY(output_pic_format_.height,
-                       output_pic_format_.chroma_format);
-  output_pic->stride[2] = output_pic->stride[1];
-
   // Decrease counter for how many decoded pictures are buffered.
   num_pics_in_buffer_--;
-  return true;
+  return pic_dec;
 }
 
 std::shared_ptr<PictureDecoder>
 Decoder::GetFreePictureDecoder(const SegmentHeader &segment) {
+  // Picture components are hashed in parallel when decoding with threads
+  const int checksum_threads =
+    thread_decoder_ ? util::GetNumComponents(segment.chroma_format) : 1;
   if (pic_decoders_.size() < pic_buffering_num_) {
     auto pic =
       std::make_shared<PictureDecoder>(simd_, segment.GetInternalPicFormat(),
                                        segment.GetCropWidth(),
-                                       segment.GetCropHeight());
+                                       segment.GetCropHeight(),
+                                       checksum_threads, slice_threads_);
     pic_decoders_.push_back(pic);
     return pic;
   }
@@ -472,7 +539,8 @@ Decoder::GetFreePictureDecoder(const SegmentHeader &segment) {
       segment.internal_bitdepth != pic_data->GetBitdepth()) {
     pic_dec_it->reset(new PictureDecoder(simd_, segment.GetInternalPicFormat(),
                                          segment.GetCropWidth(),
-                                         segment.GetCropHeight()));
+                                         segment.GetCropHeight(),
+                                         checksum_threads, slice_threads_));
   }
   return *pic_dec_it;
 }
@@ -494,11 +562,39 @@ void Decoder::OnPictureDecoded(std::shared_ptr<PictureDecoder> pic_dec,
   }
 }
 
+void Decoder::SetOutputBytes(const std::vector<uint8_t> &output_pic_bytes,
+                             xvc_decoded_picture *output_pic) {
+  if (output_pic_bytes.empty()) {
+    output_pic->size = 0;
+    output_pic->bytes = nullptr;
+    for (int c = 0; c < constants::kMaxYuvComponents; c++) {
+      output_pic->planes[c] = nullptr;
+      output_pic->stride[c] = 0;
+    }
+    return;
+  }
+  const int sample_size = output_pic_format_.bitdepth == 8 ? 1 : 2;
+  output_pic->size = output_pic_bytes.size();
+  output_pic->bytes = reinterpret_cast<const char *>(&output_pic_bytes[0]);
+  output_pic->planes[0] = output_pic->bytes;
+  output_pic->stride[0] = output_pic_format_.width * sample_size;
+  output_pic->planes[1] =
+    output_pic->planes[0] + output_pic->stride[0] * output_pic_format_.height;
+  output_pic->stride[1] =
+    util::ScaleChromaX(output_pic_format_.width,
+                       output_pic_format_.chroma_format) * sample_size;
+  output_pic->planes[2] = output_pic->planes[1] + output_pic->stride[1] *
+    util::ScaleChromaY(output_pic_format_.height,
+                       output_pic_format_.chroma_format);
+  output_pic->stride[2] = output_pic->stride[1];
+}
+
 void Decoder::SetOutputStats(std::shared_ptr<PictureDecoder> pic_dec,
                              xvc_decoded_picture *output_pic) {
   const int poc_offset = (curr_segment_header_->leading_pictures != 0 ? -1 : 0);
   auto pic_data = pic_dec->GetPicData();
   output_pic->user_data = pic_dec->GetNalUserData();
+  last_output_threads_ = pic_dec->GetNumOutputThreads();
   output_pic->stats.width = output_pic_format_.width;
   output_pic->stats.height = output_pic_format_.height;
   output_pic->stats.bitdepth = output_pic_format_.bitdepth;
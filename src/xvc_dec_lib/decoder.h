@@ -34,6 +34,7 @@
 #include "xvc_common_lib/segment_header.h"
 #include "xvc_common_lib/simd_functions.h"
 #include "xvc_dec_lib/bit_reader.h"
+#include "xvc_dec_lib/nal_unit.h"
 #include "xvc_dec_lib/picture_decoder.h"
 #include "xvc_dec_lib/xvcdec.h"
 
@@ -61,7 +62,13 @@ public:
   ~Decoder();
   size_t DecodeNal(const uint8_t *nal_unit, size_t nal_unit_size,
                    int64_t user_data = 0);
+  // Picture nal units are moved from nal_unit when buffered for decoding
+  size_t DecodeNal(NalUnit *nal_unit, int64_t user_data);
   bool GetDecodedPicture(xvc_decoded_picture *dec_pic);
+  // Returns a picture that stays valid until released by ReleasePicture
+  xvc_decoded_picture* GetDecodedPictureRef();
+  // Returns false if the picture is not an outstanding picture reference
+  static bool ReleasePicture(xvc_decoded_picture *dec_pic);
   void FlushBufferedNalUnits();
   PicNum GetNumDecodedPics() { return num_pics_in_buffer_; }
   PicNum HasPictureReadyForOutput() {
@@ -69,6 +76,8 @@ public:
       num_pics_in_buffer_ >= sliding_window_length_;
   }
   PicNum GetNumCorruptedPics() { return num_corrupted_pics_; }
+  // Number of threads used for converting the last output picture
+  int GetLastOutputThreads() const { return last_output_threads_; }
   void SetCpuCapabilities(std::set<CpuCapability> capabilities) {
     simd_ = SimdFunctions(capabilities);
   }
@@ -96,19 +105,32 @@ public:
                                  bool accept_xvc_bit_zero);
 
 private:
-  using NalUnitPtr = std::unique_ptr<std::vector<uint8_t>>;
   using PicDecList = std::vector<std::shared_ptr<const PictureDecoder>>;
+  // Keeps the sample data of an output picture alive until released
+  struct OutputPictureRef : xvc_decoded_picture {
+    std::shared_ptr<const YuvPicture> rec_pic;
+    std::shared_ptr<const std::vector<uint8_t>> pic_bytes;
+  };
+  void SetPackedOutput(bool packed_output) {
+    if (!packed_output_decided_) {
+      packed_output_ = packed_output;
+      packed_output_decided_ = true;
+    }
+  }
   void DecodeAllBufferedNals();
   size_t DecodeSegmentHeaderNal(BitReader *bit_reader);
-  size_t DecodePictureNal(const uint8_t *nal_unit, size_t nal_unit_size,
-                          int64_t user_data, BitReader *bit_reader);
-  void DecodeOneBufferedNal(NalUnitPtr &&nal, int64_t user_data);
+  size_t DecodePictureNal(NalUnit *nal_unit, int64_t user_data,
+                          BitReader *bit_reader);
+  void DecodeOneBufferedNal(NalUnit &&nal, int64_t user_data);
   std::shared_ptr<PictureDecoder>
     GetFreePictureDecoder(const SegmentHeader &segment_header);
   void OnPictureDecoded(std::shared_ptr<PictureDecoder> pic_dec, bool success,
                         const PicDecList &inter_deps);
+  std::shared_ptr<PictureDecoder> GetNextOutputPicture();
   void SetOutputStats(std::shared_ptr<PictureDecoder> pic_dec,
                       xvc_decoded_picture *output_pic);
+  void SetOutputBytes(const std::vector<uint8_t> &output_pic_bytes,
+                      xvc_decoded_picture *output_pic);
 
   PicNum sub_gop_end_poc_ = 0;
   PicNum sub_gop_start_poc_ = 0;
@@ -126,14 +148,25 @@ private:
   int decoder_ticks_ = 0;
   int max_tid_ = 0;
   bool enforce_sliding_window_ = true;
+  // Convert output pictures in the decoding threads unless the application
+  // fetches pictures by reference, which may avoid the conversion entirely.
+  // Decided by the first picture fetched and then kept for the decoder
+  // instance, so it never changes for pictures that are already decoding.
+  bool packed_output_ = true;
+  bool packed_output_decided_ = false;
   State state_ = State::kNoSegmentHeader;
   SimdFunctions simd_;
   PictureFormat output_pic_format_;
   std::vector<uint8_t> output_pic_bytes_;
   std::vector<std::shared_ptr<PictureDecoder>> pic_decoders_;
   std::list<std::shared_ptr<PictureDecoder>> zero_tid_pic_dec_;
-  std::deque<std::pair<NalUnitPtr, int64_t>> nal_buffer_;
+  std::deque<std::pair<NalUnit, int64_t>> nal_buffer_;
   std::unique_ptr<ThreadDecoder> thread_decoder_;
+  // Reused for all pictures when decoding without threads
+  std::unique_ptr<CuDecoder> cu_decoder_;
+  // Number of threads for decoding slices of a single picture in parallel
+  int slice_threads_ = 1;
+  int last_output_threads_ = 1;
   bool accept_xvc_bit_zero_ = true;
 };
 
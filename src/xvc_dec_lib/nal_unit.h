@@ -0,0 +1,102 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#ifndef XVC_DEC_LIB_NAL_UNIT_H_
+#define XVC_DEC_LIB_NAL_UNIT_H_
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "xvc_dec_lib/xvcdec.h"
+
+namespace xvc {
+
+// Nal unit data given to the decoder. Unless a release callback is given
+// the data is only valid during the DecodeNal call and must be retained
+// (copied) before being kept. With a release callback the data is read in
+// place and the callback is invoked when the nal unit is destroyed.
+class NalUnit {
+public:
+  NalUnit(const uint8_t *nal_unit, size_t nal_unit_size,
+          xvc_dec_nal_release_callback release = nullptr,
+          void *opaque = nullptr)
+    : buffer_(nal_unit),
+    data_(nal_unit),
+    size_(nal_unit_size),
+    release_(release),
+    opaque_(opaque) {
+  }
+  NalUnit(NalUnit &&other) { *this = std::move(other); }
+  NalUnit& operator=(NalUnit &&other) {
+    Release();
+    copy_ = std::move(other.copy_);
+    buffer_ = other.buffer_;
+    data_ = other.data_;
+    size_ = other.size_;
+    release_ = other.release_;
+    opaque_ = other.opaque_;
+    other.buffer_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.release_ = nullptr;
+    return *this;
+  }
+  NalUnit(const NalUnit&) = delete;
+  NalUnit& operator=(const NalUnit&) = delete;
+  ~NalUnit() { Release(); }
+
+  const uint8_t* GetData() const { return data_; }
+  size_t GetSize() const { return size_; }
+  // Removes the first num_bytes of the nal unit
+  void Skip(size_t num_bytes) {
+    assert(num_bytes <= size_);
+    data_ += num_bytes;
+    size_ -= num_bytes;
+  }
+  // Makes sure the data stays valid after returning from DecodeNal
+  void Retain() {
+    if (!release_ && copy_.empty() && size_ > 0) {
+      copy_.assign(data_, data_ + size_);
+      data_ = &copy_[0];
+    }
+  }
+
+private:
+  void Release() {
+    if (release_) {
+      release_(opaque_, buffer_);
+      release_ = nullptr;
+    }
+  }
+
+  std::vector<uint8_t> copy_;
+  const uint8_t *buffer_ = nullptr;
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  xvc_dec_nal_release_callback release_ = nullptr;
+  void *opaque_ = nullptr;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_DEC_LIB_NAL_UNIT_H_
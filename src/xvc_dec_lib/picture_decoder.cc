@@ -21,9 +21,14 @@
 
 #include "xvc_dec_lib/picture_decoder.h"
 
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>   // NOLINT
 #include <cstring>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>                // NOLINT
 #include <utility>
 
 #include "xvc_common_lib/deblocking_filter.h"
@@ -31,22 +36,62 @@
 #include "xvc_common_lib/resample.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/utils.h"
 #include "xvc_dec_lib/cu_decoder.h"
 #include "xvc_dec_lib/entropy_decoder.h"
 
 namespace xvc {
 
+typedef void(*DecodeCtuRowFunc)(CuDecoder *cu_decoder, SyntaxReader *reader,
+                                int rsaddr, int num_ctus);
+typedef DecodeCtuRowFunc(*CreateSyntaxReaderFunc)(
+  const Qp &qp, PicturePredictionType pic_type, BitReader *bit_reader,
+  std::unique_ptr<SyntaxReader> *syntax_reader);
+
+// Ctus are decoded through the concrete syntax reader type so that parsing
+// of all syntax elements is resolved at compile time
+template<typename Reader>
+static void DecodeCtuRow(CuDecoder *cu_decoder, SyntaxReader *reader,
+                         int rsaddr, int num_ctus) {
+  Reader *cabac_reader = static_cast<Reader*>(reader);
+  for (int i = 0; i < num_ctus; i++) {
+    cu_decoder->DecodeCtu(rsaddr + i, cabac_reader);
+  }
+}
+
+template<typename Reader>
+static DecodeCtuRowFunc
+CreateSyntaxReader(const Qp &qp, PicturePredictionType pic_type,
+                   BitReader *bit_reader,
+                   std::unique_ptr<SyntaxReader> *syntax_reader) {
+  syntax_reader->reset(new Reader(qp, pic_type, bit_reader));
+  return &DecodeCtuRow<Reader>;
+}
+
+// Output conversion runs on the slice threads, but there is no point in more
+// conversion jobs than ctu rows
+static int CapOutputThreads(int slice_threads, int height) {
+  const int num_ctu_rows =
+    (height + constants::kCtuSize - 1) >> constants::kCtuSizeLog2;
+  return std::max(1, std::min(slice_threads, num_ctu_rows));
+}
+
 PictureDecoder::PictureDecoder(const SimdFunctions &simd,
                                const PictureFormat &pic_fmt,
-                               int crop_width, int crop_height)
+                               int crop_width, int crop_height,
+                               int checksum_threads, int slice_threads)
   : simd_(simd),
+  checksum_threads_(checksum_threads),
+  slice_threads_(slice_threads),
+  output_threads_(CapOutputThreads(slice_threads, pic_fmt.height)),
   output_resampler_(simd.resampler),
   output_format_(),
   pic_data_(std::make_shared<PictureData>(pic_fmt.chroma_format, pic_fmt.width,
                                           pic_fmt.height, pic_fmt.bitdepth)),
   rec_pic_(std::make_shared<YuvPicture>(pic_fmt.chroma_format, pic_fmt.width,
                                         pic_fmt.height, pic_fmt.bitdepth, true,
-                                        crop_width, crop_height)) {
+                                        crop_width, crop_height)),
+  output_pic_bytes_(std::make_shared<std::vector<uint8_t>>()) {
 }
 
 PictureDecoder::PicNalHeader
@@ -144,12 +189,28 @@ void PictureDecoder::Init(const SegmentHeader &segment,
                           const PicNalHeader &header,
                           ReferencePictureLists &&ref_pic_list,
                           const PictureFormat &output_pic_format,
-                          int64_t user_data) {
+                          bool packed_output, int64_t user_data) {
   assert(output_status_ == OutputStatus::kHasBeenOutput);
   pic_qp_ = header.pic_qp;
   output_format_ = output_pic_format;
+  packed_output_ = packed_output;
   user_data_ = user_data;
   output_status_ = OutputStatus::kProcessing;
+  output_pic_converted_ = false;
+  // The application may still hold a previous picture from this decoder
+  if (!rec_pic_.unique()) {
+    rec_pic_ =
+      std::make_shared<YuvPicture>(rec_pic_->GetChromaFormat(),
+                                   rec_pic_->GetWidth(YuvComponent::kY),
+                                   rec_pic_->GetHeight(YuvComponent::kY),
+                                   rec_pic_->GetBitdepth(), true,
+                                   rec_pic_->GetCropWidth(),
+                                   rec_pic_->GetCropHeight());
+  }
+  if (!output_pic_bytes_.unique()) {
+    output_pic_bytes_ = std::make_shared<std::vector<uint8_t>>();
+  }
+  decode_progress_.Reset(pic_data_->GetNumCtuY());
   ref_count = 0;
   pic_data_->SetNalType(header.nal_unit_type);
   pic_data_->SetSoc(header.soc);
@@ -166,43 +227,237 @@ void PictureDecoder::Init(const SegmentHeader &segment,
   *pic_data_->GetRefPicLists() = std::move(ref_pic_list);
 }
 
+CuDecoder*
+PictureDecoder::BindCuDecoder(std::unique_ptr<CuDecoder> *cu_decoder) {
+  // The bitdepth may change between segments
+  if (*cu_decoder &&
+      (*cu_decoder)->GetBitdepth() == rec_pic_->GetBitdepth()) {
+    (*cu_decoder)->StartPicture(rec_pic_.get(), pic_data_.get());
+  } else {
+    cu_decoder->reset(new CuDecoder(simd_, rec_pic_.get(), pic_data_.get()));
+  }
+  return cu_decoder->get();
+}
+
 bool PictureDecoder::Decode(const SegmentHeader &segment,
                             const SegmentHeader &prev_segment_header,
-                            BitReader *bit_reader, bool post_process) {
+                            BitReader *bit_reader, bool post_process,
+                            const std::vector<std::shared_ptr<
+                            const PictureDecoder>> *inter_dependencies,
+                            std::unique_ptr<CuDecoder> *cached_cu_decoder) {
   assert(output_status_ == OutputStatus::kProcessing);
   bool success = true;
   double lambda = 0;
   Qp qp(pic_qp_, pic_data_->GetChromaFormat(), pic_data_->GetBitdepth(),
         lambda);
 
+  const int num_ctu_x = pic_data_->GetNumCtuX();
+  const int num_ctu_rows = pic_data_->GetNumCtuY();
+  const int num_slices = pic_data_->GetNumSlices(segment);
+  const int slice_threads = std::min(slice_threads_, num_slices);
+  // Slices decoded in parallel can be at any ctu rows
+  pic_data_->SetMaxParallelCtuRows(slice_threads > 1 ? num_ctu_rows : 1);
   pic_data_->Init(segment, qp, true);
+  assert(pic_data_->GetNumSlices() == num_slices);
 
-  std::unique_ptr<SyntaxReader> syntax_reader =
-    SyntaxReader::Create(qp, pic_data_->GetPredictionType(), bit_reader);
-  std::unique_ptr<CuDecoder> cu_decoder(
-    new CuDecoder(simd_, rec_pic_.get(), pic_data_.get()));
-  int num_ctus = pic_data_->GetNumberOfCtu();
-  for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
-    cu_decoder->DecodeCtu(rsaddr, syntax_reader.get());
+  CreateSyntaxReaderFunc create_syntax_reader;
+  const Restrictions &restrictions = Restrictions::Get();
+  if (restrictions.disable_cabac_ctx_update) {
+    create_syntax_reader =
+      &CreateSyntaxReader<SyntaxReaderCabac<ContextModelStatic, true>>;
+  } else if (restrictions.GetAnyRestrictions()) {
+    create_syntax_reader =
+      &CreateSyntaxReader<SyntaxReaderCabac<ContextModelDynamic, true>>;
+  } else {
+    create_syntax_reader =
+      &CreateSyntaxReader<SyntaxReaderCabac<ContextModelDynamic, false>>;
   }
-  if (pic_data_->GetDeblock()) {
-    DeblockingFilter deblocker(pic_data_.get(), rec_pic_.get(),
-                               pic_data_->GetBetaOffset(),
-                               pic_data_->GetTcOffset());
-    deblocker.DeblockPicture();
+
+  // Each slice has its own bitstream, the entry points give the size of all
+  // slices but the last one which is read from the picture bitstream
+  std::vector<BitReader> slice_readers;
+  if (num_slices > 1) {
+    const int entry_point_bits =
+      bit_reader->ReadBits(constants::kEntryPointBitsBits) + 1;
+    std::vector<size_t> slice_sizes(num_slices - 1);
+    for (size_t &slice_size : slice_sizes) {
+      slice_size = bit_reader->ReadBits(entry_point_bits);
+    }
+    bit_reader->SkipBits();
+    slice_readers.reserve(num_slices - 1);
+    for (size_t slice_size : slice_sizes) {
+      const size_t length =
+        std::min(slice_size, bit_reader->GetRemainingBytes());
+      slice_readers.emplace_back(bit_reader->GetBytePtr(), length);
+      bit_reader->SkipBytes(slice_size);
+    }
   }
-  if (!syntax_reader->Finish()) {
-    assert(0);
-    success = false;
+
+  CuDecoder::RefDecodeProgress ref_progress;
+  if (inter_dependencies) {
+    const ReferencePictureLists *ref_pic_lists = pic_data_->GetRefPicLists();
+    for (int i = 0; i < static_cast<int>(RefPicList::kTotalNumber); i++) {
+      const RefPicList ref_list = static_cast<RefPicList>(i);
+      const int num_ref_pics = ref_pic_lists->GetNumRefPics(ref_list);
+      ref_progress[i].resize(num_ref_pics, nullptr);
+      for (int ref_idx = 0; ref_idx < num_ref_pics; ref_idx++) {
+        for (auto &dep : *inter_dependencies) {
+          if (dep->GetPicData().get() !=
+              ref_pic_lists->GetRefPicData(ref_list, ref_idx)) {
+            continue;
+          }
+          const DecodeProgress &progress = dep->GetDecodeProgress();
+          if (dep->GetRecPic().get() ==
+              ref_pic_lists->GetRefPic(ref_list, ref_idx)) {
+            ref_progress[i][ref_idx] = &progress;
+          } else {
+            // Alternative picture is generated after all rows are decoded
+            progress.WaitForReconstructedRows(progress.GetNumCtuRows());
+          }
+          break;
+        }
+      }
+    }
   }
-  if (pic_data_->GetTid() == 0 || !pic_data_->IsHighestLayer()) {
-    rec_pic_->PadBorder();
+
+  // Decoding, deblocking and border padding is pipelined per ctu row so that
+  // pictures referencing this picture can start before it is fully decoded.
+  // Deblocking of a row must wait until intra prediction of the row below is
+  // done, and its horizontal edges modify the bottom of the row above.
+  const bool deblock = pic_data_->GetDeblock();
+  const bool pad_border =
+    pic_data_->GetTid() == 0 || !pic_data_->IsHighestLayer();
+  DeblockingFilter deblocker(simd_.deblocking_filter, pic_data_.get(),
+                             rec_pic_.get(), pic_data_->GetBetaOffset(),
+                             pic_data_->GetTcOffset());
+  int num_final_rows = 0;
+  auto finalize_rows = [&](int num_rows) {
+    if (pad_border) {
+      rec_pic_->PadBorderRows(simd_.yuv_picture,
+                              num_final_rows * constants::kCtuSize,
+                              num_rows * constants::kCtuSize);
+    }
+    num_final_rows = num_rows;
+  };
+  auto on_row_decoded = [&](int ctu_row) {
+    decode_progress_.SetDecodedRows(ctu_row + 1);
+    if (deblock && ctu_row > 0) {
+      deblocker.DeblockCtuRow(ctu_row - 1);
+    }
+    const int num_rows = deblock ? ctu_row - 1 : ctu_row + 1;
+    if (num_rows > num_final_rows && num_rows < num_ctu_rows) {
+      finalize_rows(num_rows);
+      decode_progress_.SetReconstructedRows(num_rows);
+    }
+  };
+  // Returns false if the slice bitstream is not correctly terminated
+  auto decode_slice = [&](int slice, CuDecoder *cu_decoder,
+                          const std::function<void(int)> &row_callback) {
+    BitReader *slice_reader =
+      slice + 1 < num_slices ? &slice_readers[slice] : bit_reader;
+    std::unique_ptr<SyntaxReader> syntax_reader;
+    DecodeCtuRowFunc decode_ctu_row =
+      create_syntax_reader(qp, pic_data_->GetPredictionType(), slice_reader,
+                           &syntax_reader);
+    const int end_row = pic_data_->GetSliceFirstCtuRow(slice + 1);
+    for (int ctu_row = pic_data_->GetSliceFirstCtuRow(slice);
+         ctu_row < end_row; ctu_row++) {
+      decode_ctu_row(cu_decoder, syntax_reader.get(), ctu_row * num_ctu_x,
+                     num_ctu_x);
+      row_callback(ctu_row);
+    }
+    bool slice_success = syntax_reader->Finish();
+    assert(slice_success);
+    return slice_success && !slice_reader->IsOverrun();
+  };
+
+  if (slice_threads > 1) {
+    // Slices are decoded by pool jobs, while one more job deblocks and
+    // publishes the rows in order as soon as they have been decoded
+    std::vector<uint8_t> row_decoded(num_ctu_rows, 0);
+    int next_slice = 0;
+    std::exception_ptr exception;
+    std::mutex mutex;
+    std::condition_variable row_cond;
+    auto mark_row_decoded = [&](int ctu_row) {
+      std::lock_guard<std::mutex> lock(mutex);
+      row_decoded[ctu_row] = 1;
+      row_cond.notify_all();
+    };
+    auto decode_slices = [&]() {
+      std::unique_ptr<CuDecoder> cu_decoder(
+        new CuDecoder(simd_, rec_pic_.get(), pic_data_.get()));
+      if (inter_dependencies) {
+        cu_decoder->SetRefDecodeProgress(&ref_progress);
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      while (next_slice < num_slices && !exception) {
+        const int slice = next_slice++;
+        lock.unlock();
+        bool slice_success = false;
+        try {
+          slice_success =
+            decode_slice(slice, cu_decoder.get(), mark_row_decoded);
+        } catch (...) {
+          lock.lock();
+          exception = std::current_exception();
+          row_cond.notify_all();
+          return;
+        }
+        lock.lock();
+        success &= slice_success;
+      }
+    };
+    auto publish_rows = [&]() {
+      for (int ctu_row = 0; ctu_row < num_ctu_rows; ctu_row++) {
+        std::unique_lock<std::mutex> lock(mutex);
+        row_cond.wait(lock, [&]() {
+          return row_decoded[ctu_row] || exception;
+        });
+        if (exception) {
+          break;
+        }
+        lock.unlock();
+        on_row_decoded(ctu_row);
+      }
+    };
+    // Publishing is the last job since it waits for the slice decoding jobs
+    util::RunJobs(slice_threads + 1, slice_threads + 1, [&](int job) {
+      Restrictions::GetRW() = segment.restrictions;
+      if (job < slice_threads) {
+        decode_slices();
+      } else {
+        publish_rows();
+      }
+    });
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  } else {
+    std::unique_ptr<CuDecoder> local_cu_decoder;
+    CuDecoder *bound_cu_decoder =
+      BindCuDecoder(cached_cu_decoder ? cached_cu_decoder : &local_cu_decoder);
+    if (inter_dependencies) {
+      bound_cu_decoder->SetRefDecodeProgress(&ref_progress);
+    }
+    for (int slice = 0; slice < num_slices; slice++) {
+      success &= decode_slice(slice, bound_cu_decoder, on_row_decoded);
+    }
+  }
+  if (deblock) {
+    deblocker.DeblockCtuRow(num_ctu_rows - 1);
+  }
+  if (bit_reader->IsOverrun()) {
+    success = false;
   }
+  finalize_rows(num_ctu_rows);
   if (pic_data_->GetNalType() == NalUnitType::kIntraAccessPicture &&
       prev_segment_header.open_gop) {
     GenerateAlternativeRecPic(segment, prev_segment_header);
   }
   pic_data_->GetRefPicLists()->ZeroOutReferences();
+  // Alternative reference picture is also ready after last row is published
+  decode_progress_.SetReconstructedRows(num_ctu_rows);
   if (post_process) {
     success &= Postprocess(segment, bit_reader);
   }
@@ -218,10 +473,31 @@ bool PictureDecoder::Postprocess(const SegmentHeader &segment,
   } else {
     pic_hash_.clear();
   }
-  output_resampler_.ConvertTo(*rec_pic_, output_format_, &output_pic_bytes_);
+  const bool high_bitdepth_samples = sizeof(Sample) > 1;
+  direct_output_ =
+    output_format_.width == rec_pic_->GetDisplayWidth(YuvComponent::kY) &&
+    output_format_.height == rec_pic_->GetDisplayHeight(YuvComponent::kY) &&
+    output_format_.chroma_format == rec_pic_->GetChromaFormat() &&
+    output_format_.bitdepth == rec_pic_->GetBitdepth() &&
+    (output_format_.bitdepth > 8) == high_bitdepth_samples;
+  if (!direct_output_ || packed_output_) {
+    output_resampler_.ConvertTo(*rec_pic_, output_format_,
+                                output_pic_bytes_.get(), output_threads_);
+    output_pic_converted_ = true;
+  }
   return success;
 }
 
+std::shared_ptr<const std::vector<uint8_t>>
+PictureDecoder::GetOutputPictureBytes() {
+  if (!output_pic_converted_) {
+    output_resampler_.ConvertTo(*rec_pic_, output_format_,
+                                output_pic_bytes_.get(), output_threads_);
+    output_pic_converted_ = true;
+  }
+  return output_pic_bytes_;
+}
+
 std::shared_ptr<YuvPicture>
 PictureDecoder::GetAlternativeRecPic(const PictureFormat &pic_fmt,
                                      int crop_width, int crop_height) const {
@@ -289,7 +565,7 @@ PictureDecoder::GenerateAlternativeRecPic(
        src, rec_pic_->GetWidth(comp), rec_pic_->GetHeight(comp),
        rec_pic_->GetStride(comp), rec_pic_->GetBitdepth());
   }
-  alt_rec_pic->PadBorder();
+  alt_rec_pic->PadBorder(simd_.yuv_picture);
 }
 
 bool PictureDecoder::ValidateChecksum(const SegmentHeader &segment,
@@ -299,7 +575,7 @@ bool PictureDecoder::ValidateChecksum(const SegmentHeader &segment,
     Restrictions::Get().disable_high_level_default_checksum_method ?
     Checksum::kFallbackMethod : Checksum::kDefaultMethod;
   Checksum checksum(checksum_method, checksum_mode);
-  checksum.HashPicture(*rec_pic_);
+  checksum.HashPicture(*rec_pic_, checksum_threads_);
   pic_hash_ = checksum.GetHash();
   if (segment.major_version <= 1) {
     size_t checksum_len = bit_reader->ReadByte();
@@ -35,11 +35,14 @@
 #include "xvc_common_lib/simd_functions.h"
 #include "xvc_common_lib/yuv_pic.h"
 #include "xvc_dec_lib/bit_reader.h"
+#include "xvc_dec_lib/decode_progress.h"
 #include "xvc_dec_lib/syntax_reader.h"
 #include "xvc_dec_lib/xvcdec.h"
 
 namespace xvc {
 
+class CuDecoder;
+
 class PictureDecoder {
 public:
   struct PicNalHeader {
@@ -55,13 +58,25 @@ public:
   };
 
   PictureDecoder(const SimdFunctions &simd, const PictureFormat &pic_format,
-                 int crop_width, int crop_height);
+                 int crop_width, int crop_height, int checksum_threads = 1,
+                 int slice_threads = 1);
+  // If packed_output is set the picture is always converted to the packed
+  // output format during post processing, otherwise the conversion is
+  // skipped when the reconstructed picture can be output directly.
   void Init(const SegmentHeader &segment, const PicNalHeader &header,
             ReferencePictureLists &&ref_pic_list,
-            const PictureFormat &output_pic_format, int64_t user_data);
+            const PictureFormat &output_pic_format, bool packed_output,
+            int64_t user_data);
+  // If inter_dependencies is given the reference pictures may still be
+  // decoding, and decoding will wait for their progress on demand.
+  // If cached_cu_decoder is given it is reused (or created) for the picture
+  // instead of allocating a new coding unit decoder.
   bool Decode(const SegmentHeader &segment,
               const SegmentHeader &prev_segment_header, BitReader *bit_reader,
-              bool post_process);
+              bool post_process,
+              const std::vector<std::shared_ptr<const PictureDecoder>>
+              *inter_dependencies = nullptr,
+              std::unique_ptr<CuDecoder> *cached_cu_decoder = nullptr);
   bool Postprocess(const SegmentHeader &segment, BitReader *bit_reader);
   std::shared_ptr<const YuvPicture> GetOrigPic() const { return nullptr; }
   std::shared_ptr<const PictureData> GetPicData() const { return pic_data_; }
@@ -75,9 +90,13 @@ public:
   OutputStatus GetOutputStatus() const {
     return output_status_.load(std::memory_order_acquire);
   }
-  const std::vector<uint8_t>& GetOutputPictureBytes() const {
-    return output_pic_bytes_;
-  }
+  // Returns the picture converted to the output format. Normally converted
+  // already during post processing, otherwise converted on demand here.
+  std::shared_ptr<const std::vector<uint8_t>> GetOutputPictureBytes();
+  bool HasDirectOutput() const { return direct_output_; }
+  int GetNumOutputThreads() const { return output_threads_; }
+  const DecodeProgress& GetDecodeProgress() const { return decode_progress_; }
+  DecodeProgress* GetDecodeProgress() { return &decode_progress_; }
   void SetIsConforming(bool conforming) { conforming_ = conforming; }
   bool GetIsConforming() const { return conforming_; }
   bool IsReferenced() const { return ref_count > 0; }
@@ -93,23 +112,32 @@ public:
                  PicNum doc, SegmentNum soc, int num_buffered_nals);
 
 private:
+  CuDecoder* BindCuDecoder(std::unique_ptr<CuDecoder> *cu_decoder);
   void GenerateAlternativeRecPic(const SegmentHeader &segment,
                                const SegmentHeader &prev_segment_header) const;
   bool ValidateChecksum(const SegmentHeader &segment,
                         BitReader *bit_reader, Checksum::Mode checksum_mode);
 
   const SimdFunctions &simd_;
+  const int checksum_threads_;
+  const int slice_threads_;
+  const int output_threads_;
   Resampler output_resampler_;
   PictureFormat output_format_;
   std::shared_ptr<PictureData> pic_data_;
   std::shared_ptr<YuvPicture> rec_pic_;
   std::shared_ptr<YuvPicture> alt_rec_pic_;
   std::vector<uint8_t> pic_hash_;
-  std::vector<uint8_t> output_pic_bytes_;
+  // Output pictures are shared with the application until it releases them
+  std::shared_ptr<std::vector<uint8_t>> output_pic_bytes_;
+  bool direct_output_ = false;
+  bool packed_output_ = false;
+  bool output_pic_converted_ = false;
   bool conforming_ = false;
   int pic_qp_ = -1;
   int64_t user_data_ = 0;
   std::atomic<OutputStatus> output_status_ = { OutputStatus::kHasBeenOutput };
+  DecodeProgress decode_progress_;
   // TODO(PH) Mutable isn't really needed if const handling is relaxed...
   // Note that ref_count should only be modified on "main thread"
   mutable int ref_count = 0;
@@ -91,6 +91,13 @@ Decoder::State SegmentHeaderReader::Read(SegmentHeader* segment_header,
 
   segment_header->restrictions = ReadRestrictions(*segment_header, bit_reader);
   Restrictions::GetRW() = segment_header->restrictions;
+  if (SegmentHeader::HasSlices(segment_header->major_version,
+                               segment_header->minor_version)) {
+    segment_header->num_slices =
+      bit_reader->ReadBits(constants::kNumSlicesBits) + 1;
+  } else {
+    segment_header->num_slices = 1;
+  }
   bit_reader->SkipBits();
 
   segment_header->soc = segment_counter;
@@ -32,18 +32,17 @@
 
 namespace xvc {
 
-template<typename Ctx>
-SyntaxReaderCabac<Ctx>::SyntaxReaderCabac(const Qp &qp,
-                                          PicturePredictionType pic_type,
-                                          BitReader *bit_reader)
+template<typename Ctx, bool Restricted>
+SyntaxReaderCabac<Ctx, Restricted>::SyntaxReaderCabac(
+  const Qp &qp, PicturePredictionType pic_type, BitReader *bit_reader)
   : decoder_(bit_reader),
   restrictions_(Restrictions::Get()) {
   ctx_.ResetStates(qp, pic_type);
   decoder_.Start();
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::Finish() {
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::Finish() {
   if (!decoder_.DecodeBinTrm()) {
     return false;
   }
@@ -51,20 +50,22 @@ bool SyntaxReaderCabac<Ctx>::Finish() {
   return true;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadAffineFlag(const CodingUnit &cu,
-                                            bool is_merge) {
-  if (restrictions_.disable_ext2_inter_affine ||
-    (is_merge && restrictions_.disable_ext2_inter_affine_merge)) {
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::ReadAffineFlag(const CodingUnit &cu,
+                                                        bool is_merge) {
+  if (Restrict(&Restrictions::disable_ext2_inter_affine) ||
+      (is_merge && Restrict(&Restrictions::disable_ext2_inter_affine_merge))) {
     return false;
   }
   Ctx &ctx = ctx_.GetAffineCtx(cu);
   return decoder_.DecodeBin(&ctx) != 0;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadCbf(const CodingUnit &cu, YuvComponent comp) {
-  if (restrictions_.disable_transform_cbf) {
+template<typename Ctx, bool Restricted>
+bool
+SyntaxReaderCabac<Ctx, Restricted>::ReadCbf(const CodingUnit &cu,
+                                            YuvComponent comp) {
+  if (Restrict(&Restrictions::disable_transform_cbf)) {
     return true;
   }
   if (util::IsLuma(comp)) {
@@ -74,11 +75,12 @@ bool SyntaxReaderCabac<Ctx>::ReadCbf(const CodingUnit &cu, YuvComponent comp) {
   }
 }
 
-template<typename Ctx>
+template<typename Ctx, bool Restricted>
 int
-SyntaxReaderCabac<Ctx>::ReadCoefficients(const CodingUnit &cu,
-                                         YuvComponent comp, Coeff *dst_coeff,
-                                         ptrdiff_t dst_stride) {
+SyntaxReaderCabac<Ctx, Restricted>::ReadCoefficients(const CodingUnit &cu,
+                                                     YuvComponent comp,
+                                                     Coeff *dst_coeff,
+                                                     ptrdiff_t dst_stride) {
   if (cu.GetWidth(comp) == 2 || cu.GetHeight(comp) == 2) {
     return ReadCoeffSubblock<1>(cu, comp, dst_coeff, dst_stride);
   } else {
@@ -87,12 +89,13 @@ SyntaxReaderCabac<Ctx>::ReadCoefficients(const CodingUnit &cu,
   }
 }
 
-template<typename Ctx>
+template<typename Ctx, bool Restricted>
 template<int SubBlockShift>
 int
-SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
-                                          YuvComponent comp, Coeff *dst_coeff,
-                                          ptrdiff_t dst_stride) {
+SyntaxReaderCabac<Ctx, Restricted>::ReadCoeffSubblock(const CodingUnit &cu,
+                                                      YuvComponent comp,
+                                                      Coeff *dst_coeff,
+                                                      ptrdiff_t dst_stride) {
   const int width = cu.GetWidth(comp);
   const int height = cu.GetHeight(comp);
   const int width_log2 = util::SizeToLog2(width);
@@ -125,7 +128,7 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
 
   int last_nonzero_pos = -1;
   int first_nonzero_pos = subblock_size;
-  if (!restrictions_.disable_transform_last_position) {
+  if (!Restrict(&Restrictions::disable_transform_last_position)) {
     uint32_t pos_last_x, pos_last_y;
     ReadCoeffLastPos(width, height, comp, scan_order, &pos_last_x, &pos_last_y);
     const int pos_last_index =
@@ -141,8 +144,8 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
     subblock_last_coeff_offset =
       ((subblock_last_index + 1) << (subblock_shift + subblock_shift)) -
       pos_last_index + 1;
-    if (restrictions_.disable_transform_cbf &&
-        restrictions_.disable_transform_subblock_csbf &&
+    if (Restrict(&Restrictions::disable_transform_cbf) &&
+        Restrict(&Restrictions::disable_transform_subblock_csbf) &&
         pos_last_x == 0 && pos_last_y == 0) {
       subblock_last_coeff_offset--;
     } else {
@@ -169,12 +172,12 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
 
     int pattern_sig_ctx = 0;
     bool is_last_subblock = subblock_index == subblock_last_index &&
-      !restrictions_.disable_transform_last_position &&
-      !restrictions_.disable_transform_cbf;
+      !Restrict(&Restrictions::disable_transform_last_position) &&
+      !Restrict(&Restrictions::disable_transform_cbf);
     bool is_first_subblock = subblock_index == 0 &&
-      !restrictions_.disable_transform_cbf;
+      !Restrict(&Restrictions::disable_transform_cbf);
     if (is_last_subblock || is_first_subblock ||
-        restrictions_.disable_transform_subblock_csbf) {
+        Restrict(&Restrictions::disable_transform_subblock_csbf)) {
       subblock_csbf[subblock_scan] = 1;
       // derive pattern_sig_ctx
       ctx_.GetSubblockCsbfCtx(comp, &subblock_csbf[0], subblock_scan_x,
@@ -200,7 +203,7 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
       const int coeff_scan_y = subblock_pos_y + (scan_offset >> subblock_shift);
       bool sig_coeff;
       bool not_first_subblock = subblock_index > 0 &&
-        !restrictions_.disable_transform_subblock_csbf;
+        !Restrict(&Restrictions::disable_transform_subblock_csbf);
       if (coeff_index == 0 && not_first_subblock && coeff_num_non_zero == 0) {
         sig_coeff = true;
       } else {
@@ -238,7 +241,8 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
 
     // greater than 1 flag
     int max_num_c1_flags = constants::kMaxNumC1Flags;
-    if (restrictions_.disable_transform_residual_greater_than_flags) {
+    if (Restrict(
+      &Restrictions::disable_transform_residual_greater_than_flags)) {
       max_num_c1_flags = 0;
     }
     for (int i = 0; i < coeff_num_non_zero; i++) {
@@ -255,7 +259,7 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
       if (greater_than_1) {
         c1 = 0;
         if (first_c2_idx == -1 &&
-            !restrictions_.disable_transform_residual_greater2) {
+            !Restrict(&Restrictions::disable_transform_residual_greater2)) {
           first_c2_idx = i;
         }
         subblock_coeff[i] = 2;
@@ -281,7 +285,7 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
 
     // sign hiding
     bool sign_hidden = false;
-    if (!restrictions_.disable_transform_sign_hiding &&
+    if (!Restrict(&Restrictions::disable_transform_sign_hiding) &&
         last_nonzero_pos - first_nonzero_pos > constants::SignHidingThreshold) {
       sign_hidden = true;
     }
@@ -301,7 +305,7 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
     // abs level remaining
     if (c1 == 0 || coeff_num_non_zero > max_num_c1_flags) {
       int first_coeff_greater2 =
-        restrictions_.disable_transform_residual_greater2 ? 0 : 1;
+        Restrict(&Restrictions::disable_transform_residual_greater2) ? 0 : 1;
       uint32_t golomb_rice_k = 0;
       for (int i = 0; i < coeff_num_non_zero; i++) {
         const int coeff_scan_y = subblock_pos[i] >> log2size;
@@ -309,7 +313,7 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
         Coeff base_level = static_cast<Coeff>(
           (i < max_num_c1_flags) ? (2 + first_coeff_greater2) : 1);
         if (subblock_coeff[i] == base_level) {
-          if (!restrictions_.disable_ext2_cabac_alt_residual_ctx) {
+          if (!Restrict(&Restrictions::disable_ext2_cabac_alt_residual_ctx)) {
             golomb_rice_k =
               ctx_.GetCoeffGolombRiceK(coeff_scan_x, coeff_scan_y, width,
                                        height, dst_coeff, dst_stride);
@@ -319,7 +323,7 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
           subblock_coeff[i] += abs_lvl;
           dst_coeff[coeff_scan_y * dst_stride + coeff_scan_x] += abs_lvl;
           if (subblock_coeff[i] > 3 * (1 << golomb_rice_k) &&
-              !restrictions_.disable_transform_adaptive_exp_golomb) {
+              !Restrict(&Restrictions::disable_transform_adaptive_exp_golomb)) {
             golomb_rice_k = std::min(golomb_rice_k + 1, 4u);
           }
         }
@@ -359,14 +363,15 @@ SyntaxReaderCabac<Ctx>::ReadCoeffSubblock(const CodingUnit &cu,
   return total_num_sig_coeff;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadEndOfSlice() {
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::ReadEndOfSlice() {
   uint32_t bin = decoder_.DecodeBinTrm();
   return bin != 0;
 }
 
-template<typename Ctx>
-InterDir SyntaxReaderCabac<Ctx>::ReadInterDir(const CodingUnit &cu) {
+template<typename Ctx, bool Restricted>
+InterDir
+SyntaxReaderCabac<Ctx, Restricted>::ReadInterDir(const CodingUnit &cu) {
   assert(cu.GetPartitionType() == PartitionType::kSize2Nx2N);
   Ctx &ctx = ctx_.GetInterDirBiCtx(cu);
   if (decoder_.DecodeBin(&ctx) != 0) {
@@ -376,18 +381,20 @@ InterDir SyntaxReaderCabac<Ctx>::ReadInterDir(const CodingUnit &cu) {
   return bin == 0 ? InterDir::kL0 : InterDir::kL1;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadInterFullpelMvFlag(const CodingUnit &cu) {
-  if (restrictions_.disable_ext2_inter_adaptive_fullpel_mv) {
+template<typename Ctx, bool Restricted>
+bool
+SyntaxReaderCabac<Ctx, Restricted>::ReadInterFullpelMvFlag(
+  const CodingUnit &cu) {
+  if (Restrict(&Restrictions::disable_ext2_inter_adaptive_fullpel_mv)) {
     return false;
   }
   Ctx &ctx = ctx_.GetInterFullpelMvCtx(cu);
   return decoder_.DecodeBin(&ctx) != 0;
 }
 
-template<typename Ctx>
-MvDelta SyntaxReaderCabac<Ctx>::ReadInterMvd() {
-  if (restrictions_.disable_inter_mvd_greater_than_flags) {
+template<typename Ctx, bool Restricted>
+MvDelta SyntaxReaderCabac<Ctx, Restricted>::ReadInterMvd() {
+  if (Restrict(&Restrictions::disable_inter_mvd_greater_than_flags)) {
     MvDelta mvd;
     mvd.x += ReadExpGolomb(1);
     if (mvd.x) {
@@ -427,18 +434,20 @@ MvDelta SyntaxReaderCabac<Ctx>::ReadInterMvd() {
   return mvd;
 }
 
-template<typename Ctx>
-int SyntaxReaderCabac<Ctx>::ReadInterMvpIdx(const CodingUnit &cu) {
-  if ((!cu.GetUseAffine() && restrictions_.disable_inter_mvp) ||
-    (cu.GetUseAffine() && restrictions_.disable_ext2_inter_affine_mvp)) {
+template<typename Ctx, bool Restricted>
+int SyntaxReaderCabac<Ctx, Restricted>::ReadInterMvpIdx(const CodingUnit &cu) {
+  if ((!cu.GetUseAffine() && Restrict(&Restrictions::disable_inter_mvp)) ||
+      (cu.GetUseAffine() &&
+       Restrict(&Restrictions::disable_ext2_inter_affine_mvp))) {
     return 0;
   }
   return ReadUnaryMaxSymbol(constants::kNumInterMvPredictors - 1,
                             &ctx_.inter_mvp_idx[0], &ctx_.inter_mvp_idx[0]);
 }
 
-template<typename Ctx>
-int SyntaxReaderCabac<Ctx>::ReadInterRefIdx(int num_refs_available) {
+template<typename Ctx, bool Restricted>
+int
+SyntaxReaderCabac<Ctx, Restricted>::ReadInterRefIdx(int num_refs_available) {
   if (num_refs_available == 1) {
     return 0;
   }
@@ -459,12 +468,14 @@ int SyntaxReaderCabac<Ctx>::ReadInterRefIdx(int num_refs_available) {
   return ref_idx + 1;
 }
 
-template<typename Ctx>
-IntraMode SyntaxReaderCabac<Ctx>::ReadIntraMode(const IntraPredictorLuma &mpm) {
+template<typename Ctx, bool Restricted>
+IntraMode
+SyntaxReaderCabac<Ctx, Restricted>::ReadIntraMode(
+  const IntraPredictorLuma &mpm) {
   Ctx &ctx = ctx_.intra_pred_luma[0];
   uint32_t is_mpm_coded = decoder_.DecodeBin(&ctx);
   if (is_mpm_coded) {
-    if (!restrictions_.disable_ext2_intra_6_predictors) {
+    if (!Restrict(&Restrictions::disable_ext2_intra_6_predictors)) {
       int mpm_index =
         decoder_.DecodeBin(&ctx_.GetIntraPredictorCtx(mpm[0]));
       if (mpm_index > 0) {
@@ -490,9 +501,9 @@ IntraMode SyntaxReaderCabac<Ctx>::ReadIntraMode(const IntraPredictorLuma &mpm) {
       return mpm[mpm_index];
     }
   } else {
-    if (!restrictions_.disable_ext2_intra_6_predictors) {
+    if (!Restrict(&Restrictions::disable_ext2_intra_6_predictors)) {
       int intra_mode;
-      if (!restrictions_.disable_ext2_intra_67_modes) {
+      if (!Restrict(&Restrictions::disable_ext2_intra_67_modes)) {
         intra_mode = decoder_.DecodeBypassBins(4);
         intra_mode <<= 2;
         if (intra_mode <= kNbrIntraModesExt - 8) {
@@ -510,7 +521,7 @@ IntraMode SyntaxReaderCabac<Ctx>::ReadIntraMode(const IntraPredictorLuma &mpm) {
       return static_cast<IntraMode>(intra_mode);
     } else {
       int intra_mode;
-      if (!restrictions_.disable_ext2_intra_67_modes) {
+      if (!Restrict(&Restrictions::disable_ext2_intra_67_modes)) {
         intra_mode = decoder_.DecodeBypassBins(6);
       } else {
         intra_mode = decoder_.DecodeBypassBins(5);
@@ -533,14 +544,15 @@ IntraMode SyntaxReaderCabac<Ctx>::ReadIntraMode(const IntraPredictorLuma &mpm) {
   }
 }
 
-template<typename Ctx>
+template<typename Ctx, bool Restricted>
 IntraChromaMode
-SyntaxReaderCabac<Ctx>::ReadIntraChromaMode(IntraPredictorChroma chroma_preds) {
+SyntaxReaderCabac<Ctx, Restricted>::ReadIntraChromaMode(
+  IntraPredictorChroma chroma_preds) {
   uint32_t not_dm_chroma = decoder_.DecodeBin(&ctx_.intra_pred_chroma[0]);
   if (!not_dm_chroma) {
     return IntraChromaMode::kDmChroma;
   }
-  if (!restrictions_.disable_ext2_intra_chroma_from_luma) {
+  if (!Restrict(&Restrictions::disable_ext2_intra_chroma_from_luma)) {
     uint32_t not_lm_chroma = decoder_.DecodeBin(&ctx_.intra_pred_chroma[1]);
     if (!not_lm_chroma) {
       return IntraChromaMode::kLmChroma;
@@ -550,26 +562,26 @@ SyntaxReaderCabac<Ctx>::ReadIntraChromaMode(IntraPredictorChroma chroma_preds) {
   return chroma_preds[chroma_index];
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadLicFlag() {
-  if (restrictions_.disable_ext2_inter_local_illumination_comp) {
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::ReadLicFlag() {
+  if (Restrict(&Restrictions::disable_ext2_inter_local_illumination_comp)) {
     return false;
   }
   return decoder_.DecodeBin(&ctx_.lic_flag[0]) != 0;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadMergeFlag() {
-  if (restrictions_.disable_inter_merge_mode) {
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::ReadMergeFlag() {
+  if (Restrict(&Restrictions::disable_inter_merge_mode)) {
     return false;
   }
   uint32_t bin = decoder_.DecodeBin(&ctx_.inter_merge_flag[0]);
   return bin != 0;
 }
 
-template<typename Ctx>
-int SyntaxReaderCabac<Ctx>::ReadMergeIdx() {
-  if (restrictions_.disable_inter_merge_candidates) {
+template<typename Ctx, bool Restricted>
+int SyntaxReaderCabac<Ctx, Restricted>::ReadMergeIdx() {
+  if (Restrict(&Restrictions::disable_inter_merge_candidates)) {
     return 0;
   }
   const int max_merge_cand = constants::kNumInterMergeCandidates;
@@ -582,8 +594,9 @@ int SyntaxReaderCabac<Ctx>::ReadMergeIdx() {
   return merge_idx;
 }
 
-template<typename Ctx>
-PartitionType SyntaxReaderCabac<Ctx>::ReadPartitionType(const CodingUnit &cu) {
+template<typename Ctx, bool Restricted>
+PartitionType
+SyntaxReaderCabac<Ctx, Restricted>::ReadPartitionType(const CodingUnit &cu) {
   if (cu.GetPredMode() == PredictionMode::kIntra) {
     PartitionType part_type = PartitionType::kSize2Nx2N;
     // Signaling partition type for lowest level assumes single CU tree
@@ -604,15 +617,15 @@ PartitionType SyntaxReaderCabac<Ctx>::ReadPartitionType(const CodingUnit &cu) {
   return PartitionType::kSizeNxN;
 }
 
-template<typename Ctx>
-PredictionMode SyntaxReaderCabac<Ctx>::ReadPredMode() {
+template<typename Ctx, bool Restricted>
+PredictionMode SyntaxReaderCabac<Ctx, Restricted>::ReadPredMode() {
   uint32_t is_intra = decoder_.DecodeBin(&ctx_.cu_pred_mode[0]);
   return is_intra != 0 ? PredictionMode::kIntra : PredictionMode::kInter;
 }
 
-template<typename Ctx>
-int SyntaxReaderCabac<Ctx>::ReadQp(int predicted_qp, int base_qp,
-                                   int aqp_mode) {
+template<typename Ctx, bool Restricted>
+int SyntaxReaderCabac<Ctx, Restricted>::ReadQp(int predicted_qp, int base_qp,
+                                               int aqp_mode) {
   if (aqp_mode == 1) {
     return decoder_.DecodeBypassBins(7);
   }
@@ -641,28 +654,28 @@ int SyntaxReaderCabac<Ctx>::ReadQp(int predicted_qp, int base_qp,
   return tmp_qp;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadRootCbf() {
-  if (restrictions_.disable_transform_root_cbf) {
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::ReadRootCbf() {
+  if (Restrict(&Restrictions::disable_transform_root_cbf)) {
     return true;
   }
   return decoder_.DecodeBin(&ctx_.cu_root_cbf[0]) != 0;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadSkipFlag(const CodingUnit &cu) {
-  if (restrictions_.disable_inter_skip_mode ||
-      restrictions_.disable_inter_merge_mode) {
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::ReadSkipFlag(const CodingUnit &cu) {
+  if (Restrict(&Restrictions::disable_inter_skip_mode) ||
+      Restrict(&Restrictions::disable_inter_merge_mode)) {
     return false;
   }
   Ctx &ctx = ctx_.GetSkipFlagCtx(cu);
   return decoder_.DecodeBin(&ctx) != 0;
 }
 
-template<typename Ctx>
+template<typename Ctx, bool Restricted>
 SplitType
-SyntaxReaderCabac<Ctx>::ReadSplitBinary(const CodingUnit &cu,
-                                        SplitRestriction split_restriction) {
+SyntaxReaderCabac<Ctx, Restricted>::ReadSplitBinary(
+  const CodingUnit &cu, SplitRestriction split_restriction) {
   Ctx &ctx = ctx_.GetSplitBinaryCtx(cu);
   uint32_t bin = decoder_.DecodeBin(&ctx);
   if (!bin) {
@@ -684,18 +697,19 @@ SyntaxReaderCabac<Ctx>::ReadSplitBinary(const CodingUnit &cu,
   return bin2 != 0 ? SplitType::kVertical : SplitType::kHorizontal;
 }
 
-template<typename Ctx>
-SplitType SyntaxReaderCabac<Ctx>::ReadSplitQuad(const CodingUnit &cu,
-                                                int max_depth) {
+template<typename Ctx, bool Restricted>
+SplitType
+SyntaxReaderCabac<Ctx, Restricted>::ReadSplitQuad(const CodingUnit &cu,
+                                                  int max_depth) {
   Ctx &ctx = ctx_.GetSplitFlagCtx(cu, max_depth);
   uint32_t bin = decoder_.DecodeBin(&ctx);
   return bin != 0 ? SplitType::kQuad : SplitType::kNone;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadTransformSkip(const CodingUnit &cu,
-                                               YuvComponent comp) {
-  if (restrictions_.disable_ext2_transform_skip ||
+template<typename Ctx, bool Restricted>
+bool SyntaxReaderCabac<Ctx, Restricted>::ReadTransformSkip(const CodingUnit &cu,
+                                                           YuvComponent comp) {
+  if (Restrict(&Restrictions::disable_ext2_transform_skip) ||
       !cu.CanTransformSkip(comp)) {
     return false;
   }
@@ -703,18 +717,22 @@ bool SyntaxReaderCabac<Ctx>::ReadTransformSkip(const CodingUnit &cu,
   return decoder_.DecodeBin(&ctx) != 0;
 }
 
-template<typename Ctx>
-bool SyntaxReaderCabac<Ctx>::ReadTransformSelectEnable(const CodingUnit &cu) {
-  if (restrictions_.disable_ext2_transform_select) {
+template<typename Ctx, bool Restricted>
+bool
+SyntaxReaderCabac<Ctx, Restricted>::ReadTransformSelectEnable(
+  const CodingUnit &cu) {
+  if (Restrict(&Restrictions::disable_ext2_transform_select)) {
     return false;
   }
   Ctx &ctx = ctx_.transform_select_flag[cu.GetDepth()];
   return decoder_.DecodeBin(&ctx) != 0;
 }
 
-template<typename Ctx>
-int SyntaxReaderCabac<Ctx>::ReadTransformSelectIdx(const CodingUnit &cu) {
-  if (restrictions_.disable_ext2_transform_select) {
+template<typename Ctx, bool Restricted>
+int
+SyntaxReaderCabac<Ctx, Restricted>::ReadTransformSelectIdx(
+  const CodingUnit &cu) {
+  if (Restrict(&Restrictions::disable_ext2_transform_select)) {
     return 0;
   }
   static_assert(constants::kMaxTransformSelectIdx == 4, "2 bits signaling");
@@ -728,12 +746,13 @@ int SyntaxReaderCabac<Ctx>::ReadTransformSelectIdx(const CodingUnit &cu) {
   return type_idx;
 }
 
-template<typename Ctx>
-void SyntaxReaderCabac<Ctx>::ReadCoeffLastPos(int width, int height,
-                                              YuvComponent comp,
-                                              ScanOrder scan_order,
-                                              uint32_t *out_pos_last_x,
-                                              uint32_t *out_pos_last_y) {
+template<typename Ctx, bool Restricted>
+void
+SyntaxReaderCabac<Ctx, Restricted>::ReadCoeffLastPos(int width, int height,
+                                                     YuvComponent comp,
+                                                     ScanOrder scan_order,
+                                                     uint32_t *out_pos_last_x,
+                                                     uint32_t *out_pos_last_y) {
   if (scan_order == ScanOrder::kVertical) {
     std::swap(width, height);
   }
@@ -782,14 +801,12 @@ void SyntaxReaderCabac<Ctx>::ReadCoeffLastPos(int width, int height,
   *out_pos_last_y = pos_last_y;
 }
 
-template<typename Ctx>
+template<typename Ctx, bool Restricted>
 template<int SubBlockShift>
 int
-SyntaxReaderCabac<Ctx>::DetermineLastIndex(int subblock_width,
-                                           int subblock_height,
-                                           int pos_last_x, int pos_last_y,
-                                           const uint16_t *subblock_scan_table,
-                                           const uint8_t *coeff_scan_table) {
+SyntaxReaderCabac<Ctx, Restricted>::DetermineLastIndex(
+  int subblock_width, int subblock_height, int pos_last_x, int pos_last_y,
+  const uint16_t *subblock_scan_table, const uint8_t *coeff_scan_table) {
   constexpr int subblock_shift = SubBlockShift;
   constexpr int subblock_mask = (1 << subblock_shift) - 1;
   constexpr int subblock_size = 1 << (subblock_shift * 2);
@@ -813,11 +830,12 @@ SyntaxReaderCabac<Ctx>::DetermineLastIndex(int subblock_width,
   return 0;
 }
 
-template<typename Ctx>
+template<typename Ctx, bool Restricted>
 uint32_t
-SyntaxReaderCabac<Ctx>::ReadCoeffRemainExpGolomb(uint32_t golomb_rice_k) {
+SyntaxReaderCabac<Ctx, Restricted>::ReadCoeffRemainExpGolomb(
+  uint32_t golomb_rice_k) {
   const uint32_t threshold =
-    !restrictions_.disable_ext2_cabac_alt_residual_ctx ?
+    !Restrict(&Restrictions::disable_ext2_cabac_alt_residual_ctx) ?
     TransformHelper::kGolombRiceRangeExt[golomb_rice_k] :
     constants::kCoeffRemainBinReduction;
   uint32_t prefix = 0;
@@ -836,8 +854,9 @@ SyntaxReaderCabac<Ctx>::ReadCoeffRemainExpGolomb(uint32_t golomb_rice_k) {
   }
 }
 
-template<typename Ctx>
-uint32_t SyntaxReaderCabac<Ctx>::ReadExpGolomb(uint32_t golomb_rice_k) {
+template<typename Ctx, bool Restricted>
+uint32_t
+SyntaxReaderCabac<Ctx, Restricted>::ReadExpGolomb(uint32_t golomb_rice_k) {
   uint32_t abs_level = 0;
   uint32_t bin = 1;
   while (bin) {
@@ -851,11 +870,11 @@ uint32_t SyntaxReaderCabac<Ctx>::ReadExpGolomb(uint32_t golomb_rice_k) {
   return abs_level;
 }
 
-template<typename Ctx>
+template<typename Ctx, bool Restricted>
 uint32_t
-SyntaxReaderCabac<Ctx>::ReadUnaryMaxSymbol(uint32_t max_val,
-                                           Ctx *ctx_start,
-                                           Ctx *ctx_rest) {
+SyntaxReaderCabac<Ctx, Restricted>::ReadUnaryMaxSymbol(uint32_t max_val,
+                                                       Ctx *ctx_start,
+                                                       Ctx *ctx_rest) {
   assert(max_val > 0);
   uint32_t symbol = decoder_.DecodeBin(ctx_start);
   if (!symbol || max_val == 1) {
@@ -876,12 +895,24 @@ SyntaxReaderCabac<Ctx>::ReadUnaryMaxSymbol(uint32_t max_val,
 std::unique_ptr<SyntaxReader>
 SyntaxReader::Create(const Qp &qp, PicturePredictionType pic_type,
                      BitReader *bit_reader) {
-  if (Restrictions::Get().disable_cabac_ctx_update) {
+  const Restrictions &restrictions = Restrictions::Get();
+  if (restrictions.disable_cabac_ctx_update) {
     return std::unique_ptr<SyntaxReader>(
-      new SyntaxReaderCabac<ContextModelStatic>(qp, pic_type, bit_reader));
+      new SyntaxReaderCabac<ContextModelStatic, true>(qp, pic_type,
+                                                      bit_reader));
+  }
+  if (restrictions.GetAnyRestrictions()) {
+    return std::unique_ptr<SyntaxReader>(
+      new SyntaxReaderCabac<ContextModelDynamic, true>(qp, pic_type,
+                                                       bit_reader));
   }
   return std::unique_ptr<SyntaxReader>(
-    new SyntaxReaderCabac<ContextModelDynamic>(qp, pic_type, bit_reader));
+    new SyntaxReaderCabac<ContextModelDynamic, false>(qp, pic_type,
+                                                      bit_reader));
 }
 
+template class SyntaxReaderCabac<ContextModelStatic, true>;
+template class SyntaxReaderCabac<ContextModelDynamic, true>;
+template class SyntaxReaderCabac<ContextModelDynamic, false>;
+
 }   // namespace xvc
@@ -29,6 +29,7 @@
 #include "xvc_common_lib/intra_prediction.h"
 #include "xvc_common_lib/picture_types.h"
 #include "xvc_common_lib/quantize.h"
+#include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/transform.h"
 #include "xvc_dec_lib/entropy_decoder.h"
 
@@ -72,9 +73,12 @@ public:
   virtual int ReadTransformSelectIdx(const CodingUnit &cu) = 0;
 };
 
-template<typename ContextModel>
+// When Restricted is false the reader is only used for segments without any
+// restriction flags set and all checks of them are resolved at compile time.
+template<typename ContextModel, bool Restricted>
 class SyntaxReaderCabac final : public SyntaxReader {
 public:
+  static const bool kRestricted = Restricted;
   SyntaxReaderCabac(const Qp &qp, PicturePredictionType pic_type,
                     BitReader *bit_reader);
   bool Finish() override;
@@ -107,6 +111,10 @@ public:
   int ReadTransformSelectIdx(const CodingUnit &cu) override;
 
 private:
+  // The restriction check is removed at compile time if not Restricted
+  bool Restrict(bool Restrictions::*flag) const {
+    return Restricted && restrictions_.*flag;
+  }
   template<int SubBlockShift>
   int ReadCoeffSubblock(const CodingUnit &cu, YuvComponent comp,
                         Coeff *dst_coeff, ptrdiff_t dst_coeff_stride);
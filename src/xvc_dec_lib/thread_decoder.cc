@@ -23,6 +23,8 @@
 
 #include <algorithm>
 
+#include "xvc_dec_lib/cu_decoder.h"
+
 namespace xvc {
 
 ThreadDecoder::ThreadDecoder(int num_threads) {
@@ -43,10 +45,7 @@ ThreadDecoder::~ThreadDecoder() {
 }
 
 void ThreadDecoder::StopAll() {
-  std::unique_lock<std::mutex> lock(global_mutex_);
-  running_ = false;
-  wait_work_cond_.notify_all();  // wakeup all
-  lock.unlock();
+  scheduler_.Stop();
   for (auto &thread : worker_threads_) {
     thread.join();
   }
@@ -58,7 +57,7 @@ void ThreadDecoder::DecodeAsync(
   std::shared_ptr<SegmentHeader> &&prev_segment_header,
   std::shared_ptr<PictureDecoder> &&pic_dec,
   std::vector<std::shared_ptr<const PictureDecoder>> &&deps,
-  std::unique_ptr<std::vector<uint8_t>> &&nal, size_t nal_offset) {
+  NalUnit &&nal, size_t nal_offset) {
   // Prepare work for thread
   WorkItem work;
   work.pic_dec = std::move(pic_dec);
@@ -68,11 +67,21 @@ void ThreadDecoder::DecodeAsync(
   work.nal_offset = nal_offset;
   work.nal = std::move(nal);
 
-  // Signal one worker thread to begin processing
-  std::unique_lock<std::mutex> lock(global_mutex_);
-  pending_work_.push_back(std::move(work));
-  jobs_in_flight_++;
-  wait_work_cond_.notify_one();
+  // All dependencies must have started decoding before taking work,
+  // the remaining dependency is resolved per ctu row while decoding.
+  // Since dependencies always started before the picture itself the
+  // oldest picture being decoded can always make progress.
+  const WorkScheduler::JobId job = work.pic_dec.get();
+  std::vector<WorkScheduler::JobId> job_dependencies;
+  for (auto &dependency : work.inter_dependencies) {
+    job_dependencies.push_back(dependency.get());
+  }
+  {
+    std::lock_guard<std::mutex> lock(work_mutex_);
+    pending_work_[job] = std::move(work);
+    jobs_in_flight_++;
+  }
+  scheduler_.Add(job, job_dependencies, 0);
 }
 
 void ThreadDecoder::WaitForPicture(const std::shared_ptr<PictureDecoder> &pic,
@@ -83,7 +92,7 @@ void ThreadDecoder::WaitForPicture(const std::shared_ptr<PictureDecoder> &pic,
 }
 
 void ThreadDecoder::WaitOne(PictureDecodedCallback callback) {
-  std::unique_lock<std::mutex> lock(global_mutex_);
+  std::unique_lock<std::mutex> lock(work_mutex_);
   work_done_cond_.wait(lock, [this] { return !finished_work_.empty(); });
   WorkItem work = std::move(finished_work_.front());
   finished_work_.pop_front();
@@ -93,7 +102,7 @@ void ThreadDecoder::WaitOne(PictureDecodedCallback callback) {
 }
 
 void ThreadDecoder::WaitAll(PictureDecodedCallback callback) {
-  std::unique_lock<std::mutex> lock(global_mutex_);
+  std::unique_lock<std::mutex> lock(work_mutex_);
   while (jobs_in_flight_ > 0) {
     work_done_cond_.wait(lock, [this] { return !finished_work_.empty(); });
     WorkItem work = std::move(finished_work_.front());
@@ -105,40 +114,24 @@ void ThreadDecoder::WaitAll(PictureDecodedCallback callback) {
 }
 
 void ThreadDecoder::WorkerMain() {
-  std::unique_lock<std::mutex> lock(global_mutex_);
+  // Coding unit decoder buffers are allocated once and reused for all
+  // pictures decoded by this thread
+  std::unique_ptr<CuDecoder> cu_decoder;
   while (true) {
-    ThreadDecoder::WorkItem work;
-    // Find one picture that can be decoded now
-    wait_work_cond_.wait(lock, [this, &work] {
-      if (!running_) {
-        return true;
-      }
-      if (pending_work_.empty()) {
-        return false;
-      }
-      // Verify all dependencies are satisfied before taking work
-      auto it = pending_work_.begin();
-      for (; it != pending_work_.end(); ++it) {
-        bool valid = true;
-        for (auto &dependency : it->inter_dependencies) {
-          if (dependency->GetOutputStatus() == OutputStatus::kProcessing) {
-            valid = false;
-            break;
-          }
-        }
-        if (!valid) {
-          continue;
-        }
-        work = std::move(*it);
-        pending_work_.erase(it);
-        return true;
-      }
-      return false;
-    });
-    if (!running_) {
+    WorkScheduler::JobId job = scheduler_.Take();
+    if (!job) {
       break;
     }
-    lock.unlock();
+    ThreadDecoder::WorkItem work;
+    {
+      std::lock_guard<std::mutex> lock(work_mutex_);
+      auto it = pending_work_.find(job);
+      work = std::move(it->second);
+      pending_work_.erase(it);
+    }
+    // Pictures depending on this one can now be started by other workers
+    work.pic_dec->GetDecodeProgress()->SetStarted();
+    scheduler_.Release(job);
 
     // Load restriction flags for current thread unles already done
     thread_local SegmentNum restriction_soc = static_cast<SegmentNum>(-1);
@@ -148,26 +141,22 @@ void ThreadDecoder::WorkerMain() {
     }
 
     // Decode picture
-    BitReader bit_reader(&(*work.nal)[0] + work.nal_offset,
-                         work.nal->size() - work.nal_offset);
+    BitReader bit_reader(work.nal.GetData() + work.nal_offset,
+                         work.nal.GetSize() - work.nal_offset);
     work.success = work.pic_dec->Decode(*work.segment_header,
                                         *work.prev_segment_header, &bit_reader,
-                                        false);
+                                        false, &work.inter_dependencies,
+                                        &cu_decoder);
     work.pic_dec->SetOutputStatus(OutputStatus::kPostProcessing);
 
-    // Notify all workers that a dependency might be ready
-    lock.lock();
-    wait_work_cond_.notify_all();
-    lock.unlock();
-
     // Verify checksum and prepare output picture
     work.success &=
       work.pic_dec->Postprocess(*work.segment_header, &bit_reader);
     work.pic_dec->SetOutputStatus(OutputStatus::kFinishedProcessing);
 
     // Notify main thread picture that picture is fully decoded
-    lock.lock();
-    // TODO(PH) some fields are not needed anymore (like nal)
+    std::lock_guard<std::mutex> lock(work_mutex_);
+    // Note that nal is released when the main thread picks up the work
     finished_work_.push_back(std::move(work));
     work_done_cond_.notify_all();
   }
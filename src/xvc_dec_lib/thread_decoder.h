@@ -26,13 +26,15 @@
 #include <condition_variable>   // NOLINT
 #include <deque>
 #include <functional>
-#include <list>
 #include <memory>
 #include <mutex>                // NOLINT
 #include <thread>               // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/work_scheduler.h"
+#include "xvc_dec_lib/nal_unit.h"
 #include "xvc_dec_lib/picture_decoder.h"
 
 namespace xvc {
@@ -51,8 +53,7 @@ public:
                    std::shared_ptr<SegmentHeader> &&prev_segment_header,
                    std::shared_ptr<PictureDecoder> &&pic_dec,
                    std::vector<std::shared_ptr<const PictureDecoder>> &&deps,
-                   std::unique_ptr<std::vector<uint8_t>> &&nal,
-                   size_t nal_offset);
+                   NalUnit &&nal, size_t nal_offset);
   void WaitForPicture(const std::shared_ptr<PictureDecoder> &pic,
                       PictureDecodedCallback callback);
   void WaitOne(PictureDecodedCallback callback);
@@ -64,20 +65,20 @@ private:
     std::vector<std::shared_ptr<const PictureDecoder>> inter_dependencies;
     std::shared_ptr<SegmentHeader> segment_header;
     std::shared_ptr<SegmentHeader> prev_segment_header;
-    std::unique_ptr<std::vector<uint8_t>> nal;
+    NalUnit nal = NalUnit(nullptr, 0);
     std::size_t nal_offset;
     bool success;
   };
   void WorkerMain();
 
   std::vector<std::thread> worker_threads_;
-  std::mutex global_mutex_;
-  std::condition_variable wait_work_cond_;
+  WorkScheduler scheduler_;
+  // Only guards handing over work items, scheduling is done without it
+  std::mutex work_mutex_;
   std::condition_variable work_done_cond_;
-  std::list<WorkItem> pending_work_;
+  std::unordered_map<WorkScheduler::JobId, WorkItem> pending_work_;
   std::deque<WorkItem> finished_work_;
   int jobs_in_flight_ = 0;
-  bool running_ = true;
 };
 
 }   // namespace xvc
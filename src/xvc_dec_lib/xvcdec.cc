@@ -153,18 +153,21 @@ extern "C" {
   }
 
   static xvc_dec_return_code
-    xvc_dec_decoder_decode_nal(xvc_decoder *decoder, const uint8_t *nal_unit,
-                               size_t nal_unit_size, int64_t user_data) {
+    xvc_dec_decoder_decode_nal2(xvc_decoder *decoder, const uint8_t *nal_unit,
+                                size_t nal_unit_size, int64_t user_data,
+                                xvc_dec_nal_release_callback nal_release,
+                                void *opaque) {
     if (!decoder || !nal_unit || nal_unit_size < 1) {
       return XVC_DEC_INVALID_ARGUMENT;
     }
     xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
-    size_t decoded_bytes =
-      lib_decoder->DecodeNal(nal_unit, nal_unit_size, user_data);
+    // Released when going out of scope unless buffered by the decoder
+    xvc::NalUnit nal(nal_unit, nal_unit_size, nal_release, opaque);
+    size_t decoded_bytes = lib_decoder->DecodeNal(&nal, user_data);
     if (decoded_bytes != xvc::Decoder::kInvalidNal &&
         decoded_bytes < nal_unit_size) {
-      lib_decoder->DecodeNal(nal_unit + decoded_bytes,
-                             nal_unit_size - decoded_bytes, user_data);
+      nal.Skip(decoded_bytes);
+      lib_decoder->DecodeNal(&nal, user_data);
     }
 
     xvc::Decoder::State dec_state = lib_decoder->GetState();
@@ -182,6 +185,13 @@ extern "C" {
     return XVC_DEC_OK;
   }
 
+  static xvc_dec_return_code
+    xvc_dec_decoder_decode_nal(xvc_decoder *decoder, const uint8_t *nal_unit,
+                               size_t nal_unit_size, int64_t user_data) {
+    return xvc_dec_decoder_decode_nal2(decoder, nal_unit, nal_unit_size,
+                                       user_data, nullptr, nullptr);
+  }
+
   static xvc_dec_return_code
     xvc_dec_decoder_get_picture(xvc_decoder *decoder,
                                 xvc_decoded_picture *pic_bytes) {
@@ -195,6 +205,28 @@ extern "C" {
     return XVC_DEC_OK;
   }
 
+  static xvc_dec_return_code
+    xvc_dec_decoder_get_picture_ref(xvc_decoder *decoder,
+                                    xvc_decoded_picture **out_pic) {
+    if (!decoder || !out_pic) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    xvc::Decoder *lib_decoder = reinterpret_cast<xvc::Decoder*>(decoder);
+    *out_pic = lib_decoder->GetDecodedPictureRef();
+    if (!*out_pic) {
+      return XVC_DEC_NO_DECODED_PIC;
+    }
+    return XVC_DEC_OK;
+  }
+
+  static
+    xvc_dec_return_code xvc_dec_picture_release(xvc_decoded_picture *pic) {
+    if (pic && !xvc::Decoder::ReleasePicture(pic)) {
+      return XVC_DEC_INVALID_ARGUMENT;
+    }
+    return XVC_DEC_OK;
+  }
+
   static
     xvc_dec_return_code xvc_dec_decoder_flush(xvc_decoder *decoder) {
     if (!decoder) {
@@ -275,6 +307,9 @@ extern "C" {
     &xvc_dec_decoder_flush,
     &xvc_dec_decoder_check_conformance,
     &xvc_dec_get_error_text,
+    &xvc_dec_decoder_get_picture_ref,
+    &xvc_dec_picture_release,
+    &xvc_dec_decoder_decode_nal2,
   };
 
   const xvc_decoder_api* xvc_decoder_api_get() {
@@ -40,7 +40,7 @@ extern "C" {
 #define XVC_DEC_API
 #endif
 
-#define XVC_DEC_API_VERSION   1
+#define XVC_DEC_API_VERSION   3
 
   typedef enum {
     XVC_DEC_OK = 0,
@@ -98,6 +98,8 @@ extern "C" {
   // Represents a decoded picture
   // Lifecycle managed by api->picture_create & api->picture_destory
   // Populated using api->decoder_get_picture
+  // Alternatively created by api->decoder_get_picture_ref and released by
+  // api->picture_release
   typedef struct xvc_decoded_picture {
     const char* bytes;  // Address of first picture sample
     size_t size;        // Number of pic bytes for all planes (incl. padding)
@@ -111,6 +113,11 @@ extern "C" {
   // Lifecycle managed by api->decoder_create & api->decoder_destroy
   typedef struct xvc_decoder xvc_decoder;
 
+  // Called when the decoder no longer needs a nal unit passed to
+  // api->decoder_decode_nal2, nal_unit is the pointer that was passed
+  typedef void(*xvc_dec_nal_release_callback)(void *opaque,
+                                              const uint8_t *nal_unit);
+
   // xvc decoder configuration
   // Lifecycle managed by api->parameters_create & api->parameters_destroy
   typedef struct xvc_decoder_parameters {
@@ -161,6 +168,31 @@ extern "C" {
                                                     int *num);
     // Misc
     const char*(*xvc_dec_get_error_text)(xvc_dec_return_code error_code);
+    // Get next output picture that is available in display order.
+    // The picture and its sample data stays valid until released using
+    // picture_release, regardless of other API calls. If the output format
+    // matches the decoded picture no copy is made, instead the planes point
+    // directly into the decoded picture (bytes is then null and stride
+    // includes padding). Releasing a picture that was not returned by
+    // decoder_get_picture_ref, or releasing it twice, gives
+    // XVC_DEC_INVALID_ARGUMENT.
+    xvc_dec_return_code(*decoder_get_picture_ref)(xvc_decoder *decoder,
+                                                  xvc_decoded_picture
+                                                  **out_pic);
+    xvc_dec_return_code(*picture_release)(xvc_decoded_picture *pic);
+    // Same as decoder_decode_nal but the nal unit is read in place instead of
+    // being copied. The nal unit must stay valid until nal_release is called,
+    // which happens exactly once from within a later (or the same) call to
+    // the decoder api on the calling thread, at the latest in
+    // decoder_destroy. It is not called if XVC_DEC_INVALID_ARGUMENT is
+    // returned. The callback must not call the decoder api.
+    xvc_dec_return_code(*decoder_decode_nal2)(xvc_decoder *decoder,
+                                              const uint8_t *nal_unit,
+                                              size_t nal_unit_size,
+                                              int64_t user_data,
+                                              xvc_dec_nal_release_callback
+                                              nal_release,
+                                              void *opaque);
   } xvc_decoder_api;
 
   // Starting point for using the xvc decoder api
@@ -32,8 +32,12 @@
 
 namespace xvc {
 
-CuCache::CuCache(PictureData *pic_data)
-  : pic_data_(pic_data) {
+CuCache::CuCache(PictureData *pic_data) {
+  SetPictureData(pic_data);
+}
+
+void CuCache::SetPictureData(PictureData *pic_data) {
+  pic_data_ = pic_data;
   for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
     const CuTree cu_tree = static_cast<CuTree>(tree_idx);
     const int max_depth = static_cast<int>(cu_cache_[tree_idx].size());
@@ -41,6 +45,7 @@ CuCache::CuCache(PictureData *pic_data)
       for (int quad = 0; quad < constants::kQuadSplit; quad++) {
         for (int part = 0; part < kNumCachePartitions; part++) {
           CacheEntry &cache_entry = cu_cache_[tree_idx][depth][quad][part];
+          cache_entry.features = 0;
           for (int cache_idx = 0; cache_idx < kNumCuPerEntry; cache_idx++) {
             cache_entry.valid[cache_idx] = false;
             cache_entry.cu[cache_idx] =
@@ -52,22 +57,6 @@ CuCache::CuCache(PictureData *pic_data)
   }
 }
 
-CuCache::~CuCache() {
-  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
-    const int max_depth = static_cast<int>(cu_cache_[tree_idx].size());
-    for (int depth = 0; depth < max_depth; depth++) {
-      for (int quad = 0; quad < constants::kQuadSplit; quad++) {
-        for (int part = 0; part < kNumCachePartitions; part++) {
-          CacheEntry &cache_entry = cu_cache_[tree_idx][depth][quad][part];
-          for (int cu_idx = 0; cu_idx < kNumCuPerEntry; cu_idx++) {
-            pic_data_->ReleaseCu(cache_entry.cu[cu_idx]);
-          }
-        }
-      }
-    }
-  }
-}
-
 void CuCache::Invalidate(CuTree cu_tree, int cu_depth) {
   const int tree_idx = static_cast<int>(cu_tree);
   auto clear_depth = [this, &tree_idx](int depth) {
@@ -51,7 +51,9 @@ public:
     bool any_skip;
   };
   explicit CuCache(PictureData *pic_data);
-  ~CuCache();
+  // Binds the cache to a new picture, cached cu objects of the previous
+  // picture are recycled by its picture data and are not released here
+  void SetPictureData(PictureData *pic_data);
 
   void Invalidate(CuTree cu_tree, int depth);
   Result Lookup(const CodingUnit &cu);
@@ -84,7 +86,7 @@ private:
   CacheEntry* Find(const CodingUnit &cu);
   CachePartition DetermineCuPartition(const CodingUnit &cu);
 
-  PictureData* const pic_data_;
+  PictureData *pic_data_;
   std::array<std::array<std::array<std::array<CacheEntry,
     kNumCachePartitions>,
     constants::kQuadSplit>,
@@ -50,33 +50,45 @@ CuEncoder::CuEncoder(const EncoderSimdFunctions &simd,
   : TransformEncoder(simd, rec_pic->GetBitdepth(),
                      pic_data->GetMaxNumComponents(),
                      orig_pic, encoder_settings),
-  orig_pic_(orig_pic),
+  orig_pic_(&orig_pic),
   encoder_settings_(encoder_settings),
-  rec_pic_(*rec_pic),
-  pic_data_(*pic_data),
+  rec_pic_(rec_pic),
+  pic_data_(pic_data),
   inter_search_(simd, *pic_data, orig_pic, *rec_pic,
                 *pic_data->GetRefPicLists(), encoder_settings),
   intra_search_(simd, rec_pic->GetBitdepth(), *pic_data, orig_pic,
                 encoder_settings),
-  cu_writer_(pic_data_, &intra_search_),
+  cu_writer_(*pic_data, &intra_search_),
   cu_cache_(pic_data) {
-  for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
-    const CuTree cu_tree = static_cast<CuTree>(tree_idx);
-    const int max_depth = static_cast<int>(rdo_temp_cu_[tree_idx].size());
-    for (int depth = 0; depth < max_depth; depth++) {
-      rdo_temp_cu_[tree_idx][depth] =
-        pic_data_.CreateCu(cu_tree, depth, -1, -1, 0, 0);
-    }
-  }
+  AllocateTempCu();
+}
+
+void CuEncoder::StartPicture(const YuvPicture &orig_pic, YuvPicture *rec_pic,
+                             PictureData *pic_data) {
+  assert(rec_pic->GetBitdepth() == orig_pic_->GetBitdepth());
+  orig_pic_ = &orig_pic;
+  rec_pic_ = rec_pic;
+  pic_data_ = pic_data;
+  inter_search_.SetPicture(*pic_data, orig_pic, *rec_pic,
+                           *pic_data->GetRefPicLists());
+  intra_search_.SetPicture(*pic_data, orig_pic);
+  cu_writer_.SetPictureData(*pic_data);
+  cu_cache_.SetPictureData(pic_data);
+  last_ctu_frac_bits_ = 0;
+  ctu_qp_offsets_ = nullptr;
+  AllocateTempCu();
 }
 
-CuEncoder::~CuEncoder() {
+void CuEncoder::AllocateTempCu() {
+  // Invariant: Cu objects are recycled by the picture data when it is
+  // initialized for a new picture, so they are allocated for every picture
+  // and never released back
   for (int tree_idx = 0; tree_idx < constants::kMaxNumCuTrees; tree_idx++) {
+    const CuTree cu_tree = static_cast<CuTree>(tree_idx);
     const int max_depth = static_cast<int>(rdo_temp_cu_[tree_idx].size());
     for (int depth = 0; depth < max_depth; depth++) {
-      // Invariant: These must be released after coding each picture since
-      // cu objects are recycled without any reference counting
-      pic_data_.ReleaseCu(rdo_temp_cu_[tree_idx][depth]);
+      rdo_temp_cu_[tree_idx][depth] =
+        pic_data_->CreateCu(cu_tree, depth, -1, -1, 0, 0);
     }
   }
 }
@@ -84,20 +96,29 @@ CuEncoder::~CuEncoder() {
 void CuEncoder::EncodeCtu(int rsaddr, SyntaxWriter *bitstream_writer) {
   uint32_t frac_bits = bitstream_writer->GetFractionalBits();
   if (!EncoderSettings::kEncoderCountActualWrittenBits) {
-    frac_bits = rsaddr == 0 ? 0 : last_ctu_frac_bits_;
+    const int ctu_x = rsaddr % pic_data_->GetNumCtuX();
+    const int ctu_y = rsaddr / pic_data_->GetNumCtuX();
+    const bool slice_start =
+      ctu_x == 0 && pic_data_->IsSliceStart(ctu_y << constants::kCtuSizeLog2);
+    frac_bits = slice_start ? 0 : last_ctu_frac_bits_;
   }
   RdoSyntaxWriter rdo_writer(*bitstream_writer, 0, frac_bits);
 
-  CodingUnit *ctu = pic_data_.GetCtu(CuTree::Primary, rsaddr);
-  int ctu_qp = pic_data_.GetPicQp()->GetQpRaw(YuvComponent::kY);
+  CodingUnit *ctu = pic_data_->GetCtu(CuTree::Primary, rsaddr);
+  int ctu_qp = pic_data_->GetPicQp()->GetQpRaw(YuvComponent::kY);
   if (encoder_settings_.adaptive_qp) {
-    ctu_qp += CalcDeltaQpFromVariance(ctu);
+    int delta_qp = CalcDeltaQpFromVariance(ctu);
+    if (ctu_qp_offsets_) {
+      delta_qp = util::Clip3(delta_qp + (*ctu_qp_offsets_)[rsaddr],
+                             kMinDeltaQp, kMaxDeltaQp);
+    }
+    ctu_qp += delta_qp;
   }
   ctu->SetQp(ctu_qp);
   CompressCu(&ctu, 0, SplitRestriction::kNone, &rdo_writer, ctu->GetQp());
-  pic_data_.SetCtu(CuTree::Primary, rsaddr, ctu);
-  if (pic_data_.HasSecondaryCuTree()) {
-    CodingUnit *ctu2 = pic_data_.GetCtu(CuTree::Secondary, rsaddr);
+  pic_data_->SetCtu(CuTree::Primary, rsaddr, ctu);
+  if (pic_data_->HasSecondaryCuTree()) {
+    CodingUnit *ctu2 = pic_data_->GetCtu(CuTree::Secondary, rsaddr);
     ctu2->SetQp(ctu_qp);
     if (EncoderSettings::kEncoderStrictRdoBitCounting) {
       CompressCu(&ctu2, 0, SplitRestriction::kNone, &rdo_writer, ctu2->GetQp());
@@ -106,7 +127,7 @@ void CuEncoder::EncodeCtu(int rsaddr, SyntaxWriter *bitstream_writer) {
       CompressCu(&ctu2, 0, SplitRestriction::kNone, &rdo_writer2,
                  ctu2->GetQp());
     }
-    pic_data_.SetCtu(CuTree::Secondary, rsaddr, ctu2);
+    pic_data_->SetCtu(CuTree::Secondary, rsaddr, ctu2);
   }
   last_ctu_frac_bits_ = rdo_writer.GetFractionalBits();
 
@@ -130,7 +151,7 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
   const int cu_tree = static_cast<int>(cu->GetCuTree());
   const int depth = cu->GetDepth();
   const bool do_quad_split = cu->GetBinaryDepth() == 0 &&
-    depth < pic_data_.GetMaxDepth(cu->GetCuTree());
+    depth < pic_data_->GetMaxDepth(cu->GetCuTree());
   const bool can_binary_split = cu->IsBinarySplitValid() &&
     cu->IsFullyWithinPicture() &&
     cu->GetWidth(YuvComponent::kY) <= kMaxTrSize &&
@@ -170,7 +191,7 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
     Bits full_bits = best_writer.GetNumWrittenBits() - start_bits;
     best_cost.cost =
       best_cost.dist + static_cast<Cost>(full_bits * qp.GetLambda() + 0.5);
-    cu->SaveStateTo(best_state, rec_pic_);
+    cu->SaveStateTo(best_state, *rec_pic_);
   }
 
   // Skip split eval speed-up
@@ -203,11 +224,11 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
       }
       best_cost = split_cost;
       best_writer = splitcu_writer;
-      cu->SaveStateTo(best_state, rec_pic_);
+      cu->SaveStateTo(best_state, *rec_pic_);
     } else {
       // Restore (previous) best state
-      cu->LoadStateFrom(*best_state, &rec_pic_);
-      pic_data_.MarkUsedInPic(cu);
+      cu->LoadStateFrom(*best_state, rec_pic_);
+      pic_data_->MarkUsedInPic(cu);
     }
   }
 
@@ -234,11 +255,11 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
       }
       best_cost = split_cost;
       best_writer = splitcu_writer;
-      cu->SaveStateTo(best_state, rec_pic_);
+      cu->SaveStateTo(best_state, *rec_pic_);
     } else {
       // Restore (previous) best state
-      cu->LoadStateFrom(*best_state, &rec_pic_);
-      pic_data_.MarkUsedInPic(cu);
+      cu->LoadStateFrom(*best_state, rec_pic_);
+      pic_data_->MarkUsedInPic(cu);
     }
   }
 
@@ -263,8 +284,8 @@ Distortion CuEncoder::CompressCu(CodingUnit **best_cu, int rdo_depth,
       return split_cost.dist;
     } else {
       // Restore (previous) best state
-      cu->LoadStateFrom(*best_state, &rec_pic_);
-      pic_data_.MarkUsedInPic(cu);
+      cu->LoadStateFrom(*best_state, rec_pic_);
+      pic_data_->MarkUsedInPic(cu);
     }
   }
 
@@ -281,7 +302,7 @@ CuEncoder::CompressSplitCu(CodingUnit *cu, int rdo_depth, const Qp &qp,
     cu->UnSplit();
   }
   cu->Split(split_type);
-  pic_data_.ClearMarkCuInPic(cu);
+  pic_data_->ClearMarkCuInPic(cu);
   Distortion dist = 0;
   Bits start_bits = rdo_writer->GetNumWrittenBits();
   SplitRestriction sub_split_restriction = SplitRestriction::kNone;
@@ -310,8 +331,6 @@ int CuEncoder::CalcDeltaQpFromVariance(const CodingUnit *cu) {
   const double kOffset = 15;
   const int kVarBlocksize = 16;
   const int kMeanDiv = 2;
-  const int kMinQpOffset = -3;
-  const int kMaxQpOffset = 7;
   const YuvComponent luma = YuvComponent::kY;
   const int x = cu->GetPosX(luma);
   const int y = cu->GetPosY(luma);
@@ -337,17 +356,17 @@ int CuEncoder::CalcDeltaQpFromVariance(const CodingUnit *cu) {
   std::vector<uint64_t> v(h * w, std::numeric_limits<uint64_t>::max());
   int blocks = 0;
   for (int i = 0; i < h; i++) {
-    if (y + i * kVarBlocksize >= pic_data_.GetPictureHeight(luma)) {
+    if (y + i * kVarBlocksize >= pic_data_->GetPictureHeight(luma)) {
       continue;
     }
-    const Sample *orig = orig_pic_.GetSamplePtr(luma, x, y) +
-      i * kVarBlocksize * orig_pic_.GetStride(luma);
+    const Sample *orig = orig_pic_->GetSamplePtr(luma, x, y) +
+      i * kVarBlocksize * orig_pic_->GetStride(luma);
     for (int j = 0; j < w; j++) {
-      if (x + j * kVarBlocksize >= pic_data_.GetPictureWidth(luma)) {
+      if (x + j * kVarBlocksize >= pic_data_->GetPictureWidth(luma)) {
         continue;
       }
       uint64_t variance =
-        calc_variance(orig, kVarBlocksize, orig_pic_.GetStride(luma));
+        calc_variance(orig, kVarBlocksize, orig_pic_->GetStride(luma));
       v[blocks++] = variance;
       orig += kVarBlocksize;
     }
@@ -356,10 +375,10 @@ int CuEncoder::CalcDeltaQpFromVariance(const CodingUnit *cu) {
   uint64_t variance;
   variance = 1 + v[blocks / kMeanDiv];
 
-  int bd = orig_pic_.GetBitdepth();
+  int bd = orig_pic_->GetBitdepth();
   double dqp = kStrength * (1.5 * std::log(variance) - kOffset - 2 * (bd - 8));
 
-  return util::Clip3(static_cast<int>(dqp), kMinQpOffset, kMaxQpOffset);
+  return util::Clip3(static_cast<int>(dqp), kMinDeltaQp, kMaxDeltaQp);
 }
 
 
@@ -383,7 +402,7 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
     cu->CopyPredictionDataFrom(*cache_result.cu);
     best_cost.cost = 0;
     best_cost.dist = CompressFast(cu, qp, *writer);
-  } else if (pic_data_.IsIntraPic()) {
+  } else if (pic_data_->IsIntraPic()) {
     // Intra pic
     best_cost = CompressIntra(cu, qp, *writer);
   } else {
@@ -391,7 +410,7 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
                                  qp, rdo_depth, cache_result, *writer);
     cu = *best_cu;
   }
-  pic_data_.MarkUsedInPic(cu);
+  pic_data_->MarkUsedInPic(cu);
 
   if (cache_result.cacheable) {
     // Save prediction data in cache
@@ -401,7 +420,7 @@ Distortion CuEncoder::CompressNoSplit(CodingUnit **best_cu, int rdo_depth,
   if (EncoderSettings::kEncoderStrictRdoBitCounting) {
     cu_writer_.WriteSplit(*cu, split_restriction, writer);
   }
-  for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
+  for (YuvComponent comp : pic_data_->GetComponents(cu->GetCuTree())) {
     cu_writer_.WriteComponent(*cu, comp, writer);
   }
   if (!EncoderSettings::kEncoderStrictRdoBitCounting) {
@@ -415,14 +434,14 @@ Distortion CuEncoder::CompressFast(CodingUnit *cu, const Qp &qp,
   assert(cu->GetSplit() == SplitType::kNone);
   Distortion dist = 0;
   if (cu->IsIntra()) {
-    for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
+    for (YuvComponent comp : pic_data_->GetComponents(cu->GetCuTree())) {
       dist +=
-        intra_search_.CompressIntraFast(cu, comp, qp, writer, this, &rec_pic_);
+        intra_search_.CompressIntraFast(cu, comp, qp, writer, this, rec_pic_);
     }
   } else {
-    for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
+    for (YuvComponent comp : pic_data_->GetComponents(cu->GetCuTree())) {
       dist += inter_search_.CompressInterFast(cu, comp, qp, writer, this,
-                                              &rec_pic_);
+                                              rec_pic_);
     }
   }
   return dist;
@@ -453,7 +472,7 @@ CuEncoder::CompressInterPic(CodingUnit **best_cu_ref, CodingUnit **temp_cu_ref,
   const auto save_if_best_cost = [&](RdoCost cost) {
     if (cost < best_cost) {
       best_cost = cost;
-      cu->SaveStateTo(best_state, rec_pic_);
+      cu->SaveStateTo(best_state, *rec_pic_);
       std::swap(best_cu, cu);
     }
   };
@@ -480,7 +499,7 @@ CuEncoder::CompressInterPic(CodingUnit **best_cu_ref, CodingUnit **temp_cu_ref,
     save_if_best_cost(cost);
   }
 
-  if (!fast_skip_inter && pic_data_.GetUseLocalIlluminationCompensation() &&
+  if (!fast_skip_inter && pic_data_->GetUseLocalIlluminationCompensation() &&
       !Restrictions::Get().disable_ext2_inter_local_illumination_comp) {
     RdoCost cost = CompressInter(cu, qp, writer, RdMode::INTER_LIC,
                                  best_cost.cost);
@@ -493,7 +512,7 @@ CuEncoder::CompressInterPic(CodingUnit **best_cu_ref, CodingUnit **temp_cu_ref,
     save_if_best_cost(cost);
   }
 
-  if (pic_data_.GetUseLocalIlluminationCompensation() &&
+  if (pic_data_->GetUseLocalIlluminationCompensation() &&
       !Restrictions::Get().disable_ext2_inter_local_illumination_comp &&
       !Restrictions::Get().disable_ext2_inter_adaptive_fullpel_mv) {
     RdoCost cost = CompressInter(cu, qp, writer, RdMode::INTER_LIC_FULLPEL,
@@ -508,7 +527,7 @@ CuEncoder::CompressInterPic(CodingUnit **best_cu_ref, CodingUnit **temp_cu_ref,
   }
 
   assert(best_cost.cost < std::numeric_limits<Cost>::max());
-  best_cu->LoadStateFrom(*best_state, &rec_pic_);
+  best_cu->LoadStateFrom(*best_state, rec_pic_);
   *best_cu_ref = best_cu;
   *temp_cu_ref = cu;
   return best_cost;
@@ -522,15 +541,15 @@ CuEncoder::CompressIntra(CodingUnit *cu, const Qp &qp,
   cu->SetSkipFlag(false);
   RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
   Distortion dist = 0;
-  if (YuvComponent::kY == pic_data_.GetComponents(cu->GetCuTree())[0]) {
+  if (YuvComponent::kY == pic_data_->GetComponents(cu->GetCuTree())[0]) {
     dist += intra_search_.CompressIntraLuma(cu, qp, bitstream_writer, this,
-                                            &rec_pic_);
+                                            rec_pic_);
     cu_writer_.WriteComponent(*cu, YuvComponent::kY, &rdo_writer);
   }
-  if (pic_data_.GetComponents(cu->GetCuTree()).size() > 1) {
+  if (pic_data_->GetComponents(cu->GetCuTree()).size() > 1) {
     // TODO(PH) This should optimally use rdo_writer as starting state
     dist += intra_search_.CompressIntraChroma(cu, qp, bitstream_writer, this,
-                                              &rec_pic_);
+                                              rec_pic_);
     cu_writer_.WriteComponent(*cu, YuvComponent::kU, &rdo_writer);
     cu_writer_.WriteComponent(*cu, YuvComponent::kV, &rdo_writer);
   }
@@ -569,7 +588,7 @@ CuEncoder::CompressInter(CodingUnit *cu, const Qp &qp,
   }
   Distortion dist =
     inter_search_.CompressInter(cu, qp, bitstream_writer, search_flags,
-                                best_cu_cost, this, &rec_pic_);
+                                best_cu_cost, this, rec_pic_);
   if (dist == std::numeric_limits<Distortion>::max()) {
     return RdoCost(std::numeric_limits<Cost>::max(), dist);
   }
@@ -616,7 +635,7 @@ CuEncoder::CompressMerge(CodingUnit *cu, const Qp &qp,
       Distortion dist =
         inter_search_.CompressMergeCand(cu, qp, bitstream_writer, merge_list,
                                         merge_idx, force_skip, best_cu_cost,
-                                        this, &rec_pic_);
+                                        this, rec_pic_);
       RdoCost cost = GetCuCostWithoutSplit(*cu, qp, bitstream_writer, dist);
       if (!cu->GetHasAnyCbf()) {
         skip_evaluated[merge_idx] = true;
@@ -625,7 +644,7 @@ CuEncoder::CompressMerge(CodingUnit *cu, const Qp &qp,
         best_cu_cost = std::min(cost.cost, best_cu_cost);
         best_cost = cost;
         best_merge_idx = merge_idx;
-        cu->SaveStateTo(&best_transform_state, rec_pic_);
+        cu->SaveStateTo(&best_transform_state, *rec_pic_);
         if (!cu->GetHasAnyCbf() && !force_skip) {
           // Encoder optimization, assume skip is always best
           break;
@@ -635,7 +654,7 @@ CuEncoder::CompressMerge(CodingUnit *cu, const Qp &qp,
   }
   cu->SetMergeIdx(best_merge_idx);
   inter_search_.ApplyMergeCand(cu, merge_list[best_merge_idx]);
-  cu->LoadStateFrom(best_transform_state, &rec_pic_);
+  cu->LoadStateFrom(best_transform_state, rec_pic_);
   cu->SetSkipFlag(!cu->GetHasAnyCbf() &&
                   !Restrictions::Get().disable_inter_skip_mode);
   return best_cost;
@@ -655,19 +674,19 @@ CuEncoder::CompressAffineMerge(CodingUnit *cu, const Qp &qp,
   AffineMergeCandidate merge_cand = inter_search_.GetAffineMergeCand(*cu);
   Distortion dist =
     inter_search_.CompressAffineMerge(cu, qp, bitstream_writer, merge_cand,
-                                      false, best_cu_cost, this, &rec_pic_);
+                                      false, best_cu_cost, this, rec_pic_);
   RdoCost best_cost = GetCuCostWithoutSplit(*cu, qp, bitstream_writer, dist);
   if (cu->GetHasAnyCbf()) {
-    cu->SaveStateTo(&best_transform_state, rec_pic_);
+    cu->SaveStateTo(&best_transform_state, *rec_pic_);
     Distortion dist_skip =
       inter_search_.CompressAffineMerge(cu, qp, bitstream_writer, merge_cand,
-                                        true, best_cu_cost, this, &rec_pic_);
+                                        true, best_cu_cost, this, rec_pic_);
     RdoCost cost = GetCuCostWithoutSplit(*cu, qp, bitstream_writer, dist_skip);
     if (cost < best_cost) {
       return cost;
     }
     cu->SetSkipFlag(false);
-    cu->LoadStateFrom(best_transform_state, &rec_pic_);
+    cu->LoadStateFrom(best_transform_state, rec_pic_);
   }
   return best_cost;
 }
@@ -677,7 +696,7 @@ CuEncoder::GetCuCostWithoutSplit(const CodingUnit &cu, const Qp &qp,
                                  const SyntaxWriter &bitstream_writer,
                                  Distortion ssd) {
   RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
-  for (YuvComponent comp : pic_data_.GetComponents(cu.GetCuTree())) {
+  for (YuvComponent comp : pic_data_->GetComponents(cu.GetCuTree())) {
     cu_writer_.WriteComponent(cu, comp, &rdo_writer);
   }
   Bits bits = rdo_writer.GetNumWrittenBits();
@@ -689,25 +708,25 @@ void CuEncoder::WriteCtu(int rsaddr, SyntaxWriter *writer) {
   if (EncoderSettings::kEncoderCountActualWrittenBits) {
     writer->ResetBitCounting();
   }
-  CodingUnit *ctu = pic_data_.GetCtu(CuTree::Primary, rsaddr);
-  bool write_delta_qp = cu_writer_.WriteCtu(ctu, &pic_data_, writer);
-  if (pic_data_.HasSecondaryCuTree()) {
-    CodingUnit *ctu2 = pic_data_.GetCtu(CuTree::Secondary, rsaddr);
-    write_delta_qp |= cu_writer_.WriteCtu(ctu2, &pic_data_, writer);;
+  CodingUnit *ctu = pic_data_->GetCtu(CuTree::Primary, rsaddr);
+  bool write_delta_qp = cu_writer_.WriteCtu(ctu, pic_data_, writer);
+  if (pic_data_->HasSecondaryCuTree()) {
+    CodingUnit *ctu2 = pic_data_->GetCtu(CuTree::Secondary, rsaddr);
+    write_delta_qp |= cu_writer_.WriteCtu(ctu2, pic_data_, writer);;
   }
 
   const int predicted_qp = ctu->GetPredictedQp();
-  if (pic_data_.GetAdaptiveQp() > 0 && write_delta_qp) {
+  if (pic_data_->GetAdaptiveQp() > 0 && write_delta_qp) {
     writer->WriteQp(ctu->GetQp().GetQpRaw(YuvComponent::kY),
                     predicted_qp,
-                    pic_data_.GetAdaptiveQp());
+                    pic_data_->GetAdaptiveQp());
   } else {
     // Delta qp is not written if there was no cbf in the entire CTU.
-    const int derived_qp = pic_data_.GetAdaptiveQp() == 2 ? predicted_qp :
-      pic_data_.GetPicQp()->GetQpRaw(YuvComponent::kY);
+    const int derived_qp = pic_data_->GetAdaptiveQp() == 2 ? predicted_qp :
+      pic_data_->GetPicQp()->GetQpRaw(YuvComponent::kY);
     SetQpForAllCusInCtu(ctu, derived_qp);
-    if (pic_data_.HasSecondaryCuTree()) {
-      CodingUnit *ctu2 = pic_data_.GetCtu(CuTree::Secondary, rsaddr);
+    if (pic_data_->HasSecondaryCuTree()) {
+      CodingUnit *ctu2 = pic_data_->GetCtu(CuTree::Secondary, rsaddr);
       SetQpForAllCusInCtu(ctu2, derived_qp);
     }
   }
@@ -724,7 +743,7 @@ void CuEncoder::SetQpForAllCusInCtu(CodingUnit *ctu, int qp) {
   for (int i = 0; i < h; i += constants::kMinBlockSize) {
     for (int j = 0; j < w; j += constants::kMinBlockSize) {
       CodingUnit *tmp_cu =
-        pic_data_.GetCuAtForModification(ctu->GetCuTree(),
+        pic_data_->GetCuAtForModification(ctu->GetCuTree(),
                                          ctu->GetPosX(YuvComponent::kY) + j,
                                          ctu->GetPosY(YuvComponent::kY) + i);
       if (tmp_cu) {
@@ -736,7 +755,7 @@ void CuEncoder::SetQpForAllCusInCtu(CodingUnit *ctu, int qp) {
 
 
 bool CuEncoder::CanSkipAnySplitForCu(const CodingUnit &cu) const {
-  const int binary_depth_threshold = pic_data_.IsHighestLayer() ? 2 : 3;
+  const int binary_depth_threshold = pic_data_->IsHighestLayer() ? 2 : 3;
   return cu.GetSkipFlag() && cu.GetBinaryDepth() >= binary_depth_threshold;
 }
 
@@ -745,9 +764,9 @@ CuEncoder::CanSkipQuadSplitForCu(const CodingUnit &cu,
                                  bool binary_depth_greater_than_one) const {
   const YuvComponent comp = YuvComponent::kY;
   const CodingUnit *cu_top_left =
-    pic_data_.GetCuAt(cu.GetCuTree(), cu.GetPosX(comp), cu.GetPosY(comp));
+    pic_data_->GetCuAt(cu.GetCuTree(), cu.GetPosX(comp), cu.GetPosY(comp));
   const CodingUnit *cu_bottom_right =
-    pic_data_.GetCuAt(cu.GetCuTree(), cu.GetPosX(comp) + cu.GetWidth(comp) - 1,
+    pic_data_->GetCuAt(cu.GetCuTree(), cu.GetPosX(comp) + cu.GetWidth(comp) - 1,
                       cu.GetPosY(comp) + cu.GetHeight(comp) - 1);
   if (encoder_settings_.fast_quad_split_based_on_binary_split == 1 &&
       binary_depth_greater_than_one) {
@@ -756,16 +775,16 @@ CuEncoder::CanSkipQuadSplitForCu(const CodingUnit &cu,
   const bool best_is_no_split = cu_top_left->GetBinaryDepth() == 0;
   const bool best_is_single_bt_split = cu_top_left->GetBinaryDepth() == 1 &&
     cu_bottom_right->GetBinaryDepth() == 1;
-  switch (pic_data_.GetMaxBinarySplitDepth(cu.GetCuTree())) {
+  switch (pic_data_->GetMaxBinarySplitDepth(cu.GetCuTree())) {
     case 1:
-      return best_is_no_split && !pic_data_.IsIntraPic();
+      return best_is_no_split && !pic_data_->IsIntraPic();
 
     case 2:
-      return best_is_no_split && !pic_data_.IsIntraPic();
+      return best_is_no_split && !pic_data_->IsIntraPic();
 
     case 3:
       return best_is_no_split ||
-        (best_is_single_bt_split && !pic_data_.IsIntraPic());
+        (best_is_single_bt_split && !pic_data_->IsIntraPic());
 
     case 4:
       return best_is_no_split || best_is_single_bt_split;
@@ -44,10 +44,23 @@ public:
   CuEncoder(const EncoderSimdFunctions &simd, const YuvPicture &orig_pic,
             YuvPicture *rec_pic, PictureData *pic_data,
             const EncoderSettings &encoder_settings);
-  ~CuEncoder();
+  // Rebinds the encoder to a new picture of the same format, all buffers
+  // are kept so that one encoder can be reused for many pictures
+  void StartPicture(const YuvPicture &orig_pic, YuvPicture *rec_pic,
+                    PictureData *pic_data);
+  void SetMotionPreanalysis(const MotionPreanalysis *motion_preanalysis) {
+    inter_search_.SetMotionPreanalysis(motion_preanalysis);
+  }
+  // Temporal qp offset per ctu used with adaptive qp, cleared by StartPicture
+  void SetCtuQpOffsets(const std::vector<int> *ctu_qp_offsets) {
+    ctu_qp_offsets_ = ctu_qp_offsets;
+  }
   void EncodeCtu(int rsaddr, SyntaxWriter *writer);
 
 private:
+  // Range of ctu qp relative to picture qp that can be signaled
+  static const int kMinDeltaQp = -3;
+  static const int kMaxDeltaQp = 7;
   enum class RdMode {
     INTER_ME,
     INTER_FULLPEL,
@@ -56,6 +69,7 @@ private:
   };
   struct RdoCost;
 
+  void AllocateTempCu();
   Distortion CompressCu(CodingUnit **cu, int rdo_depth,
                         SplitRestriction split_restiction,
                         RdoSyntaxWriter *rdo_writer,
@@ -93,15 +107,16 @@ private:
   bool CanSkipQuadSplitForCu(const CodingUnit &cu,
                              bool binary_depth_greater_than_one) const;
 
-  const YuvPicture &orig_pic_;
+  const YuvPicture *orig_pic_;
   const EncoderSettings &encoder_settings_;
-  YuvPicture &rec_pic_;
-  PictureData &pic_data_;
+  YuvPicture *rec_pic_;
+  PictureData *pic_data_;
   InterSearch inter_search_;
   IntraSearch intra_search_;
   CuWriter cu_writer_;
   CuCache cu_cache_;
   uint32_t last_ctu_frac_bits_ = 0;
+  const std::vector<int> *ctu_qp_offsets_ = nullptr;
   // +2 for allow access to one depth lower than smallest CU in RDO
   std::array<CodingUnit::ReconstructionState,
     constants::kMaxBlockDepth + 2> temp_cu_state_;
@@ -49,7 +49,7 @@ void CuWriter::WriteCu(CodingUnit *cu, SplitRestriction split_restriction,
     }
   } else {
     cu_map->MarkUsedInPic(cu);
-    for (YuvComponent comp : pic_data_.GetComponents(cu->GetCuTree())) {
+    for (YuvComponent comp : pic_data_->GetComponents(cu->GetCuTree())) {
       WriteComponent(*cu, comp, writer);
     }
   }
@@ -60,7 +60,7 @@ void CuWriter::WriteSplit(const CodingUnit &cu,
                           SyntaxWriter *writer) {
   SplitType split_type = cu.GetSplit();
   int binary_depth = cu.GetBinaryDepth();
-  int max_depth = pic_data_.GetMaxDepth(cu.GetCuTree());
+  int max_depth = pic_data_->GetMaxDepth(cu.GetCuTree());
   if (cu.GetDepth() < max_depth && binary_depth == 0) {
     if (cu.IsFullyWithinPicture()) {
       writer->WriteSplitQuad(cu, max_depth, split_type);
@@ -78,7 +78,7 @@ void CuWriter::WriteSplit(const CodingUnit &cu,
 void CuWriter::WriteComponent(const CodingUnit &cu, YuvComponent comp,
                               SyntaxWriter *writer) {
   if (util::IsLuma(comp)) {
-    if (!pic_data_.IsIntraPic()) {
+    if (!pic_data_->IsIntraPic()) {
       writer->WriteSkipFlag(cu, cu.GetSkipFlag());
       if (cu.GetSkipFlag()) {
         WriteMergePrediction(cu, comp, writer);
@@ -105,7 +105,7 @@ void CuWriter::WriteComponent(const CodingUnit &cu, YuvComponent comp,
 
 void CuWriter::WriteIntraPrediction(const CodingUnit &cu, YuvComponent comp,
                                     SyntaxWriter *writer) {
-  const CodingUnit *luma_cu = pic_data_.GetLumaCu(&cu);
+  const CodingUnit *luma_cu = pic_data_->GetLumaCu(&cu);
   IntraMode luma_mode = luma_cu->GetIntraMode(YuvComponent::kY);
   if (util::IsLuma(comp)) {
     IntraPredictorLuma mpm = intra_pred_->GetPredictorLuma(cu);
@@ -128,7 +128,7 @@ void CuWriter::WriteInterPrediction(const CodingUnit &cu, YuvComponent comp,
       WriteMergePrediction(cu, comp, writer);
       return;
     }
-    if (pic_data_.GetPredictionType() == PicturePredictionType::kBi) {
+    if (pic_data_->GetPredictionType() == PicturePredictionType::kBi) {
       writer->WriteInterDir(cu, cu.GetInterDir());
     } else {
       assert(cu.GetInterDir() == InterDir::kL0);
@@ -145,7 +145,7 @@ void CuWriter::WriteInterPrediction(const CodingUnit &cu, YuvComponent comp,
         continue;
       }
       int num_refs_available =
-        pic_data_.GetRefPicLists()->GetNumRefPics(ref_pic_list);
+        pic_data_->GetRefPicLists()->GetNumRefPics(ref_pic_list);
       assert(num_refs_available > 0);
       writer->WriteInterRefIdx(cu.GetRefIdx(ref_pic_list), num_refs_available);
       if (cu.GetForceMvdZero(ref_pic_list)) {
@@ -162,7 +162,7 @@ void CuWriter::WriteInterPrediction(const CodingUnit &cu, YuvComponent comp,
         !cu.GetUseAffine()) {
       writer->WriteInterFullpelMvFlag(cu, cu.GetFullpelMv());
     }
-    if (pic_data_.GetUseLocalIlluminationCompensation() &&
+    if (pic_data_->GetUseLocalIlluminationCompensation() &&
         !cu.GetUseAffine()) {
       writer->WriteLicFlag(cu.GetUseLic());
     } else {
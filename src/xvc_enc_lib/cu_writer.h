@@ -32,9 +32,10 @@ namespace xvc {
 class CuWriter {
 public:
   CuWriter(const PictureData &pic_data, const IntraPrediction *intra_pred)
-    : pic_data_(pic_data),
+    : pic_data_(&pic_data),
     intra_pred_(intra_pred) {
   }
+  void SetPictureData(const PictureData &pic_data) { pic_data_ = &pic_data; }
   bool WriteCtu(CodingUnit *ctu, PictureData *cu_map, SyntaxWriter *writer);
   void WriteCu(CodingUnit *cu, SplitRestriction split_restriction,
                PictureData *cu_map, SyntaxWriter *writer);
@@ -60,7 +61,7 @@ private:
   bool WriteCbfInvariant(const CodingUnit &cu, YuvComponent comp,
                          SyntaxWriter *writer) const;
 
-  const PictureData &pic_data_;
+  const PictureData *pic_data_;
   const IntraPrediction *intra_pred_;
   bool ctu_has_coeffs_ = false;
 };
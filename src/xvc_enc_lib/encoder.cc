@@ -29,6 +29,8 @@
 #include "xvc_common_lib/reference_list_sorter.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/utils.h"
+#include "xvc_enc_lib/cu_encoder.h"
 #include "xvc_enc_lib/segment_header_writer.h"
 #include "xvc_enc_lib/thread_encoder.h"
 
@@ -51,8 +53,13 @@ Encoder::Encoder(int internal_bitdepth, int num_threads)
   segment_header_->internal_bitdepth = internal_bitdepth;
   segment_header_->soc = 0;
   if (num_threads != 0) {
+    auto on_bitstream = [this](std::shared_ptr<const SegmentHeader> segment,
+                               const PictureEncoder &pic_enc,
+                               NalBuffer &&nal_buffer) {
+      OnPictureBitstream(std::move(segment), pic_enc, std::move(nal_buffer));
+    };
     thread_encoder_ = std::unique_ptr<ThreadEncoder>(
-      new ThreadEncoder(num_threads, encoder_settings_));
+      new ThreadEncoder(num_threads, encoder_settings_, on_bitstream));
   }
 }
 
@@ -119,11 +126,27 @@ bool Encoder::Encode(const uint8_t *pic_bytes, const PicPlanes *pic_planes,
     EncodeOnePicture(pic_enc);
     doc_ = 0;
   } else if (tid == 0) {
+    WorkScheduler::JobId lookahead_job = nullptr;
+    auto sub_gop = std::make_shared<Lookahead::SubGop>();
+    if (lookahead_ &&
+        lookahead_->PrepareSubGop(pic_encoders_, poc_,
+                                  segment_header_->max_sub_gop_length,
+                                  sub_gop.get())) {
+      if (thread_encoder_) {
+        // Analysis runs on a worker ahead of the pictures of the sub-gop
+        const Lookahead *lookahead = lookahead_.get();
+        lookahead_job = thread_encoder_->RunAsync([lookahead, sub_gop]() {
+          lookahead->AnalyzeSubGop(*sub_gop);
+        });
+      } else {
+        lookahead_->AnalyzeSubGop(*sub_gop);
+      }
+    }
     for (PicNum i = 0; i < segment_header_->max_sub_gop_length; i++) {
       for (auto &pic : pic_encoders_) {
         if (pic->GetPicData()->GetDoc() == doc_ + 1) {
           assert(pic->GetOutputStatus() == OutputStatus::kReady);
-          EncodeOnePicture(pic);
+          EncodeOnePicture(pic, lookahead_job);
         }
       }
     }
@@ -142,7 +165,8 @@ bool Encoder::Encode(const uint8_t *pic_bytes, const PicPlanes *pic_planes,
     out_rec_pic->pic = nullptr;
     out_rec_pic->size = 0;
   }
-  PrepareOutputNals();
+  std::unique_lock<std::mutex> lock(output_mutex_);
+  PrepareOutputNals(&lock);
   return true;
 }
 
@@ -194,7 +218,8 @@ bool Encoder::Flush(xvc_enc_pic_buffer *rec_pic) {
   }
   // Check if reconstruction should be performed.
   ReconstructNextPicture(rec_pic);
-  PrepareOutputNals();
+  std::unique_lock<std::mutex> lock(output_mutex_);
+  PrepareOutputNals(&lock);
   return doc_ + 1 < poc_ || last_rec_poc_ + 1 < poc_ ||
     !doc_bitstream_order_.empty();
 }
@@ -211,6 +236,8 @@ void Encoder::SetEncoderSettings(const EncoderSettings &settings) {
   segment_header_->chroma_qp_offset_u = settings.chroma_qp_offset_u;
   segment_header_->chroma_qp_offset_v = settings.chroma_qp_offset_v;
   segment_header_->adaptive_qp = settings.adaptive_qp;
+  segment_header_->num_slices =
+    util::Clip3(settings.num_slices, 1, 1 << constants::kNumSlicesBits);
   // Setup restriction flags
   Restrictions &restrictions = segment_header_->restrictions;
   restrictions.EnableRestrictedMode(settings.restricted_mode);
@@ -249,6 +276,14 @@ void Encoder::Initialize() {
     extra_num_buffered_subgops_ =
       static_cast<int>(thread_encoder_->GetNumThreads() - 1);
   }
+  if (rate_control_settings_.mode != RateControlMode::kConstantQp) {
+    rate_control_.reset(new RateControl(rate_control_settings_, framerate_,
+                                        segment_qp_));
+  }
+  if (encoder_settings_.temporal_aqp && encoder_settings_.adaptive_qp &&
+      !segment_header_->low_delay && segment_header_->max_sub_gop_length > 1) {
+    lookahead_.reset(new Lookahead(simd_, encoder_settings_));
+  }
   pic_buffering_num_ = segment_header_->num_ref_pics +
     static_cast<size_t>(segment_header_->max_sub_gop_length);
   if (!extra_num_buffered_subgops_) {
@@ -276,7 +311,8 @@ void Encoder::StartNewSegment() {
   }
 }
 
-void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic_enc) {
+void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic_enc,
+                               WorkScheduler::JobId lookahead_job) {
   // Check if current picture is a tail picture.
   // This means that it will be sent before the key picture of the
   // next segment and then be buffered in the decoder to be decoded after
@@ -288,11 +324,29 @@ void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic_enc) {
   pic_enc->SetOutputStatus(OutputStatus::kProcessing);
 
   NalBuffer pic_nal_buffer;
-  if (!avail_nal_buffers_.empty()) {
-    pic_nal_buffer = std::move(avail_nal_buffers_.back());
-    avail_nal_buffers_.pop_back();
-  } else {
-    pic_nal_buffer.reset(new std::vector<uint8_t>());
+  int segment_qp = segment_qp_;
+  {
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    if (!avail_nal_buffers_.empty()) {
+      pic_nal_buffer = std::move(avail_nal_buffers_.back());
+      avail_nal_buffers_.pop_back();
+    } else {
+      pic_nal_buffer.reset(new std::vector<uint8_t>());
+    }
+    // Rate control decides qp in encoding order, threads may finish out of
+    // order
+    if (rate_control_) {
+      segment_qp =
+        rate_control_->StartPicture(pic_enc->GetDoc(),
+                                    pic_enc->GetPicData()->IsIntraPic(),
+                                    pic_enc->GetPicData()->GetTid());
+    }
+    // For all pictures expect last sub-gop bitstream order is equal to doc
+    // order
+    // TODO(PH) Is there a more robust mechanism to detect this case?
+    if (pic_enc->GetPicData()->GetSoc() == segment_header_->soc) {
+      doc_bitstream_order_.push_back(pic_enc->GetDoc());
+    }
   }
 
   // Determine reference pictures
@@ -306,44 +360,52 @@ void Encoder::EncodeOnePicture(std::shared_ptr<PictureEncoder> pic_enc) {
 
   if (thread_encoder_) {
     thread_encoder_->EncodeAsync(segment_header, pic_enc, dependent_pic_enc,
-                                 std::move(pic_nal_buffer), segment_qp_,
-                                 pic_enc->GetBufferFlag());
+                                 std::move(pic_nal_buffer), segment_qp,
+                                 pic_enc->GetBufferFlag(), lookahead_job);
   } else {
-    // Bitstream reference valid until next picture is coded
-    const std::vector<uint8_t> *pic_bytes =
-      pic_enc->Encode(*segment_header, segment_qp_, pic_enc->GetBufferFlag(),
-                      encoder_settings_);
-    *pic_nal_buffer = *pic_bytes;
+    // Take over the bitstream and give the picture encoder a spare buffer
+    std::vector<uint8_t> *pic_bytes =
+      pic_enc->Encode(*segment_header, segment_qp, pic_enc->GetBufferFlag(),
+                      encoder_settings_, dependent_pic_enc, &cu_encoder_);
+    pic_nal_buffer->swap(*pic_bytes);
     pic_enc->SetOutputStatus(OutputStatus::kFinishedProcessing);
-    OnPictureEncoded(pic_enc, dependent_pic_enc, std::move(pic_nal_buffer));
-  }
-
-  // For all pictures expect last sub-gop bitstream order is equal to doc order
-  // TODO(PH) Is there a more robust mechanism to detect this case?
-  if (pic_enc->GetPicData()->GetSoc() == segment_header_->soc) {
-    doc_bitstream_order_.push_back(pic_enc->GetDoc());
+    OnPictureBitstream(segment_header, *pic_enc, std::move(pic_nal_buffer));
+    OnPictureEncoded(pic_enc, dependent_pic_enc);
   }
   doc_++;
 }
 
-void Encoder::OnPictureEncoded(std::shared_ptr<PictureEncoder> pic_enc,
-                               const PicEncList &inter_deps,
-                               NalBuffer &&pic_nal_buffer) {
-  assert(pic_enc->GetOutputStatus() == OutputStatus::kFinishedProcessing);
-  pic_enc->SetOutputStatus(OutputStatus::kHasNotBeenOutput);
-
+void Encoder::OnPictureBitstream(
+  std::shared_ptr<const SegmentHeader> segment_header,
+  const PictureEncoder &pic_enc, NalBuffer &&pic_nal_buffer) {
   // When a picture has been encoded, the picture data is put into
   // the xvc_enc_nal_unit struct to be delivered through the API.
   xvc_enc_nal_unit nal;
   nal.bytes = const_cast<uint8_t*>(&(*pic_nal_buffer)[0]);
   nal.size = pic_nal_buffer->size();
-  nal.buffer_flag = pic_enc->GetBufferFlag();
-  nal.user_data = pic_enc ? pic_enc->GetUserData() : 0;
-  SetNalStats(*pic_enc->GetPicData(), *pic_enc, &nal.stats);
-  auto &nal_stats_pair =
-    pending_out_nal_buffers_[pic_enc->GetPicData()->GetDoc()];
-  nal_stats_pair.first = std::move(pic_nal_buffer);
-  nal_stats_pair.second = nal;
+  nal.buffer_flag = pic_enc.GetBufferFlag();
+  nal.user_data = pic_enc.GetUserData();
+  SetNalStats(*segment_header, *pic_enc.GetPicData(), pic_enc, &nal.stats);
+
+  std::unique_lock<std::mutex> lock(output_mutex_);
+  if (rate_control_) {
+    rate_control_->FinishPicture(pic_enc.GetDoc(), 8 * nal.size);
+  }
+  PendingNal &pending_nal = pending_out_nal_buffers_[pic_enc.GetDoc()];
+  pending_nal.nal_buffer = std::move(pic_nal_buffer);
+  pending_nal.nal = nal;
+  pending_nal.segment_header = std::move(segment_header);
+  // With a callback the nal units are delivered from the encoding thread
+  // instead of waiting for the next api call
+  if (nal_callback_) {
+    PrepareOutputNals(&lock);
+  }
+}
+
+void Encoder::OnPictureEncoded(std::shared_ptr<PictureEncoder> pic_enc,
+                               const PicEncList &inter_deps) {
+  assert(pic_enc->GetOutputStatus() == OutputStatus::kFinishedProcessing);
+  pic_enc->SetOutputStatus(OutputStatus::kHasNotBeenOutput);
 
   // Decrease ref count for all reference pictures (avoiding duplicate entries)
   PicNum last_poc = pic_enc->GetPoc();
@@ -376,31 +438,97 @@ void Encoder::OnPictureEncoded(std::shared_ptr<PictureEncoder> pic_enc,
   }
 }
 
-void Encoder::PrepareOutputNals() {
-  if (doc_bitstream_order_.empty()) {
+void Encoder::PrepareOutputNals(std::unique_lock<std::mutex> *lock) {
+  if (!nal_callback_) {
+    // Nal units in the output nals vector stay valid until next api call,
+    // since buffers are not reused for encoding until then
+    PopNextOutputNal(&api_output_nals_, &avail_nal_buffers_);
+    return;
+  }
+  if (delivering_nals_) {
+    // Picked up by the thread that is currently delivering
     return;
   }
+  delivering_nals_ = true;
+  delivering_thread_ = std::this_thread::get_id();
+  std::vector<xvc_enc_nal_unit> nals;
+  std::vector<NalBuffer> nal_buffers;
+  while (nal_callback_) {
+    xvc_enc_nal_callback nal_callback = nal_callback_;
+    void *nal_callback_opaque = nal_callback_opaque_;
+    while (PopNextOutputNal(&nals, &nal_buffers)) {
+    }
+    if (nals.empty()) {
+      break;
+    }
+    // The callback may be slow or call back into the encoder, so other
+    // threads must be able to hand over their pictures meanwhile
+    lock->unlock();
+    for (const xvc_enc_nal_unit &nal : nals) {
+      nal_callback(nal_callback_opaque, &nal);
+    }
+    lock->lock();
+    for (NalBuffer &nal_buffer : nal_buffers) {
+      avail_nal_buffers_.emplace_back(std::move(nal_buffer));
+    }
+    nals.clear();
+    nal_buffers.clear();
+  }
+  delivering_nals_ = false;
+  nal_delivery_done_.notify_all();
+}
+
+bool Encoder::PopNextOutputNal(std::vector<xvc_enc_nal_unit> *nals,
+                               std::vector<NalBuffer> *nal_buffers) {
+  if (doc_bitstream_order_.empty()) {
+    return false;
+  }
   PicNum next_doc = doc_bitstream_order_.front();
   auto next_output_nal_it = pending_out_nal_buffers_.find(next_doc);
   if (next_output_nal_it == pending_out_nal_buffers_.end()) {
-    return;
+    return false;
   }
   doc_bitstream_order_.pop_front();
-  NalBuffer &&pic_nal_buffer = std::move(next_output_nal_it->second.first);
-  xvc_enc_nal_unit &nal = next_output_nal_it->second.second;
-  if (nal.stats.nal_unit_type ==
+  PendingNal &pending_nal = next_output_nal_it->second;
+  if (pending_nal.nal.stats.nal_unit_type ==
       static_cast<uint32_t>(NalUnitType::kIntraAccessPicture)) {
     xvc_enc_nal_unit segment_nal =
-      WriteSegmentHeaderNal(*segment_header_, &segment_header_bit_writer_);
-    api_output_nals_.emplace_back(std::move(segment_nal));
-  }
-  assert(nal.bytes == &(*pic_nal_buffer)[0]);
-  assert(nal.size == pic_nal_buffer->size());
-  api_output_nals_.emplace_back(nal);
-  // The assumption is that we don't start encoding any new pictures until
-  // next api call
-  avail_nal_buffers_.emplace_back(std::move(pic_nal_buffer));
+      WriteSegmentHeaderNal(*pending_nal.segment_header,
+                            &segment_header_bit_writer_);
+    // Segment header bit writer is reused for the next segment header
+    NalBuffer segment_nal_buffer;
+    if (!avail_nal_buffers_.empty()) {
+      segment_nal_buffer = std::move(avail_nal_buffers_.back());
+      avail_nal_buffers_.pop_back();
+    } else {
+      segment_nal_buffer.reset(new std::vector<uint8_t>());
+    }
+    segment_nal_buffer->assign(segment_nal.bytes,
+                               segment_nal.bytes + segment_nal.size);
+    segment_nal.bytes = &(*segment_nal_buffer)[0];
+    nals->push_back(segment_nal);
+    nal_buffers->emplace_back(std::move(segment_nal_buffer));
+  }
+  assert(pending_nal.nal.bytes == &(*pending_nal.nal_buffer)[0]);
+  assert(pending_nal.nal.size == pending_nal.nal_buffer->size());
+  nals->push_back(pending_nal.nal);
+  nal_buffers->emplace_back(std::move(pending_nal.nal_buffer));
   pending_out_nal_buffers_.erase(next_output_nal_it);
+  return true;
+}
+
+void Encoder::SetNalCallback(xvc_enc_nal_callback callback, void *opaque) {
+  std::unique_lock<std::mutex> lock(output_mutex_);
+  nal_callback_ = callback;
+  nal_callback_opaque_ = opaque;
+  // The previous callback must not be invoked after this returns
+  if (delivering_thread_ != std::this_thread::get_id()) {
+    nal_delivery_done_.wait(lock, [this]() { return !delivering_nals_; });
+  }
+  if (nal_callback_) {
+    // Deliver the pictures that were finished in between api calls
+    PrepareOutputNals(&lock);
+  }
 }
 
 void Encoder::ReconstructNextPicture(xvc_enc_pic_buffer *out_pic) {
@@ -423,8 +551,8 @@ void Encoder::ReconstructNextPicture(xvc_enc_pic_buffer *out_pic) {
   if (thread_encoder_) {
     thread_encoder_->WaitForPicture(
       pic_enc, [this](std::shared_ptr<PictureEncoder> pic,
-                      const PicEncList &deps, NalBuffer &&nal_buffer) {
-      OnPictureEncoded(pic, deps, std::move(nal_buffer));
+                      const PicEncList &deps) {
+      OnPictureEncoded(pic, deps);
     });
   } else if (pic_enc->GetOutputStatus() != OutputStatus::kHasNotBeenOutput) {
     if (out_pic) {
@@ -499,6 +627,7 @@ void Encoder::DetermineBufferFlags(const PictureEncoder &intra_pic) {
       }
       // Insert last sub-gop before next intra access picture in bitstream order
       // TODO(PH) Consider also check soc to ensure inserted before next segment
+      std::lock_guard<std::mutex> lock(output_mutex_);
       auto doc_order_insert_it = doc_bitstream_order_.end();
       for (auto doc_order_it = doc_bitstream_order_.begin();
            doc_order_it != doc_bitstream_order_.end(); ++doc_order_it) {
@@ -591,9 +720,8 @@ std::shared_ptr<PictureEncoder> Encoder::GetNewPictureEncoder() {
     }
     // No more available buffers, sleep and wait for one to become available
     thread_encoder_->WaitOne([this](std::shared_ptr<PictureEncoder> pic,
-                                    const PicEncList &deps,
-                                    NalBuffer &&nal_buffer) {
-      OnPictureEncoded(pic, deps, std::move(nal_buffer));
+                                    const PicEncList &deps) {
+      OnPictureEncoded(pic, deps);
     });
   }
   assert(avail_pic_enc);
@@ -651,10 +779,11 @@ Encoder::WriteSegmentHeaderNal(const SegmentHeader &segment_header,
   return nal;
 }
 
-void Encoder::SetNalStats(const PictureData &pic_data,
+void Encoder::SetNalStats(const SegmentHeader &segment_header,
+                          const PictureData &pic_data,
                           const PictureEncoder &pic_enc,
                           xvc_enc_nal_stats *nal_stats) {
-  const int poc_offset = (segment_header_->leading_pictures != 0 ? -1 : 0);
+  const int poc_offset = (segment_header.leading_pictures != 0 ? -1 : 0);
   nal_stats->nal_unit_type =
     static_cast<uint32_t>(pic_data.GetNalType());
 
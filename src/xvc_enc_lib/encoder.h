@@ -22,11 +22,14 @@
 #ifndef XVC_ENC_LIB_ENCODER_H_
 #define XVC_ENC_LIB_ENCODER_H_
 
+#include <condition_variable>   // NOLINT
 #include <deque>
 #include <limits>
 #include <memory>
+#include <mutex>    // NOLINT
 #include <set>
 #include <string>
+#include <thread>   // NOLINT
 #include <utility>
 #include <vector>
 #include <unordered_map>
@@ -36,8 +39,11 @@
 #include "xvc_common_lib/resample.h"
 #include "xvc_common_lib/restrictions.h"
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/work_scheduler.h"
 #include "xvc_enc_lib/bit_writer.h"
+#include "xvc_enc_lib/lookahead.h"
 #include "xvc_enc_lib/picture_encoder.h"
+#include "xvc_enc_lib/rate_control.h"
 #include "xvc_enc_lib/encoder_settings.h"
 #include "xvc_enc_lib/encoder_simd_functions.h"
 
@@ -61,6 +67,11 @@ public:
   std::vector<xvc_enc_nal_unit>& GetOutputNals() {
     return api_output_nals_;
   }
+  // When a callback is set nal units are delivered through it instead of
+  // being collected in the output nals vector. Nal units are then output as
+  // soon as they are ready in bitstream order, possibly from an encoding
+  // thread, until the callback is reset.
+  void SetNalCallback(xvc_enc_nal_callback callback, void *opaque);
   const SegmentHeader* GetCurrentSegment() const {
     return segment_header_.get();
   }
@@ -116,6 +127,9 @@ public:
   void SetChecksumMode(Checksum::Mode mode) {
     segment_header_->checksum_mode = mode;
   }
+  void SetRateControl(const RateControl::Settings &settings) {
+    rate_control_settings_ = settings;
+  }
 
   const EncoderSettings& GetEncoderSettings() { return encoder_settings_; }
   void SetEncoderSettings(const EncoderSettings &settings);
@@ -127,11 +141,19 @@ private:
               xvc_enc_pic_buffer *rec_pic, int64_t user_data);
   void Initialize();
   void StartNewSegment();
-  void EncodeOnePicture(std::shared_ptr<PictureEncoder> pic);
+  // With threads the picture is not encoded before lookahead_job is done
+  void EncodeOnePicture(std::shared_ptr<PictureEncoder> pic,
+                        WorkScheduler::JobId lookahead_job = nullptr);
   void OnPictureEncoded(std::shared_ptr<PictureEncoder> pic_enc,
-                        const PicEncList &inter_deps,
-                        NalBuffer &&pic_nal_buffer);
-  void PrepareOutputNals();
+                        const PicEncList &inter_deps);
+  void OnPictureBitstream(std::shared_ptr<const SegmentHeader> segment_header,
+                          const PictureEncoder &pic_enc,
+                          NalBuffer &&pic_nal_buffer);
+  // Must be called with output_mutex_ held, the lock is temporarily
+  // released while invoking the nal callback
+  void PrepareOutputNals(std::unique_lock<std::mutex> *lock);
+  bool PopNextOutputNal(std::vector<xvc_enc_nal_unit> *nals,
+                        std::vector<NalBuffer> *nal_buffers);
   void ReconstructNextPicture(xvc_enc_pic_buffer *rec_pic);
   std::shared_ptr<PictureEncoder>
     PrepareNewInputPicture(const SegmentHeader &segment, PicNum doc, PicNum poc,
@@ -144,7 +166,8 @@ private:
   std::shared_ptr<PictureEncoder> RewriteLeadingPictures();
   xvc_enc_nal_unit WriteSegmentHeaderNal(const SegmentHeader &segment_header,
                                          BitWriter *bit_writer);
-  void SetNalStats(const PictureData &pic_data, const PictureEncoder &pic_enc,
+  void SetNalStats(const SegmentHeader &segment_header,
+                   const PictureData &pic_data, const PictureEncoder &pic_enc,
                    xvc_enc_nal_stats *nal_stats);
 
   bool initialized_ = false;
@@ -162,17 +185,36 @@ private:
   int segment_qp_ = std::numeric_limits<int>::max();
   EncoderSimdFunctions simd_;
   EncoderSettings encoder_settings_;
+  RateControl::Settings rate_control_settings_;
+  std::unique_ptr<RateControl> rate_control_;
+  std::unique_ptr<Lookahead> lookahead_;
   Resampler input_resampler_;
   std::vector<std::shared_ptr<PictureEncoder>> pic_encoders_;
   std::vector<uint8_t> output_pic_bytes_;
+  // Guards the output state below and the rate control, since encoding
+  // threads hand over their bitstream as soon as a picture is encoded
+  std::mutex output_mutex_;
   BitWriter segment_header_bit_writer_;
   std::vector<xvc_enc_nal_unit> api_output_nals_;
+  xvc_enc_nal_callback nal_callback_ = nullptr;
+  void *nal_callback_opaque_ = nullptr;
   std::vector<NalBuffer> avail_nal_buffers_;
+  // Only one thread at a time invokes the nal callback, other threads just
+  // leave their pictures as pending for it to deliver
+  bool delivering_nals_ = false;
+  std::thread::id delivering_thread_;
+  std::condition_variable nal_delivery_done_;
   std::deque<PicNum> doc_bitstream_order_;
-  std::unordered_map<PicNum,
-    std::pair<NalBuffer, xvc_enc_nal_unit>> pending_out_nal_buffers_;
+  struct PendingNal {
+    NalBuffer nal_buffer;
+    xvc_enc_nal_unit nal;
+    std::shared_ptr<const SegmentHeader> segment_header;
+  };
+  std::unordered_map<PicNum, PendingNal> pending_out_nal_buffers_;
   PicNum last_rec_poc_ = static_cast<PicNum>(-1);
   std::unique_ptr<ThreadEncoder> thread_encoder_;
+  // Reused for all pictures when encoding without threads
+  std::unique_ptr<CuEncoder> cu_encoder_;
 };
 
 }   // namespace xvc
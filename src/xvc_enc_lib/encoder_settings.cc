@@ -41,6 +41,8 @@ void EncoderSettings::Initialize(SpeedMode speed_mode) {
       fast_transform_select = 0;
       fast_inter_local_illumination_comp = 0;
       fast_inter_adaptive_fullpel_mv = 0;
+      fast_rate_estimation = 0;
+      fast_motion_preanalysis = 0;
       break;
     case SpeedMode::kSlow:
       bipred_refinement_iterations = 1;
@@ -53,6 +55,8 @@ void EncoderSettings::Initialize(SpeedMode speed_mode) {
       fast_transform_select = 0;
       fast_inter_local_illumination_comp = 0;
       fast_inter_adaptive_fullpel_mv = 0;
+      fast_rate_estimation = 0;
+      fast_motion_preanalysis = 0;
       break;
     case SpeedMode::kFast:
       bipred_refinement_iterations = 1;
@@ -65,6 +69,8 @@ void EncoderSettings::Initialize(SpeedMode speed_mode) {
       fast_transform_select = 1;
       fast_inter_local_illumination_comp = 1;
       fast_inter_adaptive_fullpel_mv = 1;
+      fast_rate_estimation = 1;
+      fast_motion_preanalysis = 1;
       break;
     default:
       assert(0);
@@ -88,6 +94,8 @@ void EncoderSettings::Initialize(RestrictedMode mode) {
   fast_transform_select = 0;
   fast_inter_local_illumination_comp = 0;
   fast_inter_adaptive_fullpel_mv = 0;
+  fast_rate_estimation = 0;
+  fast_motion_preanalysis = 0;
   fast_merge_eval = 1;
   fast_quad_split_based_on_binary_split = 2;
   eval_prev_mv_search_result = 0;
@@ -95,6 +103,7 @@ void EncoderSettings::Initialize(RestrictedMode mode) {
   rdo_quant_2x2 = 0;
   smooth_lambda_scaling = 0;
   adaptive_qp = 0;
+  temporal_aqp = 0;
   structural_ssd = 0;
   source_padding = 1;
   switch (mode) {
@@ -165,6 +174,10 @@ void EncoderSettings::ParseExplicitSettings(std::string explicit_settings) {
       stream >> fast_inter_local_illumination_comp;
     } else if (setting == "fast_inter_adaptive_fullpel_mv") {
       stream >> fast_inter_adaptive_fullpel_mv;
+    } else if (setting == "fast_rate_estimation") {
+      stream >> fast_rate_estimation;
+    } else if (setting == "fast_motion_preanalysis") {
+      stream >> fast_motion_preanalysis;
     } else if (setting == "fast_merge_eval") {
       stream >> fast_merge_eval;
     } else if (setting == "fast_quad_split_based_on_binary_split") {
@@ -183,6 +196,10 @@ void EncoderSettings::ParseExplicitSettings(std::string explicit_settings) {
       stream >> adaptive_qp;
     } else if (setting == "aqp_strength") {
       stream >> aqp_strength;
+    } else if (setting == "temporal_aqp") {
+      stream >> temporal_aqp;
+    } else if (setting == "temporal_aqp_strength") {
+      stream >> temporal_aqp_strength;
     } else if (setting == "structural_ssd") {
       stream >> structural_ssd;
     } else if (setting == "structural_strength") {
@@ -193,6 +210,12 @@ void EncoderSettings::ParseExplicitSettings(std::string explicit_settings) {
       stream >> leading_pictures;
     } else if (setting == "source_padding") {
       stream >> source_padding;
+    } else if (setting == "wavefront_threads") {
+      stream >> wavefront_threads;
+    } else if (setting == "num_slices") {
+      stream >> num_slices;
+    } else if (setting == "slice_threads") {
+      stream >> slice_threads;
     } else if (setting == "lambda_scale_a") {
       stream >> lambda_scale_a;
     } else if (setting == "lambda_scale_b") {
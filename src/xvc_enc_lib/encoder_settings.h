@@ -77,6 +77,8 @@ struct EncoderSettings {
   int fast_transform_select = -1;
   int fast_inter_local_illumination_comp = -1;
   int fast_inter_adaptive_fullpel_mv = -1;
+  int fast_rate_estimation = -1;
+  int fast_motion_preanalysis = -1;
 
   // Settings with default values used in all speed modes
   int fast_merge_eval = 1;
@@ -88,6 +90,8 @@ struct EncoderSettings {
   int smooth_lambda_scaling = 1;
   int adaptive_qp = 2;
   int aqp_strength = 13;
+  int temporal_aqp = 0;
+  int temporal_aqp_strength = 20;
   int structural_ssd = 1;
   int structural_strength = 16;
   int encapsulation_mode = 0;
@@ -97,6 +101,9 @@ struct EncoderSettings {
   int chroma_qp_offset_u = 0;
   int chroma_qp_offset_v = 0;
   int flat_lambda = 0;
+  int wavefront_threads = 0;
+  int num_slices = 1;
+  int slice_threads = 0;
   float lambda_scale_a = 1.0f;
   float lambda_scale_b = 0.0f;
   RestrictedMode restricted_mode = RestrictedMode::kUnrestricted;
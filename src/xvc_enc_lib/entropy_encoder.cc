@@ -21,6 +21,8 @@
 
 #include "xvc_enc_lib/entropy_encoder.h"
 
+#include <cassert>
+
 #include "xvc_common_lib/cabac.h"
 #include "xvc_enc_lib/encoder_settings.h"
 
@@ -42,6 +44,13 @@ void EntropyEncoder::EncodeBin(uint32_t binval, ContextModel *ctx) {
   uint32_t lps = ctx->GetLps(range_);
 
   if (!bit_writer_) {
+    if (bin_recorder_) {
+      const ptrdiff_t ctx_offset =
+        reinterpret_cast<const uint8_t*>(ctx) - bin_recorder_ctx_base_;
+      bin_recorder_->push_back(static_cast<uint32_t>(
+        (ctx_offset << (kBinTypeBits + 1)) | (binval << kBinTypeBits) |
+        kBinTypeContext));
+    }
     frac_bits_ += ctx->GetEntropyBits(binval);
     if (binval != ctxmps) {
       ctx->UpdateLPS();
@@ -77,6 +86,9 @@ void EntropyEncoder::EncodeBin(uint32_t binval, ContextModel *ctx) {
 
 void EntropyEncoder::EncodeBypass(uint32_t binval) {
   if (!bit_writer_) {
+    if (bin_recorder_) {
+      bin_recorder_->push_back((binval << kBinTypeBits) | kBinTypeBypass);
+    }
     frac_bits_ += ContextModel::kEntropyBypassBits;
     return;
   }
@@ -93,6 +105,11 @@ void EntropyEncoder::EncodeBypass(uint32_t binval) {
 
 void EntropyEncoder::EncodeBypassBins(uint32_t binvals, int num_bins) {
   if (!bit_writer_) {
+    if (bin_recorder_) {
+      bin_recorder_->push_back((num_bins << kBinTypeBits) |
+                               kBinTypeBypassMulti);
+      bin_recorder_->push_back(binvals);
+    }
     frac_bits_ += ContextModel::kEntropyBypassBits * num_bins;
     return;
   }
@@ -119,6 +136,9 @@ void EntropyEncoder::EncodeBypassBins(uint32_t binvals, int num_bins) {
 
 void EntropyEncoder::EncodeBinTrm(uint32_t binval) {
   if (!bit_writer_) {
+    if (bin_recorder_) {
+      bin_recorder_->push_back((binval << kBinTypeBits) | kBinTypeTerminate);
+    }
     frac_bits_ += ContextModel::GetEntropyBitsTrm(binval);
     return;
   }
@@ -177,6 +197,36 @@ void EntropyEncoder::Finish() {
   bit_writer_->PadZeroBits();
 }
 
+void EntropyEncoder::SetBinRecorder(std::vector<uint32_t> *bins,
+                                    const ContextModel *ctx_base) {
+  assert(!bit_writer_);
+  bin_recorder_ = bins;
+  bin_recorder_ctx_base_ = reinterpret_cast<const uint8_t*>(ctx_base);
+}
+
+void EntropyEncoder::WriteRecordedBins(const std::vector<uint32_t> &bins,
+                                       ContextModel *ctx_base) {
+  uint8_t *ctx_base_ptr = reinterpret_cast<uint8_t*>(ctx_base);
+  for (size_t i = 0; i < bins.size(); i++) {
+    const uint32_t bin = bins[i];
+    switch (bin & kBinTypeMask) {
+      case kBinTypeContext:
+        EncodeBin((bin >> kBinTypeBits) & 1, reinterpret_cast<ContextModel*>(
+          ctx_base_ptr + (bin >> (kBinTypeBits + 1))));
+        break;
+      case kBinTypeBypass:
+        EncodeBypass(bin >> kBinTypeBits);
+        break;
+      case kBinTypeTerminate:
+        EncodeBinTrm(bin >> kBinTypeBits);
+        break;
+      case kBinTypeBypassMulti:
+        EncodeBypassBins(bins[++i], static_cast<int>(bin >> kBinTypeBits));
+        break;
+    }
+  }
+}
+
 void EntropyEncoder::WriteOut() {
   uint32_t lead_byte = low_ >> (24 - bits_left_);
   bits_left_ += 8;
@@ -22,6 +22,8 @@
 #ifndef XVC_ENC_LIB_ENTROPY_ENCODER_H_
 #define XVC_ENC_LIB_ENTROPY_ENCODER_H_
 
+#include <vector>
+
 #include "xvc_common_lib/context_model.h"
 #include "xvc_enc_lib/bit_writer.h"
 
@@ -41,6 +43,13 @@ public:
   void ResetBitCounting() { frac_bits_ &= 32767; }
   void Start();
   void Finish();
+  // Records all bins as context offsets relative to ctx_base so that they can
+  // later be written using another set of context states (requires that no
+  // bit writer is used)
+  void SetBinRecorder(std::vector<uint32_t> *bins,
+                      const ContextModel *ctx_base);
+  void WriteRecordedBins(const std::vector<uint32_t> &bins,
+                         ContextModel *ctx_base);
   Bits GetNumWrittenBits() const {
     return static_cast<uint32_t>(frac_bits_ >> 15);
   }
@@ -49,6 +58,15 @@ public:
   }
 
 private:
+  enum BinType {
+    kBinTypeContext = 0,
+    kBinTypeBypass = 1,
+    kBinTypeTerminate = 2,
+    kBinTypeBypassMulti = 3,
+  };
+  static const int kBinTypeBits = 2;
+  static const uint32_t kBinTypeMask = (1 << kBinTypeBits) - 1;
+
   void WriteOut();
   void WriteIfPossible();
 
@@ -59,6 +77,8 @@ private:
   int bits_left_;
   uint64_t frac_bits_ = 0;
   BitWriter *bit_writer_;
+  std::vector<uint32_t> *bin_recorder_ = nullptr;
+  const uint8_t *bin_recorder_ctx_base_ = nullptr;
 };
 
 }   // namespace xvc
@@ -32,6 +32,7 @@
 #include "xvc_common_lib/utils.h"
 #include "xvc_enc_lib/inter_tz_search.h"
 #include "xvc_enc_lib/cu_writer.h"
+#include "xvc_enc_lib/rate_estimator.h"
 
 namespace xvc {
 
@@ -51,9 +52,6 @@ InterSearch::InterSearch(const EncoderSimdFunctions &simd,
   : InterPrediction(simd.inter_prediction, rec_pic, pic_data.GetBitdepth()),
   bitdepth_(pic_data.GetBitdepth()),
   max_components_(pic_data.GetMaxNumComponents()),
-  poc_(pic_data.GetPoc()),
-  sub_gop_length_(static_cast<int>(pic_data.GetSubGopLength())),
-  orig_pic_(orig_pic),
   encoder_settings_(encoder_settings),
   simd_(simd),
   cu_metric_(simd.sample_metric, bitdepth_, encoder_settings_.structural_ssd ?
@@ -63,11 +61,28 @@ InterSearch::InterSearch(const EncoderSimdFunctions &simd,
   cu_writer_(pic_data, nullptr),
   bipred_orig_buffer_(constants::kMaxBlockSize, constants::kMaxBlockSize),
   bipred_pred_buffer_(constants::kMaxBlockSize, constants::kMaxBlockSize) {
+  SetPicture(pic_data, orig_pic, rec_pic, ref_pic_list);
+}
+
+void InterSearch::SetPicture(const PictureData &pic_data,
+                             const YuvPicture &orig_pic,
+                             const YuvPicture &rec_pic,
+                             const ReferencePictureLists &ref_pic_list) {
+  SetRecPic(rec_pic);
+  poc_ = pic_data.GetPoc();
+  sub_gop_length_ = static_cast<int>(pic_data.GetSubGopLength());
+  orig_pic_ = &orig_pic;
+  motion_preanalysis_ = nullptr;
+  cu_writer_.SetPictureData(pic_data);
   std::vector<int> l1_mapping =
     ref_pic_list.GetSamePocMappingFor(RefPicList::kL1);
   assert(l1_mapping.size() <= same_poc_in_l0_mapping_.size());
+  same_poc_in_l0_mapping_.fill(-1);
   std::copy(l1_mapping.begin(), l1_mapping.end(),
             same_poc_in_l0_mapping_.begin());
+  for (auto &list_mvs : previous_fullpel_) {
+    list_mvs.fill(MvFullpel());
+  }
 }
 
 Distortion
@@ -107,12 +122,12 @@ InterSearch::CompressInterFast(CodingUnit *cu, YuvComponent comp, const Qp &qp,
     SampleBuffer reco =
       rec_pic->GetSampleBuffer(comp, cu->GetPosX(comp), cu->GetPosY(comp));
     MotionCompensation(*cu, comp, &reco);
-    return cu_metric_.CompareSample(*cu, comp, orig_pic_, reco);
+    return cu_metric_.CompareSample(*cu, comp, *orig_pic_, reco);
   } else {
     SampleBuffer &pred = encoder->GetPredBuffer(comp);
     MotionCompensation(*cu, comp, &pred);
     return encoder->TransformAndReconstruct(cu, comp, qp, bitstream_writer,
-                                            orig_pic_, rec_pic);
+                                            *orig_pic_, rec_pic);
   }
 }
 
@@ -176,7 +191,7 @@ InterSearch::SearchMergeCandidates(CodingUnit *cu, const Qp &qp,
     ApplyMergeCand(cu, merge_list[merge_idx]);
     MotionCompensation(*cu, YuvComponent::kY, &pred_buffer);
     Distortion dist =
-      metric.CompareSample(*cu, YuvComponent::kY, orig_pic_, pred_buffer);
+      metric.CompareSample(*cu, YuvComponent::kY, *orig_pic_, pred_buffer);
     Bits bits = merge_idx + 1 - (merge_idx < max_merge_cand - 1 ? 0 : 1);
     double cost = dist + bits * qp.GetLambdaSqrt();
     cand_cost[merge_idx] = std::make_pair(merge_idx, cost);
@@ -202,7 +217,7 @@ Distortion InterSearch::SearchMotion(CodingUnit *cu, const Qp &qp,
                                      SampleBuffer *pred_buffer) {
   const YuvComponent comp = YuvComponent::kY;
   SampleBufferConst orig_luma =
-    orig_pic_.GetSampleBuffer(comp, cu->GetPosX(comp), cu->GetPosY(comp));
+    orig_pic_->GetSampleBuffer(comp, cu->GetPosX(comp), cu->GetPosY(comp));
 
   cu->ResetPredictionState();
   cu->SetPredMode(PredictionMode::kInter);
@@ -265,10 +280,10 @@ InterSearch::CompressAndEvalCbf(CodingUnit *cu, const Qp &qp,
                                 TransformEncoder *encoder,
                                 YuvPicture *rec_pic) {
   auto get_zero_cost = [&](Distortion dist) {
-    RdoSyntaxWriter rdo_writer_zero(bitstream_writer, 0);
+    RateEstimator rate_estimator(bitstream_writer);
     // Note that root cbf is not used in case of merge/skip
-    rdo_writer_zero.WriteRootCbf(false);
-    Bits bits_zero = rdo_writer_zero.GetNumWrittenBits();
+    rate_estimator.EstimateRootCbf(false);
+    Bits bits_zero = rate_estimator.GetNumBits();
     return dist + static_cast<Cost>(bits_zero * qp.GetLambda() + 0.5);
   };
   std::array<TransformEncoder::RdCost, constants::kMaxYuvComponents> best_cost;
@@ -296,7 +311,7 @@ InterSearch::CompressAndEvalCbf(CodingUnit *cu, const Qp &qp,
       // TODO(PH) Should update contexts after each component for rdo quant
       TransformEncoder::RdCost tx_cost =
         encoder->CompressAndEvalTransform(cu, comp, qp, bitstream_writer,
-                                          orig_pic_, tx_rd_flags,
+                                          *orig_pic_, tx_rd_flags,
                                           best_cost_comp, &comp_dist_zero[c],
                                           &cu_writer_, rec_pic);
       if (tx_pass == 0) {
@@ -384,7 +399,7 @@ InterSearch::CompressSkipOnly(CodingUnit *cu, const Qp &qp,
     SampleBuffer reco_buffer = rec_pic->GetSampleBuffer(comp, posx, posy);
     MotionCompensation(*cu, comp, &reco_buffer);
     cu->ClearCbf(comp);
-    sum_dist += cu_metric_.CompareSample(*cu, comp, orig_pic_, reco_buffer);
+    sum_dist += cu_metric_.CompareSample(*cu, comp, *orig_pic_, reco_buffer);
   }
   return sum_dist;
 }
@@ -396,7 +411,7 @@ InterSearch::SearchBiIterative(CodingUnit *cu, const Qp &qp,
                                CodingUnit::InterState *best_state) {
   const YuvComponent comp = YuvComponent::kY;
   SampleBufferConst orig_luma =
-    orig_pic_.GetSampleBuffer(comp, cu->GetPosX(comp), cu->GetPosY(comp));
+    orig_pic_->GetSampleBuffer(comp, cu->GetPosX(comp), cu->GetPosY(comp));
   int width = cu->GetWidth(comp);
   int height = cu->GetHeight(comp);
   cu->SetInterDir(InterDir::kBi);
@@ -616,10 +631,24 @@ InterSearch::MotionEstNormal(const CodingUnit &cu, const Qp &qp,
     cu.GetRefPicLists()->GetRefPic(ref_list, ref_idx);
   const PicNum ref_poc =
     cu.GetRefPicLists()->GetRefPoc(ref_list, ref_idx);
-  const int search_range = search_method == SearchMethod::FullSearch ?
+  int search_range = search_method == SearchMethod::FullSearch ?
     encoder_settings_.inter_search_range_bi : GetSearchRangeUniPred(ref_poc);
+  // Coarse pre-analysis vector allows a much smaller search window
+  MvFullpel mv_seed;
+  const bool use_seed = search_method == SearchMethod::TzSearch &&
+    motion_preanalysis_ && !mv_bootstrap &&
+    motion_preanalysis_->GetMv(ref_list, ref_idx,
+                               cu.GetPosX(YuvComponent::kY) +
+                               (cu.GetWidth(YuvComponent::kY) >> 1),
+                               cu.GetPosY(YuvComponent::kY) +
+                               (cu.GetHeight(YuvComponent::kY) >> 1),
+                               &mv_seed);
   MvFullpel clip_min, clip_max;
-  if (!mv_bootstrap) {
+  if (use_seed) {
+    search_range = std::min(search_range, kSearchRangePreanalysis);
+    DetermineMinMaxMv(cu, *ref_pic, MotionVector(mv_seed), search_range,
+                      &clip_min, &clip_max);
+  } else if (!mv_bootstrap) {
     DetermineMinMaxMv(cu, *ref_pic, mvp, search_range, &clip_min, &clip_max);
   } else {
     DetermineMinMaxMv(cu, *ref_pic, *mv_bootstrap, search_range,
@@ -633,11 +662,12 @@ InterSearch::MotionEstNormal(const CodingUnit &cu, const Qp &qp,
     mv_fullpel =
       FullSearch(cu, qp, fullpel_metric, mvp, *ref_pic, clip_min, clip_max);
   } else if (search_method == SearchMethod::TzSearch) {
-    TzSearch tz_search(orig_pic_, *this, encoder_settings_, search_range);
+    TzSearch tz_search(*orig_pic_, *this, encoder_settings_, search_range);
     mv_fullpel =
       tz_search.Search(cu, qp, fullpel_metric, mvp, *ref_pic,
                        clip_min, clip_max,
-                       previous_fullpel_[static_cast<int>(ref_list)][ref_idx]);
+                       previous_fullpel_[static_cast<int>(ref_list)][ref_idx],
+                       use_seed ? &mv_seed : nullptr);
     previous_fullpel_[static_cast<int>(ref_list)][ref_idx] = mv_fullpel;
   } else {
     assert(0);
@@ -755,54 +785,60 @@ InterSearch::AffineGradientSearch(int width, int height,
                                   const SampleBuffer &pred_buffer,
                                   const ResidualBuffer &err_buffer) {
   static const int kNbrParams = 4;
-  const ptrdiff_t pred_stride = pred_buffer.GetStride();
-  const Sample *pred = pred_buffer.GetDataPtr();
-  pred += pred_stride;
+  // Gradients are kept as integers scaled by 8, the accumulated sums are
+  // exact so the scaling is removed when converting to floating point
+  static const int kGradScale = 8;
+  simd_.inter_prediction.affine_gradient(width, height,
+                                         pred_buffer.GetDataPtr(),
+                                         pred_buffer.GetStride(),
+                                         &affine_grad_hor_[0][0],
+                                         &affine_grad_ver_[0][0],
+                                         constants::kMaxBlockSize);
   for (int y = 1; y < height - 1; y++) {
-    for (int x = 1; x < width - 1; x++) {
-      Sample a0 = pred[x - pred_stride - 1];
-      Sample a1 = pred[x - pred_stride];
-      Sample a2 = pred[x - pred_stride + 1];
-      Sample b0 = pred[x - 1];
-      Sample b2 = pred[x + 1];
-      Sample c0 = pred[x + pred_stride - 1];
-      Sample c1 = pred[x + pred_stride];
-      Sample c2 = pred[x + pred_stride + 1];
-      affine_delta_hor_[y][x] = (-a0 + a2 - 2 * b0 + 2 * b2 - c0 + c2) / 8.0f;
-      affine_delta_ver_[y][x] = (-a0 - 2 * a1 - a2 + c0 + 2 * c1 + c2) / 8.0f;
-    }
-    affine_delta_hor_[y][0] = affine_delta_hor_[y][1];
-    affine_delta_hor_[y][width - 1] = affine_delta_hor_[y][width - 2];
-    affine_delta_ver_[y][0] = affine_delta_ver_[y][1];
-    affine_delta_ver_[y][width - 1] = affine_delta_ver_[y][width - 2];
-    pred += pred_stride;
+    affine_grad_hor_[y][0] = affine_grad_hor_[y][1];
+    affine_grad_hor_[y][width - 1] = affine_grad_hor_[y][width - 2];
+    affine_grad_ver_[y][0] = affine_grad_ver_[y][1];
+    affine_grad_ver_[y][width - 1] = affine_grad_ver_[y][width - 2];
   }
   for (int x = 0; x < width; x++) {
-    affine_delta_hor_[0][x] = affine_delta_hor_[1][x];
-    affine_delta_hor_[height - 1][x] = affine_delta_hor_[height - 2][x];
-    affine_delta_ver_[0][x] = affine_delta_ver_[1][x];
-    affine_delta_ver_[height - 1][x] = affine_delta_ver_[height - 2][x];
+    affine_grad_hor_[0][x] = affine_grad_hor_[1][x];
+    affine_grad_hor_[height - 1][x] = affine_grad_hor_[height - 2][x];
+    affine_grad_ver_[0][x] = affine_grad_ver_[1][x];
+    affine_grad_ver_[height - 1][x] = affine_grad_ver_[height - 2][x];
   }
 
-  std::array<std::array<double, kNbrParams + 1>, kNbrParams> matrix = { { 0 } };
+  // Only the upper triangle is accumulated since the matrix is symmetric
+  std::array<std::array<int64_t, kNbrParams + 1>, kNbrParams> acc = { { 0 } };
   const Residual *err = err_buffer.GetDataPtr();
   for (int y = 0; y < height; y++) {
     for (int x = 0; x < width; x++) {
-      const double c[4] = {
-        affine_delta_hor_[y][x],
-        x * affine_delta_hor_[y][x] + y * affine_delta_ver_[y][x],
-        affine_delta_ver_[y][x],
-        y * affine_delta_hor_[y][x] - x * affine_delta_ver_[y][x],
+      const int grad_hor = affine_grad_hor_[y][x];
+      const int grad_ver = affine_grad_ver_[y][x];
+      const int64_t c[kNbrParams] = {
+        grad_hor,
+        x * grad_hor + y * grad_ver,
+        grad_ver,
+        y * grad_hor - x * grad_ver,
       };
       for (int row = 0; row < kNbrParams; row++) {
-        for (int col = 0; col < kNbrParams; col++) {
-          matrix[row][col] += c[row] * c[col];
+        for (int col = row; col < kNbrParams; col++) {
+          acc[row][col] += c[row] * c[col];
         }
-        matrix[row][kNbrParams] += err[x] * c[row];
+        acc[row][kNbrParams] += err[x] * c[row];
       }
     }
     err += err_buffer.GetStride();
   }
+  std::array<std::array<double, kNbrParams + 1>, kNbrParams> matrix;
+  for (int row = 0; row < kNbrParams; row++) {
+    for (int col = row; col < kNbrParams; col++) {
+      matrix[row][col] =
+        static_cast<double>(acc[row][col]) / (kGradScale * kGradScale);
+      matrix[col][row] = matrix[row][col];
+    }
+    matrix[row][kNbrParams] =
+      static_cast<double>(acc[row][kNbrParams]) / kGradScale;
+  }
 
   // solve linear equation system using row echelon form
   for (int i = 0; i < kNbrParams - 1; i++) {
@@ -979,7 +1015,7 @@ int InterSearch::EvalStartMvp(const CodingUnit &cu, const Qp &qp,
     auto mv = mvp_list[i];
     ClipMv(cu, ref_pic, &mv);   // TODO(PH) Is clip really needed here?
     MotionCompensationMv(cu, YuvComponent::kY, ref_pic, mv, true, pred_buffer);
-    Distortion dist = metric.CompareSample(cu, YuvComponent::kY, orig_pic_,
+    Distortion dist = metric.CompareSample(cu, YuvComponent::kY, *orig_pic_,
                                            *pred_buffer);
     Bits bits = GetMvpBits(i, static_cast<int>(mvp_list.size()));
     Distortion cost = dist + (static_cast<uint32_t>(bits * lambda + 0.5) >> 16);
@@ -32,6 +32,7 @@
 #include "xvc_common_lib/quantize.h"
 #include "xvc_enc_lib/encoder_settings.h"
 #include "xvc_enc_lib/encoder_simd_functions.h"
+#include "xvc_enc_lib/motion_preanalysis.h"
 #include "xvc_enc_lib/sample_metric.h"
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/transform_encoder.h"
@@ -55,6 +56,15 @@ public:
               const YuvPicture &rec_pic,
               const ReferencePictureLists &ref_pic_list,
               const EncoderSettings &encoder_settings);
+  // Rebinds the search to another picture and clears per picture state
+  void SetPicture(const PictureData &pic_data, const YuvPicture &orig_pic,
+                  const YuvPicture &rec_pic,
+                  const ReferencePictureLists &ref_pic_list);
+  // Seeds uni-prediction motion search of the current picture, cleared by
+  // SetPicture
+  void SetMotionPreanalysis(const MotionPreanalysis *motion_preanalysis) {
+    motion_preanalysis_ = motion_preanalysis;
+  }
   Distortion CompressInter(CodingUnit *cu, const Qp &qp,
                            const SyntaxWriter &bitstream_writer,
                            InterSearchFlags search_flags, Cost best_cu_cost,
@@ -83,6 +93,7 @@ public:
 private:
   enum class SearchMethod { TzSearch, FullSearch };
   static const int kSearchRangeBi = 4;
+  static const int kSearchRangePreanalysis = 32;
   static constexpr int kFastMergeNumCand = 4;
   static constexpr double kFastMergeCostFactor = 1.25;
   static constexpr double kFastTransformSelectCostFactor = 1.1;
@@ -216,9 +227,10 @@ private:
 
   const int bitdepth_;
   const int max_components_;
-  const PicNum poc_;
-  const int sub_gop_length_;
-  const YuvPicture &orig_pic_;
+  PicNum poc_;
+  int sub_gop_length_;
+  const YuvPicture *orig_pic_;
+  const MotionPreanalysis *motion_preanalysis_ = nullptr;
   const EncoderSettings &encoder_settings_;
   const EncoderSimdFunctions &simd_;
   const SampleMetric cu_metric_;    // TODO(PH) Get this from TransformEncocder
@@ -240,11 +252,11 @@ private:
   // Best fullpel search mv per ref list, ref idx and picture
   std::array<std::array<MvFullpel, constants::kMaxNumRefPics>,
     static_cast<int>(RefPicList::kTotalNumber)> previous_fullpel_;
-  // Affine search buffers
-  std::array<std::array<float, constants::kMaxBlockSize>,
-    constants::kMaxBlockSize> affine_delta_hor_;
-  std::array<std::array<float, constants::kMaxBlockSize>,
-    constants::kMaxBlockSize> affine_delta_ver_;
+  // Affine search gradient buffers, scaled by 8
+  std::array<std::array<int16_t, constants::kMaxBlockSize>,
+    constants::kMaxBlockSize> affine_grad_hor_;
+  std::array<std::array<int16_t, constants::kMaxBlockSize>,
+    constants::kMaxBlockSize> affine_grad_ver_;
   friend class TzSearch;
 };
 
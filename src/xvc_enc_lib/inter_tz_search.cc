@@ -85,7 +85,7 @@ MvFullpel
 TzSearch::Search(const CodingUnit &cu, const Qp &qp, const SampleMetric &metric,
                  const MotionVector &mvp, const YuvPicture &ref_pic,
                  const MvFullpel &mv_min, const MvFullpel &mv_max,
-                 const MvFullpel &prev_search) {
+                 const MvFullpel &prev_search, const MvFullpel *mv_seed) {
   static const int kDiamondSearchThreshold = 3;
   static const int kFullSearchGranularity = 5;
   const YuvComponent comp = YuvComponent::kY;
@@ -127,6 +127,14 @@ TzSearch::Search(const CodingUnit &cu, const Qp &qp, const SampleMetric &metric,
     }
   }
 
+  // Check vector from motion pre-analysis, search window is centered on it
+  if (mv_seed) {
+    MotionVector seed_clip = MotionVector(*mv_seed);
+    inter_pred_.ClipMv(cu, ref_pic, &seed_clip);
+    MvFullpel seed_fullpel = seed_clip;
+    CheckCostBest(&state, seed_fullpel.x, seed_fullpel.y);
+  }
+
   // Initial search around mvp
   MvFullpel mv_base = state.mv_best;
   int rounds_with_no_match = 0;
@@ -43,7 +43,8 @@ public:
   MvFullpel Search(const CodingUnit &cu, const Qp &qp,
                    const SampleMetric &metric, const MotionVector &mvp,
                    const YuvPicture &ref_pic, const MvFullpel &mv_min,
-                   const MvFullpel &mv_max, const MvFullpel &prev_search);
+                   const MvFullpel &mv_max, const MvFullpel &prev_search,
+                   const MvFullpel *mv_seed = nullptr);
 
 private:
   using const_mv = const MvFullpel;
@@ -24,6 +24,7 @@
 #include <limits>
 
 #include "xvc_common_lib/restrictions.h"
+#include "xvc_enc_lib/rate_estimator.h"
 #include "xvc_enc_lib/sample_metric.h"
 
 namespace xvc {
@@ -32,14 +33,21 @@ IntraSearch::IntraSearch(const EncoderSimdFunctions &simd, int bitdepth,
                          const PictureData &pic_data,
                          const YuvPicture &orig_pic,
                          const EncoderSettings &encoder_settings)
-  : IntraPrediction(bitdepth),
-  pic_data_(pic_data),
-  orig_pic_(orig_pic),
+  : IntraPrediction(simd.intra_prediction, bitdepth),
+  pic_data_(&pic_data),
+  orig_pic_(&orig_pic),
   encoder_settings_(encoder_settings),
   satd_metric_(simd.sample_metric, bitdepth, MetricType::kSatd),
   cu_writer_(pic_data, this) {
 }
 
+void IntraSearch::SetPicture(const PictureData &pic_data,
+                             const YuvPicture &orig_pic) {
+  pic_data_ = &pic_data;
+  orig_pic_ = &orig_pic;
+  cu_writer_.SetPictureData(pic_data);
+}
+
 Distortion
 IntraSearch::CompressIntraLuma(CodingUnit *cu, const Qp &qp,
                                const SyntaxWriter &bitstream_writer,
@@ -63,12 +71,20 @@ IntraSearch::CompressIntraLuma(CodingUnit *cu, const Qp &qp,
     best_is_applied = false;
 
     // Full reconstruction
-    RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
-    Distortion ssd = PredictAndTransform(cu, comp, qp, rdo_writer, ref_state,
-                                         encoder, rec_pic);
-    cu_writer_.WriteComponent(*cu, comp, &rdo_writer);
-
-    Bits bits = rdo_writer.GetNumWrittenBits();
+    Distortion ssd = PredictAndTransform(cu, comp, qp, bitstream_writer,
+                                         ref_state, encoder, rec_pic);
+    Bits bits;
+    if (encoder_settings_.fast_rate_estimation) {
+      // Syntax other than intra mode and residual is same for all modes
+      RateEstimator rate_estimator(bitstream_writer);
+      rate_estimator.EstimateIntraMode(intra_mode, GetPredictorLuma(*cu));
+      rate_estimator.EstimateResidualDataRdoCbf(*cu, comp);
+      bits = rate_estimator.GetNumBits();
+    } else {
+      RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
+      cu_writer_.WriteComponent(*cu, comp, &rdo_writer);
+      bits = rdo_writer.GetNumWrittenBits();
+    }
     Cost cost = ssd + static_cast<Cost>(bits * qp.GetLambda() + 0.5);
     const bool bias_normal_tx_type = cost == best_cost &&
       best_uses_tx_select && !cu->HasTransformSelectIdx();
@@ -93,7 +109,7 @@ Distortion
 IntraSearch::CompressIntraChroma(CodingUnit *cu, const Qp &qp,
                                  const SyntaxWriter &bitstream_writer,
                                  TransformEncoder *enc, YuvPicture *rec_pic) {
-  const CodingUnit *luma_cu = pic_data_.GetLumaCu(cu);
+  const CodingUnit *luma_cu = pic_data_->GetLumaCu(cu);
   IntraMode luma_mode = luma_cu->GetIntraMode(YuvComponent::kY);
   IntraPredictorChroma chroma_modes = GetPredictorsChroma(luma_mode);
   IntraPrediction::RefState ref_state_u;
@@ -180,8 +196,9 @@ IntraSearch::PredictAndTransform(CodingUnit *cu, YuvComponent comp,
   Predict(intra_mode, *cu, comp, ref_state, *rec_pic, &pred_buffer);
   TxSearchFlags tx_flags = TxSearchFlags::kFullEval & ~TxSearchFlags::kCbfZero;
   TransformEncoder::RdCost tx_cost =
-    encoder->CompressAndEvalTransform(cu, comp, qp, writer, orig_pic_, tx_flags,
-                                      nullptr, nullptr, &cu_writer_, rec_pic);
+    encoder->CompressAndEvalTransform(cu, comp, qp, writer, *orig_pic_,
+                                      tx_flags, nullptr, nullptr, &cu_writer_,
+                                      rec_pic);
   return tx_cost.dist_reco;
 }
 
@@ -227,12 +244,10 @@ IntraSearch::DetermineSlowIntraModes(CodingUnit *cu, const Qp &qp,
     Predict(intra_mode, *cu, comp, ref_state, *rec_pic, &pred_buf);
 
     // Bits
-    RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
-    rdo_writer.WriteIntraMode(intra_mode, mpm);
-    Bits bits = rdo_writer.GetNumWrittenBits();
+    Bits bits = GetIntraModeBits(intra_mode, mpm, bitstream_writer);
 
     uint64_t dist =
-      satd_metric_.CompareSample(*cu, comp, orig_pic_,
+      satd_metric_.CompareSample(*cu, comp, *orig_pic_,
                                  pred_buf.GetDataPtr(), pred_buf.GetStride());
     double cost = dist + bits * qp.GetLambdaSqrt();
     (*modes_cost)[i] = std::make_pair(intra_mode, cost);
@@ -269,11 +284,9 @@ IntraSearch::DetermineSlowIntraModes(CodingUnit *cu, const Qp &qp,
         }
         Predict(intra_mode, *cu, comp, ref_state, *rec_pic, &pred_buf);
         // Bits
-        RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
-        rdo_writer.WriteIntraMode(intra_mode, mpm);
-        Bits bits = rdo_writer.GetNumWrittenBits();
+        Bits bits = GetIntraModeBits(intra_mode, mpm, bitstream_writer);
         uint64_t dist =
-          satd_metric_.CompareSample(*cu, comp, orig_pic_, pred_buf);
+          satd_metric_.CompareSample(*cu, comp, *orig_pic_, pred_buf);
         double cost = dist + bits * qp.GetLambdaSqrt();
         (*modes_cost)[modes_added++] = std::make_pair(intra_mode, cost);
         evaluated_modes[intra_mode] = true;
@@ -302,4 +315,17 @@ IntraSearch::DetermineSlowIntraModes(CodingUnit *cu, const Qp &qp,
   return num_modes_for_slow_rdo;
 }
 
+Bits IntraSearch::GetIntraModeBits(IntraMode intra_mode,
+                                   const IntraPredictorLuma &mpm,
+                                   const SyntaxWriter &bitstream_writer) const {
+  if (encoder_settings_.fast_rate_estimation) {
+    RateEstimator rate_estimator(bitstream_writer);
+    rate_estimator.EstimateIntraMode(intra_mode, mpm);
+    return rate_estimator.GetNumBits();
+  }
+  RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
+  rdo_writer.WriteIntraMode(intra_mode, mpm);
+  return rdo_writer.GetNumWrittenBits();
+}
+
 }   // namespace xvc
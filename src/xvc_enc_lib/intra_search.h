@@ -39,6 +39,7 @@ public:
   IntraSearch(const EncoderSimdFunctions &simd, int bitdepth,
               const PictureData &pic_data, const YuvPicture &orig_pic,
               const EncoderSettings &encoder_settings);
+  void SetPicture(const PictureData &pic_data, const YuvPicture &orig_pic);
 
   Distortion CompressIntraLuma(CodingUnit *cu, const Qp &qp,
                                const SyntaxWriter &bitstream_writer,
@@ -64,9 +65,11 @@ private:
                               const IntraPrediction::RefState &ref_state,
                               TransformEncoder *encoder, YuvPicture *rec_pic,
                               IntraModeSet *modes_cost);
+  Bits GetIntraModeBits(IntraMode intra_mode, const IntraPredictorLuma &mpm,
+                        const SyntaxWriter &bitstream_writer) const;
 
-  const PictureData &pic_data_;
-  const YuvPicture &orig_pic_;
+  const PictureData *pic_data_;
+  const YuvPicture *orig_pic_;
   const EncoderSettings &encoder_settings_;
   const SampleMetric satd_metric_;
   CodingUnit::ResidualState best_cu_state_;
@@ -0,0 +1,255 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include "xvc_enc_lib/lookahead.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/utils.h"
+
+namespace xvc {
+
+bool Lookahead::PrepareSubGop(
+  const std::vector<std::shared_ptr<PictureEncoder>> &pic_buffer,
+  PicNum end_poc, PicNum sub_gop_length, SubGop *sub_gop) const {
+  const YuvComponent comp = YuvComponent::kY;
+  if (sub_gop_length < 2 || end_poc < sub_gop_length) {
+    return false;
+  }
+  const PicNum first_poc = end_poc - sub_gop_length;
+  sub_gop->first_poc = first_poc;
+  sub_gop->sub_gop_length = sub_gop_length;
+  sub_gop->pics.assign(sub_gop_length + 1, nullptr);
+  sub_gop->pyramids.assign(sub_gop_length + 1, nullptr);
+  for (auto &pic : pic_buffer) {
+    if (pic->GetPoc() > first_poc && pic->GetPoc() <= end_poc &&
+        pic->GetOutputStatus() == OutputStatus::kReady) {
+      sub_gop->pics[pic->GetPoc() - first_poc] = pic;
+    }
+  }
+  // Picture before the sub-gop is only used as reference
+  sub_gop->pics[0] = FindPicture(pic_buffer, first_poc);
+  const std::shared_ptr<PictureEncoder> &key_pic = sub_gop->pics.back();
+  if (!key_pic) {
+    return false;
+  }
+  const int width = key_pic->GetOrigPic()->GetWidth(comp);
+  const int height = key_pic->GetOrigPic()->GetHeight(comp);
+  for (size_t i = 0; i < sub_gop->pics.size(); i++) {
+    std::shared_ptr<PictureEncoder> &pic = sub_gop->pics[i];
+    if (pic && (pic->GetOrigPic()->GetWidth(comp) != width ||
+                pic->GetOrigPic()->GetHeight(comp) != height)) {
+      pic.reset();
+    }
+    if (pic) {
+      // Held by the job so that the picture buffer entry can be reused
+      sub_gop->pyramids[i] = pic->GetOrigPyramid();
+    }
+  }
+  return true;
+}
+
+void Lookahead::AnalyzeSubGop(const SubGop &sub_gop) const {
+  const int length = static_cast<int>(sub_gop.sub_gop_length);
+  MotionPreanalysis motion_analysis(simd_.sample_metric);
+  std::vector<std::vector<uint32_t>> intra_costs(length + 1);
+  std::vector<std::vector<double>> propagate_costs(length + 1);
+  std::vector<MvFullpel> mvs[2];
+  std::vector<uint32_t> inter_costs[2];
+  int num_blocks_x = 0;
+  int num_blocks_y = 0;
+
+  // Pictures of a temporal layer are only predicted from lower layers, so
+  // all cost has been propagated to a picture when its layer is reached
+  const int max_tid = SegmentHeader::GetMaxTid(sub_gop.sub_gop_length);
+  for (int tid = max_tid; tid >= 0; tid--) {
+    for (int i = 1; i <= length; i++) {
+      const std::shared_ptr<PictureEncoder> &pic = sub_gop.pics[i];
+      if (!pic || pic->GetTid() != tid) {
+        continue;
+      }
+      const MotionPreanalysis::Pyramid &orig_pyramid = *sub_gop.pyramids[i];
+      motion_analysis.CalcIntraCosts(orig_pyramid,
+                                     pic->GetOrigPic()->GetBitdepth(),
+                                     &intra_costs[i]);
+      num_blocks_x = motion_analysis.GetNumBlocksX();
+      num_blocks_y = motion_analysis.GetNumBlocksY();
+      const int num_blocks = static_cast<int>(intra_costs[i].size());
+      propagate_costs[i].resize(num_blocks, 0);
+
+      // Prediction structure is assumed to be dyadic, the key picture only
+      // refers to pictures outside of the sub-gop so nothing is propagated
+      const int distance = std::max(1, length >> tid);
+      const int ref_candidates[2] = { i - distance, i + distance };
+      int ref_indices[2] = { -1, -1 };
+      int num_refs = 0;
+      for (int ref_idx : ref_candidates) {
+        if (tid == 0 || ref_idx < 0 || ref_idx > length ||
+            !sub_gop.pics[ref_idx]) {
+          continue;
+        }
+        const int search_range =
+          MotionPreanalysis::CalcSearchRange(encoder_settings_, distance,
+                                             length);
+        motion_analysis.AnalyzeRefPic(orig_pyramid, *sub_gop.pyramids[ref_idx],
+                                      search_range, &mvs[num_refs],
+                                      &inter_costs[num_refs]);
+        if (encoder_settings_.fast_motion_preanalysis > 0) {
+          // Same search as the preanalysis would do when encoding
+          pic->AddPreanalysisMvs(*sub_gop.pics[ref_idx], search_range,
+                                 mvs[num_refs]);
+        }
+        ref_indices[num_refs] = ref_idx;
+        num_refs++;
+      }
+
+      // Propagate the part of the block cost that inter prediction saves
+      for (int block = 0; block < num_blocks && num_refs > 0; block++) {
+        int best_ref = 0;
+        if (num_refs > 1 && inter_costs[1][block] < inter_costs[0][block]) {
+          best_ref = 1;
+        }
+        // Nothing is derived for the picture before the sub-gop
+        const int ref_idx = ref_indices[best_ref];
+        if (ref_idx == 0) {
+          continue;
+        }
+        const double intra_cost = intra_costs[i][block];
+        const double inter_cost =
+          std::min(intra_cost, 1.0 * inter_costs[best_ref][block]);
+        const double amount = (intra_cost + propagate_costs[i][block]) *
+          (intra_cost - inter_cost) / intra_cost;
+        propagate_costs[ref_idx].resize(num_blocks, 0);
+        PropagateCost(mvs[best_ref], num_blocks_x, num_blocks_y, block,
+                      amount, &propagate_costs[ref_idx]);
+      }
+    }
+  }
+
+  for (int i = 1; i <= length; i++) {
+    if (sub_gop.pics[i]) {
+      sub_gop.pics[i]->SetCtuQpOffsets(
+        DeriveCtuQpOffsets(*sub_gop.pics[i]->GetOrigPic(), num_blocks_x,
+                           intra_costs[i], propagate_costs[i]));
+    }
+  }
+}
+
+std::shared_ptr<PictureEncoder>
+Lookahead::FindPicture(
+  const std::vector<std::shared_ptr<PictureEncoder>> &pic_buffer,
+  PicNum poc) const {
+  for (auto &pic : pic_buffer) {
+    // Reference pictures are kept after output, others may be reused
+    if (pic->GetPoc() == poc &&
+        (pic->GetOutputStatus() != OutputStatus::kHasBeenOutput ||
+         pic->IsReferenced())) {
+      return pic;
+    }
+  }
+  return nullptr;
+}
+
+void Lookahead::PropagateCost(const std::vector<MvFullpel> &mvs,
+                              int num_blocks_x, int num_blocks_y,
+                              int block_idx, double amount,
+                              std::vector<double> *ref_propagate) const {
+  const int kBlockSize = MotionPreanalysis::kBlockSize;
+  const int kBlockSizeLog2 = MotionPreanalysis::kBlockSizeLog2;
+  // Referenced area is split over the up to four blocks that it overlaps
+  const int posx = (block_idx % num_blocks_x) * kBlockSize + mvs[block_idx].x;
+  const int posy = (block_idx / num_blocks_x) * kBlockSize + mvs[block_idx].y;
+  const int block_x = posx >> kBlockSizeLog2;
+  const int block_y = posy >> kBlockSizeLog2;
+  const int frac_x = posx & (kBlockSize - 1);
+  const int frac_y = posy & (kBlockSize - 1);
+  const int weights[2][2] = {
+    { (kBlockSize - frac_x) * (kBlockSize - frac_y),
+      frac_x * (kBlockSize - frac_y) },
+    { (kBlockSize - frac_x) * frac_y, frac_x * frac_y },
+  };
+  for (int dy = 0; dy < 2; dy++) {
+    for (int dx = 0; dx < 2; dx++) {
+      const int x = block_x + dx;
+      const int y = block_y + dy;
+      if (x < 0 || y < 0 || x >= num_blocks_x || y >= num_blocks_y ||
+          !weights[dy][dx]) {
+        continue;
+      }
+      (*ref_propagate)[y * num_blocks_x + x] +=
+        amount * weights[dy][dx] / (kBlockSize * kBlockSize);
+    }
+  }
+}
+
+std::vector<int>
+Lookahead::DeriveCtuQpOffsets(const YuvPicture &orig_pic, int num_blocks_x,
+                              const std::vector<uint32_t> &intra_costs,
+                              const std::vector<double> &propagate) const {
+  const YuvComponent comp = YuvComponent::kY;
+  const int kBlocksPerCtuLog2 =
+    constants::kCtuSizeLog2 - MotionPreanalysis::kBlockSizeLog2;
+  const double strength = encoder_settings_.temporal_aqp_strength / 10.0;
+  const int num_ctu_x =
+    (orig_pic.GetWidth(comp) + constants::kCtuSize - 1) >>
+    constants::kCtuSizeLog2;
+  const int num_ctu_y =
+    (orig_pic.GetHeight(comp) + constants::kCtuSize - 1) >>
+    constants::kCtuSizeLog2;
+  if (propagate.empty()) {
+    return std::vector<int>();
+  }
+
+  // Average qp offset of the blocks in each ctu
+  std::vector<double> ctu_offsets(num_ctu_x * num_ctu_y, 0);
+  std::vector<int> ctu_num_blocks(num_ctu_x * num_ctu_y, 0);
+  for (int block = 0; block < static_cast<int>(intra_costs.size());
+       block++) {
+    const int ctu_x = (block % num_blocks_x) >> kBlocksPerCtuLog2;
+    const int ctu_y = (block / num_blocks_x) >> kBlocksPerCtuLog2;
+    const double intra_cost = intra_costs[block];
+    ctu_offsets[ctu_y * num_ctu_x + ctu_x] -=
+      strength * std::log2((intra_cost + propagate[block]) / intra_cost);
+    ctu_num_blocks[ctu_y * num_ctu_x + ctu_x]++;
+  }
+  for (int ctu = 0; ctu < num_ctu_x * num_ctu_y; ctu++) {
+    ctu_offsets[ctu] /= std::max(1, ctu_num_blocks[ctu]);
+  }
+
+  // Offsets are centered around zero to keep the rate of the picture, so
+  // ctus that are referenced less than average get a higher qp
+  double mean_offset = 0;
+  for (int ctu = 0; ctu < num_ctu_x * num_ctu_y; ctu++) {
+    mean_offset += ctu_offsets[ctu];
+  }
+  mean_offset /= num_ctu_x * num_ctu_y;
+  std::vector<int> qp_offsets(num_ctu_x * num_ctu_y);
+  for (int ctu = 0; ctu < num_ctu_x * num_ctu_y; ctu++) {
+    const int offset =
+      static_cast<int>(std::lround(ctu_offsets[ctu] - mean_offset));
+    qp_offsets[ctu] = util::Clip3(offset, -kMaxQpOffset, kMaxQpOffset);
+  }
+  return qp_offsets;
+}
+
+}   // namespace xvc
@@ -0,0 +1,88 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_LOOKAHEAD_H_
+#define XVC_ENC_LIB_LOOKAHEAD_H_
+
+#include <memory>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/encoder_simd_functions.h"
+#include "xvc_enc_lib/motion_preanalysis.h"
+#include "xvc_enc_lib/picture_encoder.h"
+
+namespace xvc {
+
+// Temporal adaptive qp from the original pictures of a sub-gop. Coding cost
+// that each block saves for the pictures predicting from it is propagated
+// backwards through the prediction hierarchy, ctus that are referenced a lot
+// get a lower qp and ctus that no other picture uses get a higher qp.
+class Lookahead {
+public:
+  // Pictures of one sub-gop together with the picture before it, indexed by
+  // poc minus first_poc. They are collected up front so that the analysis
+  // can run as a job without touching the picture buffer.
+  struct SubGop {
+    PicNum first_poc = 0;
+    PicNum sub_gop_length = 0;
+    std::vector<std::shared_ptr<PictureEncoder>> pics;
+    std::vector<std::shared_ptr<const MotionPreanalysis::Pyramid>> pyramids;
+  };
+
+  Lookahead(const EncoderSimdFunctions &simd,
+            const EncoderSettings &encoder_settings)
+    : simd_(simd),
+    encoder_settings_(encoder_settings) {
+  }
+  // Collects the sub-gop ending with the key picture at end_poc, returns
+  // false if there is nothing to analyze
+  bool PrepareSubGop(
+    const std::vector<std::shared_ptr<PictureEncoder>> &pic_buffer,
+    PicNum end_poc, PicNum sub_gop_length, SubGop *sub_gop) const;
+  // Sets ctu qp offsets and motion preanalysis vectors of all pictures in the
+  // sub-gop, the pictures must not have started encoding. Different sub-gops
+  // can be analyzed concurrently.
+  void AnalyzeSubGop(const SubGop &sub_gop) const;
+
+private:
+  static const int kMaxQpOffset = 6;
+
+  std::shared_ptr<PictureEncoder>
+    FindPicture(const std::vector<std::shared_ptr<PictureEncoder>> &pic_buffer,
+                PicNum poc) const;
+  void PropagateCost(const std::vector<MvFullpel> &mvs, int num_blocks_x,
+                     int num_blocks_y, int block_idx, double amount,
+                     std::vector<double> *ref_propagate) const;
+  std::vector<int> DeriveCtuQpOffsets(const YuvPicture &orig_pic,
+                                      int num_blocks_x,
+                                      const std::vector<uint32_t> &intra_costs,
+                                      const std::vector<double> &propagate)
+                                      const;
+
+  const EncoderSimdFunctions &simd_;
+  const EncoderSettings &encoder_settings_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_LOOKAHEAD_H_
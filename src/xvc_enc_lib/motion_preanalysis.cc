@@ -0,0 +1,331 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include "xvc_enc_lib/motion_preanalysis.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "xvc_common_lib/utils.h"
+
+namespace xvc {
+
+void MotionPreanalysis::Analyze(const PictureData &pic_data,
+                                const YuvPicture &orig_pic,
+                                const Pyramid &orig_pyramid,
+                                const RefPyramidFunc &get_ref_pyramid,
+                                const EncoderSettings &encoder_settings) {
+  const YuvComponent comp = YuvComponent::kY;
+  const ReferencePictureLists &ref_pic_lists = *pic_data.GetRefPicLists();
+  const int sub_gop_length = static_cast<int>(pic_data.GetSubGopLength());
+  const int width = orig_pic.GetWidth(comp);
+  const int height = orig_pic.GetHeight(comp);
+  SetPictureSize(orig_pyramid);
+  for (int list_idx = 0; list_idx < 2; list_idx++) {
+    const RefPicList ref_list = static_cast<RefPicList>(list_idx);
+    num_ref_pics_[list_idx] = ref_pic_lists.GetNumRefPics(ref_list);
+    for (int ref_idx = 0; ref_idx < num_ref_pics_[list_idx]; ref_idx++) {
+      std::vector<MvFullpel> &mvs = mvs_[list_idx][ref_idx];
+      mvs.clear();
+      const YuvPicture *ref_orig =
+        ref_pic_lists.GetRefOrigPic(ref_list, ref_idx);
+      if (!ref_orig || ref_orig->GetWidth(comp) != width ||
+          ref_orig->GetHeight(comp) != height) {
+        continue;
+      }
+      // Same picture can be present in both reference picture lists
+      const std::vector<MvFullpel> *prev_mvs = nullptr;
+      for (int prev_list = 0; prev_list <= list_idx && !prev_mvs;
+           prev_list++) {
+        const RefPicList ref_list_prev = static_cast<RefPicList>(prev_list);
+        const int num_prev = prev_list == list_idx ? ref_idx :
+          num_ref_pics_[prev_list];
+        for (int prev_idx = 0; prev_idx < num_prev; prev_idx++) {
+          if (ref_pic_lists.GetRefOrigPic(ref_list_prev, prev_idx) ==
+              ref_orig && !mvs_[prev_list][prev_idx].empty()) {
+            prev_mvs = &mvs_[prev_list][prev_idx];
+            break;
+          }
+        }
+      }
+      if (prev_mvs) {
+        mvs = *prev_mvs;
+        continue;
+      }
+      const PicNum ref_poc = ref_pic_lists.GetRefPoc(ref_list, ref_idx);
+      const int delta_poc = static_cast<int>(pic_data.GetPoc() - ref_poc);
+      const int search_range =
+        CalcSearchRange(encoder_settings, delta_poc, sub_gop_length);
+      for (auto &searched : searched_mvs_) {
+        if (searched.ref_orig == ref_orig && searched.ref_poc == ref_poc &&
+            searched.search_range == search_range) {
+          mvs = searched.mvs;
+          break;
+        }
+      }
+      if (!mvs.empty()) {
+        continue;
+      }
+      const Pyramid *ref_pyramid =
+        get_ref_pyramid ? get_ref_pyramid(*ref_orig) : nullptr;
+      if (!ref_pyramid) {
+        BuildPyramid(*ref_orig, &ref_pyramid_);
+        ref_pyramid = &ref_pyramid_;
+      }
+      SearchRefPic(orig_pyramid, *ref_pyramid, (search_range + 3) >> 2,
+                   &mvs);
+    }
+  }
+}
+
+void MotionPreanalysis::AddSearchedMvs(const YuvPicture *ref_orig,
+                                       PicNum ref_poc, int search_range,
+                                       const std::vector<MvFullpel> &mvs) {
+  SearchedMvs searched;
+  searched.ref_orig = ref_orig;
+  searched.ref_poc = ref_poc;
+  searched.search_range = search_range;
+  searched.mvs = mvs;
+  searched_mvs_.push_back(std::move(searched));
+}
+
+bool MotionPreanalysis::GetMv(RefPicList ref_list, int ref_idx, int posx,
+                              int posy, MvFullpel *mv) const {
+  const int list_idx = static_cast<int>(ref_list);
+  if (ref_idx >= num_ref_pics_[list_idx] ||
+      mvs_[list_idx][ref_idx].empty()) {
+    return false;
+  }
+  const int block_x = std::min(posx >> kBlockSizeLog2, num_blocks_x_ - 1);
+  const int block_y = std::min(posy >> kBlockSizeLog2, num_blocks_y_ - 1);
+  *mv = mvs_[list_idx][ref_idx][block_y * num_blocks_x_ + block_x];
+  return true;
+}
+
+void MotionPreanalysis::AnalyzeRefPic(const Pyramid &orig_pyramid,
+                                      const Pyramid &ref_pyramid,
+                                      int search_range,
+                                      std::vector<MvFullpel> *mvs,
+                                      std::vector<uint32_t> *costs) {
+  SetPictureSize(orig_pyramid);
+  SearchRefPic(orig_pyramid, ref_pyramid, (search_range + 3) >> 2, mvs,
+               costs);
+}
+
+void MotionPreanalysis::CalcIntraCosts(const Pyramid &orig_pyramid,
+                                       int bitdepth,
+                                       std::vector<uint32_t> *costs) {
+  const int block_size = kBlockSize >> 1;
+  // Avoids that flat areas get an undefined share of propagated cost
+  const uint32_t min_cost =
+    static_cast<uint32_t>(block_size * block_size) << (bitdepth - 8);
+  SetPictureSize(orig_pyramid);
+  const Plane &plane = orig_pyramid.half;
+  costs->resize(num_blocks_x_ * num_blocks_y_);
+  // Deviation from block mean as a rough estimate of intra dc prediction
+  for (int block_y = 0; block_y < num_blocks_y_; block_y++) {
+    for (int block_x = 0; block_x < num_blocks_x_; block_x++) {
+      const Sample *src = &plane.samples[block_y * block_size * plane.width +
+                                         block_x * block_size];
+      int sum = 0;
+      for (int y = 0; y < block_size; y++) {
+        for (int x = 0; x < block_size; x++) {
+          sum += src[y * plane.width + x];
+        }
+      }
+      const int mean = sum / (block_size * block_size);
+      uint32_t cost = 0;
+      for (int y = 0; y < block_size; y++) {
+        for (int x = 0; x < block_size; x++) {
+          cost += std::abs(src[y * plane.width + x] - mean);
+        }
+      }
+      (*costs)[block_y * num_blocks_x_ + block_x] = cost + min_cost;
+    }
+  }
+}
+
+void MotionPreanalysis::BuildPyramid(const YuvPicture &pic,
+                                     Pyramid *pyramid) {
+  const YuvComponent comp = YuvComponent::kY;
+  Downscale(pic.GetSamplePtr(comp, 0, 0), pic.GetStride(comp),
+            pic.GetWidth(comp), pic.GetHeight(comp), kBlockSize >> 1,
+            &pyramid->half);
+  const Plane &half = pyramid->half;
+  Downscale(&half.samples[0], half.width, half.width, half.height,
+            kBlockSize >> 2, &pyramid->quarter);
+}
+
+int MotionPreanalysis::CalcSearchRange(const EncoderSettings &encoder_settings,
+                                       int delta_poc, int sub_gop_length) {
+  // Same range as full resolution uni-prediction search without seed
+  const int max = encoder_settings.inter_search_range_uni_max;
+  const int min = encoder_settings.inter_search_range_uni_min;
+  const int search_range =
+    (max * std::abs(delta_poc) + (sub_gop_length / 2)) / sub_gop_length;
+  return util::Clip3(search_range, min, max);
+}
+
+void MotionPreanalysis::SetPictureSize(const Pyramid &pyramid) {
+  num_blocks_x_ = pyramid.half.width >> (kBlockSizeLog2 - 1);
+  num_blocks_y_ = pyramid.half.height >> (kBlockSizeLog2 - 1);
+}
+
+void MotionPreanalysis::Downscale(const Sample *src, ptrdiff_t src_stride,
+                                  int src_width, int src_height,
+                                  int block_size, Plane *dst) {
+  dst->width =
+    (((src_width + 1) >> 1) + block_size - 1) / block_size * block_size;
+  dst->height =
+    (((src_height + 1) >> 1) + block_size - 1) / block_size * block_size;
+  dst->samples.resize(dst->width * dst->height);
+  Sample *dst_ptr = &dst->samples[0];
+  for (int y = 0; y < dst->height; y++) {
+    const Sample *src0 = src + std::min(2 * y, src_height - 1) * src_stride;
+    const Sample *src1 = src + std::min(2 * y + 1, src_height - 1) * src_stride;
+    for (int x = 0; x < dst->width; x++) {
+      const int x0 = std::min(2 * x, src_width - 1);
+      const int x1 = std::min(2 * x + 1, src_width - 1);
+      dst_ptr[x] = static_cast<Sample>(
+        (src0[x0] + src0[x1] + src1[x0] + src1[x1] + 2) >> 2);
+    }
+    dst_ptr += dst->width;
+  }
+}
+
+void MotionPreanalysis::SearchRefPic(const Pyramid &orig_pyramid,
+                                     const Pyramid &ref_pyramid,
+                                     int coarse_range,
+                                     std::vector<MvFullpel> *mvs,
+                                     std::vector<uint32_t> *costs) {
+  const int num_blocks = num_blocks_x_ * num_blocks_y_;
+  const int quarter_block_size = kBlockSize >> 2;
+  const int half_block_size = kBlockSize >> 1;
+  quarter_mvs_.resize(num_blocks);
+  mvs->resize(num_blocks);
+  if (costs) {
+    costs->resize(num_blocks);
+  }
+
+  // Coarse search around the best of zero and neighboring block vectors
+  for (int block_y = 0; block_y < num_blocks_y_; block_y++) {
+    for (int block_x = 0; block_x < num_blocks_x_; block_x++) {
+      const int idx = block_y * num_blocks_x_ + block_x;
+      MvFullpel center(0, 0);
+      uint32_t center_cost;
+      SearchBlock(orig_pyramid.quarter, ref_pyramid.quarter,
+                  quarter_block_size, block_x, block_y, center, 0, 1,
+                  &center_cost);
+      MvFullpel neighbors[2];
+      int num_neighbors = 0;
+      if (block_x > 0) {
+        neighbors[num_neighbors++] = quarter_mvs_[idx - 1];
+      }
+      if (block_y > 0) {
+        neighbors[num_neighbors++] = quarter_mvs_[idx - num_blocks_x_];
+      }
+      for (int i = 0; i < num_neighbors; i++) {
+        uint32_t cost;
+        MvFullpel mv =
+          SearchBlock(orig_pyramid.quarter, ref_pyramid.quarter,
+                      quarter_block_size, block_x, block_y, neighbors[i], 0,
+                      1, &cost);
+        if (cost < center_cost) {
+          center = mv;
+          center_cost = cost;
+        }
+      }
+      uint32_t cost;
+      if (coarse_range > kCoarseSearchRange) {
+        center = SearchBlock(orig_pyramid.quarter, ref_pyramid.quarter,
+                             quarter_block_size, block_x, block_y, center,
+                             coarse_range, 2, &cost);
+        quarter_mvs_[idx] =
+          SearchBlock(orig_pyramid.quarter, ref_pyramid.quarter,
+                      quarter_block_size, block_x, block_y, center, 1, 1,
+                      &cost);
+      } else {
+        quarter_mvs_[idx] =
+          SearchBlock(orig_pyramid.quarter, ref_pyramid.quarter,
+                      quarter_block_size, block_x, block_y, center,
+                      kCoarseSearchRange, 1, &cost);
+      }
+    }
+  }
+
+  // Refinement at half resolution
+  for (int block_y = 0; block_y < num_blocks_y_; block_y++) {
+    for (int block_x = 0; block_x < num_blocks_x_; block_x++) {
+      const int idx = block_y * num_blocks_x_ + block_x;
+      const MvFullpel center(2 * quarter_mvs_[idx].x,
+                             2 * quarter_mvs_[idx].y);
+      uint32_t cost;
+      MvFullpel mv =
+        SearchBlock(orig_pyramid.half, ref_pyramid.half, half_block_size,
+                    block_x, block_y, center, kRefineSearchRange, 1, &cost);
+      (*mvs)[idx] = MvFullpel(2 * mv.x, 2 * mv.y);
+      if (costs) {
+        (*costs)[idx] = cost;
+      }
+    }
+  }
+}
+
+MvFullpel
+MotionPreanalysis::SearchBlock(const Plane &orig, const Plane &ref,
+                               int block_size, int block_x, int block_y,
+                               const MvFullpel &center, int search_range,
+                               int step_size, uint32_t *best_cost) const {
+  const int posx = block_x * block_size;
+  const int posy = block_y * block_size;
+  auto sad_func = simd_.sad_sample_sample[util::SizeToLog2(block_size)];
+  const Sample *orig_ptr = &orig.samples[posy * orig.width + posx];
+  const Sample *ref_ptr = &ref.samples[posy * ref.width + posx];
+  // Reference block is kept inside of the downscaled picture
+  const int min_x = -posx;
+  const int min_y = -posy;
+  const int max_x = ref.width - block_size - posx;
+  const int max_y = ref.height - block_size - posy;
+  const int center_x = util::Clip3(center.x, min_x, max_x);
+  const int center_y = util::Clip3(center.y, min_y, max_y);
+  MvFullpel best_mv(center_x, center_y);
+  *best_cost = sad_func(block_size, block_size, orig_ptr, orig.width,
+                        ref_ptr + center_y * ref.width + center_x, ref.width);
+  const int start_x = std::max(center_x - search_range, min_x);
+  const int start_y = std::max(center_y - search_range, min_y);
+  const int end_x = std::min(center_x + search_range, max_x);
+  const int end_y = std::min(center_y + search_range, max_y);
+  for (int mv_y = start_y; mv_y <= end_y; mv_y += step_size) {
+    for (int mv_x = start_x; mv_x <= end_x; mv_x += step_size) {
+      const uint32_t cost =
+        sad_func(block_size, block_size, orig_ptr, orig.width,
+                 ref_ptr + mv_y * ref.width + mv_x, ref.width);
+      if (cost < *best_cost) {
+        *best_cost = cost;
+        best_mv = MvFullpel(mv_x, mv_y);
+      }
+    }
+  }
+  return best_mv;
+}
+
+}   // namespace xvc
@@ -0,0 +1,132 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_MOTION_PREANALYSIS_H_
+#define XVC_ENC_LIB_MOTION_PREANALYSIS_H_
+
+#include <functional>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/cu_types.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/reference_picture_lists.h"
+#include "xvc_common_lib/yuv_pic.h"
+#include "xvc_enc_lib/encoder_settings.h"
+#include "xvc_enc_lib/sample_metric.h"
+
+namespace xvc {
+
+// Coarse block motion estimation on downscaled original pictures. Vectors are
+// first searched at quarter resolution, refined at half resolution and then
+// used for seeding the full resolution motion estimation or for lookahead.
+class MotionPreanalysis {
+public:
+  static const int kBlockSizeLog2 = 4;
+  static const int kBlockSize = 1 << kBlockSizeLog2;
+
+  // Downscaled luma plane, the size is rounded up to whole blocks at each
+  // resolution by repeating the last column and row
+  struct Plane {
+    std::vector<Sample> samples;
+    int width = 0;
+    int height = 0;
+  };
+  struct Pyramid {
+    Plane half;
+    Plane quarter;
+  };
+  // Returns the pyramid of a reference picture or nullptr if not available
+  typedef std::function<const Pyramid*(const YuvPicture &ref_orig)>
+    RefPyramidFunc;
+
+  explicit MotionPreanalysis(const SampleMetric::SimdFunc &simd)
+    : simd_(simd) {
+  }
+  // Estimates one vector for each block and reference picture, the search
+  // range follows the temporal distance to each reference picture
+  void Analyze(const PictureData &pic_data, const YuvPicture &orig_pic,
+               const Pyramid &orig_pyramid,
+               const RefPyramidFunc &get_ref_pyramid,
+               const EncoderSettings &encoder_settings);
+  // Vectors from an earlier search of the same picture pair, e.g. by the
+  // lookahead, that are used by Analyze instead of searching again
+  void AddSearchedMvs(const YuvPicture *ref_orig, PicNum ref_poc,
+                      int search_range, const std::vector<MvFullpel> &mvs);
+  void ClearSearchedMvs() { searched_mvs_.clear(); }
+  // Fullpel vector at full resolution for the block covering a luma position
+  bool GetMv(RefPicList ref_list, int ref_idx, int posx, int posy,
+             MvFullpel *mv) const;
+  // Searches all blocks against a single reference picture of the same size,
+  // block costs are sum of absolute differences at half resolution
+  void AnalyzeRefPic(const Pyramid &orig_pyramid, const Pyramid &ref_pyramid,
+                     int search_range, std::vector<MvFullpel> *mvs,
+                     std::vector<uint32_t> *costs);
+  // Intra cost estimate per block on the same scale as the inter costs
+  void CalcIntraCosts(const Pyramid &orig_pyramid, int bitdepth,
+                      std::vector<uint32_t> *costs);
+  // Vectors at quarter resolution from the last reference picture searched
+  const std::vector<MvFullpel>& GetQuarterMvs() const { return quarter_mvs_; }
+  int GetNumBlocksX() const { return num_blocks_x_; }
+  int GetNumBlocksY() const { return num_blocks_y_; }
+  static void BuildPyramid(const YuvPicture &pic, Pyramid *pyramid);
+  static int CalcSearchRange(const EncoderSettings &encoder_settings,
+                             int delta_poc, int sub_gop_length);
+
+private:
+  // Search range in samples at quarter resolution that is searched
+  // exhaustively, larger ranges are first searched on every second position
+  static const int kCoarseSearchRange = 8;
+  // Search range in samples at half resolution around the scaled vector
+  static const int kRefineSearchRange = 2;
+
+  struct SearchedMvs {
+    const YuvPicture *ref_orig;
+    PicNum ref_poc;
+    int search_range;
+    std::vector<MvFullpel> mvs;
+  };
+  void SetPictureSize(const Pyramid &pyramid);
+  static void Downscale(const Sample *src, ptrdiff_t src_stride,
+                        int src_width, int src_height, int block_size,
+                        Plane *dst);
+  void SearchRefPic(const Pyramid &orig_pyramid, const Pyramid &ref_pyramid,
+                    int coarse_range, std::vector<MvFullpel> *mvs,
+                    std::vector<uint32_t> *costs = nullptr);
+  MvFullpel SearchBlock(const Plane &orig, const Plane &ref, int block_size,
+                        int block_x, int block_y, const MvFullpel &center,
+                        int search_range, int step_size,
+                        uint32_t *best_cost) const;
+
+  const SampleMetric::SimdFunc &simd_;
+  Pyramid ref_pyramid_;
+  int num_blocks_x_ = 0;
+  int num_blocks_y_ = 0;
+  std::vector<MvFullpel> quarter_mvs_;
+  std::vector<MvFullpel>
+    mvs_[static_cast<int>(RefPicList::kTotalNumber)][constants::kMaxNumRefPics];
+  int num_ref_pics_[static_cast<int>(RefPicList::kTotalNumber)] = { 0, 0 };
+  std::vector<SearchedMvs> searched_mvs_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_MOTION_PREANALYSIS_H_
@@ -24,9 +24,12 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <condition_variable>   // NOLINT
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <memory>
+#include <mutex>                // NOLINT
 #include <numeric>
 #include <utility>
 
@@ -50,7 +53,8 @@ PictureEncoder::PictureEncoder(const EncoderSimdFunctions &simd,
                                           pic_fmt.height, pic_fmt.bitdepth)),
   rec_pic_(std::make_shared<YuvPicture>(pic_fmt.chroma_format, pic_fmt.width,
                                         pic_fmt.height, pic_fmt.bitdepth,
-                                        true, 0, 0)) {
+                                        true, 0, 0)),
+  motion_preanalysis_(simd.sample_metric) {
 }
 
 void PictureEncoder::Init(const SegmentHeader &segment, PicNum doc, PicNum poc,
@@ -58,6 +62,13 @@ void PictureEncoder::Init(const SegmentHeader &segment, PicNum doc, PicNum poc,
   const int max_tid = SegmentHeader::GetMaxTid(segment.max_sub_gop_length);
   output_status_ = OutputStatus::kReady;
   buffer_flag_ = false;
+  ctu_qp_offsets_.clear();
+  {
+    // Original picture is about to be replaced
+    std::lock_guard<std::mutex> lock(orig_pyramid_mutex_);
+    has_orig_pyramid_ = false;
+  }
+  motion_preanalysis_.ClearSearchedMvs();
   pic_data_->SetDoc(doc);
   pic_data_->SetPoc(poc);
   pic_data_->SetTid(tid);
@@ -92,10 +103,13 @@ void PictureEncoder::Init(const SegmentHeader &segment, PicNum doc, PicNum poc,
   }
 }
 
-const std::vector<uint8_t>*
+std::vector<uint8_t>*
 PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
                        int buffer_flag,
-                       const EncoderSettings &encoder_settings) {
+                       const EncoderSettings &encoder_settings,
+                       const std::vector<std::shared_ptr<const PictureEncoder>>
+                       &ref_pics,
+                       std::unique_ptr<CuEncoder> *cached_cu_encoder) {
   const PicturePredictionType picture_type = pic_data_->GetPredictionType();
   int sub_gop_length = static_cast<int>(segment.max_sub_gop_length);
   int max_tid = SegmentHeader::GetMaxTid(sub_gop_length);
@@ -117,7 +131,17 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
              encoder_settings.chroma_qp_offset_u,
              encoder_settings.chroma_qp_offset_v);
 
+  const int num_ctu_rows = pic_data_->GetNumCtuY();
+  const int num_slices = pic_data_->GetNumSlices(segment);
+  const int slice_threads =
+    num_slices > 1 ? std::min(encoder_settings.slice_threads, num_slices) : 0;
+  const int wavefront_threads =
+    std::min(encoder_settings.wavefront_threads, num_ctu_rows);
+  // Slices coded in parallel can be at any ctu rows
+  pic_data_->SetMaxParallelCtuRows(slice_threads > 1 ? num_ctu_rows :
+                                   std::max(1, wavefront_threads));
   pic_data_->Init(segment, base_qp, encoder_settings.adaptive_qp > 0);
+  assert(pic_data_->GetNumSlices() == num_slices);
   const bool allow_lic = DetermineAllowLic(pic_data_->GetPredictionType(),
                                            *pic_data_->GetRefPicLists());
   pic_data_->SetUseLocalIlluminationCompensation(allow_lic);
@@ -129,30 +153,67 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
   }
   WriteHeader(segment, *pic_data_, sub_gop_length, buffer_flag, &bit_writer_);
 
-  SyntaxWriter writer(base_qp, pic_data_->GetPredictionType(),
-                      &bit_writer_);
-  std::unique_ptr<CuEncoder>
-    cu_encoder(new CuEncoder(simd_, *orig_pic_, rec_pic_.get(), pic_data_.get(),
-                             encoder_settings));
-  int num_ctus = pic_data_->GetNumberOfCtu();
-  for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
-    cu_encoder->EncodeCtu(rsaddr, &writer);
+  use_motion_preanalysis_ = encoder_settings.fast_motion_preanalysis > 0 &&
+    !pic_data_->IsIntraPic();
+  if (use_motion_preanalysis_) {
+    auto get_ref_pyramid = [&ref_pics](const YuvPicture &ref_orig)
+      -> const MotionPreanalysis::Pyramid* {
+      for (auto &ref_pic : ref_pics) {
+        if (ref_pic->GetOrigPic().get() == &ref_orig) {
+          return ref_pic->GetOrigPyramid().get();
+        }
+      }
+      return nullptr;
+    };
+    motion_preanalysis_.Analyze(*pic_data_, *orig_pic_, *GetOrigPyramid(),
+                                get_ref_pyramid, encoder_settings);
+  }
+
+  std::unique_ptr<CuEncoder> local_cu_encoder;
+  CuEncoder *bound_cu_encoder =
+    BindCuEncoder(encoder_settings,
+                  cached_cu_encoder ? cached_cu_encoder : &local_cu_encoder);
+  if (num_slices > 1) {
+    EncodeSlices(segment, base_qp, encoder_settings, slice_threads,
+                 wavefront_threads, bound_cu_encoder);
+  } else if (wavefront_threads > 1) {
+    SyntaxWriter writer(base_qp, pic_data_->GetPredictionType(),
+                        &bit_writer_);
+    EncodeCtusWavefront(segment, encoder_settings, wavefront_threads, 0,
+                        num_ctu_rows, bound_cu_encoder, &writer);
+    writer.Finish();
+  } else {
+    SyntaxWriter writer(base_qp, pic_data_->GetPredictionType(),
+                        &bit_writer_);
+    int num_ctus = pic_data_->GetNumberOfCtu();
+    for (int rsaddr = 0; rsaddr < num_ctus; rsaddr++) {
+      bound_cu_encoder->EncodeCtu(rsaddr, &writer);
+    }
+    writer.Finish();
   }
+  // Border padding of a ctu row is done by the deblocking threads as soon
+  // as the row is final, instead of as a separate pass over the picture
+  const bool pad_border =
+    pic_data_->GetTid() == 0 || !pic_data_->IsHighestLayer();
+  auto pad_ctu_row = [this](int ctu_row) {
+    rec_pic_->PadBorderRows(simd_.yuv_picture, ctu_row * constants::kCtuSize,
+                            (ctu_row + 1) * constants::kCtuSize);
+  };
   if (pic_data_->GetDeblock()) {
-    DeblockingFilter deblocker(pic_data_.get(), rec_pic_.get(),
-                               pic_data_->GetBetaOffset(),
+    DeblockingFilter deblocker(simd_.deblocking_filter, pic_data_.get(),
+                               rec_pic_.get(), pic_data_->GetBetaOffset(),
                                pic_data_->GetTcOffset());
-    deblocker.DeblockPicture();
-  }
-  writer.Finish();
-
-  if (pic_data_->GetTid() == 0 || !pic_data_->IsHighestLayer()) {
-    rec_pic_->PadBorder();
+    deblocker.DeblockPicture(std::max(slice_threads, wavefront_threads),
+                             pad_border ? pad_ctu_row :
+                             std::function<void(int)>());
+  } else if (pad_border) {
+    rec_pic_->PadBorder(simd_.yuv_picture);
   }
   pic_data_->GetRefPicLists()->ZeroOutReferences();
   if (pic_data_->GetTid() == 0 ||
       segment.checksum_mode == Checksum::Mode::kMaxRobust) {
-    WriteChecksum(segment, &bit_writer_, segment.checksum_mode);
+    WriteChecksum(segment, &bit_writer_, segment.checksum_mode,
+                  wavefront_threads);
   } else {
     pic_hash_.clear();
   }
@@ -163,6 +224,167 @@ PictureEncoder::Encode(const SegmentHeader &segment, int segment_qp,
   return bit_writer_.GetBytes();
 }
 
+CuEncoder*
+PictureEncoder::BindCuEncoder(const EncoderSettings &encoder_settings,
+                              std::unique_ptr<CuEncoder> *cu_encoder) {
+  if (*cu_encoder) {
+    (*cu_encoder)->StartPicture(*orig_pic_, rec_pic_.get(), pic_data_.get());
+  } else {
+    cu_encoder->reset(new CuEncoder(simd_, *orig_pic_, rec_pic_.get(),
+                                    pic_data_.get(), encoder_settings));
+  }
+  (*cu_encoder)->SetMotionPreanalysis(use_motion_preanalysis_ ?
+                                      &motion_preanalysis_ : nullptr);
+  (*cu_encoder)->SetCtuQpOffsets(ctu_qp_offsets_.empty() ?
+                                 nullptr : &ctu_qp_offsets_);
+  return cu_encoder->get();
+}
+
+// Jobs may end up on pool threads, so each job loads the thread local
+// restrictions. Only the first job gets the cached cu encoder, the others are
+// given nullptr and use a temporary cu encoder of their own.
+template<typename Func>
+void PictureEncoder::RunCuEncoderJobs(const SegmentHeader &segment,
+                                      int num_threads, CuEncoder *cu_encoder,
+                                      const Func &func) {
+  util::RunJobs(num_threads, num_threads, [&](int job) {
+    Restrictions::GetRW() = segment.restrictions;
+    func(job == 0 ? cu_encoder : nullptr);
+  });
+}
+
+void PictureEncoder::EncodeSlices(const SegmentHeader &segment,
+                                  const Qp &qp,
+                                  const EncoderSettings &encoder_settings,
+                                  int num_threads, int wavefront_threads,
+                                  CuEncoder *cu_encoder) {
+  const int num_slices = pic_data_->GetNumSlices();
+  const int num_ctu_x = pic_data_->GetNumCtuX();
+  slice_bit_writers_.resize(num_slices);
+  int next_slice = 0;
+  std::mutex mutex;
+
+  // Each slice is written to its own bitstream with new context states,
+  // helper threads use their own temporary cu encoder
+  auto encode_slices = [&](CuEncoder *thread_cu_encoder) {
+    std::unique_ptr<CuEncoder> local_cu_encoder;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (next_slice < num_slices) {
+      const int slice = next_slice++;
+      lock.unlock();
+      const int first_row = pic_data_->GetSliceFirstCtuRow(slice);
+      const int end_row = pic_data_->GetSliceFirstCtuRow(slice + 1);
+      BitWriter *bit_writer = &slice_bit_writers_[slice];
+      bit_writer->Clear();
+      SyntaxWriter writer(qp, pic_data_->GetPredictionType(), bit_writer);
+      if (wavefront_threads > 1 && num_threads <= 1) {
+        EncodeCtusWavefront(segment, encoder_settings,
+                            std::min(wavefront_threads, end_row - first_row),
+                            first_row, end_row, thread_cu_encoder, &writer);
+      } else {
+        if (!thread_cu_encoder) {
+          thread_cu_encoder = BindCuEncoder(encoder_settings,
+                                            &local_cu_encoder);
+        }
+        for (int rsaddr = first_row * num_ctu_x; rsaddr < end_row * num_ctu_x;
+             rsaddr++) {
+          thread_cu_encoder->EncodeCtu(rsaddr, &writer);
+        }
+      }
+      writer.Finish();
+      lock.lock();
+    }
+  };
+
+  RunCuEncoderJobs(segment, num_threads, cu_encoder, encode_slices);
+
+  // Entry points give the size of all slices but the last one, which
+  // ends where the checksum begins
+  size_t max_slice_size = 1;
+  for (int slice = 0; slice < num_slices - 1; slice++) {
+    max_slice_size =
+      std::max(max_slice_size, slice_bit_writers_[slice].GetBytes()->size());
+  }
+  int entry_point_bits = 1;
+  while (entry_point_bits < 32 && (max_slice_size >> entry_point_bits)) {
+    entry_point_bits++;
+  }
+  bit_writer_.WriteBits(entry_point_bits - 1, constants::kEntryPointBitsBits);
+  for (int slice = 0; slice < num_slices - 1; slice++) {
+    bit_writer_.WriteBits(
+      static_cast<uint32_t>(slice_bit_writers_[slice].GetBytes()->size()),
+      entry_point_bits);
+  }
+  bit_writer_.PadZeroBits();
+  for (BitWriter &slice_writer : slice_bit_writers_) {
+    const std::vector<uint8_t> &bytes = *slice_writer.GetBytes();
+    bit_writer_.WriteBytes(&bytes[0], bytes.size());
+  }
+}
+
+void
+PictureEncoder::EncodeCtusWavefront(const SegmentHeader &segment,
+                                    const EncoderSettings &encoder_settings,
+                                    int num_threads, int first_row,
+                                    int end_row, CuEncoder *cu_encoder,
+                                    SyntaxWriter *writer) {
+  const int num_ctu_x = pic_data_->GetNumCtuX();
+  const int num_rows = end_row - first_row;
+  // Context states for a row are inherited from the row above after its
+  // second ctu, this is also the lag needed for above-right neighbors
+  const int ctx_ctu = std::min(2, num_ctu_x);
+  std::vector<Contexts> row_contexts(num_rows, writer->GetContexts());
+  // The bins of each row are recorded and written to the bitstream in raster
+  // order as rows complete, so the resulting bitstream is decodable without
+  // any knowledge of how the rows were encoded
+  std::vector<std::vector<uint32_t>> row_bins(num_rows);
+  std::vector<int> row_progress(num_rows, 0);
+  int next_row = 0;
+  int next_write_row = 0;
+  std::mutex mutex;
+  std::condition_variable progress_cond;
+
+  auto encode_rows = [&](CuEncoder *thread_cu_encoder) {
+    std::unique_ptr<CuEncoder> local_cu_encoder;
+    if (!thread_cu_encoder) {
+      thread_cu_encoder = BindCuEncoder(encoder_settings, &local_cu_encoder);
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    while (next_row < num_rows) {
+      const int row = next_row++;
+      progress_cond.wait(lock, [&]() {
+        return row == 0 || row_progress[row - 1] >= ctx_ctu;
+      });
+      SyntaxWriter row_writer(row_contexts[row], EntropyEncoder(nullptr));
+      row_writer.SetBinRecorder(&row_bins[row]);
+      for (int x = 0; x < num_ctu_x; x++) {
+        const int above_progress = std::min(x + ctx_ctu, num_ctu_x);
+        progress_cond.wait(lock, [&]() {
+          return row == 0 || row_progress[row - 1] >= above_progress;
+        });
+        lock.unlock();
+        thread_cu_encoder->EncodeCtu((first_row + row) * num_ctu_x + x,
+                                     &row_writer);
+        lock.lock();
+        if (x + 1 == ctx_ctu && row + 1 < num_rows) {
+          row_contexts[row + 1] = row_writer.GetContexts();
+        }
+        row_progress[row] = x + 1;
+        progress_cond.notify_all();
+      }
+      while (next_write_row < num_rows &&
+             row_progress[next_write_row] == num_ctu_x) {
+        writer->WriteRecordedBins(row_bins[next_write_row]);
+        std::vector<uint32_t>().swap(row_bins[next_write_row]);
+        next_write_row++;
+      }
+    }
+  };
+
+  RunCuEncoderJobs(segment, num_threads, cu_encoder, encode_rows);
+  assert(next_write_row == num_rows);
+}
+
 std::shared_ptr<YuvPicture>
 PictureEncoder::GetAlternativeRecPic(const PictureFormat &pic_fmt,
                                      int crop_width, int crop_height) const {
@@ -170,6 +392,20 @@ PictureEncoder::GetAlternativeRecPic(const PictureFormat &pic_fmt,
   return std::shared_ptr<YuvPicture>();
 }
 
+std::shared_ptr<const MotionPreanalysis::Pyramid>
+PictureEncoder::GetOrigPyramid() const {
+  std::lock_guard<std::mutex> lock(orig_pyramid_mutex_);
+  if (!has_orig_pyramid_) {
+    // Pyramid of the previous picture may still be used by the lookahead
+    if (!orig_pyramid_ || orig_pyramid_.use_count() > 1) {
+      orig_pyramid_ = std::make_shared<MotionPreanalysis::Pyramid>();
+    }
+    MotionPreanalysis::BuildPyramid(*orig_pic_, orig_pyramid_.get());
+    has_orig_pyramid_ = true;
+  }
+  return orig_pyramid_;
+}
+
 void PictureEncoder::WriteHeader(const SegmentHeader &segment,
                                  const PictureData &pic_data,
                                  PicNum sub_gop_length, int buffer_flag,
@@ -198,12 +434,13 @@ void PictureEncoder::WriteHeader(const SegmentHeader &segment,
 
 void PictureEncoder::WriteChecksum(const SegmentHeader &segment,
                                    BitWriter *bit_writer,
-                                   Checksum::Mode checksum_mode) {
+                                   Checksum::Mode checksum_mode,
+                                   int num_threads) {
   Checksum::Method checksum_method =
     Restrictions::Get().disable_high_level_default_checksum_method ?
     Checksum::kFallbackMethod : Checksum::kDefaultMethod;
   Checksum checksum(checksum_method, checksum_mode);
-  checksum.HashPicture(*rec_pic_);
+  checksum.HashPicture(*rec_pic_, num_threads);
   pic_hash_ = checksum.GetHash();
   assert(pic_hash_.size() < UINT8_MAX);
   if (segment.major_version <= 1) {
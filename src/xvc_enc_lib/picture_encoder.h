@@ -23,7 +23,9 @@
 #define XVC_ENC_LIB_PICTURE_ENCODER_H_
 
 #include <memory>
+#include <mutex>    // NOLINT
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "xvc_common_lib/checksum.h"
@@ -34,11 +36,14 @@
 #include "xvc_enc_lib/bit_writer.h"
 #include "xvc_enc_lib/encoder_settings.h"
 #include "xvc_enc_lib/encoder_simd_functions.h"
+#include "xvc_enc_lib/motion_preanalysis.h"
 #include "xvc_enc_lib/syntax_writer.h"
 #include "xvc_enc_lib/xvcenc.h"
 
 namespace xvc {
 
+class CuEncoder;
+
 class PictureEncoder {
 public:
   PictureEncoder(const EncoderSimdFunctions &simd,
@@ -80,23 +85,56 @@ public:
     }
   }
   void SetUserData(int64_t user_data) { user_data_ = user_data; }
+  // Qp offset for each ctu in raster order, added to the adaptive qp
+  void SetCtuQpOffsets(std::vector<int> &&ctu_qp_offsets) {
+    ctu_qp_offsets_ = std::move(ctu_qp_offsets);
+  }
+  const std::vector<int>& GetCtuQpOffsets() const { return ctu_qp_offsets_; }
+  // Motion preanalysis vectors already searched against a reference picture
+  void AddPreanalysisMvs(const PictureEncoder &ref_pic, int search_range,
+                         const std::vector<MvFullpel> &mvs) {
+    motion_preanalysis_.AddSearchedMvs(ref_pic.GetOrigPic().get(),
+                                       ref_pic.GetPoc(), search_range, mvs);
+  }
   int64_t GetUserData() const { return user_data_; }
+  // Downscaled original picture, built on first use and shared by all
+  // pictures that search motion against this one
+  std::shared_ptr<const MotionPreanalysis::Pyramid> GetOrigPyramid() const;
 
   void Init(const SegmentHeader &segment, PicNum doc, PicNum poc, int tid,
             bool is_access_picture);
-  const std::vector<uint8_t>*
+  // Returned bitstream is valid until next picture is coded, the caller may
+  // also take over the bytes by swapping in another buffer for reuse.
+  // If cached_cu_encoder is given it is reused (or created) for the picture
+  // instead of allocating a new coding unit encoder.
+  // The reference picture encoders provide the cached original pyramids.
+  std::vector<uint8_t>*
     Encode(const SegmentHeader &segment, int segment_qp, int buffer_flag,
-           const EncoderSettings &encoder_settings);
+           const EncoderSettings &encoder_settings,
+           const std::vector<std::shared_ptr<const PictureEncoder>> &ref_pics,
+           std::unique_ptr<CuEncoder> *cached_cu_encoder = nullptr);
   const std::vector<uint8_t>& GetLastChecksum() const { return pic_hash_; }
   std::shared_ptr<YuvPicture> GetAlternativeRecPic(
     const PictureFormat &pic_fmt, int crop_width, int crop_height) const;
 
 private:
+  CuEncoder* BindCuEncoder(const EncoderSettings &encoder_settings,
+                           std::unique_ptr<CuEncoder> *cu_encoder);
+  template<typename Func>
+  static void RunCuEncoderJobs(const SegmentHeader &segment, int num_threads,
+                               CuEncoder *cu_encoder, const Func &func);
+  void EncodeSlices(const SegmentHeader &segment, const Qp &qp,
+                    const EncoderSettings &encoder_settings, int num_threads,
+                    int wavefront_threads, CuEncoder *cu_encoder);
+  void EncodeCtusWavefront(const SegmentHeader &segment,
+                           const EncoderSettings &encoder_settings,
+                           int num_threads, int first_row, int end_row,
+                           CuEncoder *cu_encoder, SyntaxWriter *writer);
   void WriteHeader(const SegmentHeader &segment, const PictureData &pic_data,
                    PicNum sub_gop_length, int buffer_flag,
                    BitWriter *bit_writer);
   void WriteChecksum(const SegmentHeader &segment, BitWriter *bit_writer,
-                     Checksum::Mode checksum_mode);
+                     Checksum::Mode checksum_mode, int num_threads);
   int DerivePictureQp(const EncoderSettings &encoder_settings, int segment_qp,
                       PicturePredictionType pic_type, int tid) const;
   bool DetermineAllowLic(PicturePredictionType pic_type,
@@ -112,10 +150,17 @@ private:
 
   const EncoderSimdFunctions &simd_;
   BitWriter bit_writer_;
+  std::vector<BitWriter> slice_bit_writers_;
   std::shared_ptr<YuvPicture> orig_pic_;
   std::shared_ptr<PictureData> pic_data_;
   std::shared_ptr<YuvPicture> rec_pic_;
   std::vector<uint8_t> pic_hash_;
+  MotionPreanalysis motion_preanalysis_;
+  bool use_motion_preanalysis_ = false;
+  mutable std::mutex orig_pyramid_mutex_;
+  mutable std::shared_ptr<MotionPreanalysis::Pyramid> orig_pyramid_;
+  mutable bool has_orig_pyramid_ = false;
+  std::vector<int> ctu_qp_offsets_;
   uint64_t rec_sse_ = 0;
   double rec_psnr_y_ = 0;
   double rec_psnr_u_ = 0;
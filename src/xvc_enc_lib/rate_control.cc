@@ -0,0 +1,165 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#include "xvc_enc_lib/rate_control.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "xvc_common_lib/utils.h"
+
+namespace xvc {
+
+static const int kMaxQpStep = 2;
+static const double kComplexityDecay = 0.5;
+static const double kFrequencyDecay = 0.95;
+static const double kVbvMinFullness = 0.1;
+// Allowed bitrate deviation in seconds for variable bitrate mode
+static const double kVbrBufferSeconds = 2.0;
+
+RateControl::RateControl(const Settings &settings, double framerate,
+                         int initial_qp)
+  : settings_(settings),
+  last_finished_qp_(initial_qp) {
+  if (settings_.mode == RateControlMode::kConstantBitrate) {
+    if (settings_.vbv_max_bitrate <= 0) {
+      settings_.vbv_max_bitrate = settings_.bitrate;
+    }
+    if (settings_.vbv_buffer_size <= 0) {
+      settings_.vbv_buffer_size = settings_.vbv_max_bitrate;
+    }
+    abr_buffer_ = settings_.vbv_buffer_size;
+  } else {
+    if (settings_.vbv_max_bitrate > 0 && settings_.vbv_buffer_size <= 0) {
+      settings_.vbv_buffer_size = settings_.vbv_max_bitrate;
+    }
+    abr_buffer_ = kVbrBufferSeconds * settings_.bitrate;
+  }
+  bits_per_pic_ = settings_.bitrate / framerate;
+  vbv_bits_per_pic_ = settings_.vbv_max_bitrate / framerate;
+  vbv_fullness_ = settings_.vbv_initial_fullness * settings_.vbv_buffer_size;
+}
+
+int RateControl::StartPicture(PicNum doc, bool intra_pic, int tid) {
+  const int kind = intra_pic ? 0 : 1 + tid;
+  if (kind >= static_cast<int>(complexity_.size())) {
+    complexity_.resize(kind + 1);
+  }
+  for (Complexity &complexity : complexity_) {
+    complexity.frequency *= kFrequencyDecay;
+  }
+  complexity_[kind].frequency += 1;
+
+  // Keep previous qp until there is a model for this kind of picture
+  int qp = last_finished_qp_;
+  const double cplx = GetAverageComplexity();
+  if (complexity_[kind].count > 0 && cplx > 0) {
+    // Compensate for the deviation from target bitrate so far, including the
+    // predicted size of all pictures that are still being encoded
+    const double target_bits = bits_per_pic_ * num_started_;
+    const double overflow =
+      util::Clip3(1.0 + (bits_encoded_ + bits_pending_ - target_bits) /
+                  abr_buffer_, 0.5, 2.0);
+    const double qscale = cplx * overflow / bits_per_pic_;
+    const int model_qp = static_cast<int>(std::round(QscaleToQp(qscale)));
+    qp = util::Clip3(model_qp, last_finished_qp_ - kMaxQpStep,
+                     last_finished_qp_ + kMaxQpStep);
+  }
+  qp = util::Clip3(qp, constants::kMinAllowedQp, constants::kMaxAllowedQp);
+
+  if (settings_.vbv_max_bitrate > 0) {
+    // Avoid vbv underflow by increasing qp beyond the normal qp step limit
+    vbv_fullness_ = std::min(vbv_fullness_ + vbv_bits_per_pic_,
+                             settings_.vbv_buffer_size);
+    const double max_bits =
+      std::max(vbv_fullness_ - kVbvMinFullness * settings_.vbv_buffer_size,
+               vbv_fullness_ * 0.5);
+    while (qp < constants::kMaxAllowedQp && PredictBits(kind, qp) > max_bits) {
+      qp++;
+    }
+  }
+  const double predicted_bits = PredictBits(kind, qp);
+  if (settings_.vbv_max_bitrate > 0) {
+    vbv_fullness_ -= predicted_bits;
+  }
+  PendingPicture &pending_pic = pending_[doc];
+  pending_pic.kind = kind;
+  pending_pic.qp = qp;
+  pending_pic.predicted_bits = predicted_bits;
+  bits_pending_ += predicted_bits;
+  num_started_ += 1;
+  return qp;
+}
+
+void RateControl::FinishPicture(PicNum doc, size_t num_bits) {
+  auto it = pending_.find(doc);
+  assert(it != pending_.end());
+  const PendingPicture pic = it->second;
+  pending_.erase(it);
+  last_finished_qp_ = pic.qp;
+  const double bits = static_cast<double>(num_bits);
+  Complexity &complexity = complexity_[pic.kind];
+  complexity.cplx_sum =
+    complexity.cplx_sum * kComplexityDecay + bits * QpToQscale(pic.qp);
+  complexity.count = complexity.count * kComplexityDecay + 1;
+  bits_encoded_ += bits;
+  bits_pending_ = pending_.empty() ? 0 : bits_pending_ - pic.predicted_bits;
+  if (settings_.vbv_max_bitrate > 0) {
+    vbv_fullness_ -= bits - pic.predicted_bits;
+  }
+}
+
+double RateControl::QpToQscale(int qp) {
+  return 0.85 * std::pow(2.0, (qp - 12) / 6.0);
+}
+
+double RateControl::QscaleToQp(double qscale) {
+  return 12 + 6 * std::log2(qscale / 0.85);
+}
+
+double RateControl::GetAverageComplexity() const {
+  // Weight by how often each kind of picture occurs
+  double cplx = 0;
+  double frequency = 0;
+  for (const Complexity &complexity : complexity_) {
+    if (complexity.count > 0) {
+      cplx += complexity.frequency * complexity.cplx_sum / complexity.count;
+      frequency += complexity.frequency;
+    }
+  }
+  return frequency > 0 ? cplx / frequency : 0;
+}
+
+double RateControl::PredictBits(int kind, int qp) const {
+  const Complexity &complexity = complexity_[kind];
+  if (complexity.count > 0) {
+    return complexity.cplx_sum / complexity.count / QpToQscale(qp);
+  }
+  const double cplx = GetAverageComplexity();
+  if (cplx > 0) {
+    return cplx / QpToQscale(qp);
+  }
+  return bits_per_pic_;
+}
+
+}   // namespace xvc
@@ -0,0 +1,95 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#ifndef XVC_ENC_LIB_RATE_CONTROL_H_
+#define XVC_ENC_LIB_RATE_CONTROL_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+
+namespace xvc {
+
+enum struct RateControlMode {
+  kConstantQp = 0,
+  kVariableBitrate = 1,
+  kConstantBitrate = 2,
+  kTotalNumber = 3,
+};
+
+// Picture level rate control selecting the segment qp of each picture.
+// Pictures may finish encoding in another order than they were started
+// (e.g. when using threads), therefore the size of pictures still being
+// encoded is predicted from the complexity of previous pictures.
+class RateControl {
+public:
+  struct Settings {
+    RateControlMode mode = RateControlMode::kConstantQp;
+    double bitrate = 0;           // bits per second
+    double vbv_max_bitrate = 0;   // bits per second, 0 to disable vbv
+    double vbv_buffer_size = 0;   // bits
+    double vbv_initial_fullness = 0.9;
+  };
+
+  RateControl(const Settings &settings, double framerate, int initial_qp);
+  // Returns the segment qp to use for a picture that is about to be encoded
+  int StartPicture(PicNum doc, bool intra_pic, int tid);
+  // Updates the model with the actual size of a previously started picture
+  void FinishPicture(PicNum doc, size_t num_bits);
+  double GetVbvFullness() const { return vbv_fullness_; }
+
+private:
+  struct Complexity {
+    // Exponentially decaying sums of bits * qscale and of picture counts
+    double cplx_sum = 0;
+    double count = 0;
+    // How frequently pictures of this kind are started
+    double frequency = 0;
+  };
+  struct PendingPicture {
+    int kind;
+    int qp;
+    double predicted_bits;
+  };
+  static double QpToQscale(int qp);
+  static double QscaleToQp(double qscale);
+  double GetAverageComplexity() const;
+  double PredictBits(int kind, int qp) const;
+
+  Settings settings_;
+  double bits_per_pic_ = 0;
+  double vbv_bits_per_pic_ = 0;
+  double abr_buffer_ = 0;
+  // Qp of most recently finished picture, limits how far qp can drift while
+  // waiting for the actual size of pictures still being encoded
+  int last_finished_qp_;
+  double bits_encoded_ = 0;
+  double bits_pending_ = 0;
+  double num_started_ = 0;
+  double vbv_fullness_ = 0;
+  std::vector<Complexity> complexity_;
+  std::unordered_map<PicNum, PendingPicture> pending_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_RATE_CONTROL_H_
@@ -0,0 +1,216 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#include "xvc_enc_lib/rate_estimator.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "xvc_common_lib/transform.h"
+#include "xvc_common_lib/utils.h"
+
+namespace xvc {
+
+void RateEstimator::EstimateResidualDataRdoCbf(const CodingUnit &cu,
+                                               YuvComponent comp) {
+  const bool cbf = cu.GetCbf(comp);
+  EstimateCbf(comp, cbf);
+  if (!cbf) {
+    return;
+  }
+  const bool transform_select = !restrictions_.disable_ext2_transform_select;
+  if (util::IsLuma(comp) && transform_select) {
+    frac_bits_ += ctx_.transform_select_flag[cu.GetDepth()].GetEntropyBits(
+      cu.HasTransformSelectIdx() ? 1 : 0);
+  }
+  if (!restrictions_.disable_ext2_transform_skip &&
+      cu.CanTransformSkip(comp)) {
+    const ContextModel &ctx =
+      ctx_.transform_skip_flag[util::IsLuma(comp) ? 0 : 1];
+    frac_bits_ += ctx.GetEntropyBits(cu.GetTransformSkip(comp) ? 1 : 0);
+  }
+  CoeffBufferConst cu_coeff = cu.GetCoeff(comp);
+  const int num_coeff = EstimateCoefficients(cu, comp, cu_coeff.GetDataPtr(),
+                                             cu_coeff.GetStride());
+  if (util::IsLuma(comp) && transform_select && cu.HasTransformSelectIdx() &&
+      !cu.GetTransformSkip(comp) &&
+      (cu.IsInter() || num_coeff >= constants::kTransformSelectMinSigCoeffs)) {
+    const int type_idx = cu.GetTransformSelectIdx();
+    const int ctx_offset = cu.IsIntra() ? 0 : 2;
+    frac_bits_ += ctx_.transform_select_idx[ctx_offset].GetEntropyBits(
+      (type_idx & 1) ? 1 : 0);
+    frac_bits_ += ctx_.transform_select_idx[ctx_offset + 1].GetEntropyBits(
+      (type_idx >> 1) ? 1 : 0);
+  }
+}
+
+void RateEstimator::EstimateCbf(YuvComponent comp, bool cbf) {
+  if (restrictions_.disable_transform_cbf) {
+    return;
+  }
+  const ContextModel &ctx =
+    util::IsLuma(comp) ? ctx_.cu_cbf_luma[0] : ctx_.cu_cbf_chroma[0];
+  frac_bits_ += ctx.GetEntropyBits(cbf ? 1 : 0);
+}
+
+void RateEstimator::EstimateRootCbf(bool root_cbf) {
+  if (restrictions_.disable_transform_root_cbf) {
+    return;
+  }
+  frac_bits_ += ctx_.cu_root_cbf[0].GetEntropyBits(root_cbf ? 1 : 0);
+}
+
+void RateEstimator::EstimateIntraMode(IntraMode intra_mode,
+                                      const IntraPredictorLuma &mpm) {
+  const bool mpm_ext = !restrictions_.disable_ext2_intra_6_predictors;
+  const int num_mpm =
+    mpm_ext ? constants::kNumIntraMpmExt : constants::kNumIntraMpm;
+  int mpm_index = -1;
+  for (int i = 0; i < num_mpm; i++) {
+    if (intra_mode == mpm[i]) {
+      mpm_index = i;
+    }
+  }
+  frac_bits_ += ctx_.intra_pred_luma[0].GetEntropyBits(mpm_index >= 0);
+  if (mpm_index < 0) {
+    int num_bins = restrictions_.disable_ext2_intra_67_modes ? 5 : 6;
+    if (mpm_ext && num_bins == 6) {
+      int mode_index = static_cast<int>(intra_mode);
+      for (int i = 0; i < num_mpm; i++) {
+        mode_index -= intra_mode > mpm[i] ? 1 : 0;
+      }
+      if (mode_index > kNbrIntraModesExt - 8) {
+        num_bins = 4;
+      }
+    }
+    frac_bits_ += num_bins * ContextModel::kEntropyBypassBits;
+  } else if (mpm_ext) {
+    for (int i = 0; i < std::min(mpm_index + 1, 3); i++) {
+      frac_bits_ += ctx_.GetIntraPredictorCtx(mpm[i]).GetEntropyBits(
+        mpm_index > i ? 1 : 0);
+    }
+    frac_bits_ += std::min(std::max(mpm_index - 2, 0), 2) *
+      ContextModel::kEntropyBypassBits;
+  } else {
+    frac_bits_ += (1 + (mpm_index > 0)) * ContextModel::kEntropyBypassBits;
+  }
+}
+
+int RateEstimator::EstimateCoefficients(const CodingUnit &cu,
+                                        YuvComponent comp,
+                                        const Coeff *coeff,
+                                        ptrdiff_t coeff_stride) {
+  const int width = cu.GetWidth(comp);
+  const int height = cu.GetHeight(comp);
+  const bool luma = util::IsLuma(comp);
+  GroupBits sig_bits, gt1_bits, gt2_bits;
+  if (!restrictions_.disable_ext2_cabac_alt_residual_ctx) {
+    sig_bits = luma ? GetAverageBits(ctx_.coeff_ext.sig_luma) :
+      GetAverageBits(ctx_.coeff_ext.sig_chroma);
+    gt1_bits = luma ? GetAverageBits(ctx_.coeff_ext.greater1_luma) :
+      GetAverageBits(ctx_.coeff_ext.greater1_chroma);
+    gt2_bits = gt1_bits;
+  } else {
+    sig_bits = luma ? GetAverageBits(ctx_.coeff.sig_luma) :
+      GetAverageBits(ctx_.coeff.sig_chroma);
+    gt1_bits = luma ? GetAverageBits(ctx_.coeff.greater1_luma) :
+      GetAverageBits(ctx_.coeff.greater1_chroma);
+    gt2_bits = luma ? GetAverageBits(ctx_.coeff.greater2_luma) :
+      GetAverageBits(ctx_.coeff.greater2_chroma);
+  }
+
+  // Levels are estimated independently of position, the last position is
+  // approximated by the coefficient on the highest diagonal
+  int num_sig = 0;
+  int last_x = 0;
+  int last_y = 0;
+  uint64_t level_bits = 0;
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      const int level = std::abs(coeff[y * coeff_stride + x]);
+      if (!level) {
+        continue;
+      }
+      num_sig++;
+      if (x + y >= last_x + last_y) {
+        last_x = x;
+        last_y = y;
+      }
+      level_bits += ContextModel::kEntropyBypassBits + gt1_bits[level > 1];
+      if (level > 1) {
+        level_bits += gt2_bits[level > 2];
+      }
+      if (level > 2) {
+        // Exp-Golomb code length of remaining level
+        level_bits += ContextModel::kEntropyBypassBits *
+          (2 * util::Log2Floor(level - 2) + 1);
+      }
+    }
+  }
+  if (!num_sig) {
+    return 0;
+  }
+
+  // Number of sig flags coded before the last position in diagonal scan
+  const int last_diag = last_x + last_y;
+  int num_coded = 0;
+  for (int x = 0; x < std::min(width, last_diag + 1); x++) {
+    num_coded += std::min(height, last_diag - x + 1);
+  }
+  const GroupBits last_bits = luma ?
+    GetAverageBits(ctx_.coeff_last_pos_x_luma) :
+    GetAverageBits(ctx_.coeff_last_pos_x_chroma);
+  frac_bits_ += EstimateLastPos(last_x, width, last_bits);
+  frac_bits_ += EstimateLastPos(last_y, height, last_bits);
+  frac_bits_ += static_cast<uint64_t>(num_sig - 1) * sig_bits[1];
+  frac_bits_ += static_cast<uint64_t>(num_coded - num_sig) * sig_bits[0];
+  frac_bits_ += level_bits;
+  return num_sig;
+}
+
+template<size_t N>
+RateEstimator::GroupBits
+RateEstimator::GetAverageBits(const std::array<ContextModel, N> &ctx) {
+  GroupBits bits = { { 0, 0 } };
+  for (size_t i = 0; i < N; i++) {
+    bits[0] += ctx[i].GetEntropyBits(0);
+    bits[1] += ctx[i].GetEntropyBits(1);
+  }
+  bits[0] /= N;
+  bits[1] /= N;
+  return bits;
+}
+
+uint32_t RateEstimator::EstimateLastPos(int pos, int size,
+                                        const GroupBits &bits) {
+  const int group_idx = TransformHelper::kLastPosGroupIdx[pos];
+  uint32_t num_bits = group_idx * bits[1];
+  if (group_idx < TransformHelper::kLastPosGroupIdx[size - 1]) {
+    num_bits += bits[0];
+  }
+  if (group_idx > 3) {
+    num_bits += ((group_idx - 2) >> 1) * ContextModel::kEntropyBypassBits;
+  }
+  return num_bits;
+}
+
+}   // namespace xvc
@@ -0,0 +1,70 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#ifndef XVC_ENC_LIB_RATE_ESTIMATOR_H_
+#define XVC_ENC_LIB_RATE_ESTIMATOR_H_
+
+#include <array>
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/intra_prediction.h"
+#include "xvc_common_lib/restrictions.h"
+#include "xvc_enc_lib/syntax_writer.h"
+
+namespace xvc {
+
+// Estimates the number of bits of the residual syntax during rdo without
+// writing it. Entropy bits are read from the context states of the writer
+// without copying or updating them. Coefficients use the average entropy of
+// each group of contexts instead of deriving the context of each bin.
+class RateEstimator {
+public:
+  explicit RateEstimator(const SyntaxWriter &writer)
+    : ctx_(writer.GetContexts()),
+    restrictions_(Restrictions::Get()),
+    frac_bits_(writer.GetFractionalBits()) {
+  }
+  Bits GetNumBits() const {
+    return static_cast<Bits>(frac_bits_ >> ContextModel::kFracBitsPrecision);
+  }
+  void EstimateResidualDataRdoCbf(const CodingUnit &cu, YuvComponent comp);
+  void EstimateCbf(YuvComponent comp, bool cbf);
+  void EstimateRootCbf(bool root_cbf);
+  void EstimateIntraMode(IntraMode intra_mode, const IntraPredictorLuma &mpm);
+  int EstimateCoefficients(const CodingUnit &cu, YuvComponent comp,
+                           const Coeff *coeff, ptrdiff_t coeff_stride);
+
+private:
+  // Average entropy bits of a group of contexts, indexed by bin value
+  using GroupBits = std::array<uint32_t, 2>;
+  template<size_t N>
+  static GroupBits GetAverageBits(const std::array<ContextModel, N> &ctx);
+  static uint32_t EstimateLastPos(int pos, int size, const GroupBits &bits);
+
+  const Contexts &ctx_;
+  const Restrictions &restrictions_;
+  uint64_t frac_bits_;
+};
+
+}   // namespace xvc
+
+#endif  // XVC_ENC_LIB_RATE_ESTIMATOR_H_
@@ -24,7 +24,6 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
-#include <functional>
 #include <limits>
 #include <utility>
 #include <vector>
@@ -43,6 +42,47 @@ struct RdoQuant::CoeffCodingState {
   uint32_t golomb_rice_k = 0;
 };
 
+// Quantization of a single coefficient magnitude with rounding to nearest
+class FwdQuantizer {
+public:
+  FwdQuantizer(int scale, int shift)
+    : scale_(scale),
+    shift_(shift),
+    offset_(1ll << (shift - 1)) {
+  }
+  Coeff operator()(Coeff abs_coeff) const {
+    return static_cast<Coeff>(
+      ((static_cast<int64_t>(abs_coeff) * scale_) + offset_) >> shift_);
+  }
+
+private:
+  const int scale_;
+  const int shift_;
+  const int64_t offset_;
+};
+
+// Inverse quantization of a single level, specialized on shift direction
+template<bool LeftShift>
+class InvQuantizer {
+public:
+  InvQuantizer(int scale, int shift)
+    : scale_(scale),
+    shift_(LeftShift ? -shift : shift),
+    offset_(LeftShift ? 0 : (1 << (shift - 1))) {
+  }
+  Coeff operator()(Coeff level) const {
+    int coeff = LeftShift ? ((level * scale_) << shift_) :
+      ((level * scale_) + offset_) >> shift_;
+    return static_cast<Coeff>(
+      util::Clip3(coeff, constants::kInt16Min, constants::kInt16Max));
+  }
+
+private:
+  const int scale_;
+  const int shift_;
+  const int offset_;
+};
+
 template<int SubBlockShift>
 class SubblockScan {
 public:
@@ -171,27 +211,11 @@ int RdoQuant::QuantFast(const CodingUnit &cu, YuvComponent comp, const Qp &qp,
   Coeff delta[constants::kMaxBlockSize * constants::kMaxBlockSize];
   ptrdiff_t delta_stride = constants::kMaxBlockSize;
 
-  const Coeff *in_ptr = in;
-  Coeff *delta_ptr = delta;
-  Coeff *out_ptr = out;
-
-  int num_non_zero = 0;
-  for (int y = 0; y < height; y++) {
-    for (int x = 0; x < width; x++) {
-      int sign = in_ptr[x] < 0 ? -1 : 1;
-      int64_t abs_coeff = std::abs(in_ptr[x]);
-      int level = static_cast<int>(((abs_coeff * scale) + offset) >> shift);
-      num_non_zero += level != 0;
-      int coeff =
-        util::Clip3(level * sign, constants::kInt16Min, constants::kInt16Max);
-      out_ptr[x] = static_cast<Coeff>(coeff);
-      delta_ptr[x] = static_cast<Coeff>(((abs_coeff * scale) -
-        (static_cast<int64_t>(level) << shift)) >> (shift - 8));
-    }
-    in_ptr += in_stride;
-    delta_ptr += delta_stride;
-    out_ptr += out_stride;
-  }
+  int num_non_zero =
+    simd_.forward[util::SizeToLog2(width) - 1](scale, shift, offset,
+                                               width, height, in, in_stride,
+                                               out, out_stride,
+                                               delta, delta_stride);
   if (!Restrictions::Get().disable_transform_sign_hiding &&
       num_non_zero > 1 && width >= 4 && height >= 4) {
     num_non_zero = CoeffSignHideFast(cu, comp, width, height, in, in_stride,
@@ -221,6 +245,23 @@ int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
 }
 
 template<int SubBlockShift>
+int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
+                       const Qp &qp, PicturePredictionType pic_type,
+                       const SyntaxWriter &writer,
+                       const Coeff *src, ptrdiff_t src_stride,
+                       Coeff *out, ptrdiff_t out_stride) {
+  const int inv_shift =
+    Quantize::GetInverseShift(cu.GetWidth(comp), cu.GetHeight(comp),
+                              bitdepth_);
+  if (inv_shift > 0) {
+    return QuantRdo<SubBlockShift, false>(cu, comp, qp, pic_type, writer,
+                                          src, src_stride, out, out_stride);
+  }
+  return QuantRdo<SubBlockShift, true>(cu, comp, qp, pic_type, writer,
+                                       src, src_stride, out, out_stride);
+}
+
+template<int SubBlockShift, bool InvLeftShift>
 int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
                        const Qp &qp, PicturePredictionType pic_type,
                        const SyntaxWriter &writer,
@@ -254,8 +295,10 @@ int RdoQuant::QuantRdo(const CodingUnit &cu, YuvComponent comp,
   Contexts *contexts = const_cast<Contexts*>(&writer.GetContexts());
 
   const ScanOrder scan_order = TransformHelper::DetermineScanOrder(cu, comp);
-  const auto fwd_quant = GetFwdQuantFunc(comp, qp, width, height);
-  const auto inv_quant = GetInvQuantFunc(comp, qp, width, height);
+  const FwdQuantizer fwd_quant(scale, shift + size_bias_shift);
+  const InvQuantizer<InvLeftShift> inv_quant(
+    Quantize::GetInverseScale(comp, qp, width, height),
+    Quantize::GetInverseShift(width, height, bitdepth_));
 
   constexpr int kMaxSubblockSize = constants::kMaxBlockSize >> SubBlockShift;
   uint8_t subblock_csbf[kMaxSubblockSize * kMaxSubblockSize];
@@ -703,13 +746,13 @@ RdoQuant::CoeffSignHideRdo(const CodingUnit &cu, YuvComponent comp,
   return num_non_zero;
 }
 
+template<typename InvQuant>
 Coeff
 RdoQuant::QuantCoeffRdo(YuvComponent comp, Coeff orig_coeff, Coeff max_level,
                         const CoeffCodingState &code_state, Bits sig1_bits,
                         int64_t lambda, int cost_scale,
                         const ContextModel &c1_ctx, const ContextModel &c2_ctx,
-                        const std::function<Coeff(Coeff)> &inv_quant,
-                        int64_t *out_cost) const {
+                        const InvQuant &inv_quant, int64_t *out_cost) const {
   int64_t best_cost = std::numeric_limits<int64_t>::max();
   Coeff best_level = max_level;
   auto get_cost = [&](Coeff level) {
@@ -951,44 +994,4 @@ Bits RdoQuant::GetLastPosBits(int width, int height, YuvComponent comp,
   return bits;
 }
 
-std::function<Coeff(Coeff)>
-RdoQuant::GetFwdQuantFunc(YuvComponent comp, const Qp &qp, int width,
-                          int height) {
-  const bool size_rounding_bias =
-    (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
-  const int transform_shift =
-    Quantize::GetTransformShift(width, height, bitdepth_);
-  const int shift = Quantize::kQuantShift + qp.GetQpPer(comp) +
-    transform_shift + (size_rounding_bias ? 7 : 0);
-  const int scale = qp.GetFwdScale(comp) * (size_rounding_bias ? 181 : 1);
-  const int64_t offset = 1ull << (shift - 1);
-  return [scale, offset, shift](const Coeff abs_coeff) {
-    int level = static_cast<int>(
-      ((static_cast<int64_t>(abs_coeff) * scale) + offset) >> shift);
-    return static_cast<Coeff>(level);
-  };
-}
-
-std::function<Coeff(Coeff)>
-RdoQuant::GetInvQuantFunc(YuvComponent comp, const Qp &qp, int width,
-                          int height) {
-  const bool size_rounding_bias =
-    (util::SizeToLog2(width) + util::SizeToLog2(height)) % 2 != 0;
-  const int transform_shift =
-    Quantize::GetTransformShift(width, height, bitdepth_);
-  const int shift = Quantize::kIQuantShift - transform_shift +
-    (size_rounding_bias ? 8 : 0);
-  const int scale = qp.GetInvScale(comp) * (size_rounding_bias ? 181 : 1);
-  return [scale, shift](Coeff in) {
-    if (shift > 0) {
-      const int offset = (1 << (shift - 1));
-      int coeff = ((in * scale) + offset) >> shift;
-      return util::Clip3(coeff, constants::kInt16Min, constants::kInt16Max);
-    } else {
-      int coeff = ((in * scale)) << -shift;
-      return util::Clip3(coeff, constants::kInt16Min, constants::kInt16Max);
-    }
-  };
-}
-
 }   // namespace xvc
@@ -22,8 +22,6 @@
 #ifndef XVC_ENC_LIB_RDO_QUANT_H_
 #define XVC_ENC_LIB_RDO_QUANT_H_
 
-#include <functional>
-
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/quantize.h"
 #include "xvc_enc_lib/encoder_settings.h"
@@ -33,8 +31,10 @@ namespace xvc {
 
 class RdoQuant {
 public:
-  RdoQuant(int bitdepth, const EncoderSettings &encoder_settings)
-    : bitdepth_(bitdepth),
+  RdoQuant(const Quantize::SimdFunc &simd, int bitdepth,
+           const EncoderSettings &encoder_settings)
+    : simd_(simd),
+    bitdepth_(bitdepth),
     encoder_settings_(encoder_settings) {
   }
   int QuantFast(const CodingUnit &cu, YuvComponent comp, const Qp &qp,
@@ -51,7 +51,7 @@ private:
     constants::kMaxBlockSize * constants::kMaxBlockSize;
   static const int kLambdaPrecision = 16;
   struct CoeffCodingState;
-  template<int SubBlockShift>
+  template<int SubBlockShift, bool InvLeftShift>
   int QuantRdo(const CodingUnit &cu, YuvComponent comp, const Qp &qp,
                PicturePredictionType pic_type, const SyntaxWriter &writer,
                const Coeff *in, ptrdiff_t in_stride,
@@ -65,12 +65,17 @@ private:
                        const Qp &qp,
                        const Coeff *src, ptrdiff_t src_stride,
                        Coeff *out, ptrdiff_t out_stride) const;
+  template<int SubBlockShift>
+  int QuantRdo(const CodingUnit &cu, YuvComponent comp, const Qp &qp,
+               PicturePredictionType pic_type, const SyntaxWriter &writer,
+               const Coeff *in, ptrdiff_t in_stride,
+               Coeff *out, ptrdiff_t out_stride);
+  template<typename InvQuant>
   Coeff QuantCoeffRdo(YuvComponent comp, Coeff orig_coeff, Coeff level,
                       const CoeffCodingState &code_state, Bits sig1_bits,
                       int64_t lambda, int cost_scale,
                       const ContextModel &c1_ctx, const ContextModel &c2_ctx,
-                      const std::function<Coeff(Coeff)> &inv_quant,
-                      int64_t *out_cost) const;
+                      const InvQuant &inv_quant, int64_t *out_cost) const;
   bool EvalZeroSubblock(int subblock_index, int size, bool subblock_csbf,
                         const ContextModel &csbf_ctx, int last_pos_index,
                         int64_t subblock_zero_dist, int64_t lambda,
@@ -93,14 +98,11 @@ private:
   Bits GetLastPosBits(int width, int height, YuvComponent comp,
                       ScanOrder scan_order, Contexts *contexts,
                       int last_pos_x, int last_pos_y) const;
-  std::function<Coeff(Coeff)> GetFwdQuantFunc(YuvComponent comp, const Qp &qp,
-                                              int width, int height);
-  std::function<Coeff(Coeff)> GetInvQuantFunc(YuvComponent comp, const Qp &qp,
-                                              int width, int height);
   int64_t BitCost(Bits bits, int64_t lambda) const {
     return (bits * lambda) >> kLambdaPrecision;
   }
 
+  const Quantize::SimdFunc &simd_;
   const int bitdepth_;
   const EncoderSettings &encoder_settings_;
   // Last position eval state
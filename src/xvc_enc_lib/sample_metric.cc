@@ -181,7 +181,7 @@ SampleMetric::Compare(const Qp &qp, YuvComponent comp, int width, int height,
       dist = dist >> (2 * (bitdepth_ - 8));
       break;
     case MetricType::kSatd:
-      dist = ComputeSatd<false>(width, height, 0, src1, stride1, src2, stride2);
+      dist = ComputeSatd(width, height, 0, src1, stride1, src2, stride2);
       break;
     case MetricType::kSatdAcOnly:
       dist = ComputeSatdAcOnly(width, height, src1, stride1, src2, stride2);
@@ -235,7 +235,7 @@ SampleMetric::Compare(const Qp &qp, YuvComponent comp, int width, int height,
       dist = dist >> (2 * (bitdepth_ - 8));
       break;
     case MetricType::kSatd:
-      dist = ComputeSatd<false>(width, height, 0, src1, stride1, src2, stride2);
+      dist = ComputeSatd(width, height, 0, src1, stride1, src2, stride2);
       break;
     case MetricType::kSatdAcOnly:
       dist = ComputeSatdAcOnly(width, height, src1, stride1, src2, stride2);
@@ -313,121 +313,34 @@ static uint64_t ComputeSsd_c(int width, int height,
   return ssd;
 }
 
-template<bool RemoveAvg, typename SampleT1, typename SampleT2>
-uint64_t
-SampleMetric::ComputeSatd(int width, int height, int offset,
-                          const SampleT1 *sample1, ptrdiff_t stride1,
-                          const SampleT2 *sample2, ptrdiff_t stride2) const {
-  uint64_t sad = 0;
-  if (width == 2 || height == 2) {
-    for (int y = 0; y < height; y += 2) {
-      for (int x = 0; x < width; x += 2) {
-        sad += ComputeSatd2x2<RemoveAvg>(sample1 + x, stride1,
-                                         sample2 + x, stride2, offset);
-      }
-      sample1 += stride1 * 2;
-      sample2 += stride2 * 2;
-    }
-  } else if (width == 4 && height == 4) {
-    for (int y = 0; y < height; y += 4) {
-      for (int x = 0; x < width; x += 4) {
-        sad += ComputeSatdNxM<RemoveAvg, 4, 4>(sample1 + x, stride1,
-                                               sample2 + x, stride2, offset);
-      }
-      sample1 += stride1 * 4;
-      sample2 += stride2 * 4;
-    }
-  } else if (height == 4 && width > height) {
-    for (int y = 0; y < height; y += 4) {
-      for (int x = 0; x < width; x += 8) {
-        sad += ComputeSatdNxM<RemoveAvg, 8, 4>(sample1 + x, stride1,
-                                               sample2 + x, stride2, offset);
-      }
-      sample1 += stride1 * 4;
-      sample2 += stride2 * 4;
-    }
-  } else if (width == 4 && height > width) {
-    for (int y = 0; y < height; y += 8) {
-      for (int x = 0; x < width; x += 4) {
-        sad += ComputeSatdNxM<RemoveAvg, 4, 8>(sample1 + x, stride1,
-                                               sample2 + x, stride2, offset);
-      }
-      sample1 += stride1 * 8;
-      sample2 += stride2 * 8;
-    }
-  } else if (width > height) {
-    for (int y = 0; y < height; y += 8) {
-      for (int x = 0; x < width; x += 16) {
-        sad +=
-          ComputeSatdNxM<RemoveAvg, 16, 8>(sample1 + x, stride1,
-                                           sample2 + x, stride2, offset);
-      }
-      sample1 += stride1 * 8;
-      sample2 += stride2 * 8;
-    }
-  } else if (width < height) {
-    for (int y = 0; y < height; y += 16) {
-      for (int x = 0; x < width; x += 8) {
-        sad +=
-          ComputeSatdNxM<RemoveAvg, 8, 16>(sample1 + x, stride1,
-                                           sample2 + x, stride2, offset);
-      }
-      sample1 += stride1 * 16;
-      sample2 += stride2 * 16;
-    }
-  } else {
-    for (int y = 0; y < height; y += 8) {
-      for (int x = 0; x < width; x += 8) {
-        sad += ComputeSatdNxM<RemoveAvg, 8, 8>(sample1 + x, stride1,
-                                               sample2 + x, stride2, offset);
-      }
-      sample1 += stride1 * 8;
-      sample2 += stride2 * 8;
-    }
-  }
-  return sad >> (bitdepth_ - 8);
-}
-
-template<typename SampleT1, typename SampleT2>
-uint64_t
-SampleMetric::ComputeSatdAcOnly(int width, int height,
-                                const SampleT1 *sample1, ptrdiff_t stride1,
-                                const SampleT2 *sample2,
-                                ptrdiff_t stride2) const {
-  const int avg =
-    CalcMeanDiff<0>(width, height, sample1, stride1, sample2, stride2);
-  return
-    ComputeSatd<true>(width, height, avg, sample1, stride1, sample2, stride2);
-}
-
-template<bool RemoveAvg, int W, int H, typename SampleT1, typename SampleT2>
-int SampleMetric::ComputeSatdNxM(const SampleT1 *sample1, ptrdiff_t stride1,
-                                 const SampleT2 *sample2, ptrdiff_t stride2,
-                                 int offset) const {
+template<int W, int H, typename SampleT1, typename SampleT2>
+static int ComputeSatdNxM_c(const SampleT1 *sample1, ptrdiff_t stride1,
+                            const SampleT2 *sample2, ptrdiff_t stride2,
+                            int offset) {
   int diff[W*H], m1[H][W], m2[H][W];
   static_assert(W == 4 || W == 8 || W == 16, "Only W = 4, 8 and 16 supported");
   static_assert(H == 4 || H == 8 || H == 16, "Only H = 4, 8 and 16 supported");
 
   for (int k = 0; k < W*H; k += W) {
-    diff[k + 0] = sample1[0] - sample2[0] - (RemoveAvg ? offset : 0);
-    diff[k + 1] = sample1[1] - sample2[1] - (RemoveAvg ? offset : 0);
-    diff[k + 2] = sample1[2] - sample2[2] - (RemoveAvg ? offset : 0);
-    diff[k + 3] = sample1[3] - sample2[3] - (RemoveAvg ? offset : 0);
+    diff[k + 0] = sample1[0] - sample2[0] - offset;
+    diff[k + 1] = sample1[1] - sample2[1] - offset;
+    diff[k + 2] = sample1[2] - sample2[2] - offset;
+    diff[k + 3] = sample1[3] - sample2[3] - offset;
     if (W > 4) {
-      diff[k + 4] = sample1[4] - sample2[4] - (RemoveAvg ? offset : 0);
-      diff[k + 5] = sample1[5] - sample2[5] - (RemoveAvg ? offset : 0);
-      diff[k + 6] = sample1[6] - sample2[6] - (RemoveAvg ? offset : 0);
-      diff[k + 7] = sample1[7] - sample2[7] - (RemoveAvg ? offset : 0);
+      diff[k + 4] = sample1[4] - sample2[4] - offset;
+      diff[k + 5] = sample1[5] - sample2[5] - offset;
+      diff[k + 6] = sample1[6] - sample2[6] - offset;
+      diff[k + 7] = sample1[7] - sample2[7] - offset;
     }
     if (W > 8) {
-      diff[k + 8] = sample1[8] - sample2[8] - (RemoveAvg ? offset : 0);
-      diff[k + 9] = sample1[9] - sample2[9] - (RemoveAvg ? offset : 0);
-      diff[k + 10] = sample1[10] - sample2[10] - (RemoveAvg ? offset : 0);
-      diff[k + 11] = sample1[11] - sample2[11] - (RemoveAvg ? offset : 0);
-      diff[k + 12] = sample1[12] - sample2[12] - (RemoveAvg ? offset : 0);
-      diff[k + 13] = sample1[13] - sample2[13] - (RemoveAvg ? offset : 0);
-      diff[k + 14] = sample1[14] - sample2[14] - (RemoveAvg ? offset : 0);
-      diff[k + 15] = sample1[15] - sample2[15] - (RemoveAvg ? offset : 0);
+      diff[k + 8] = sample1[8] - sample2[8] - offset;
+      diff[k + 9] = sample1[9] - sample2[9] - offset;
+      diff[k + 10] = sample1[10] - sample2[10] - offset;
+      diff[k + 11] = sample1[11] - sample2[11] - offset;
+      diff[k + 12] = sample1[12] - sample2[12] - offset;
+      diff[k + 13] = sample1[13] - sample2[13] - offset;
+      diff[k + 14] = sample1[14] - sample2[14] - offset;
+      diff[k + 15] = sample1[15] - sample2[15] - offset;
     }
     sample1 += stride1;
     sample2 += stride2;
@@ -630,31 +543,34 @@ int SampleMetric::ComputeSatdNxM(const SampleT1 *sample1, ptrdiff_t stride1,
       sum += std::abs(m2[i][j]);
     }
   }
-  if (W == 4 && H == 4) {
-    sum = (sum + 1) >> 1;
-  } else if (W == H) {
-    sum = (sum + 2) >> 2;
-  } else {
-    sum = static_cast<int>(2.0 * sum / std::sqrt(W*H));
+  return SampleMetric::NormalizeSatd<W, H>(sum);
+}
+
+template<int W, int H, typename SampleT1>
+static uint64_t ComputeSatd_c(int width, int height, int offset,
+                              const SampleT1 *sample1, ptrdiff_t stride1,
+                              const Sample *sample2, ptrdiff_t stride2) {
+  uint64_t sum = 0;
+  for (int y = 0; y < height; y += H) {
+    for (int x = 0; x < width; x += W) {
+      sum += ComputeSatdNxM_c<W, H>(sample1 + x, stride1, sample2 + x, stride2,
+                                    offset);
+    }
+    sample1 += stride1 * H;
+    sample2 += stride2 * H;
   }
   return sum;
 }
 
-template<bool RemoveAvg, typename SampleT1, typename SampleT2>
-int SampleMetric::ComputeSatd2x2(const SampleT1 *sample1, ptrdiff_t stride1,
-                                 const SampleT2 *sample2, ptrdiff_t stride2,
-                                 int offset) const {
+template<typename SampleT1>
+static int ComputeSatd2x2(const SampleT1 *sample1, ptrdiff_t stride1,
+                          const Sample *sample2, ptrdiff_t stride2,
+                          int offset) {
   int diff[2 * 2], m[2 * 2];
-  diff[0] = sample1[0 + 0 * stride1] - sample2[0 + 0 * stride2];
-  diff[1] = sample1[1 + 0 * stride1] - sample2[1 + 0 * stride2];
-  diff[2] = sample1[0 + 1 * stride1] - sample2[0 + 1 * stride2];
-  diff[3] = sample1[1 + 1 * stride1] - sample2[1 + 1 * stride2];
-  if (RemoveAvg) {
-    diff[0] -= offset;
-    diff[1] -= offset;
-    diff[2] -= offset;
-    diff[3] -= offset;
-  }
+  diff[0] = sample1[0 + 0 * stride1] - sample2[0 + 0 * stride2] - offset;
+  diff[1] = sample1[1 + 0 * stride1] - sample2[1 + 0 * stride2] - offset;
+  diff[2] = sample1[0 + 1 * stride1] - sample2[0 + 1 * stride2] - offset;
+  diff[3] = sample1[1 + 1 * stride1] - sample2[1 + 1 * stride2] - offset;
   m[0] = diff[0] + diff[2];
   m[1] = diff[1] + diff[3];
   m[2] = diff[0] - diff[2];
@@ -667,6 +583,73 @@ int SampleMetric::ComputeSatd2x2(const SampleT1 *sample1, ptrdiff_t stride1,
   return sum;
 }
 
+static uint64_t
+ComputeSatdTiles(const SampleMetric::SimdFunc &simd_func, int tile_width,
+                 int tile_height, int width, int height, int offset,
+                 const Sample *sample1, ptrdiff_t stride1,
+                 const Sample *sample2, ptrdiff_t stride2) {
+  return simd_func.satd_sample_sample[util::SizeToLog2(tile_width) - 2]
+    [util::SizeToLog2(tile_height) - 2](width, height, offset,
+                                        sample1, stride1, sample2, stride2);
+}
+
+static uint64_t
+ComputeSatdTiles(const SampleMetric::SimdFunc &simd_func, int tile_width,
+                 int tile_height, int width, int height, int offset,
+                 const Residual *sample1, ptrdiff_t stride1,
+                 const Sample *sample2, ptrdiff_t stride2) {
+  return simd_func.satd_short_sample[util::SizeToLog2(tile_width) - 2]
+    [util::SizeToLog2(tile_height) - 2](width, height, offset,
+                                        sample1, stride1, sample2, stride2);
+}
+
+template<typename SampleT1>
+uint64_t
+SampleMetric::ComputeSatd(int width, int height, int offset,
+                          const SampleT1 *sample1, ptrdiff_t stride1,
+                          const Sample *sample2, ptrdiff_t stride2) const {
+  uint64_t sad = 0;
+  if (width == 2 || height == 2) {
+    for (int y = 0; y < height; y += 2) {
+      for (int x = 0; x < width; x += 2) {
+        sad += ComputeSatd2x2(sample1 + x, stride1, sample2 + x, stride2,
+                              offset);
+      }
+      sample1 += stride1 * 2;
+      sample2 += stride2 * 2;
+    }
+    return sad >> (bitdepth_ - 8);
+  }
+  int tile_width = 8;
+  int tile_height = 8;
+  if (width == 4 && height == 4) {
+    tile_width = 4;
+    tile_height = 4;
+  } else if (height == 4 && width > height) {
+    tile_height = 4;
+  } else if (width == 4 && height > width) {
+    tile_width = 4;
+  } else if (width > height) {
+    tile_width = 16;
+  } else if (width < height) {
+    tile_height = 16;
+  }
+  sad = ComputeSatdTiles(simd_func_, tile_width, tile_height, width, height,
+                         offset, sample1, stride1, sample2, stride2);
+  return sad >> (bitdepth_ - 8);
+}
+
+template<typename SampleT1>
+uint64_t
+SampleMetric::ComputeSatdAcOnly(int width, int height,
+                                const SampleT1 *sample1, ptrdiff_t stride1,
+                                const Sample *sample2,
+                                ptrdiff_t stride2) const {
+  const int avg =
+    CalcMeanDiff<0>(width, height, sample1, stride1, sample2, stride2);
+  return ComputeSatd(width, height, avg, sample1, stride1, sample2, stride2);
+}
+
 template<typename SampleT1, typename SampleT2>
 static int ComputeSad_c(int width, int height,
                         const SampleT1 *sample1, ptrdiff_t stride1,
@@ -820,6 +803,25 @@ SampleMetric::SimdFunc::SimdFunc() {
   ssd_short_short[4] = &ComputeSsd_c<Residual, Residual>;  // 16
   ssd_short_short[5] = &ComputeSsd_c<Residual, Residual>;  // 32
   ssd_short_short[6] = &ComputeSsd_c<Residual, Residual>;  // 64
+
+  for (int w = 0; w < kSatdSizes; w++) {
+    for (int h = 0; h < kSatdSizes; h++) {
+      satd_sample_sample[w][h] = nullptr;
+      satd_short_sample[w][h] = nullptr;
+    }
+  }
+  satd_sample_sample[0][0] = &ComputeSatd_c<4, 4, Sample>;     // 4x4
+  satd_sample_sample[1][0] = &ComputeSatd_c<8, 4, Sample>;     // 8x4
+  satd_sample_sample[0][1] = &ComputeSatd_c<4, 8, Sample>;     // 4x8
+  satd_sample_sample[1][1] = &ComputeSatd_c<8, 8, Sample>;     // 8x8
+  satd_sample_sample[2][1] = &ComputeSatd_c<16, 8, Sample>;    // 16x8
+  satd_sample_sample[1][2] = &ComputeSatd_c<8, 16, Sample>;    // 8x16
+  satd_short_sample[0][0] = &ComputeSatd_c<4, 4, Residual>;    // 4x4
+  satd_short_sample[1][0] = &ComputeSatd_c<8, 4, Residual>;    // 8x4
+  satd_short_sample[0][1] = &ComputeSatd_c<4, 8, Residual>;    // 4x8
+  satd_short_sample[1][1] = &ComputeSatd_c<8, 8, Residual>;    // 8x8
+  satd_short_sample[2][1] = &ComputeSatd_c<16, 8, Residual>;   // 16x8
+  satd_short_sample[1][2] = &ComputeSatd_c<8, 16, Residual>;   // 8x16
 }
 
 }   // namespace xvc
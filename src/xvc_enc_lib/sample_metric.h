@@ -22,6 +22,7 @@
 #ifndef XVC_ENC_LIB_SAMPLE_METRIC_H_
 #define XVC_ENC_LIB_SAMPLE_METRIC_H_
 
+#include <cmath>
 #include <vector>
 
 #include "xvc_common_lib/coding_unit.h"
@@ -111,6 +112,16 @@ public:
                           const Residual *src2, ptrdiff_t stride2) const {
     return Compare(qp, comp, width, height, src1, stride1, src2, stride2);
   }
+  // Scaling of the absolute sum of Hadamard coefficients for one WxH tile
+  template<int W, int H>
+  static int NormalizeSatd(int sum) {
+    if (W == 4 && H == 4) {
+      return (sum + 1) >> 1;
+    } else if (W == H) {
+      return (sum + 2) >> 2;
+    }
+    return static_cast<int>(2.0 * sum / std::sqrt(W * H));
+  }
 
 private:
   Distortion Compare(const Qp &qp, YuvComponent comp, int width, int height,
@@ -122,22 +133,14 @@ private:
   Distortion Compare(const Qp &qp, YuvComponent comp, int width, int height,
                      const Residual *src1, ptrdiff_t stride1,
                      const Residual *src2, ptrdiff_t stride2) const;
-  template<bool RemoveAvg, typename SampleT1, typename SampleT2>
+  template<typename SampleT1>
   uint64_t ComputeSatd(int width, int height, int offset,
                        const SampleT1 *sample1, ptrdiff_t stride1,
-                       const SampleT2 *sample2, ptrdiff_t stride2) const;
-  template<typename SampleT1, typename SampleT2>
+                       const Sample *sample2, ptrdiff_t stride2) const;
+  template<typename SampleT1>
   uint64_t ComputeSatdAcOnly(int width, int height,
                              const SampleT1 *sample1, ptrdiff_t stride1,
-                             const SampleT2 *sample2, ptrdiff_t stride2) const;
-  template<bool RemoveAvg, int W, int H, typename SampleT1, typename SampleT2>
-  int ComputeSatdNxM(const SampleT1 *sample1, ptrdiff_t stride1,
-                     const SampleT2 *sample2, ptrdiff_t stride2,
-                     int offset) const;
-  template<bool RemoveAvg, typename SampleT1, typename SampleT2>
-  int ComputeSatd2x2(const SampleT1 *sample1, ptrdiff_t stride1,
-                     const SampleT2 *sample2, ptrdiff_t stride2,
-                     int offset) const;
+                             const Sample *sample2, ptrdiff_t stride2) const;
   template<int SkipLines, typename SampleT1, typename SampleT2>
   uint64_t ComputeSadAcOnly(int width, int height,
                             const SampleT1 *sample1, ptrdiff_t stride1,
@@ -165,6 +168,8 @@ private:
 
 struct SampleMetric::SimdFunc {
   static const int kMaxSize = constants::kCtuSizeLog2 + 1;
+  // Hadamard tiles are 4, 8 or 16 samples in each direction
+  static const int kSatdSizes = 3;
   SimdFunc();
 
   int(*sad_sample_sample[kMaxSize])(int width, int height,
@@ -188,6 +193,16 @@ struct SampleMetric::SimdFunc {
                                        ptrdiff_t stride1,
                                        const int16_t *sample2,
                                        ptrdiff_t stride2);
+  // Sum of normalized satd for all tiles of the given size in the block,
+  // indexed by log2 of tile width and height minus 2
+  uint64_t(*satd_sample_sample[kSatdSizes][kSatdSizes])(
+    int width, int height, int offset,
+    const Sample *sample1, ptrdiff_t stride1,
+    const Sample *sample2, ptrdiff_t stride2);
+  uint64_t(*satd_short_sample[kSatdSizes][kSatdSizes])(
+    int width, int height, int offset,
+    const int16_t *sample1, ptrdiff_t stride1,
+    const Sample *sample2, ptrdiff_t stride2);
 };
 
 }   // namespace xvc
@@ -89,6 +89,13 @@ void SegmentHeaderWriter::Write(const SegmentHeader &segment_header,
   }
 
   WriteRestrictions(segment_header.restrictions, bit_writer);
+  if (SegmentHeader::HasSlices(segment_header.major_version,
+                               segment_header.minor_version)) {
+    assert(segment_header.num_slices >= 1 &&
+           segment_header.num_slices <= (1 << constants::kNumSlicesBits));
+    bit_writer->WriteBits(segment_header.num_slices - 1,
+                          constants::kNumSlicesBits);
+  }
   bit_writer->PadZeroBits();
 }
 
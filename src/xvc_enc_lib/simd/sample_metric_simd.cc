@@ -33,6 +33,11 @@
 #include <immintrin.h>    // AVX2
 #endif  // XVC_ARCH_X86
 
+#ifdef XVC_HAVE_NEON
+#include <arm_neon.h>
+#endif  // XVC_HAVE_NEON
+
+#include <cstring>
 #include <type_traits>
 
 #include "xvc_enc_lib/encoder_simd_functions.h"
@@ -210,15 +215,508 @@ static uint64_t ComputeSsd_16x2_avx2(int width, int height,
   _mm_storel_epi64(reinterpret_cast<__m128i*>(&result), out);
   return result;
 }
+
+// Loads 8 samples from two consecutive rows into one register
+template<typename SampleT>
+__attribute__((target("avx2")))
+static inline __m256i Load8x2Avx2(const SampleT *ptr, ptrdiff_t stride) {
+  __m128i row0 = _mm_loadu_si128(CAST_M128i_CONST(ptr));
+  __m128i row1 = _mm_loadu_si128(CAST_M128i_CONST(ptr + stride));
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(row0), row1, 1);
+}
+
+// Loads 4 samples from four consecutive rows into one register
+template<typename SampleT>
+__attribute__((target("avx2")))
+static inline __m256i Load4x4Avx2(const SampleT *ptr, ptrdiff_t stride) {
+  __m128i row0 = _mm_loadl_epi64(CAST_M128i_CONST(ptr));
+  __m128i row1 = _mm_loadl_epi64(CAST_M128i_CONST(ptr + stride));
+  __m128i row2 = _mm_loadl_epi64(CAST_M128i_CONST(ptr + stride * 2));
+  __m128i row3 = _mm_loadl_epi64(CAST_M128i_CONST(ptr + stride * 3));
+  __m128i row01 = _mm_unpacklo_epi64(row0, row1);
+  __m128i row23 = _mm_unpacklo_epi64(row2, row3);
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(row01), row23, 1);
+}
+
+// Loads 4 samples from two consecutive rows into the lower half
+template<typename SampleT>
+__attribute__((target("avx2")))
+static inline __m256i Load4x2Avx2(const SampleT *ptr, ptrdiff_t stride) {
+  __m128i row0 = _mm_loadl_epi64(CAST_M128i_CONST(ptr));
+  __m128i row1 = _mm_loadl_epi64(CAST_M128i_CONST(ptr + stride));
+  return _mm256_castsi128_si256(_mm_unpacklo_epi64(row0, row1));
+}
+
+__attribute__((target("avx2")))
+static inline int HorizontalSumEpi32Avx2(__m256i sum) {
+  __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                 _mm256_extracti128_si256(sum, 1));
+  __m128i sum64_hi = _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2));
+  __m128i sum32 = _mm_add_epi32(sum128, sum64_hi);
+  __m128i sum32_hi = _mm_shuffle_epi32(sum32, _MM_SHUFFLE(2, 3, 0, 1));
+  return _mm_cvtsi128_si32(_mm_add_epi32(sum32, sum32_hi));
+}
+
+__attribute__((target("avx2")))
+static inline uint64_t HorizontalSumEpi64Avx2(__m256i sum) {
+  __m128i sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum),
+                                 _mm256_extracti128_si256(sum, 1));
+  __m128i sum64_hi = _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2));
+  uint64_t result = 0;
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(&result),
+                   _mm_add_epi64(sum128, sum64_hi));
+  return result;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i SadEpi32Avx2(__m256i src1, __m256i src2) {
+  __m256i abs = _mm256_abs_epi16(_mm256_sub_epi16(src1, src2));
+  __m256i ones_epi16 = _mm256_load_si256(CAST_M256i_CONST(&kOnes16bit[0]));
+  return _mm256_madd_epi16(abs, ones_epi16);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i SsdEpi64Avx2(__m256i src1, __m256i src2) {
+  __m256i diff = _mm256_sub_epi16(src1, src2);
+  __m256i ssd = _mm256_madd_epi16(diff, diff);
+  __m256i zero_vec = _mm256_setzero_si256();
+  return _mm256_add_epi64(_mm256_unpacklo_epi32(ssd, zero_vec),
+                          _mm256_unpackhi_epi32(ssd, zero_vec));
+}
+
+template<typename SampleT1>
+__attribute__((target("avx2")))
+static int ComputeSad_8x2_avx2(int width, int height,
+                               const SampleT1 *src1, ptrdiff_t stride1,
+                               const Sample *src2, ptrdiff_t stride2) {
+  static_assert(std::is_same<Sample, uint16_t>::value, "assume high bitdepth");
+  __m256i sum = _mm256_setzero_si256();
+  for (int y = 0; y < height; y += 2) {
+    for (int x = 0; x < width; x += 8) {
+      sum = _mm256_add_epi32(sum, SadEpi32Avx2(Load8x2Avx2(src1 + x, stride1),
+                                               Load8x2Avx2(src2 + x, stride2)));
+    }
+    src1 += stride1 * 2;
+    src2 += stride2 * 2;
+  }
+  return HorizontalSumEpi32Avx2(sum);
+}
+
+template<typename SampleT1, typename Sample>
+__attribute__((target("avx2")))
+static uint64_t ComputeSsd_8x2_avx2(int width, int height,
+                                    const SampleT1 *src1, ptrdiff_t stride1,
+                                    const Sample *src2, ptrdiff_t stride2) {
+  static_assert((std::is_same<Sample, uint16_t>::value) ||
+    (std::is_same<Sample, int16_t>::value), "assume high bitdepth");
+  __m256i sum = _mm256_setzero_si256();
+  for (int y = 0; y < height; y += 2) {
+    for (int x = 0; x < width; x += 8) {
+      sum = _mm256_add_epi64(sum, SsdEpi64Avx2(Load8x2Avx2(src1 + x, stride1),
+                                               Load8x2Avx2(src2 + x, stride2)));
+    }
+    src1 += stride1 * 2;
+    src2 += stride2 * 2;
+  }
+  return HorizontalSumEpi64Avx2(sum);
+}
+
+template<typename SampleT1>
+__attribute__((target("avx2")))
+static int ComputeSad_4x4_avx2(int width, int height,
+                               const SampleT1 *src1, ptrdiff_t stride1,
+                               const Sample *src2, ptrdiff_t stride2) {
+  static_assert(std::is_same<Sample, uint16_t>::value, "assume high bitdepth");
+  __m256i sum = _mm256_setzero_si256();
+  int y = 0;
+  for (; y + 4 <= height; y += 4) {
+    sum = _mm256_add_epi32(sum, SadEpi32Avx2(Load4x4Avx2(src1, stride1),
+                                             Load4x4Avx2(src2, stride2)));
+    src1 += stride1 * 4;
+    src2 += stride2 * 4;
+  }
+  if (y < height) {
+    sum = _mm256_add_epi32(sum, SadEpi32Avx2(Load4x2Avx2(src1, stride1),
+                                             Load4x2Avx2(src2, stride2)));
+  }
+  return HorizontalSumEpi32Avx2(sum);
+}
+
+template<typename SampleT1, typename Sample>
+__attribute__((target("avx2")))
+static uint64_t ComputeSsd_4x4_avx2(int width, int height,
+                                    const SampleT1 *src1, ptrdiff_t stride1,
+                                    const Sample *src2, ptrdiff_t stride2) {
+  static_assert((std::is_same<Sample, uint16_t>::value) ||
+    (std::is_same<Sample, int16_t>::value), "assume high bitdepth");
+  __m256i sum = _mm256_setzero_si256();
+  int y = 0;
+  for (; y + 4 <= height; y += 4) {
+    sum = _mm256_add_epi64(sum, SsdEpi64Avx2(Load4x4Avx2(src1, stride1),
+                                             Load4x4Avx2(src2, stride2)));
+    src1 += stride1 * 4;
+    src2 += stride2 * 4;
+  }
+  if (y < height) {
+    sum = _mm256_add_epi64(sum, SsdEpi64Avx2(Load4x2Avx2(src1, stride1),
+                                             Load4x2Avx2(src2, stride2)));
+  }
+  return HorizontalSumEpi64Avx2(sum);
+}
 #endif
 #endif  // XVC_ARCH_X86
 
+#ifdef XVC_ARCH_X86
+// Satd kernels work on 32-bit differences so that any bitdepth and residual
+// input fits. A WxH Hadamard transform is split into butterflies between
+// 4x4 blocks followed by a 4x4 transform of each block, this only permutes
+// the output coefficients compared to the scalar version.
+__attribute__((target("sse4.1")))
+static inline __m128i Load4Epi32Sse4(const uint8_t *ptr) {
+  int32_t val;
+  std::memcpy(&val, ptr, sizeof(val));
+  return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(val));
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i Load4Epi32Sse4(const uint16_t *ptr) {
+  return _mm_cvtepu16_epi32(_mm_loadl_epi64(CAST_M128i_CONST(ptr)));
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i Load4Epi32Sse4(const int16_t *ptr) {
+  return _mm_cvtepi16_epi32(_mm_loadl_epi64(CAST_M128i_CONST(ptr)));
+}
+
+// Hadamard transform between N registers located dist registers apart
+template<int N>
+__attribute__((target("sse4.1")))
+static inline void HadamardButterfliesSse4(__m128i *v, int dist) {
+  for (int step = 1; step < N; step *= 2) {
+    for (int i = 0; i < N; i++) {
+      if (i & step) {
+        continue;
+      }
+      __m128i a = v[i * dist];
+      __m128i b = v[(i + step) * dist];
+      v[i * dist] = _mm_add_epi32(a, b);
+      v[(i + step) * dist] = _mm_sub_epi32(a, b);
+    }
+  }
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i Hadamard4x4AbsSse4(__m128i *rows) {
+  HadamardButterfliesSse4<4>(rows, 1);
+  __m128i t0 = _mm_unpacklo_epi32(rows[0], rows[1]);
+  __m128i t1 = _mm_unpacklo_epi32(rows[2], rows[3]);
+  __m128i t2 = _mm_unpackhi_epi32(rows[0], rows[1]);
+  __m128i t3 = _mm_unpackhi_epi32(rows[2], rows[3]);
+  __m128i cols[4] = {
+    _mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+    _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)
+  };
+  HadamardButterfliesSse4<4>(cols, 1);
+  __m128i sum01 = _mm_add_epi32(_mm_abs_epi32(cols[0]),
+                                _mm_abs_epi32(cols[1]));
+  __m128i sum23 = _mm_add_epi32(_mm_abs_epi32(cols[2]),
+                                _mm_abs_epi32(cols[3]));
+  return _mm_add_epi32(sum01, sum23);
+}
+
+__attribute__((target("sse4.1")))
+static inline int HorizontalSumEpi32Sse4(__m128i sum) {
+  __m128i sum64_hi = _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2));
+  __m128i sum32 = _mm_add_epi32(sum, sum64_hi);
+  __m128i sum32_hi = _mm_shuffle_epi32(sum32, _MM_SHUFFLE(2, 3, 0, 1));
+  return _mm_cvtsi128_si32(_mm_add_epi32(sum32, sum32_hi));
+}
+
+template<int W, int H, typename SampleT1>
+__attribute__((target("sse4.1")))
+static uint64_t ComputeSatd_sse4(int width, int height, int offset,
+                                 const SampleT1 *src1, ptrdiff_t stride1,
+                                 const Sample *src2, ptrdiff_t stride2) {
+  const int kBlocksX = W / 4;
+  const int kBlocksY = H / 4;
+  const __m128i voffset = _mm_set1_epi32(offset);
+  uint64_t sum = 0;
+  for (int y = 0; y < height; y += H) {
+    for (int x = 0; x < width; x += W) {
+      // blocks[by][bx][row]
+      __m128i blocks[kBlocksY][kBlocksX][4];
+      for (int by = 0; by < kBlocksY; by++) {
+        for (int bx = 0; bx < kBlocksX; bx++) {
+          for (int i = 0; i < 4; i++) {
+            const ptrdiff_t row = by * 4 + i;
+            __m128i diff =
+              _mm_sub_epi32(Load4Epi32Sse4(src1 + row * stride1 + x + bx * 4),
+                            Load4Epi32Sse4(src2 + row * stride2 + x + bx * 4));
+            blocks[by][bx][i] = _mm_sub_epi32(diff, voffset);
+          }
+        }
+      }
+      for (int i = 0; i < 4; i++) {
+        for (int by = 0; by < kBlocksY; by++) {
+          HadamardButterfliesSse4<kBlocksX>(&blocks[by][0][i], 4);
+        }
+        for (int bx = 0; bx < kBlocksX; bx++) {
+          HadamardButterfliesSse4<kBlocksY>(&blocks[0][bx][i], 4 * kBlocksX);
+        }
+      }
+      __m128i abs_sum = _mm_setzero_si128();
+      for (int by = 0; by < kBlocksY; by++) {
+        for (int bx = 0; bx < kBlocksX; bx++) {
+          abs_sum =
+            _mm_add_epi32(abs_sum, Hadamard4x4AbsSse4(blocks[by][bx]));
+        }
+      }
+      sum += SampleMetric::NormalizeSatd<W, H>(HorizontalSumEpi32Sse4(abs_sum));
+    }
+    src1 += stride1 * H;
+    src2 += stride2 * H;
+  }
+  return sum;
+}
+#endif  // XVC_ARCH_X86
+
+#if defined(XVC_ARCH_X86) && USE_AVX2
+__attribute__((target("avx2")))
+static inline __m256i Load8Epi32Avx2(const uint8_t *ptr) {
+  return _mm256_cvtepu8_epi32(_mm_loadl_epi64(CAST_M128i_CONST(ptr)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i Load8Epi32Avx2(const uint16_t *ptr) {
+  return _mm256_cvtepu16_epi32(_mm_loadu_si128(CAST_M128i_CONST(ptr)));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i Load8Epi32Avx2(const int16_t *ptr) {
+  return _mm256_cvtepi16_epi32(_mm_loadu_si128(CAST_M128i_CONST(ptr)));
+}
+
+template<int N>
+__attribute__((target("avx2")))
+static inline void HadamardButterfliesAvx2(__m256i *v, int dist) {
+  for (int step = 1; step < N; step *= 2) {
+    for (int i = 0; i < N; i++) {
+      if (i & step) {
+        continue;
+      }
+      __m256i a = v[i * dist];
+      __m256i b = v[(i + step) * dist];
+      v[i * dist] = _mm256_add_epi32(a, b);
+      v[(i + step) * dist] = _mm256_sub_epi32(a, b);
+    }
+  }
+}
+
+// Each register holds one row of two horizontally adjacent 4x4 blocks,
+// the 4x4 transforms are done independently in each 128-bit lane
+template<int W, int H, typename SampleT1>
+__attribute__((target("avx2")))
+static uint64_t ComputeSatd_avx2(int width, int height, int offset,
+                                 const SampleT1 *src1, ptrdiff_t stride1,
+                                 const Sample *src2, ptrdiff_t stride2) {
+  static_assert(W >= 8, "two 4x4 blocks per register");
+  const int kPairsX = W / 8;
+  const int kBlocksY = H / 4;
+  const __m256i voffset = _mm256_set1_epi32(offset);
+  uint64_t sum = 0;
+  for (int y = 0; y < height; y += H) {
+    for (int x = 0; x < width; x += W) {
+      // blocks[by][px][row]
+      __m256i blocks[kBlocksY][kPairsX][4];
+      for (int by = 0; by < kBlocksY; by++) {
+        for (int px = 0; px < kPairsX; px++) {
+          for (int i = 0; i < 4; i++) {
+            const ptrdiff_t row = by * 4 + i;
+            __m256i diff =
+              _mm256_sub_epi32(
+                Load8Epi32Avx2(src1 + row * stride1 + x + px * 8),
+                Load8Epi32Avx2(src2 + row * stride2 + x + px * 8));
+            blocks[by][px][i] = _mm256_sub_epi32(diff, voffset);
+          }
+        }
+      }
+      for (int i = 0; i < 4; i++) {
+        for (int by = 0; by < kBlocksY; by++) {
+          HadamardButterfliesAvx2<kPairsX>(&blocks[by][0][i], 4);
+          for (int px = 0; px < kPairsX; px++) {
+            // Butterfly between the two blocks of the pair, the sign of the
+            // difference in the upper lane does not matter for the abs sum
+            __m256i val = blocks[by][px][i];
+            __m256i swapped = _mm256_permute2x128_si256(val, val, 0x01);
+            blocks[by][px][i] =
+              _mm256_blend_epi32(_mm256_add_epi32(val, swapped),
+                                 _mm256_sub_epi32(val, swapped), 0xf0);
+          }
+        }
+        for (int px = 0; px < kPairsX; px++) {
+          HadamardButterfliesAvx2<kBlocksY>(&blocks[0][px][i], 4 * kPairsX);
+        }
+      }
+      __m256i abs_sum = _mm256_setzero_si256();
+      for (int by = 0; by < kBlocksY; by++) {
+        for (int px = 0; px < kPairsX; px++) {
+          __m256i *rows = blocks[by][px];
+          HadamardButterfliesAvx2<4>(rows, 1);
+          __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+          __m256i t1 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+          __m256i t2 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+          __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+          __m256i cols[4] = {
+            _mm256_unpacklo_epi64(t0, t1), _mm256_unpackhi_epi64(t0, t1),
+            _mm256_unpacklo_epi64(t2, t3), _mm256_unpackhi_epi64(t2, t3)
+          };
+          HadamardButterfliesAvx2<4>(cols, 1);
+          abs_sum = _mm256_add_epi32(abs_sum, _mm256_abs_epi32(cols[0]));
+          abs_sum = _mm256_add_epi32(abs_sum, _mm256_abs_epi32(cols[1]));
+          abs_sum = _mm256_add_epi32(abs_sum, _mm256_abs_epi32(cols[2]));
+          abs_sum = _mm256_add_epi32(abs_sum, _mm256_abs_epi32(cols[3]));
+        }
+      }
+      __m128i abs_sum128 = _mm_add_epi32(_mm256_castsi256_si128(abs_sum),
+                                         _mm256_extracti128_si256(abs_sum, 1));
+      sum +=
+        SampleMetric::NormalizeSatd<W, H>(HorizontalSumEpi32Sse4(abs_sum128));
+    }
+    src1 += stride1 * H;
+    src2 += stride2 * H;
+  }
+  return sum;
+}
+#endif  // XVC_ARCH_X86 && USE_AVX2
+
+#ifdef XVC_HAVE_NEON
+static inline int32x4_t Load4Epi32Neon(const uint8_t *ptr) {
+  uint32_t val;
+  std::memcpy(&val, ptr, sizeof(val));
+  uint16x8_t val16 = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(val)));
+  return vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(val16)));
+}
+
+static inline int32x4_t Load4Epi32Neon(const uint16_t *ptr) {
+  return vreinterpretq_s32_u32(vmovl_u16(vld1_u16(ptr)));
+}
+
+static inline int32x4_t Load4Epi32Neon(const int16_t *ptr) {
+  return vmovl_s16(vld1_s16(ptr));
+}
+
+template<int N>
+static inline void HadamardButterfliesNeon(int32x4_t *v, int dist) {
+  for (int step = 1; step < N; step *= 2) {
+    for (int i = 0; i < N; i++) {
+      if (i & step) {
+        continue;
+      }
+      int32x4_t a = v[i * dist];
+      int32x4_t b = v[(i + step) * dist];
+      v[i * dist] = vaddq_s32(a, b);
+      v[(i + step) * dist] = vsubq_s32(a, b);
+    }
+  }
+}
+
+static inline int32x4_t Hadamard4x4AbsNeon(int32x4_t *rows) {
+  HadamardButterfliesNeon<4>(rows, 1);
+  int32x4x2_t t01 = vtrnq_s32(rows[0], rows[1]);
+  int32x4x2_t t23 = vtrnq_s32(rows[2], rows[3]);
+  int32x4_t cols[4] = {
+    vcombine_s32(vget_low_s32(t01.val[0]), vget_low_s32(t23.val[0])),
+    vcombine_s32(vget_low_s32(t01.val[1]), vget_low_s32(t23.val[1])),
+    vcombine_s32(vget_high_s32(t01.val[0]), vget_high_s32(t23.val[0])),
+    vcombine_s32(vget_high_s32(t01.val[1]), vget_high_s32(t23.val[1]))
+  };
+  HadamardButterfliesNeon<4>(cols, 1);
+  int32x4_t sum01 = vaddq_s32(vabsq_s32(cols[0]), vabsq_s32(cols[1]));
+  int32x4_t sum23 = vaddq_s32(vabsq_s32(cols[2]), vabsq_s32(cols[3]));
+  return vaddq_s32(sum01, sum23);
+}
+
+template<int W, int H, typename SampleT1>
+static uint64_t ComputeSatdNeon(int width, int height, int offset,
+                                const SampleT1 *src1, ptrdiff_t stride1,
+                                const Sample *src2, ptrdiff_t stride2) {
+  const int kBlocksX = W / 4;
+  const int kBlocksY = H / 4;
+  const int32x4_t voffset = vdupq_n_s32(offset);
+  uint64_t sum = 0;
+  for (int y = 0; y < height; y += H) {
+    for (int x = 0; x < width; x += W) {
+      // blocks[by][bx][row]
+      int32x4_t blocks[kBlocksY][kBlocksX][4];
+      for (int by = 0; by < kBlocksY; by++) {
+        for (int bx = 0; bx < kBlocksX; bx++) {
+          for (int i = 0; i < 4; i++) {
+            const ptrdiff_t row = by * 4 + i;
+            int32x4_t diff =
+              vsubq_s32(Load4Epi32Neon(src1 + row * stride1 + x + bx * 4),
+                        Load4Epi32Neon(src2 + row * stride2 + x + bx * 4));
+            blocks[by][bx][i] = vsubq_s32(diff, voffset);
+          }
+        }
+      }
+      for (int i = 0; i < 4; i++) {
+        for (int by = 0; by < kBlocksY; by++) {
+          HadamardButterfliesNeon<kBlocksX>(&blocks[by][0][i], 4);
+        }
+        for (int bx = 0; bx < kBlocksX; bx++) {
+          HadamardButterfliesNeon<kBlocksY>(&blocks[0][bx][i], 4 * kBlocksX);
+        }
+      }
+      int32x4_t abs_sum = vdupq_n_s32(0);
+      for (int by = 0; by < kBlocksY; by++) {
+        for (int bx = 0; bx < kBlocksX; bx++) {
+          abs_sum = vaddq_s32(abs_sum, Hadamard4x4AbsNeon(blocks[by][bx]));
+        }
+      }
+      int64x2_t abs_sum64 = vpaddlq_s32(abs_sum);
+      const int tile_sum = static_cast<int>(vgetq_lane_s64(abs_sum64, 0) +
+                                            vgetq_lane_s64(abs_sum64, 1));
+      sum += SampleMetric::NormalizeSatd<W, H>(tile_sum);
+    }
+    src1 += stride1 * H;
+    src2 += stride2 * H;
+  }
+  return sum;
+}
+#endif  // XVC_HAVE_NEON
+
 #ifdef XVC_ARCH_X86
 void SampleMetricSimd::Register(const std::set<CpuCapability> &caps,
                                 int internal_bitdepth,
                                 xvc::EncoderSimdFunctions *simd_functions) {
-#if XVC_HIGH_BITDEPTH
   SampleMetric::SimdFunc &sm = simd_functions->sample_metric;
+  if (caps.find(CpuCapability::kSse4_1) != caps.end()) {
+    sm.satd_sample_sample[0][0] = &ComputeSatd_sse4<4, 4, Sample>;     // 4x4
+    sm.satd_sample_sample[1][0] = &ComputeSatd_sse4<8, 4, Sample>;     // 8x4
+    sm.satd_sample_sample[0][1] = &ComputeSatd_sse4<4, 8, Sample>;     // 4x8
+    sm.satd_sample_sample[1][1] = &ComputeSatd_sse4<8, 8, Sample>;     // 8x8
+    sm.satd_sample_sample[2][1] = &ComputeSatd_sse4<16, 8, Sample>;    // 16x8
+    sm.satd_sample_sample[1][2] = &ComputeSatd_sse4<8, 16, Sample>;    // 8x16
+    sm.satd_short_sample[0][0] = &ComputeSatd_sse4<4, 4, int16_t>;     // 4x4
+    sm.satd_short_sample[1][0] = &ComputeSatd_sse4<8, 4, int16_t>;     // 8x4
+    sm.satd_short_sample[0][1] = &ComputeSatd_sse4<4, 8, int16_t>;     // 4x8
+    sm.satd_short_sample[1][1] = &ComputeSatd_sse4<8, 8, int16_t>;     // 8x8
+    sm.satd_short_sample[2][1] = &ComputeSatd_sse4<16, 8, int16_t>;    // 16x8
+    sm.satd_short_sample[1][2] = &ComputeSatd_sse4<8, 16, int16_t>;    // 8x16
+  }
+#if USE_AVX2
+  if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    sm.satd_sample_sample[1][0] = &ComputeSatd_avx2<8, 4, Sample>;     // 8x4
+    sm.satd_sample_sample[1][1] = &ComputeSatd_avx2<8, 8, Sample>;     // 8x8
+    sm.satd_sample_sample[2][1] = &ComputeSatd_avx2<16, 8, Sample>;    // 16x8
+    sm.satd_sample_sample[1][2] = &ComputeSatd_avx2<8, 16, Sample>;    // 8x16
+    sm.satd_short_sample[1][0] = &ComputeSatd_avx2<8, 4, int16_t>;     // 8x4
+    sm.satd_short_sample[1][1] = &ComputeSatd_avx2<8, 8, int16_t>;     // 8x8
+    sm.satd_short_sample[2][1] = &ComputeSatd_avx2<16, 8, int16_t>;    // 16x8
+    sm.satd_short_sample[1][2] = &ComputeSatd_avx2<8, 16, int16_t>;    // 8x16
+  }
+#endif  // USE_AVX2
+#if XVC_HIGH_BITDEPTH
   // TODO(PH) Check for 16-bit samples and bitdepth <= 12
   if (caps.find(CpuCapability::kSse2) != caps.end()) {
     sm.sad_sample_sample[3] = &ComputeSad_8x2_sse2<Sample>;   // 8
@@ -245,12 +743,29 @@ void SampleMetricSimd::Register(const std::set<CpuCapability> &caps,
   }
 #if USE_AVX2
   if (caps.find(CpuCapability::kAvx2) != caps.end()) {
+    sm.sad_sample_sample[2] = &ComputeSad_4x4_avx2<Sample>;    // 4
+    sm.sad_sample_sample[3] = &ComputeSad_8x2_avx2<Sample>;    // 8
     sm.sad_sample_sample[4] = &ComputeSad_16x2_avx2<Sample>;   // 16
     sm.sad_sample_sample[5] = &ComputeSad_16x2_avx2<Sample>;   // 32
     sm.sad_sample_sample[6] = &ComputeSad_16x2_avx2<Sample>;   // 64
+    sm.sad_short_sample[2] = &ComputeSad_4x4_avx2<int16_t>;    // 4
+    sm.sad_short_sample[3] = &ComputeSad_8x2_avx2<int16_t>;    // 8
+    sm.sad_short_sample[4] = &ComputeSad_16x2_avx2<int16_t>;   // 16
+    sm.sad_short_sample[5] = &ComputeSad_16x2_avx2<int16_t>;   // 32
+    sm.sad_short_sample[6] = &ComputeSad_16x2_avx2<int16_t>;   // 64
+
+    sm.ssd_sample_sample[2] = &ComputeSsd_4x4_avx2<Sample, Sample>;    // 4
+    sm.ssd_sample_sample[3] = &ComputeSsd_8x2_avx2<Sample, Sample>;    // 8
     sm.ssd_sample_sample[4] = &ComputeSsd_16x2_avx2<Sample, Sample>;   // 16
     sm.ssd_sample_sample[5] = &ComputeSsd_16x2_avx2<Sample, Sample>;   // 32
     sm.ssd_sample_sample[6] = &ComputeSsd_16x2_avx2<Sample, Sample>;   // 64
+    sm.ssd_short_sample[2] = &ComputeSsd_4x4_avx2<int16_t, Sample>;    // 4
+    sm.ssd_short_sample[3] = &ComputeSsd_8x2_avx2<int16_t, Sample>;    // 8
+    sm.ssd_short_sample[4] = &ComputeSsd_16x2_avx2<int16_t, Sample>;   // 16
+    sm.ssd_short_sample[5] = &ComputeSsd_16x2_avx2<int16_t, Sample>;   // 32
+    sm.ssd_short_sample[6] = &ComputeSsd_16x2_avx2<int16_t, Sample>;   // 64
+    sm.ssd_short_short[2] = &ComputeSsd_4x4_avx2<int16_t, int16_t>;    // 4
+    sm.ssd_short_short[3] = &ComputeSsd_8x2_avx2<int16_t, int16_t>;    // 8
     sm.ssd_short_short[4] = &ComputeSsd_16x2_avx2<int16_t, int16_t>;   // 16
     sm.ssd_short_short[5] = &ComputeSsd_16x2_avx2<int16_t, int16_t>;   // 32
     sm.ssd_short_short[6] = &ComputeSsd_16x2_avx2<int16_t, int16_t>;   // 64
@@ -265,6 +780,21 @@ void SampleMetricSimd::Register(const std::set<CpuCapability> &caps,
                                 int internal_bitdepth,
                                 xvc::EncoderSimdFunctions *simd_functions) {
 #ifdef XVC_HAVE_NEON
+  if (caps.find(CpuCapability::kNeon) != caps.end()) {
+    SampleMetric::SimdFunc &sm = simd_functions->sample_metric;
+    sm.satd_sample_sample[0][0] = &ComputeSatdNeon<4, 4, Sample>;     // 4x4
+    sm.satd_sample_sample[1][0] = &ComputeSatdNeon<8, 4, Sample>;     // 8x4
+    sm.satd_sample_sample[0][1] = &ComputeSatdNeon<4, 8, Sample>;     // 4x8
+    sm.satd_sample_sample[1][1] = &ComputeSatdNeon<8, 8, Sample>;     // 8x8
+    sm.satd_sample_sample[2][1] = &ComputeSatdNeon<16, 8, Sample>;    // 16x8
+    sm.satd_sample_sample[1][2] = &ComputeSatdNeon<8, 16, Sample>;    // 8x16
+    sm.satd_short_sample[0][0] = &ComputeSatdNeon<4, 4, int16_t>;     // 4x4
+    sm.satd_short_sample[1][0] = &ComputeSatdNeon<8, 4, int16_t>;     // 8x4
+    sm.satd_short_sample[0][1] = &ComputeSatdNeon<4, 8, int16_t>;     // 4x8
+    sm.satd_short_sample[1][1] = &ComputeSatdNeon<8, 8, int16_t>;     // 8x8
+    sm.satd_short_sample[2][1] = &ComputeSatdNeon<16, 8, int16_t>;    // 16x8
+    sm.satd_short_sample[1][2] = &ComputeSatdNeon<8, 16, int16_t>;    // 8x16
+  }
 #endif  // XVC_HAVE_NEON
 }
 #endif  // XVC_ARCH_ARM
@@ -49,6 +49,14 @@ void SyntaxWriter::Finish() {
   encoder_.Finish();
 }
 
+void SyntaxWriter::SetBinRecorder(std::vector<uint32_t> *bins) {
+  encoder_.SetBinRecorder(bins, reinterpret_cast<const ContextModel*>(&ctx_));
+}
+
+void SyntaxWriter::WriteRecordedBins(const std::vector<uint32_t> &bins) {
+  encoder_.WriteRecordedBins(bins, reinterpret_cast<ContextModel*>(&ctx_));
+}
+
 void SyntaxWriter::WriteAffineFlag(const CodingUnit &cu, bool is_merge,
                                    bool use_affine) {
   if (Restrictions::Get().disable_ext2_inter_affine ||
@@ -22,6 +22,8 @@
 #ifndef XVC_ENC_LIB_SYNTAX_WRITER_H_
 #define XVC_ENC_LIB_SYNTAX_WRITER_H_
 
+#include <vector>
+
 #include "xvc_common_lib/cabac.h"
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/intra_prediction.h"
@@ -48,6 +50,8 @@ public:
   }
   void ResetBitCounting() { encoder_.ResetBitCounting(); }
   void Finish();
+  void SetBinRecorder(std::vector<uint32_t> *bins);
+  void WriteRecordedBins(const std::vector<uint32_t> &bins);
 
   void WriteAffineFlag(const CodingUnit &cu, bool is_merge, bool use_affine);
   void WriteCbf(const CodingUnit &cu, YuvComponent comp, bool cbf);
@@ -22,14 +22,19 @@
 #include "xvc_enc_lib/thread_encoder.h"
 
 #include <algorithm>
+#include <utility>
+
+#include "xvc_enc_lib/cu_encoder.h"
 
 namespace xvc {
 
 static const int kMaxNumThreads = 64;
 
 ThreadEncoder::ThreadEncoder(int num_threads,
-                             const EncoderSettings &encoder_settings)
-  : encoder_settings_(encoder_settings) {
+                             const EncoderSettings &encoder_settings,
+                             BitstreamCallback bitstream_callback)
+  : encoder_settings_(encoder_settings),
+  bitstream_callback_(std::move(bitstream_callback)) {
   if (num_threads < 0) {
     num_threads = std::thread::hardware_concurrency();
   }
@@ -47,22 +52,32 @@ ThreadEncoder::~ThreadEncoder() {
 }
 
 void ThreadEncoder::StopAll() {
-  std::unique_lock<std::mutex> lock(global_mutex_);
-  running_ = false;
-  wait_work_cond_.notify_all();  // wakeup all
-  lock.unlock();
+  scheduler_.Stop();
   for (auto &thread : worker_threads_) {
     thread.join();
   }
   worker_threads_.clear();
 }
 
+WorkScheduler::JobId ThreadEncoder::RunAsync(std::function<void()> task) {
+  std::unique_ptr<std::function<void()>> pending_task(
+    new std::function<void()>(std::move(task)));
+  const WorkScheduler::JobId job = pending_task.get();
+  {
+    std::lock_guard<std::mutex> lock(work_mutex_);
+    pending_tasks_[job] = std::move(pending_task);
+  }
+  // Lower priority value than any picture
+  scheduler_.Add(job, {}, -1);
+  return job;
+}
+
 void ThreadEncoder::EncodeAsync(
   std::shared_ptr<SegmentHeader> segment_header,
   std::shared_ptr<PictureEncoder> pic_enc,
   const std::vector<std::shared_ptr<const PictureEncoder>> &deps,
   std::unique_ptr<std::vector<uint8_t>> &&output_nal_buffer,
-  int segment_qp, bool buffer_flag) {
+  int segment_qp, bool buffer_flag, WorkScheduler::JobId task_dependency) {
   // Prepare work for thread
   WorkItem work;
   work.pic_enc = std::move(pic_enc);
@@ -72,10 +87,22 @@ void ThreadEncoder::EncodeAsync(
   work.segment_qp = segment_qp;
   work.buffer_flag = buffer_flag;
 
-  // Signal one worker thread to begin processing
-  std::unique_lock<std::mutex> lock(global_mutex_);
-  pending_work_.push_back(std::move(work));
-  wait_work_cond_.notify_one();
+  // A picture can be encoded once all its reference pictures are finished,
+  // lower temporal layers are prioritized since more pictures depend on them
+  const WorkScheduler::JobId job = work.pic_enc.get();
+  std::vector<WorkScheduler::JobId> job_dependencies;
+  for (auto &dependency : work.pic_dependencies) {
+    job_dependencies.push_back(dependency.get());
+  }
+  if (task_dependency) {
+    job_dependencies.push_back(task_dependency);
+  }
+  const int priority = work.pic_enc->GetTid();
+  {
+    std::lock_guard<std::mutex> lock(work_mutex_);
+    pending_work_[job] = std::move(work);
+  }
+  scheduler_.Add(job, job_dependencies, priority);
 }
 
 void ThreadEncoder::WaitForPicture(const std::shared_ptr<PictureEncoder> &pic,
@@ -86,52 +113,45 @@ void ThreadEncoder::WaitForPicture(const std::shared_ptr<PictureEncoder> &pic,
 }
 
 void ThreadEncoder::WaitOne(PictureDecodedCallback callback) {
-  std::unique_lock<std::mutex> lock(global_mutex_);
+  std::unique_lock<std::mutex> lock(work_mutex_);
   work_done_cond_.wait(lock, [this] { return !finished_work_.empty(); });
   WorkItem work = std::move(finished_work_.front());
   finished_work_.pop_front();
   // Note! Callback invoked while lock is being held
-  callback(work.pic_enc, work.pic_dependencies, std::move(work.nal_buffer));
+  callback(work.pic_enc, work.pic_dependencies);
 }
 
 void ThreadEncoder::WorkerMain(int thread_idx) {
   bool restrictions_loaded = false;
+  // Coding unit encoder buffers are allocated once and reused for all
+  // pictures encoded by this thread
+  std::unique_ptr<CuEncoder> cu_encoder;
 
-  std::unique_lock<std::mutex> lock(global_mutex_);
   while (true) {
+    WorkScheduler::JobId job = scheduler_.Take();
+    if (!job) {
+      break;
+    }
     ThreadEncoder::WorkItem work;
-    // Find one picture that can be decoded now
-    while (running_) {
-      // Verify all dependencies are satisfied before taking work
-      auto best_it = pending_work_.end();
-      for (auto it = pending_work_.begin(); it != pending_work_.end(); ++it) {
-        bool valid = true;
-        for (auto &dependency : it->pic_dependencies) {
-          if (dependency->GetOutputStatus() == OutputStatus::kProcessing ||
-              dependency->GetOutputStatus() == OutputStatus::kReady) {
-            valid = false;
-            break;
-          }
-        }
-        if (!valid) {
-          continue;
-        }
-        if (best_it == pending_work_.end() ||
-            it->pic_enc->GetTid() < best_it->pic_enc->GetTid()) {
-          best_it = it;
-        }
-      }
-      if (best_it != pending_work_.end()) {
-        work = std::move(*best_it);
-        pending_work_.erase(best_it);
-        break;
+    std::unique_ptr<std::function<void()>> task;
+    {
+      std::lock_guard<std::mutex> lock(work_mutex_);
+      auto task_it = pending_tasks_.find(job);
+      if (task_it != pending_tasks_.end()) {
+        task = std::move(task_it->second);
+        pending_tasks_.erase(task_it);
+      } else {
+        auto it = pending_work_.find(job);
+        work = std::move(it->second);
+        pending_work_.erase(it);
       }
-      wait_work_cond_.wait(lock);
     }
-    if (!running_) {
-      break;
+    if (task) {
+      // Task is destroyed after release so its job id is not reused before
+      (*task)();
+      scheduler_.Release(job);
+      continue;
     }
-    lock.unlock();
 
     if (!restrictions_loaded) {
       // The assumption is that restrictions never change during encoding
@@ -140,17 +160,22 @@ void ThreadEncoder::WorkerMain(int thread_idx) {
     }
 
     // Encode picture
-    const std::vector<uint8_t> *pic_bytes =
+    std::vector<uint8_t> *pic_bytes =
       work.pic_enc->Encode(*work.segment_header, work.segment_qp,
-                           work.buffer_flag, encoder_settings_);
-    *work.nal_buffer = *pic_bytes;
+                           work.buffer_flag, encoder_settings_,
+                           work.pic_dependencies, &cu_encoder);
+    work.nal_buffer->swap(*pic_bytes);
     work.pic_enc->SetOutputStatus(OutputStatus::kFinishedProcessing);
 
-    lock.lock();
-    // Notify all workers that a dependency might be ready
-    wait_work_cond_.notify_all();
+    // Only pictures referencing this picture are woken up
+    scheduler_.Release(job);
+
+    // The bitstream is output directly instead of waiting for the main thread
+    bitstream_callback_(std::move(work.segment_header), *work.pic_enc,
+                        std::move(work.nal_buffer));
+
     // Notify main thread picture that picture is fully decoded
-    // TODO(PH) some fields are not needed anymore (like nal)
+    std::lock_guard<std::mutex> lock(work_mutex_);
     finished_work_.push_back(std::move(work));
     work_done_cond_.notify_all();
   }
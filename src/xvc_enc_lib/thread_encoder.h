@@ -26,13 +26,14 @@
 #include <condition_variable>   // NOLINT
 #include <deque>
 #include <functional>
-#include <list>
 #include <memory>
 #include <mutex>                // NOLINT
 #include <thread>               // NOLINT
+#include <unordered_map>
 #include <vector>
 
 #include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/work_scheduler.h"
 #include "xvc_enc_lib/encoder_settings.h"
 #include "xvc_enc_lib/picture_encoder.h"
 
@@ -42,18 +43,27 @@ class ThreadEncoder {
 public:
   using PicEncList = std::vector<std::shared_ptr<const PictureEncoder>>;
   using PictureDecodedCallback =
-    std::function<void(std::shared_ptr<PictureEncoder>, const PicEncList &,
-                       std::unique_ptr<std::vector<uint8_t>> pic_nal)>;
+    std::function<void(std::shared_ptr<PictureEncoder>, const PicEncList &)>;
+  // Invoked from the worker thread as soon as a picture has been encoded
+  using BitstreamCallback =
+    std::function<void(std::shared_ptr<const SegmentHeader>,
+                       const PictureEncoder &,
+                       std::unique_ptr<std::vector<uint8_t>> &&pic_nal)>;
 
-  ThreadEncoder(int num_threads, const EncoderSettings &encoder_settings);
+  ThreadEncoder(int num_threads, const EncoderSettings &encoder_settings,
+                BitstreamCallback bitstream_callback);
   ~ThreadEncoder();
   size_t GetNumThreads() const { return worker_threads_.size(); }
   void StopAll();
+  // Runs a task on a worker thread ahead of any picture, the returned job
+  // can be given as dependency when encoding pictures
+  WorkScheduler::JobId RunAsync(std::function<void()> task);
   void EncodeAsync(std::shared_ptr<SegmentHeader> segment_header,
                    std::shared_ptr<PictureEncoder> pic_enc,
                    const std::vector<std::shared_ptr<const PictureEncoder>> &,
                    std::unique_ptr<std::vector<uint8_t>> &&output_nal_buffer,
-                   int segment_qp, bool buffer_flag);
+                   int segment_qp, bool buffer_flag,
+                   WorkScheduler::JobId task_dependency = nullptr);
   void WaitForPicture(const std::shared_ptr<PictureEncoder> &pic,
                       PictureDecodedCallback callback);
   void WaitOne(PictureDecodedCallback callback);
@@ -71,13 +81,17 @@ private:
   void WorkerMain(int thread_idx);
 
   const EncoderSettings &encoder_settings_;
+  const BitstreamCallback bitstream_callback_;
   std::vector<std::thread> worker_threads_;
-  std::mutex global_mutex_;
-  std::condition_variable wait_work_cond_;
+  WorkScheduler scheduler_;
+  // Only guards handing over work items, scheduling is done without it
+  std::mutex work_mutex_;
   std::condition_variable work_done_cond_;
-  std::list<WorkItem> pending_work_;
+  std::unordered_map<WorkScheduler::JobId, WorkItem> pending_work_;
+  // The address of a task is its job id
+  std::unordered_map<WorkScheduler::JobId,
+                     std::unique_ptr<std::function<void()>>> pending_tasks_;
   std::deque<WorkItem> finished_work_;
-  bool running_ = true;
 };
 
 }   // namespace xvc
@@ -24,6 +24,7 @@
 #include <limits>
 
 #include "xvc_common_lib/restrictions.h"
+#include "xvc_enc_lib/rate_estimator.h"
 
 namespace xvc {
 
@@ -38,10 +39,10 @@ TransformEncoder::TransformEncoder(const EncoderSimdFunctions &simd,
   cu_metric_(simd.sample_metric, bitdepth, encoder_settings_.structural_ssd ?
              MetricType::kStructuralSsd : MetricType::kSsd,
              encoder_settings_.structural_strength),
-  inv_transform_(bitdepth),
-  fwd_transform_(bitdepth),
-  inv_quant_(),
-  fwd_quant_(bitdepth, encoder_settings),
+  inv_transform_(simd.inv_transform, bitdepth),
+  fwd_transform_(simd.fwd_transform, bitdepth),
+  inv_quant_(simd.quantize),
+  fwd_quant_(simd.quantize, bitdepth, encoder_settings),
   temp_pred_({ { { constants::kMaxBlockSize, constants::kMaxBlockSize },
   { constants::kMaxBlockSize, constants::kMaxBlockSize },
   { constants::kMaxBlockSize, constants::kMaxBlockSize } } }),
@@ -75,14 +76,21 @@ TransformEncoder::CompressAndEvalTransform(CodingUnit *cu, YuvComponent comp,
       dist_resi = cu_metric_.CompareShort(qp, comp, width, height,
                                           temp_resi_orig_, temp_resi_);
     }
-    RdoSyntaxWriter rdo_writer(writer, 0);
+    Bits bits;
     if (cu->IsIntra() && util::IsLuma(comp)) {
       // TODO(PH) Consider remove this case (intra mode signaling is same)
+      RdoSyntaxWriter rdo_writer(writer, 0);
       cu_writer->WriteComponent(*cu, comp, &rdo_writer);
+      bits = rdo_writer.GetNumWrittenBits();
+    } else if (encoder_settings_.fast_rate_estimation) {
+      RateEstimator rate_estimator(writer);
+      rate_estimator.EstimateResidualDataRdoCbf(*cu, comp);
+      bits = rate_estimator.GetNumBits();
     } else {
+      RdoSyntaxWriter rdo_writer(writer, 0);
       cu_writer->WriteResidualDataRdoCbf(*cu, comp, &rdo_writer);
+      bits = rdo_writer.GetNumWrittenBits();
     }
-    Bits bits = rdo_writer.GetNumWrittenBits();
     Cost cost = dist_resi + static_cast<Cost>(bits * qp.GetLambda() + 0.5);
     return RdCost{ cost, dist, dist_resi };
   };
@@ -119,9 +127,11 @@ TransformEncoder::CompressAndEvalTransform(CodingUnit *cu, YuvComponent comp,
       *out_dist_zero = dist_zero;
     }
     if (cu->GetCbf(comp)) {
-      RdoSyntaxWriter zero_writer(writer, 0);
+      Bits bits_zero;
       if (!Restrictions::Get().disable_transform_cbf) {
-        zero_writer.WriteCbf(*cu, comp, false);
+        RateEstimator rate_estimator(writer);
+        rate_estimator.EstimateCbf(comp, false);
+        bits_zero = rate_estimator.GetNumBits();
       } else {
         // Slow method, perform full coeff writing of zero coefficients
         if (best_is_applied) {
@@ -131,9 +141,10 @@ TransformEncoder::CompressAndEvalTransform(CodingUnit *cu, YuvComponent comp,
         cu->SetRootCbf(true);
         cu->ClearCbf(comp);
         ReconstructZeroCbf(cu, comp, orig_pic, rec_pic);
+        RdoSyntaxWriter zero_writer(writer, 0);
         cu_writer->WriteResidualDataRdoCbf(*cu, comp, &zero_writer);
+        bits_zero = zero_writer.GetNumWrittenBits();
       }
-      Bits bits_zero = zero_writer.GetNumWrittenBits();
       Cost cost = dist_zero +
         static_cast<Cost>(bits_zero * qp.GetLambda() + 0.5);
       if (cost < best_cost.cost) {
@@ -287,6 +298,13 @@ TransformEncoder::TransformAndReconstruct(CodingUnit *cu, YuvComponent comp,
 Bits TransformEncoder::GetCuBitsResidual(const CodingUnit &cu,
                                          const SyntaxWriter &bitstream_writer,
                                          CuWriter *cu_writer) {
+  if (encoder_settings_.fast_rate_estimation) {
+    RateEstimator rate_estimator(bitstream_writer);
+    for (int c = 0; c < num_components_; c++) {
+      rate_estimator.EstimateResidualDataRdoCbf(cu, YuvComponent(c));
+    }
+    return rate_estimator.GetNumBits();
+  }
   RdoSyntaxWriter rdo_writer(bitstream_writer, 0);
   for (int c = 0; c < num_components_; c++) {
     const YuvComponent comp = YuvComponent(c);
@@ -84,6 +84,10 @@ extern "C" {
     param->threads = 0;
     param->simd_mask = static_cast<uint32_t>(-1);
     param->explicit_encoder_settings = nullptr;
+    param->rate_control_mode = 0;
+    param->bitrate = 0;
+    param->vbv_max_bitrate = 0;
+    param->vbv_buffer_size = 0;
     return XVC_ENC_OK;
   }
 
@@ -214,6 +218,14 @@ extern "C" {
         param->tune_mode >= static_cast<int>(xvc::TuneMode::kTotalNumber)) {
       return XVC_ENC_INVALID_PARAMETER;
     }
+    if (param->rate_control_mode < 0 ||
+        param->rate_control_mode >=
+        static_cast<int>(xvc::RateControlMode::kTotalNumber)) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
+    if (param->rate_control_mode > 0 && param->bitrate == 0) {
+      return XVC_ENC_INVALID_PARAMETER;
+    }
     return XVC_ENC_OK;
   }
 
@@ -333,6 +345,12 @@ extern "C" {
       }
     }
     encoder->SetQp(param->qp);
+    xvc::RateControl::Settings rate_control;
+    rate_control.mode = xvc::RateControlMode(param->rate_control_mode);
+    rate_control.bitrate = 1000.0 * param->bitrate;
+    rate_control.vbv_max_bitrate = 1000.0 * param->vbv_max_bitrate;
+    rate_control.vbv_buffer_size = 1000.0 * param->vbv_buffer_size;
+    encoder->SetRateControl(rate_control);
     encoder->SetLowDelay(param->low_delay != 0);
     if (param->num_ref_pics >= 0) {
       encoder->SetNumRefPics(param->num_ref_pics);
@@ -425,6 +443,40 @@ extern "C" {
     return success ? XVC_ENC_OK : XVC_ENC_NO_MORE_OUTPUT;
   }
 
+  static xvc_enc_return_code
+    xvc_enc_encoder_encode3(xvc_encoder *encoder, const uint8_t *plane_bytes[3],
+                            int plane_stride[3],
+                            xvc_enc_nal_callback nal_callback, void *opaque,
+                            xvc_enc_pic_buffer *rec_pic, int64_t user_data) {
+    if (!encoder || !plane_bytes || !nal_callback) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc::Encoder::PicPlanes pic_planes = {
+      std::make_pair(plane_bytes[0], plane_stride[0]),
+      std::make_pair(plane_bytes[1], plane_stride[1]),
+      std::make_pair(plane_bytes[2], plane_stride[2])
+    };
+    xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    lib_encoder->SetNalCallback(nal_callback, opaque);
+    bool success = lib_encoder->Encode(pic_planes, rec_pic, user_data);
+    lib_encoder->SetNalCallback(nullptr, nullptr);
+    return success ? XVC_ENC_OK : XVC_ENC_INVALID_ARGUMENT;
+  }
+
+  static xvc_enc_return_code
+    xvc_enc_encoder_flush3(xvc_encoder *encoder,
+                           xvc_enc_nal_callback nal_callback, void *opaque,
+                           xvc_enc_pic_buffer *rec_pic) {
+    if (!encoder || !nal_callback) {
+      return XVC_ENC_INVALID_ARGUMENT;
+    }
+    xvc::Encoder *lib_encoder = reinterpret_cast<xvc::Encoder*>(encoder);
+    lib_encoder->SetNalCallback(nal_callback, opaque);
+    bool success = lib_encoder->Flush(rec_pic);
+    lib_encoder->SetNalCallback(nullptr, nullptr);
+    return success ? XVC_ENC_OK : XVC_ENC_NO_MORE_OUTPUT;
+  }
+
   static const char* xvc_enc_get_error_text(xvc_enc_return_code error_code) {
     switch (error_code) {
       case XVC_ENC_OK:
@@ -483,6 +535,8 @@ extern "C" {
     &xvc_enc_encoder_encode2,
     &xvc_enc_encoder_flush,
     &xvc_enc_get_error_text,
+    &xvc_enc_encoder_encode3,
+    &xvc_enc_encoder_flush3,
   };
 
   const xvc_encoder_api* xvc_encoder_api_get() {
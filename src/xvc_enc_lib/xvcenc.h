@@ -40,7 +40,7 @@ extern "C" {
 #define XVC_ENC_API
 #endif
 
-#define XVC_ENC_API_VERSION   1
+#define XVC_ENC_API_VERSION   2
 
   typedef enum {
     XVC_ENC_OK = 0,
@@ -102,6 +102,11 @@ extern "C" {
     int64_t user_data;
   } xvc_enc_nal_unit;
 
+  // Invoked for each nal unit in bitstream order as soon as it is available
+  // The nal unit and its bytes are only valid during the callback
+  typedef void(*xvc_enc_nal_callback)(void *opaque,
+                                      const xvc_enc_nal_unit *nal_unit);
+
   // Represents one reconstructed picture
   // Lifecycle managed by api->picture_create & api->picture_destroy
   typedef struct xvc_enc_pic_buffer {
@@ -146,6 +151,11 @@ extern "C" {
     int threads;
     uint32_t simd_mask;
     char* explicit_encoder_settings;
+    // 0: constant qp, 1: variable bitrate, 2: constant bitrate
+    int rate_control_mode;
+    uint32_t bitrate;          // kbit/s
+    uint32_t vbv_max_bitrate;  // kbit/s, 0 disables vbv for variable bitrate
+    uint32_t vbv_buffer_size;  // kbit
   } xvc_encoder_parameters;
 
   // xvc encoder api
@@ -184,6 +194,23 @@ extern "C" {
                                         xvc_enc_pic_buffer *rec_pic);
     // Misc
     const char*(*xvc_enc_get_error_text)(xvc_enc_return_code error_code);
+    // Same as encoder_encode2 and encoder_flush but nal units are delivered
+    // through nal_callback directly from the internal bitstream buffers.
+    // While the call is in progress nal_callback is invoked as soon as the
+    // next nal unit in bitstream order has been encoded, possibly from one of
+    // the encoding threads, but never concurrently. Nal units finished in
+    // between calls are delivered at the start of the next call.
+    xvc_enc_return_code(*encoder_encode3)(xvc_encoder *encoder,
+                                          const uint8_t *plane_bytes[3],
+                                          int plane_stride[3],
+                                          xvc_enc_nal_callback nal_callback,
+                                          void *opaque,
+                                          xvc_enc_pic_buffer *rec_pic,
+                                          int64_t user_data);
+    xvc_enc_return_code(*encoder_flush3)(xvc_encoder *encoder,
+                                         xvc_enc_nal_callback nal_callback,
+                                         void *opaque,
+                                         xvc_enc_pic_buffer *rec_pic);
   } xvc_encoder_api;
 
   // Starting point for using the xvc encoder api
@@ -0,0 +1,603 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+// Performance harness for the simd kernels and for whole picture encoding
+// and decoding. Each result is printed as one json object per line.
+
+#include <algorithm>
+#include <chrono>   // NOLINT
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xvc_common_lib/common.h"
+#include "xvc_common_lib/simd_cpu.h"
+#include "xvc_dec_lib/xvcdec.h"
+#include "xvc_enc_lib/encoder_simd_functions.h"
+#include "xvc_enc_lib/xvcenc.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+  bool kernels = true;
+  bool end_to_end = true;
+  double min_time = 0.05;
+  int width = 416;
+  int height = 240;
+  int frames = 16;
+  int sub_gop_length = 8;
+  int qp = 32;
+  std::vector<int> speed_modes = { 2 };
+  std::vector<int> threads = { 0, 4 };
+  std::string filter;
+};
+
+struct SimdTier {
+  std::string name;
+  std::set<xvc::CpuCapability> caps;
+};
+
+const char* GetCapabilityName(xvc::CpuCapability cap) {
+  switch (cap) {
+    case xvc::CpuCapability::kNeon: return "neon";
+    case xvc::CpuCapability::kMmx: return "mmx";
+    case xvc::CpuCapability::kSse: return "sse";
+    case xvc::CpuCapability::kSse2: return "sse2";
+    case xvc::CpuCapability::kSse3: return "sse3";
+    case xvc::CpuCapability::kSsse3: return "ssse3";
+    case xvc::CpuCapability::kSse4_1: return "sse4_1";
+    case xvc::CpuCapability::kSse4_2: return "sse4_2";
+    case xvc::CpuCapability::kAvx: return "avx";
+    case xvc::CpuCapability::kAvx2: return "avx2";
+    default: return "unknown";
+  }
+}
+
+// Plain c, each capability on its own (like a single bit simd_mask) and all
+std::vector<SimdTier> GetSimdTiers() {
+  const std::set<xvc::CpuCapability> all_caps =
+    xvc::SimdCpu::GetRuntimeCapabilities();
+  std::vector<SimdTier> tiers;
+  tiers.push_back({ "c", {} });
+  for (xvc::CpuCapability cap : all_caps) {
+    tiers.push_back({ GetCapabilityName(cap), { cap } });
+  }
+  if (all_caps.size() > 1) {
+    tiers.push_back({ "all", all_caps });
+  }
+  return tiers;
+}
+
+void PrintResult(const std::vector<std::pair<std::string, std::string>> &kv) {
+  std::cout << "{";
+  for (size_t i = 0; i < kv.size(); i++) {
+    std::cout << (i ? ", " : "") << "\"" << kv[i].first << "\": "
+      << kv[i].second;
+  }
+  std::cout << "}" << std::endl;
+}
+
+std::string Quote(const std::string &str) {
+  return "\"" + str + "\"";
+}
+
+template<typename T>
+std::string ToString(T val) {
+  std::ostringstream ss;
+  ss << val;
+  return ss.str();
+}
+
+// Calls fn repeatedly for at least min_time seconds, returns ns per call
+template<typename Fn>
+double MeasureNsPerCall(double min_time, Fn fn) {
+  const int kBatchSize = 64;
+  int64_t num_calls = 0;
+  const Clock::time_point start = Clock::now();
+  double elapsed = 0;
+  do {
+    for (int i = 0; i < kBatchSize; i++) {
+      fn();
+    }
+    num_calls += kBatchSize;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (elapsed < min_time);
+  return 1e9 * elapsed / num_calls;
+}
+
+// Synthetic content with smooth gradients, block edges and some texture
+int SyntheticSample(int x, int y, int bitdepth) {
+  const int gradient = (x * 3 + y * 5) / 4;
+  const int edge = ((x / 16 + y / 16) & 1) ? 48 : 0;
+  const int texture = ((x * 7919 + y * 104729) >> 3) & 15;
+  return ((gradient + edge + texture) & 255) << (bitdepth - 8);
+}
+
+class KernelBench {
+public:
+  static const int kBufferSize = 2 * xvc::constants::kMaxBlockSize;
+  static const ptrdiff_t kStride = kBufferSize;
+
+  KernelBench(const BenchOptions &options, const SimdTier &tier)
+    : options_(options),
+    tier_(tier),
+    bitdepth_(sizeof(xvc::Sample) == 1 ? 8 : 10),
+    simd_(tier.caps, bitdepth_),
+    src_(kBufferSize * kBufferSize),
+    src2_(kBufferSize * kBufferSize),
+    dst_(kBufferSize * kBufferSize),
+    short_src_(kBufferSize * kBufferSize),
+    short_dst_(kBufferSize * kBufferSize),
+    coeff_src_(kBufferSize * kBufferSize),
+    coeff_dst_(kBufferSize * kBufferSize) {
+    for (int y = 0; y < kBufferSize; y++) {
+      for (int x = 0; x < kBufferSize; x++) {
+        src_[y * kStride + x] =
+          static_cast<xvc::Sample>(SyntheticSample(x, y, bitdepth_));
+        src2_[y * kStride + x] = static_cast<xvc::Sample>(
+          SyntheticSample(kBufferSize - 1 - x, y + 3, bitdepth_));
+      }
+    }
+    for (size_t i = 0; i < src_.size(); i++) {
+      short_src_[i] = static_cast<int16_t>(src_[i] << 4);
+      coeff_src_[i] = static_cast<xvc::Coeff>((i * 7919) % 512) - 256;
+    }
+  }
+
+  void Run() {
+    RunSampleMetric();
+    RunInterPrediction();
+    RunIntraPrediction();
+    RunTransform();
+    RunDeblocking();
+  }
+
+private:
+  template<typename Fn>
+  void Measure(const std::string &kernel, int width, int height, Fn fn) {
+    if (!options_.filter.empty() &&
+        kernel.find(options_.filter) == std::string::npos) {
+      return;
+    }
+    double ns = MeasureNsPerCall(options_.min_time, fn);
+    PrintResult({
+      { "type", Quote("kernel") },
+      { "kernel", Quote(kernel) },
+      { "simd", Quote(tier_.name) },
+      { "width", ToString(width) },
+      { "height", ToString(height) },
+      { "ns_per_call", ToString(ns) },
+      { "samples_per_ns", ToString(width * height / ns) },
+    });
+  }
+
+  void RunSampleMetric() {
+    const xvc::SampleMetric::SimdFunc &metric = simd_.sample_metric;
+    for (int log2size = 2; log2size <= xvc::constants::kCtuSizeLog2;
+         log2size++) {
+      const int size = 1 << log2size;
+      Measure("sad_sample_sample", size, size, [&]() {
+        sink_ += metric.sad_sample_sample[log2size](
+          size, size, &src_[0], kStride, &src2_[0], kStride);
+      });
+      Measure("sad_short_sample", size, size, [&]() {
+        sink_ += metric.sad_short_sample[log2size](
+          size, size, &short_src_[0], kStride, &src2_[0], kStride);
+      });
+      Measure("ssd_sample_sample", size, size, [&]() {
+        sink_ += static_cast<int>(metric.ssd_sample_sample[log2size](
+          size, size, &src_[0], kStride, &src2_[0], kStride));
+      });
+      Measure("ssd_short_sample", size, size, [&]() {
+        sink_ += static_cast<int>(metric.ssd_short_sample[log2size](
+          size, size, &short_src_[0], kStride, &src2_[0], kStride));
+      });
+    }
+  }
+
+  void RunInterPrediction() {
+    static const int16_t kLumaFilter[8] = { -1, 4, -11, 40, 40, -11, 4, -1 };
+    static const int16_t kChromaFilter[4] = { -4, 36, 36, -4 };
+    const xvc::InterPrediction::SimdFunc &inter = simd_.inter_prediction;
+    const xvc::Sample *src = &src_[8 * kStride + 8];
+    const int16_t *short_src = &short_src_[8 * kStride + 8];
+    for (int size = 8; size <= xvc::constants::kMaxBlockSize; size *= 2) {
+      for (int lc = 0; lc < xvc::InterPrediction::SimdFunc::kLC; lc++) {
+        const int16_t *filter = lc == 0 ? kLumaFilter : kChromaFilter;
+        const int w = lc == 0 ? size : size / 2;
+        const std::string suffix = lc == 0 ? "_luma" : "_chroma";
+        Measure("filter_h_sample_sample" + suffix, w, w, [&]() {
+          inter.filter_h_sample_sample[lc](w, w, bitdepth_, filter, src,
+                                           kStride, &dst_[0], kStride);
+        });
+        Measure("filter_h_sample_short" + suffix, w, w, [&]() {
+          inter.filter_h_sample_short[lc](w, w, bitdepth_, filter, src,
+                                          kStride, &short_dst_[0], kStride);
+        });
+        Measure("filter_v_sample_sample" + suffix, w, w, [&]() {
+          inter.filter_v_sample_sample[lc](w, w, bitdepth_, filter, src,
+                                           kStride, &dst_[0], kStride);
+        });
+        Measure("filter_v_short_sample" + suffix, w, w, [&]() {
+          inter.filter_v_short_sample[lc](w, w, bitdepth_, filter, short_src,
+                                          kStride, &dst_[0], kStride);
+        });
+        Measure("filter_v_short_short" + suffix, w, w, [&]() {
+          inter.filter_v_short_short[lc](w, w, bitdepth_, filter, short_src,
+                                         kStride, &short_dst_[0], kStride);
+        });
+      }
+      const int shift = 15 - bitdepth_;
+      Measure("filter_copy_bipred", size, size, [&]() {
+        inter.filter_copy_bipred[1](size, size, -8192, shift, src, kStride,
+                                    &short_dst_[0], kStride);
+      });
+      Measure("add_avg", size, size, [&]() {
+        inter.add_avg[1](size, size, 1 << shift, shift + 1, bitdepth_,
+                         short_src, kStride, &short_src_[0], kStride,
+                         &dst_[0], kStride);
+      });
+    }
+  }
+
+  void RunIntraPrediction() {
+    const xvc::IntraPrediction::SimdFunc &intra = simd_.intra_prediction;
+    const xvc::Sample *ref = &src_[0];
+    for (int size = 4; size <= xvc::constants::kMaxBlockSize; size *= 2) {
+      Measure("angular_pred", size, size, [&]() {
+        intra.angular_pred[1](size, size, 13, ref + 2 * size, &dst_[0],
+                              kStride);
+      });
+      Measure("planar_pred", size, size, [&]() {
+        intra.planar_pred[1](size, size, ref, kStride, &dst_[0], kStride);
+      });
+      Measure("filter_ref_samples", size, size, [&]() {
+        intra.filter_ref_samples(size, size, ref, &dst_[0], kStride);
+      });
+    }
+  }
+
+  void RunTransform() {
+    const xvc::InverseTransform::SimdFunc &inv = simd_.inv_transform;
+    const xvc::ForwardTransform::SimdFunc &fwd = simd_.fwd_transform;
+    for (int log2size = 2; log2size <= xvc::constants::kCtuSizeLog2;
+         log2size++) {
+      const int size = 1 << log2size;
+      const int idx = log2size - 1;
+      Measure("inv_dct2", size, size, [&]() {
+        inv.dct2[idx](7, size, false, false, &coeff_src_[0], kStride,
+                      &coeff_dst_[0], kStride);
+      });
+      Measure("fwd_dct2", size, size, [&]() {
+        fwd.dct2[idx](log2size - 1, size, false, false, &coeff_src_[0],
+                      kStride, &coeff_dst_[0], kStride);
+      });
+    }
+  }
+
+  void RunDeblocking() {
+    const xvc::DeblockingFilter::SimdFunc &deblock = simd_.deblocking_filter;
+    const int kNumEdges = 64;
+    const char *dir_name[2] = { "_ver", "_hor" };
+    for (int dir = 0; dir < 2; dir++) {
+      // Edges along one line of a picture, the filtered samples are reset
+      // from the source buffer between calls to keep data dependent paths
+      const ptrdiff_t edge_step = dir == 0 ? 8 * kStride : 8;
+      const int lines = xvc::DeblockingFilter::kFilterGroupSize;
+      Measure(std::string("filter_luma_weak") + dir_name[dir],
+              kNumEdges * lines, 8, [&]() {
+        std::copy(src_.begin(), src_.begin() + 10 * kStride, dst_.begin());
+        for (int i = 0; i < kNumEdges; i++) {
+          deblock.filter_luma_weak[dir](&dst_[4 * kStride + 8 +
+                                              (i % 8) * edge_step], kStride,
+                                        4, true, true, true, bitdepth_);
+        }
+      });
+      Measure(std::string("filter_luma_strong") + dir_name[dir],
+              kNumEdges * lines, 8, [&]() {
+        std::copy(src_.begin(), src_.begin() + 10 * kStride, dst_.begin());
+        for (int i = 0; i < kNumEdges; i++) {
+          deblock.filter_luma_strong[dir](&dst_[4 * kStride + 8 +
+                                                (i % 8) * edge_step],
+                                          kStride, 8);
+        }
+      });
+      Measure(std::string("filter_chroma") + dir_name[dir],
+              kNumEdges * lines, 2, [&]() {
+        std::copy(src_.begin(), src_.begin() + 10 * kStride, dst_.begin());
+        for (int i = 0; i < kNumEdges; i++) {
+          deblock.filter_chroma[dir](lines, &dst_[4 * kStride + 8 +
+                                                  (i % 8) * edge_step],
+                                     kStride, 4, bitdepth_);
+        }
+      });
+    }
+  }
+
+  const BenchOptions &options_;
+  const SimdTier &tier_;
+  const int bitdepth_;
+  xvc::EncoderSimdFunctions simd_;
+  std::vector<xvc::Sample> src_;
+  std::vector<xvc::Sample> src2_;
+  std::vector<xvc::Sample> dst_;
+  std::vector<int16_t> short_src_;
+  std::vector<int16_t> short_dst_;
+  std::vector<xvc::Coeff> coeff_src_;
+  std::vector<xvc::Coeff> coeff_dst_;
+  int sink_ = 0;
+};
+
+// 8-bit 4:2:0 synthetic pictures, shifted by the picture number to get some
+// motion
+std::vector<std::vector<uint8_t>> CreatePictures(const BenchOptions &options) {
+  const int width = options.width;
+  const int height = options.height;
+  const int chroma_width = width / 2;
+  const int chroma_height = height / 2;
+  std::vector<std::vector<uint8_t>> pictures;
+  for (int poc = 0; poc < options.frames; poc++) {
+    std::vector<uint8_t> pic(width * height + 2 * chroma_width * chroma_height);
+    uint8_t *dst = &pic[0];
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        *dst++ = static_cast<uint8_t>(SyntheticSample(x + poc, y + poc / 2, 8));
+      }
+    }
+    for (int c = 1; c <= 2; c++) {
+      for (int y = 0; y < chroma_height; y++) {
+        for (int x = 0; x < chroma_width; x++) {
+          *dst++ = static_cast<uint8_t>(
+            SyntheticSample(2 * x + poc + 17 * c, 2 * y + poc / 2, 8));
+        }
+      }
+    }
+    pictures.push_back(std::move(pic));
+  }
+  return pictures;
+}
+
+struct LatencyStats {
+  void Add(double seconds) {
+    total += seconds;
+    max = std::max(max, seconds);
+    count++;
+  }
+  double total = 0;
+  double max = 0;
+  int count = 0;
+};
+
+void RunEndToEnd(const BenchOptions &options, int speed_mode, int threads) {
+  const xvc_encoder_api *enc_api = xvc_encoder_api_get();
+  xvc_encoder_parameters *params = enc_api->parameters_create();
+  enc_api->parameters_set_default(params);
+  params->width = options.width;
+  params->height = options.height;
+  params->input_bitdepth = 8;
+  params->sub_gop_length = options.sub_gop_length;
+  params->qp = options.qp;
+  params->speed_mode = speed_mode;
+  params->threads = threads;
+  xvc_encoder *encoder = enc_api->encoder_create(params);
+  enc_api->parameters_destroy(params);
+  if (!encoder) {
+    std::cerr << "Failed to create encoder" << std::endl;
+    std::exit(1);
+  }
+
+  const std::vector<std::vector<uint8_t>> pictures = CreatePictures(options);
+  std::vector<std::vector<uint8_t>> nals;
+  LatencyStats enc_latency;
+  xvc_enc_nal_unit *nal_units;
+  int num_nal_units;
+  const Clock::time_point enc_start = Clock::now();
+  for (const std::vector<uint8_t> &pic : pictures) {
+    const Clock::time_point start = Clock::now();
+    const xvc_enc_return_code enc_ret =
+      enc_api->encoder_encode(encoder, &pic[0], &nal_units, &num_nal_units,
+                              nullptr);
+    if (enc_ret != XVC_ENC_OK) {
+      std::cerr << "Failed to encode: " <<
+        enc_api->xvc_enc_get_error_text(enc_ret) << std::endl;
+      std::exit(1);
+    }
+    enc_latency.Add(
+      std::chrono::duration<double>(Clock::now() - start).count());
+    for (int i = 0; i < num_nal_units; i++) {
+      nals.emplace_back(nal_units[i].bytes,
+                        nal_units[i].bytes + nal_units[i].size);
+    }
+  }
+  xvc_enc_return_code ret;
+  do {
+    ret = enc_api->encoder_flush(encoder, &nal_units, &num_nal_units, nullptr);
+    for (int i = 0; i < num_nal_units; i++) {
+      nals.emplace_back(nal_units[i].bytes,
+                        nal_units[i].bytes + nal_units[i].size);
+    }
+  } while (ret == XVC_ENC_OK);
+  if (ret != XVC_ENC_NO_MORE_OUTPUT) {
+    std::cerr << "Failed to flush encoder: " <<
+      enc_api->xvc_enc_get_error_text(ret) << std::endl;
+    std::exit(1);
+  }
+  const double enc_time =
+    std::chrono::duration<double>(Clock::now() - enc_start).count();
+  enc_api->encoder_destroy(encoder);
+  size_t num_bytes = 0;
+  for (const std::vector<uint8_t> &nal : nals) {
+    num_bytes += nal.size();
+  }
+  PrintResult({
+    { "type", Quote("encode") },
+    { "speed_mode", ToString(speed_mode) },
+    { "threads", ToString(threads) },
+    { "width", ToString(options.width) },
+    { "height", ToString(options.height) },
+    { "frames", ToString(options.frames) },
+    { "bytes", ToString(num_bytes) },
+    { "fps", ToString(options.frames / enc_time) },
+    { "avg_latency_ms", ToString(1e3 * enc_latency.total /
+                                 enc_latency.count) },
+    { "max_latency_ms", ToString(1e3 * enc_latency.max) },
+  });
+
+  const xvc_decoder_api *dec_api = xvc_decoder_api_get();
+  xvc_decoder_parameters *dec_params = dec_api->parameters_create();
+  dec_api->parameters_set_default(dec_params);
+  dec_params->threads = threads;
+  xvc_decoder *decoder = dec_api->decoder_create(dec_params);
+  dec_api->parameters_destroy(dec_params);
+  if (!decoder) {
+    std::cerr << "Failed to create decoder" << std::endl;
+    std::exit(1);
+  }
+  LatencyStats dec_latency;
+  int num_decoded = 0;
+  xvc_decoded_picture *dec_pic;
+  const Clock::time_point dec_start = Clock::now();
+  for (const std::vector<uint8_t> &nal : nals) {
+    const Clock::time_point start = Clock::now();
+    const xvc_dec_return_code dec_ret =
+      dec_api->decoder_decode_nal(decoder, &nal[0], nal.size(), 0);
+    if (dec_ret != XVC_DEC_OK) {
+      std::cerr << "Failed to decode: " <<
+        dec_api->xvc_dec_get_error_text(dec_ret) << std::endl;
+      std::exit(1);
+    }
+    while (dec_api->decoder_get_picture_ref(decoder, &dec_pic) ==
+           XVC_DEC_OK) {
+      dec_api->picture_release(dec_pic);
+      num_decoded++;
+    }
+    dec_latency.Add(
+      std::chrono::duration<double>(Clock::now() - start).count());
+  }
+  dec_api->decoder_flush(decoder);
+  while (dec_api->decoder_get_picture_ref(decoder, &dec_pic) == XVC_DEC_OK) {
+    dec_api->picture_release(dec_pic);
+    num_decoded++;
+  }
+  const double dec_time =
+    std::chrono::duration<double>(Clock::now() - dec_start).count();
+  dec_api->decoder_destroy(decoder);
+  if (num_decoded != options.frames) {
+    std::cerr << "Decoded " << num_decoded << " of " << options.frames <<
+      " pictures" << std::endl;
+    std::exit(1);
+  }
+  PrintResult({
+    { "type", Quote("decode") },
+    { "speed_mode", ToString(speed_mode) },
+    { "threads", ToString(threads) },
+    { "width", ToString(options.width) },
+    { "height", ToString(options.height) },
+    { "frames", ToString(num_decoded) },
+    { "fps", ToString(num_decoded / dec_time) },
+    { "avg_latency_ms", ToString(1e3 * dec_latency.total /
+                                 dec_latency.count) },
+    { "max_latency_ms", ToString(1e3 * dec_latency.max) },
+  });
+}
+
+std::vector<int> ParseList(const char *str) {
+  std::vector<int> list;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    list.push_back(std::atoi(item.c_str()));
+  }
+  return list;
+}
+
+void PrintUsage() {
+  std::cout << "Usage: xvc_bench [options]" << std::endl;
+  std::cout << "  -kernels-only" << std::endl;
+  std::cout << "  -end-to-end-only" << std::endl;
+  std::cout << "  -filter <kernel name substring>" << std::endl;
+  std::cout << "  -min-time <seconds per kernel> (default: 0.05)" << std::endl;
+  std::cout << "  -size <width>x<height> (default: 416x240)" << std::endl;
+  std::cout << "  -frames <int> (default: 16)" << std::endl;
+  std::cout << "  -sub-gop-length <int> (default: 8)" << std::endl;
+  std::cout << "  -qp <int> (default: 32)" << std::endl;
+  std::cout << "  -speed-modes <list> (default: 2)" << std::endl;
+  std::cout << "  -threads <list> (default: 0,4)" << std::endl;
+}
+
+}   // namespace
+
+int main(int argc, char *argv[]) {
+  BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg(argv[i]);
+    const bool has_value = i + 1 < argc;
+    if (arg == "-kernels-only") {
+      options.end_to_end = false;
+    } else if (arg == "-end-to-end-only") {
+      options.kernels = false;
+    } else if (arg == "-filter" && has_value) {
+      options.filter = argv[++i];
+    } else if (arg == "-min-time" && has_value) {
+      options.min_time = std::atof(argv[++i]);
+    } else if (arg == "-size" && has_value) {
+      char separator;
+      std::stringstream(argv[++i]) >> options.width >> separator
+        >> options.height;
+    } else if (arg == "-frames" && has_value) {
+      options.frames = std::atoi(argv[++i]);
+    } else if (arg == "-sub-gop-length" && has_value) {
+      options.sub_gop_length = std::atoi(argv[++i]);
+    } else if (arg == "-qp" && has_value) {
+      options.qp = std::atoi(argv[++i]);
+    } else if (arg == "-speed-modes" && has_value) {
+      options.speed_modes = ParseList(argv[++i]);
+    } else if (arg == "-threads" && has_value) {
+      options.threads = ParseList(argv[++i]);
+    } else {
+      PrintUsage();
+      return arg == "-help" ? 0 : 1;
+    }
+  }
+
+  if (options.kernels) {
+    for (const SimdTier &tier : GetSimdTiers()) {
+      KernelBench bench(options, tier);
+      bench.Run();
+    }
+  }
+  if (options.end_to_end) {
+    for (int speed_mode : options.speed_modes) {
+      for (int threads : options.threads) {
+        RunEndToEnd(options, speed_mode, threads);
+      }
+    }
+  }
+  return 0;
+}
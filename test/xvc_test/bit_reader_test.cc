@@ -0,0 +1,158 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include <chrono>   // NOLINT
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_dec_lib/bit_reader.h"
+
+namespace {
+
+static const size_t kBufferSize = 1 << 16;
+
+// Reference reader extracting one bit at a time
+class BitByBitReader {
+public:
+  explicit BitByBitReader(const std::vector<uint8_t> &buffer)
+    : buffer_(buffer) {
+  }
+  uint32_t ReadBits(int num_bits) {
+    uint32_t bits = 0;
+    for (int i = 0; i < num_bits; i++, position_++) {
+      int bit = (buffer_[position_ >> 3] >> (7 - (position_ & 7))) & 1;
+      bits = (bits << 1) | bit;
+    }
+    return bits;
+  }
+  uint8_t ReadByte() {
+    return static_cast<uint8_t>(ReadBits(8));
+  }
+
+private:
+  const std::vector<uint8_t> &buffer_;
+  size_t position_ = 0;
+};
+
+// Mix of short header fields and the byte reads made by entropy decoding
+template<typename Reader>
+uint32_t ReadMixed(Reader &&reader) {
+  uint32_t checksum = 0;
+  const size_t kBytesPerIteration = 8;
+  for (size_t i = 0; i < kBufferSize / kBytesPerIteration; i++) {
+    checksum += reader.ReadBits(1);
+    checksum += reader.ReadBits(7);
+    checksum += reader.ReadByte();
+    checksum += reader.ReadByte();
+    checksum += reader.ReadBits(16);
+    checksum += reader.ReadBits(24);
+  }
+  return checksum;
+}
+
+class BitReaderTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::mt19937 rand(1234);
+    buffer_.resize(kBufferSize);
+    for (auto &byte : buffer_) {
+      byte = static_cast<uint8_t>(rand());
+    }
+  }
+
+  std::vector<uint8_t> buffer_;
+};
+
+TEST_F(BitReaderTest, ReadBitsMatchesBitByBit) {
+  std::mt19937 rand(42);
+  xvc::BitReader bit_reader(&buffer_[0], buffer_.size());
+  BitByBitReader ref_reader(buffer_);
+  size_t bits_left = buffer_.size() * 8;
+  while (bits_left > 0) {
+    int num_bits = static_cast<int>(rand() % 33);
+    if (static_cast<size_t>(num_bits) > bits_left) {
+      num_bits = static_cast<int>(bits_left);
+    }
+    ASSERT_EQ(ref_reader.ReadBits(num_bits), bit_reader.ReadBits(num_bits));
+    bits_left -= num_bits;
+  }
+  EXPECT_FALSE(bit_reader.IsOverrun());
+}
+
+TEST_F(BitReaderTest, RewindSkipAndBytes) {
+  xvc::BitReader bit_reader(&buffer_[0], buffer_.size());
+  uint32_t first = bit_reader.ReadBits(13);
+  EXPECT_EQ(buffer_[1] & 7U, bit_reader.ReadBits(3));
+  bit_reader.Rewind(16);
+  EXPECT_EQ(first, bit_reader.ReadBits(13));
+  bit_reader.SkipBits();
+  EXPECT_EQ(2U, bit_reader.GetPosition());
+  EXPECT_EQ(buffer_[2], bit_reader.ReadByte());
+  bit_reader.ReadBits(27);
+  bit_reader.Rewind(3);
+  bit_reader.SkipBits();
+  EXPECT_EQ(6U, bit_reader.GetPosition());
+  std::vector<uint8_t> bytes(100);
+  bit_reader.ReadBytes(&bytes[0], bytes.size());
+  EXPECT_EQ(std::vector<uint8_t>(buffer_.begin() + 6, buffer_.begin() + 106),
+            bytes);
+  EXPECT_EQ(106U, bit_reader.GetPosition());
+  EXPECT_EQ(buffer_[106], bit_reader.ReadBits(8));
+}
+
+TEST_F(BitReaderTest, ReadPastEnd) {
+  xvc::BitReader bit_reader(&buffer_[0], 3);
+  EXPECT_EQ((buffer_[0] << 12) | (buffer_[1] << 4) | (buffer_[2] >> 4),
+            static_cast<int>(bit_reader.ReadBits(20)));
+  EXPECT_FALSE(bit_reader.IsOverrun());
+  EXPECT_EQ((buffer_[2] & 0xf) << 8, static_cast<int>(bit_reader.ReadBits(12)));
+  EXPECT_TRUE(bit_reader.IsOverrun());
+  EXPECT_EQ(0U, bit_reader.ReadBits(32));
+}
+
+// Run with --gtest_also_run_disabled_tests to compare read speed against
+// reading one bit at a time
+TEST_F(BitReaderTest, DISABLED_ReadSpeed) {
+  const int kNumIterations = 200;
+  auto start = std::chrono::steady_clock::now();
+  uint32_t ref_checksum = 0;
+  for (int i = 0; i < kNumIterations; i++) {
+    ref_checksum += ReadMixed(BitByBitReader(buffer_));
+  }
+  auto mid = std::chrono::steady_clock::now();
+  uint32_t checksum = 0;
+  for (int i = 0; i < kNumIterations; i++) {
+    checksum += ReadMixed(xvc::BitReader(&buffer_[0], buffer_.size()));
+  }
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(ref_checksum, checksum);
+  double ref_ms =
+    std::chrono::duration<double, std::milli>(mid - start).count();
+  double ms = std::chrono::duration<double, std::milli>(end - mid).count();
+  std::cout << "bit by bit: " << ref_ms << " ms, BitReader: " << ms
+    << " ms, speedup: " << ref_ms / ms << std::endl;
+}
+
+}   // namespace
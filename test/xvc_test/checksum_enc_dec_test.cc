@@ -107,7 +107,7 @@ protected:
     encoder_settings.Initialize(xvc::SpeedMode::kSlow);
     encoder_settings.Tune(xvc::TuneMode::kPsnr);
     return pic_encoder_->Encode(segment_, segment_qp_, buffer_flag,
-                                encoder_settings);
+                                encoder_settings, {});
   }
 
   bool DecodePicture(const std::vector<uint8_t> &bitstream) {
@@ -125,7 +125,7 @@ protected:
     // TODO(PH) Also verify inter pictures?
     xvc::ReferencePictureLists ref_pic_list;
     pic_decoder_->Init(segment_, pic_header, std::move(ref_pic_list),
-                       output_pic_format_, 0);
+                       output_pic_format_, false, 0);
     return pic_decoder_->Decode(segment_, segment_, &bit_reader, true);
   }
 
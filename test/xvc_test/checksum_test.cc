@@ -0,0 +1,157 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/checksum.h"
+#include "xvc_common_lib/utils_md5.h"
+#include "xvc_common_lib/yuv_pic.h"
+
+namespace {
+
+class ChecksumTest : public ::testing::TestWithParam<int> {
+protected:
+  static const int kWidth = 70;
+  static const int kHeight = 38;
+
+  void SetUp() override {
+    bitdepth_ = GetParam();
+    pic_.reset(new xvc::YuvPicture(xvc::ChromaFormat::k420, kWidth, kHeight,
+                                   bitdepth_, true, kWidth, kHeight));
+    const int mask = (1 << bitdepth_) - 1;
+    for (int c = 0; c < xvc::constants::kMaxYuvComponents; c++) {
+      const xvc::YuvComponent comp = xvc::YuvComponent(c);
+      for (int y = 0; y < pic_->GetHeight(comp); y++) {
+        xvc::Sample *src = pic_->GetSamplePtr(comp, 0, y);
+        for (int x = 0; x < pic_->GetWidth(comp); x++) {
+          src[x] = static_cast<xvc::Sample>(((x + 3) * (y + 7) * (c + 1) +
+                                             x * x) & mask);
+        }
+      }
+    }
+  }
+
+  // Bit serial crc as specified, one value for each component when robust
+  std::vector<uint8_t> ReferenceCrc(bool robust) const {
+    std::vector<uint8_t> hash;
+    uint32_t crc = 0xffff;
+    auto shift_bit = [&crc](uint32_t bit_val) {
+      uint32_t crc_msb = (crc >> 15) & 1;
+      crc = (((crc << 1) + bit_val) & 0xffff) ^ (crc_msb * 0x1021);
+    };
+    auto finish = [&]() {
+      for (int bit = 0; bit < 16; bit++) {
+        shift_bit(0);
+      }
+      hash.push_back((crc >> 8) & 0xff);
+      hash.push_back(crc & 0xff);
+    };
+    for (int c = 0; c < xvc::constants::kMaxYuvComponents; c++) {
+      const xvc::YuvComponent comp = xvc::YuvComponent(c);
+      if (robust) {
+        crc = 0xffff;
+      }
+      for (int y = 0; y < pic_->GetHeight(comp); y++) {
+        const xvc::Sample *src = pic_->GetSamplePtr(comp, 0, y);
+        for (int x = 0; x < pic_->GetWidth(comp); x++) {
+          for (int bit = 0; bit < 8; bit++) {
+            shift_bit((src[x] >> (7 - bit)) & 1);
+          }
+          if (bitdepth_ > 8) {
+            for (int bit = 0; bit < 8; bit++) {
+              shift_bit((src[x] >> (15 - bit)) & 1);
+            }
+          }
+        }
+      }
+      if (robust) {
+        finish();
+      }
+    }
+    if (!robust) {
+      finish();
+    }
+    return hash;
+  }
+
+  std::vector<uint8_t> Hash(xvc::Checksum::Method method, bool robust,
+                            int num_threads) const {
+    xvc::Checksum checksum(method, robust ? xvc::Checksum::Mode::kMaxRobust :
+                           xvc::Checksum::Mode::kMinOverhead);
+    checksum.HashPicture(*pic_, num_threads);
+    return checksum.GetHash();
+  }
+
+  int bitdepth_;
+  std::unique_ptr<xvc::YuvPicture> pic_;
+};
+
+TEST_P(ChecksumTest, CrcMatchesBitSerialReference) {
+  for (bool robust : { false, true }) {
+    for (int num_threads : { 1, 2, 5 }) {
+      EXPECT_EQ(ReferenceCrc(robust),
+                Hash(xvc::Checksum::Method::kCrc, robust, num_threads));
+    }
+  }
+}
+
+TEST_P(ChecksumTest, Md5IndependentOfThreads) {
+  for (bool robust : { false, true }) {
+    std::vector<uint8_t> hash =
+      Hash(xvc::Checksum::Method::kMd5, robust, 1);
+    EXPECT_EQ(robust ? 48U : 16U, hash.size());
+    EXPECT_EQ(hash, Hash(xvc::Checksum::Method::kMd5, robust, 3));
+  }
+}
+
+TEST(Md5Test, UpdateLowBytesEqualsUpdate) {
+  std::vector<uint16_t> values(300);
+  std::vector<uint8_t> bytes(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = static_cast<uint16_t>((i * 37) & 0xff);
+    bytes[i] = static_cast<uint8_t>(values[i]);
+  }
+  xvc::util::MD5 md5_bytes;
+  xvc::util::MD5 md5_values;
+  // Uneven chunks to cover partially filled blocks
+  for (int offset = 0, len = 1; offset < 300; offset += len, len += 13) {
+    const uint32_t n = std::min(len, 300 - offset);
+    md5_bytes.Update(&bytes[offset], n);
+    md5_values.UpdateLowBytes(&values[offset], n);
+  }
+  uint8_t digest_bytes[16];
+  uint8_t digest_values[16];
+  md5_bytes.Final(digest_bytes);
+  md5_values.Final(digest_values);
+  EXPECT_EQ(std::vector<uint8_t>(digest_bytes, digest_bytes + 16),
+            std::vector<uint8_t>(digest_values, digest_values + 16));
+}
+
+INSTANTIATE_TEST_CASE_P(NormalBitdepth, ChecksumTest, ::testing::Values(8));
+#if XVC_HIGH_BITDEPTH
+INSTANTIATE_TEST_CASE_P(HighBitdepth, ChecksumTest, ::testing::Values(10));
+#endif
+
+}   // namespace
@@ -19,12 +19,105 @@
 * Please visit https://xvc.io/license/ for more information.
 ******************************************************************************/
 
+#include <cstring>
+#include <vector>
+
 #include "googletest/include/gtest/gtest.h"
 
 #include "xvc_dec_lib/xvcdec.h"
+#include "xvc_enc_lib/xvcenc.h"
 
 namespace {
 
+struct NalReleaseCounter {
+  std::vector<std::vector<uint8_t>> *nals;
+  int num_released;
+};
+
+// Overwrites released nal units so that any later read gives a mismatch
+void ReleaseNal(void *opaque, const uint8_t *nal_unit) {
+  NalReleaseCounter *counter = reinterpret_cast<NalReleaseCounter*>(opaque);
+  for (auto &nal : *counter->nals) {
+    if (&nal[0] == nal_unit) {
+      std::memset(&nal[0], 0xff, nal.size());
+    }
+  }
+  counter->num_released++;
+}
+
+std::vector<std::vector<uint8_t>> EncodeNals(int width, int height,
+                                             int num_pics) {
+  const xvc_encoder_api *api = xvc_encoder_api_get();
+  xvc_encoder_parameters *params = api->parameters_create();
+  api->parameters_set_default(params);
+  params->width = width;
+  params->height = height;
+  params->sub_gop_length = 4;
+  params->speed_mode = 2;
+  xvc_encoder *encoder = api->encoder_create(params);
+  api->parameters_destroy(params);
+  std::vector<std::vector<uint8_t>> nals;
+  std::vector<uint8_t> pic(width * height * 3 / 2);
+  xvc_enc_nal_unit *nal_units;
+  int num_nal_units;
+  for (int poc = 0; poc < num_pics + 1; poc++) {
+    xvc_enc_return_code ret;
+    if (poc < num_pics) {
+      for (int i = 0; i < static_cast<int>(pic.size()); i++) {
+        pic[i] = static_cast<uint8_t>((i % width) * poc + i / width);
+      }
+      ret = api->encoder_encode(encoder, &pic[0], &nal_units, &num_nal_units,
+                                nullptr);
+    } else {
+      ret = api->encoder_flush(encoder, &nal_units, &num_nal_units, nullptr);
+    }
+    for (int i = 0; i < num_nal_units; i++) {
+      nals.emplace_back(nal_units[i].bytes,
+                        nal_units[i].bytes + nal_units[i].size);
+    }
+    if (poc == num_pics && ret == XVC_ENC_OK) {
+      poc--;
+    }
+  }
+  api->encoder_destroy(encoder);
+  return nals;
+}
+
+// Returns the concatenation of all output pictures
+std::vector<uint8_t> DecodeNals(std::vector<std::vector<uint8_t>> *nals,
+                                int threads, NalReleaseCounter *counter) {
+  const xvc_decoder_api *api = xvc_decoder_api_get();
+  xvc_decoder_parameters *params = api->parameters_create();
+  api->parameters_set_default(params);
+  params->threads = threads;
+  xvc_decoder *decoder = api->decoder_create(params);
+  api->parameters_destroy(params);
+  std::vector<uint8_t> output;
+  xvc_decoded_picture decoded_pic;
+  for (size_t i = 0; i < nals->size(); i++) {
+    std::vector<uint8_t> &nal = (*nals)[i];
+    if (counter) {
+      EXPECT_EQ(XVC_DEC_OK,
+                api->decoder_decode_nal2(decoder, &nal[0], nal.size(), i,
+                                         &ReleaseNal, counter));
+    } else {
+      EXPECT_EQ(XVC_DEC_OK,
+                api->decoder_decode_nal(decoder, &nal[0], nal.size(), i));
+    }
+    while (api->decoder_get_picture(decoder, &decoded_pic) == XVC_DEC_OK) {
+      output.insert(output.end(), decoded_pic.bytes,
+                    decoded_pic.bytes + decoded_pic.size);
+    }
+  }
+  api->decoder_flush(decoder);
+  while (api->decoder_get_picture(decoder, &decoded_pic) == XVC_DEC_OK) {
+    output.insert(output.end(), decoded_pic.bytes,
+                  decoded_pic.bytes + decoded_pic.size);
+  }
+  api->decoder_destroy(decoder);
+  return output;
+}
+
 TEST(DecoderAPI, NullPtrCalls) {
   const xvc_decoder_api *api = xvc_decoder_api_get();
   EXPECT_EQ(XVC_DEC_OK, api->parameters_destroy(nullptr));
@@ -95,6 +188,19 @@ TEST(DecoderAPI, DecoderDecodeNal) {
   EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
 }
 
+TEST(DecoderAPI, DecoderDecodeNalInPlace) {
+  const std::vector<std::vector<uint8_t>> nals = EncodeNals(64, 64, 9);
+  std::vector<std::vector<uint8_t>> nals_copy = nals;
+  const std::vector<uint8_t> expected = DecodeNals(&nals_copy, 0, nullptr);
+  EXPECT_FALSE(expected.empty());
+  for (int threads : { 0, 2 }) {
+    nals_copy = nals;
+    NalReleaseCounter counter = { &nals_copy, 0 };
+    EXPECT_EQ(expected, DecodeNals(&nals_copy, threads, &counter));
+    EXPECT_EQ(static_cast<int>(nals.size()), counter.num_released);
+  }
+}
+
 TEST(DecoderAPI, DecoderGetDecodedPic) {
   const xvc_decoder_api *api = xvc_decoder_api_get();
   xvc_decoded_picture decoded_pic;
@@ -111,6 +217,29 @@ TEST(DecoderAPI, DecoderGetDecodedPic) {
   EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
 }
 
+TEST(DecoderAPI, DecoderPictureRelease) {
+  const xvc_decoder_api *api = xvc_decoder_api_get();
+  std::vector<std::vector<uint8_t>> nals = EncodeNals(64, 64, 2);
+  xvc_decoder_parameters *params = api->parameters_create();
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_set_default(params));
+  xvc_decoder *decoder = api->decoder_create(params);
+  EXPECT_EQ(XVC_DEC_OK, api->parameters_destroy(params));
+  for (size_t i = 0; i < nals.size(); i++) {
+    EXPECT_EQ(XVC_DEC_OK, api->decoder_decode_nal(decoder, &nals[i][0],
+                                                  nals[i].size(), i));
+  }
+  EXPECT_EQ(XVC_DEC_OK, api->decoder_flush(decoder));
+  xvc_decoded_picture *pic = nullptr;
+  ASSERT_EQ(XVC_DEC_OK, api->decoder_get_picture_ref(decoder, &pic));
+  xvc_decoded_picture not_a_ref;
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT, api->picture_release(&not_a_ref));
+  EXPECT_EQ(XVC_DEC_OK, api->decoder_destroy(decoder));
+  // Picture references stay valid after the decoder is destroyed
+  EXPECT_EQ(XVC_DEC_OK, api->picture_release(pic));
+  EXPECT_EQ(XVC_DEC_INVALID_ARGUMENT, api->picture_release(pic));
+  EXPECT_EQ(XVC_DEC_OK, api->picture_release(nullptr));
+}
+
 TEST(DecoderAPI, DecoderFlushAndGet) {
   const xvc_decoder_api *api = xvc_decoder_api_get();
   xvc_decoder_parameters *params = api->parameters_create();
@@ -35,8 +35,8 @@ using NalUnit = std::vector<uint8_t>;
 
 class DecoderHelper {
 public:
-  void Init(bool use_threads = false) {
-    const int num_threads = use_threads ? -1 : 0;
+  void Init(bool use_threads = false, int max_threads = -1) {
+    const int num_threads = use_threads ? max_threads : 0;
     decoder_ = std::unique_ptr<xvc::Decoder>(new ::xvc::Decoder(num_threads));
   }
 
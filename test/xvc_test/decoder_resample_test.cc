@@ -259,6 +259,43 @@ TEST_P(DecoderResampleTest, BitdepthDownConversionHighToHigh) {
 }
 #endif
 
+class DecoderThreadedOutputTest : public ::testing::Test,
+  public ::xvc_test::EncoderHelper, public ::xvc_test::DecoderHelper {
+protected:
+  static const int kWidth = 64;
+  static const int kHeight = 4 * xvc::constants::kCtuSize;
+
+  void SetUp() override {
+    SetupEncoder(GetDefaultEncoderSettings(), kWidth, kHeight, kBitdepth,
+                 kQp1);
+    EncodeOneFrame(CreateSampleBuffer(kSample1, kBitdepth), kBitdepth);
+    ASSERT_EQ(2, encoded_nal_units_.size());
+  }
+
+  std::vector<uint8_t> DecodeArgb(bool use_threads, int max_threads) {
+    DecoderHelper::Init(use_threads, max_threads);
+    decoder_->SetOutputChromaFormat(XVC_DEC_CHROMA_FORMAT_ARGB);
+    ResetBitstreamPosition();
+    DecodeSegmentHeaderSuccess(GetNextNalToDecode());
+    xvc_decoded_picture *dec_pic = DecodeAndFlush(GetNextNalToDecode());
+    EXPECT_NE(nullptr, dec_pic);
+    if (!dec_pic) {
+      return std::vector<uint8_t>();
+    }
+    EXPECT_EQ(XVC_DEC_CHROMA_FORMAT_ARGB, dec_pic->stats.chroma_format);
+    return std::vector<uint8_t>(dec_pic->bytes, dec_pic->bytes + dec_pic->size);
+  }
+};
+
+TEST_F(DecoderThreadedOutputTest, ArgbConvertedOnMultipleThreads) {
+  const std::vector<uint8_t> ref_bytes = DecodeArgb(false, 0);
+  EXPECT_EQ(1, decoder_->GetLastOutputThreads());
+  ASSERT_EQ(static_cast<size_t>(kWidth * kHeight * 4), ref_bytes.size());
+  const std::vector<uint8_t> threaded_bytes = DecodeArgb(true, 4);
+  EXPECT_EQ(4, decoder_->GetLastOutputThreads());
+  EXPECT_EQ(ref_bytes, threaded_bytes);
+}
+
 INSTANTIATE_TEST_CASE_P(TestParam, DecoderResampleTest,
                         ::testing::Values(TestParam({ false, false }),
                                           TestParam({ true, false }),
@@ -19,6 +19,7 @@
 * Please visit https://xvc.io/license/ for more information.
 ******************************************************************************/
 
+#include <cstring>
 #include <list>
 #include <vector>
 
@@ -157,4 +158,190 @@ INSTANTIATE_TEST_CASE_P(HighBitdepth, EncodeDecodeTest,
                                           TestParam({ 10, true })));
 #endif
 
+static constexpr int kWidth = 3 * xvc::constants::kCtuSize - 8;
+static constexpr int kHeight = 3 * xvc::constants::kCtuSize - 24;
+static constexpr int kFrames = 3;
+
+class EncodeDecodeMultiCtuTest : public ::testing::TestWithParam<int>,
+  public ::xvc_test::EncoderHelper, public ::xvc_test::DecoderHelper {
+protected:
+  std::vector<uint8_t> CreatePicture(int frame) {
+    std::vector<uint8_t> pic_bytes(kWidth * kHeight * 3 / 2);
+    for (int y = 0; y < kHeight; y++) {
+      for (int x = 0; x < kWidth; x++) {
+        pic_bytes[y * kWidth + x] = static_cast<uint8_t>(
+          2 * (x + frame) + y + ((x * y * 31 + frame * 7) % 19));
+      }
+    }
+    for (int i = kWidth * kHeight; i < static_cast<int>(pic_bytes.size());
+         i++) {
+      pic_bytes[i] = static_cast<uint8_t>(128 + (i % 13) - frame);
+    }
+    return pic_bytes;
+  }
+
+  void EncodeAndVerifyDecode(int num_frames) {
+    for (int i = 0; i < num_frames; i++) {
+      EncodeOneFrame(CreatePicture(i), 8);
+    }
+    EncoderFlush();
+    DecodeSegmentHeaderSuccess(GetNextNalToDecode());
+    int num_decoded = 0;
+    while (HasMoreNals()) {
+      if (DecodePictureSuccess(GetNextNalToDecode())) {
+        ASSERT_TRUE(xvc_test::TestYuvPic::SamePictureBytes(
+          &rec_pics_[num_decoded][0], rec_pics_[num_decoded].size(),
+          reinterpret_cast<const uint8_t*>(last_decoded_picture_.bytes),
+          last_decoded_picture_.size));
+        num_decoded++;
+      }
+    }
+    while (DecoderFlushAndGet()) {
+      ASSERT_TRUE(xvc_test::TestYuvPic::SamePictureBytes(
+        &rec_pics_[num_decoded][0], rec_pics_[num_decoded].size(),
+        reinterpret_cast<const uint8_t*>(last_decoded_picture_.bytes),
+        last_decoded_picture_.size));
+      num_decoded++;
+    }
+    EXPECT_EQ(num_frames, num_decoded);
+  }
+};
+
+class EncodeDecodeWavefrontTest : public EncodeDecodeMultiCtuTest {
+protected:
+  void SetUp() override {
+    xvc::EncoderSettings encoder_settings;
+    encoder_settings.Initialize(xvc::SpeedMode::kFast);
+    encoder_settings.wavefront_threads = GetParam();
+    SetupEncoder(encoder_settings, kWidth, kHeight, 8, kQp);
+    encoder_->SetSubGopLength(kFrames - 1);
+    DecoderHelper::Init();
+  }
+};
+
+TEST_P(EncodeDecodeWavefrontTest, DecodedMatchesReconstruction) {
+  EncodeAndVerifyDecode(kFrames);
+}
+
+INSTANTIATE_TEST_CASE_P(WavefrontThreads, EncodeDecodeWavefrontTest,
+                        ::testing::Values(2, 3));
+
+class EncodeDecodeSliceTest : public EncodeDecodeMultiCtuTest {
+protected:
+  void SetUp() override {
+    xvc::EncoderSettings encoder_settings;
+    encoder_settings.Initialize(xvc::SpeedMode::kFast);
+    encoder_settings.num_slices = 3;
+    encoder_settings.slice_threads = GetParam();
+    SetupEncoder(encoder_settings, kWidth, kHeight, 8, kQp);
+    encoder_->SetSubGopLength(kFrames - 1);
+    DecoderHelper::Init(GetParam() > 1, GetParam());
+  }
+};
+
+TEST_P(EncodeDecodeSliceTest, DecodedMatchesReconstruction) {
+  EncodeAndVerifyDecode(kFrames);
+}
+
+INSTANTIATE_TEST_CASE_P(SliceThreads, EncodeDecodeSliceTest,
+                        ::testing::Values(1, 3));
+
+class EncodeDecodeTemporalAqpTest : public EncodeDecodeMultiCtuTest {
+protected:
+  void SetUp() override {
+    xvc::EncoderSettings encoder_settings;
+    encoder_settings.Initialize(xvc::SpeedMode::kFast);
+    encoder_settings.temporal_aqp = 1;
+    encoder_settings.temporal_aqp_strength = GetParam();
+    SetupEncoder(encoder_settings, kWidth, kHeight, 8, kQp);
+    encoder_->SetSubGopLength(kFrames - 1);
+    DecoderHelper::Init();
+  }
+};
+
+TEST_P(EncodeDecodeTemporalAqpTest, DecodedMatchesReconstruction) {
+  EncodeAndVerifyDecode(2 * kFrames + 1);
+}
+
+INSTANTIATE_TEST_CASE_P(Strength, EncodeDecodeTemporalAqpTest,
+                        ::testing::Values(20, 80));
+
+class EncodeDecodeFramePipelineTest : public EncodeDecodeMultiCtuTest {
+protected:
+  void SetUp() override {
+    xvc::EncoderSettings encoder_settings;
+    encoder_settings.Initialize(xvc::SpeedMode::kFast);
+    SetupEncoder(encoder_settings, kWidth, kHeight, 8, kQp);
+    encoder_->SetLowDelay(true);
+    DecoderHelper::Init(true, GetParam());
+  }
+};
+
+TEST_P(EncodeDecodeFramePipelineTest, DecodedMatchesReconstruction) {
+  EncodeAndVerifyDecode(kFrames + 1);
+}
+
+INSTANTIATE_TEST_CASE_P(DecoderThreads, EncodeDecodeFramePipelineTest,
+                        ::testing::Values(1, 4));
+
+class EncodeDecodePictureRefTest : public EncodeDecodeMultiCtuTest {
+protected:
+  void SetUp() override {
+    xvc::EncoderSettings encoder_settings;
+    encoder_settings.Initialize(xvc::SpeedMode::kFast);
+    SetupEncoder(encoder_settings, kWidth, kHeight, 8, kQp);
+    encoder_->SetSubGopLength(kFrames - 1);
+    DecoderHelper::Init(GetParam() > 0, GetParam());
+  }
+
+  static bool SamePlanes(const std::vector<uint8_t> &expected,
+                         const xvc_decoded_picture &pic) {
+    const int sample_size = pic.stats.bitdepth > 8 ? 2 : 1;
+    const uint8_t *expected_ptr = &expected[0];
+    for (int c = 0; c < 3; c++) {
+      const int width = (c == 0 ? kWidth : kWidth / 2) * sample_size;
+      const int height = c == 0 ? kHeight : kHeight / 2;
+      const uint8_t *plane = reinterpret_cast<const uint8_t*>(pic.planes[c]);
+      for (int y = 0; y < height; y++) {
+        if (std::memcmp(expected_ptr, plane + y * pic.stride[c], width)) {
+          return false;
+        }
+        expected_ptr += width;
+      }
+    }
+    return true;
+  }
+};
+
+TEST_P(EncodeDecodePictureRefTest, PicturesValidUntilReleased) {
+  const int num_frames = 2 * kFrames;
+  for (int i = 0; i < num_frames; i++) {
+    EncodeOneFrame(CreatePicture(i), 8);
+  }
+  EncoderFlush();
+  DecodeSegmentHeaderSuccess(GetNextNalToDecode());
+  // All pictures are held until the end while decoder buffers are reused
+  std::vector<xvc_decoded_picture*> pictures;
+  while (HasMoreNals()) {
+    const xvc_test::NalUnit &nal = GetNextNalToDecode();
+    decoder_->DecodeNal(&nal[0], nal.size());
+    if (xvc_decoded_picture *pic = decoder_->GetDecodedPictureRef()) {
+      pictures.push_back(pic);
+    }
+  }
+  decoder_->FlushBufferedNalUnits();
+  while (xvc_decoded_picture *pic = decoder_->GetDecodedPictureRef()) {
+    pictures.push_back(pic);
+  }
+  ASSERT_EQ(num_frames, static_cast<int>(pictures.size()));
+  for (int i = 0; i < num_frames; i++) {
+    EXPECT_EQ(i, static_cast<int>(pictures[i]->stats.poc));
+    EXPECT_TRUE(SamePlanes(rec_pics_[i], *pictures[i])) << "Picture " << i;
+    EXPECT_TRUE(xvc::Decoder::ReleasePicture(pictures[i]));
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(DecoderThreads, EncodeDecodePictureRefTest,
+                        ::testing::Values(0, 4));
+
 }   // namespace
@@ -19,6 +19,8 @@
 * Please visit https://xvc.io/license/ for more information.
 ******************************************************************************/
 
+#include <vector>
+
 #include "googletest/include/gtest/gtest.h"
 
 #include "xvc_common_lib/common.h"
@@ -27,6 +29,12 @@
 
 namespace {
 
+void AppendNal(void *opaque, const xvc_enc_nal_unit *nal_unit) {
+  std::vector<uint8_t> *bitstream = static_cast<std::vector<uint8_t>*>(opaque);
+  bitstream->insert(bitstream->end(), nal_unit->bytes,
+                    nal_unit->bytes + nal_unit->size);
+}
+
 TEST(EncoderAPI, NullPtrCalls) {
   const xvc_encoder_api *api = xvc_encoder_api_get();
   EXPECT_EQ(XVC_ENC_OK, api->parameters_destroy(nullptr));
@@ -251,4 +259,61 @@ TEST(EncoderAPI, EncoderFlush) {
   EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
 }
 
+TEST(EncoderAPI, EncodeWithNalCallback) {
+  const int kWidth = 64;
+  const int kHeight = 64;
+  const int kNumPics = 6;
+  const xvc_encoder_api *api = xvc_encoder_api_get();
+  xvc_encoder_parameters *params = api->parameters_create();
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_set_default(params));
+  params->width = kWidth;
+  params->height = kHeight;
+  params->sub_gop_length = 4;
+  params->speed_mode = 2;
+  xvc_encoder *encoder = api->encoder_create(params);
+  xvc_encoder *encoder_cb = api->encoder_create(params);
+  EXPECT_EQ(XVC_ENC_OK, api->parameters_destroy(params));
+  ASSERT_NE(encoder, nullptr);
+  ASSERT_NE(encoder_cb, nullptr);
+
+  std::vector<uint8_t> plane(kWidth * kHeight);
+  const uint8_t *plane_bytes[3] = { &plane[0], &plane[0], &plane[0] };
+  int plane_stride[3] = { kWidth, kWidth / 2, kWidth / 2 };
+  EXPECT_EQ(XVC_ENC_INVALID_ARGUMENT,
+            api->encoder_encode3(encoder_cb, plane_bytes, plane_stride,
+                                 nullptr, nullptr, nullptr, 0));
+  std::vector<uint8_t> bitstream;
+  std::vector<uint8_t> bitstream_cb;
+  xvc_enc_nal_unit *nal_units;
+  int num_nal_units;
+  for (int poc = 0; poc < kNumPics; poc++) {
+    for (int i = 0; i < static_cast<int>(plane.size()); i++) {
+      plane[i] = static_cast<uint8_t>((i % kWidth) * poc + i / kWidth);
+    }
+    EXPECT_EQ(XVC_ENC_OK,
+              api->encoder_encode2(encoder, plane_bytes, plane_stride,
+                                   &nal_units, &num_nal_units, nullptr, poc));
+    for (int i = 0; i < num_nal_units; i++) {
+      AppendNal(&bitstream, &nal_units[i]);
+    }
+    EXPECT_EQ(XVC_ENC_OK,
+              api->encoder_encode3(encoder_cb, plane_bytes, plane_stride,
+                                   &AppendNal, &bitstream_cb, nullptr, poc));
+  }
+  xvc_enc_return_code ret;
+  do {
+    ret = api->encoder_flush(encoder, &nal_units, &num_nal_units, nullptr);
+    for (int i = 0; i < num_nal_units; i++) {
+      AppendNal(&bitstream, &nal_units[i]);
+    }
+  } while (ret == XVC_ENC_OK);
+  while (api->encoder_flush3(encoder_cb, &AppendNal, &bitstream_cb,
+                             nullptr) == XVC_ENC_OK) {
+  }
+  EXPECT_FALSE(bitstream.empty());
+  EXPECT_EQ(bitstream, bitstream_cb);
+  EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder));
+  EXPECT_EQ(XVC_ENC_OK, api->encoder_destroy(encoder_cb));
+}
+
 }   // namespace
@@ -0,0 +1,118 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include <memory>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/segment_header.h"
+#include "xvc_common_lib/simd_cpu.h"
+#include "xvc_enc_lib/encoder_simd_functions.h"
+#include "xvc_enc_lib/lookahead.h"
+#include "xvc_enc_lib/picture_encoder.h"
+
+namespace {
+
+static const int kPicWidth = 2 * xvc::constants::kCtuSize;
+static const int kPicHeight = xvc::constants::kCtuSize;
+static const int kBitdepth = 8;
+static const xvc::PicNum kSubGopLength = 8;
+
+class LookaheadTest : public ::testing::Test {
+protected:
+  LookaheadTest()
+    : simd_(xvc::SimdCpu::GetRuntimeCapabilities(), kBitdepth) {
+  }
+
+  void SetUp() override {
+    encoder_settings_.Initialize(xvc::SpeedMode::kFast);
+    encoder_settings_.temporal_aqp = 1;
+    segment_.max_sub_gop_length = kSubGopLength;
+    segment_.num_ref_pics = 2;
+  }
+
+  static int Hash(int x, int y, int poc) {
+    uint32_t hash = (static_cast<uint32_t>(x) * 73856093u) ^
+      (static_cast<uint32_t>(y) * 19349663u) ^
+      (static_cast<uint32_t>(poc) * 83492791u);
+    hash = (hash ^ (hash >> 13)) * 1274126177u;
+    return (hash >> 16) & 255;
+  }
+
+  // Left ctu is the same texture in all pictures, right ctu is new noise in
+  // every picture so no picture can predict it from another
+  std::shared_ptr<xvc::PictureEncoder> CreatePicture(xvc::PicNum poc) {
+    const xvc::YuvComponent comp = xvc::YuvComponent::kY;
+    xvc::PictureFormat pic_fmt(kPicWidth, kPicHeight, kBitdepth,
+                               xvc::ChromaFormat::k420,
+                               xvc::ColorMatrix::k601, false);
+    auto pic = std::make_shared<xvc::PictureEncoder>(simd_, pic_fmt,
+                                                     kPicWidth, kPicHeight);
+    // Dyadic prediction hierarchy
+    int tid = xvc::SegmentHeader::GetMaxTid(kSubGopLength);
+    for (xvc::PicNum p = poc; p % 2 == 0 && tid > 0; p /= 2) {
+      tid--;
+    }
+    pic->Init(segment_, poc, poc, tid, false);
+    xvc::YuvPicture &orig_pic = *pic->GetOrigPic();
+    for (int y = 0; y < kPicHeight; y++) {
+      xvc::Sample *orig = orig_pic.GetSamplePtr(comp, 0, y);
+      for (int x = 0; x < kPicWidth; x++) {
+        const int val = x < xvc::constants::kCtuSize ?
+          Hash(x, y, 0) : Hash(x, y, static_cast<int>(poc) + 1);
+        orig[x] = static_cast<xvc::Sample>(val);
+      }
+    }
+    return pic;
+  }
+
+  xvc::EncoderSimdFunctions simd_;
+  xvc::EncoderSettings encoder_settings_;
+  xvc::SegmentHeader segment_;
+};
+
+TEST_F(LookaheadTest, ReferencedCtuGetsLowerQpThanUnreferenced) {
+  std::vector<std::shared_ptr<xvc::PictureEncoder>> pic_buffer;
+  for (xvc::PicNum poc = 0; poc <= kSubGopLength; poc++) {
+    pic_buffer.push_back(CreatePicture(poc));
+  }
+  xvc::Lookahead lookahead(simd_, encoder_settings_);
+  xvc::Lookahead::SubGop sub_gop;
+  ASSERT_TRUE(lookahead.PrepareSubGop(pic_buffer, kSubGopLength,
+                                      kSubGopLength, &sub_gop));
+  lookahead.AnalyzeSubGop(sub_gop);
+
+  // Middle picture is referenced directly or indirectly by most of the
+  // sub-gop
+  const std::vector<int> &ctu_qp_offsets =
+    pic_buffer[kSubGopLength / 2]->GetCtuQpOffsets();
+  ASSERT_EQ(2u, ctu_qp_offsets.size());
+  EXPECT_LT(ctu_qp_offsets[0], 0);
+  EXPECT_GT(ctu_qp_offsets[1], 0);
+  // Pictures in the highest layer are not referenced at all
+  const std::vector<int> &top_layer_offsets = pic_buffer[1]->GetCtuQpOffsets();
+  ASSERT_EQ(2u, top_layer_offsets.size());
+  EXPECT_EQ(0, top_layer_offsets[0]);
+  EXPECT_EQ(0, top_layer_offsets[1]);
+}
+
+}   // namespace
@@ -0,0 +1,140 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/simd_cpu.h"
+#include "xvc_common_lib/yuv_pic.h"
+#include "xvc_enc_lib/encoder_simd_functions.h"
+#include "xvc_enc_lib/motion_preanalysis.h"
+
+namespace {
+
+static const int kWidth = 128;
+static const int kHeight = 96;
+static const int kBitdepth = 8;
+static const int kSearchRange = 32;
+
+class MotionPreanalysisTest : public ::testing::Test {
+protected:
+  MotionPreanalysisTest()
+    : simd_(xvc::SimdCpu::GetRuntimeCapabilities(), kBitdepth),
+    analysis_(simd_.sample_metric),
+    orig_pic_(xvc::ChromaFormat::k420, kWidth, kHeight, kBitdepth, false, 0,
+              0),
+    ref_pic_(xvc::ChromaFormat::k420, kWidth, kHeight, kBitdepth, false, 0,
+             0) {
+  }
+
+  // Random texture that is constant within 4x4 cells so that it is kept
+  // intact at quarter resolution for shifts in multiples of 4
+  static int Texture(int x, int y) {
+    uint32_t hash = (static_cast<uint32_t>(x >> 2) * 73856093u) ^
+      (static_cast<uint32_t>(y >> 2) * 19349663u);
+    hash = (hash ^ (hash >> 13)) * 1274126177u;
+    return (hash >> 16) & 255;
+  }
+
+  // Original picture content is the reference picture displaced by mv
+  void AnalyzeShift(const xvc::MvFullpel &mv) {
+    const xvc::YuvComponent comp = xvc::YuvComponent::kY;
+    for (int y = 0; y < kHeight; y++) {
+      xvc::Sample *orig = orig_pic_.GetSamplePtr(comp, 0, y);
+      xvc::Sample *ref = ref_pic_.GetSamplePtr(comp, 0, y);
+      for (int x = 0; x < kWidth; x++) {
+        orig[x] = static_cast<xvc::Sample>(Texture(x + mv.x, y + mv.y));
+        ref[x] = static_cast<xvc::Sample>(Texture(x, y));
+      }
+    }
+    xvc::MotionPreanalysis::Pyramid orig_pyramid;
+    xvc::MotionPreanalysis::Pyramid ref_pyramid;
+    xvc::MotionPreanalysis::BuildPyramid(orig_pic_, &orig_pyramid);
+    xvc::MotionPreanalysis::BuildPyramid(ref_pic_, &ref_pyramid);
+    analysis_.AnalyzeRefPic(orig_pyramid, ref_pyramid, kSearchRange, &mvs_,
+                            &costs_);
+  }
+
+  static bool IsInside(int pos, int mv, int block_size, int size) {
+    return pos + mv >= 0 && pos + mv + block_size <= size;
+  }
+
+  xvc::EncoderSimdFunctions simd_;
+  xvc::MotionPreanalysis analysis_;
+  xvc::YuvPicture orig_pic_;
+  xvc::YuvPicture ref_pic_;
+  std::vector<xvc::MvFullpel> mvs_;
+  std::vector<uint32_t> costs_;
+};
+
+TEST_F(MotionPreanalysisTest, GlobalShiftFoundAtAllResolutions) {
+  const int kBlockSize = xvc::MotionPreanalysis::kBlockSize;
+  // Blocks without a match are at the right and bottom border so they are
+  // never used for seeding the search of the other blocks
+  const xvc::MvFullpel shift(12, 8);
+  AnalyzeShift(shift);
+  const int num_blocks_x = analysis_.GetNumBlocksX();
+  const int num_blocks_y = analysis_.GetNumBlocksY();
+  ASSERT_EQ(kWidth / kBlockSize, num_blocks_x);
+  ASSERT_EQ(kHeight / kBlockSize, num_blocks_y);
+  const std::vector<xvc::MvFullpel> &quarter_mvs = analysis_.GetQuarterMvs();
+  int num_inside = 0;
+  for (int block_y = 0; block_y < num_blocks_y; block_y++) {
+    for (int block_x = 0; block_x < num_blocks_x; block_x++) {
+      const int posx = block_x * kBlockSize;
+      const int posy = block_y * kBlockSize;
+      if (!IsInside(posx, shift.x, kBlockSize, kWidth) ||
+          !IsInside(posy, shift.y, kBlockSize, kHeight)) {
+        continue;
+      }
+      const int idx = block_y * num_blocks_x + block_x;
+      EXPECT_EQ(xvc::MvFullpel(shift.x / 4, shift.y / 4), quarter_mvs[idx]);
+      EXPECT_EQ(shift, mvs_[idx]);
+      EXPECT_EQ(0u, costs_[idx]);
+      num_inside++;
+    }
+  }
+  EXPECT_GT(num_inside, 0);
+}
+
+TEST_F(MotionPreanalysisTest, VectorsClippedAtPictureBorder) {
+  const int kBlockSize = xvc::MotionPreanalysis::kBlockSize;
+  const int kQuarterBlockSize = kBlockSize >> 2;
+  const xvc::MvFullpel shift(-20, 24);
+  AnalyzeShift(shift);
+  const int num_blocks_x = analysis_.GetNumBlocksX();
+  const std::vector<xvc::MvFullpel> &quarter_mvs = analysis_.GetQuarterMvs();
+  for (int idx = 0; idx < static_cast<int>(mvs_.size()); idx++) {
+    const int block_x = idx % num_blocks_x;
+    const int block_y = idx / num_blocks_x;
+    EXPECT_TRUE(IsInside(block_x * kBlockSize, mvs_[idx].x, kBlockSize,
+                         kWidth));
+    EXPECT_TRUE(IsInside(block_y * kBlockSize, mvs_[idx].y, kBlockSize,
+                         kHeight));
+    EXPECT_TRUE(IsInside(block_x * kQuarterBlockSize, quarter_mvs[idx].x,
+                         kQuarterBlockSize, kWidth >> 2));
+    EXPECT_TRUE(IsInside(block_y * kQuarterBlockSize, quarter_mvs[idx].y,
+                         kQuarterBlockSize, kHeight >> 2));
+  }
+}
+
+}   // namespace
@@ -0,0 +1,117 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_enc_lib/rate_control.h"
+
+namespace {
+
+static const double kFramerate = 30;
+static const int kSubGopLength = 8;
+static const int kKeyPicDistance = 64;
+static const int kTidOfDoc[kSubGopLength] = { 0, 1, 2, 3, 3, 2, 3, 3 };
+
+class RateControlTest : public ::testing::Test {
+protected:
+  struct Picture {
+    xvc::PicNum doc;
+    bool intra;
+    int tid;
+    int qp;
+  };
+
+  // Simulated picture size with the same qp offsets as the encoder
+  size_t PictureBits(const Picture &pic) const {
+    const int pic_qp = pic.intra ? pic.qp : pic.qp + pic.tid + 1;
+    const double cplx = (pic.intra ? 8 : 4 >> std::min(pic.tid, 2)) *
+      complexity_;
+    return static_cast<size_t>(cplx / std::pow(2.0, (pic_qp - 12) / 6.0));
+  }
+
+  // Encodes num_pics pictures with up to num_parallel pictures in flight,
+  // pictures in flight are finished in reverse order
+  double Encode(xvc::RateControl *rc, int num_pics, int num_parallel) {
+    std::vector<Picture> in_flight;
+    double total_bits = 0;
+    for (int i = 0; i < num_pics; i++) {
+      Picture pic;
+      pic.doc = static_cast<xvc::PicNum>(i % kKeyPicDistance);
+      pic.intra = pic.doc == 0;
+      pic.tid = kTidOfDoc[i % kSubGopLength];
+      pic.qp = rc->StartPicture(pic.doc, pic.intra, pic.tid);
+      in_flight.push_back(pic);
+      if (static_cast<int>(in_flight.size()) >= num_parallel ||
+          i + 1 == num_pics) {
+        for (auto it = in_flight.rbegin(); it != in_flight.rend(); ++it) {
+          size_t bits = PictureBits(*it);
+          rc->FinishPicture(it->doc, bits);
+          total_bits += bits;
+          min_vbv_fullness_ =
+            std::min(min_vbv_fullness_, rc->GetVbvFullness());
+        }
+        in_flight.clear();
+      }
+    }
+    return total_bits * kFramerate / num_pics;
+  }
+
+  double complexity_ = 1e5;
+  double min_vbv_fullness_ = 0;
+};
+
+TEST_F(RateControlTest, VariableBitrateReachesTarget) {
+  xvc::RateControl::Settings settings;
+  settings.mode = xvc::RateControlMode::kVariableBitrate;
+  settings.bitrate = 500000;
+  xvc::RateControl rc(settings, kFramerate, 32);
+  double bitrate = Encode(&rc, 8 * kKeyPicDistance, 1);
+  EXPECT_NEAR(settings.bitrate, bitrate, 0.05 * settings.bitrate);
+}
+
+TEST_F(RateControlTest, OutOfOrderCompletion) {
+  xvc::RateControl::Settings settings;
+  settings.mode = xvc::RateControlMode::kVariableBitrate;
+  settings.bitrate = 200000;
+  xvc::RateControl rc(settings, kFramerate, 20);
+  double bitrate = Encode(&rc, 12 * kKeyPicDistance, kSubGopLength);
+  EXPECT_NEAR(settings.bitrate, bitrate, 0.05 * settings.bitrate);
+}
+
+TEST_F(RateControlTest, ConstantBitrateVbvAfterComplexityIncrease) {
+  xvc::RateControl::Settings settings;
+  settings.mode = xvc::RateControlMode::kConstantBitrate;
+  settings.bitrate = 500000;
+  settings.vbv_buffer_size = 500000;
+  xvc::RateControl rc(settings, kFramerate, 32);
+  Encode(&rc, 2 * kKeyPicDistance, 4);
+  min_vbv_fullness_ = settings.vbv_buffer_size;
+  complexity_ *= 3;
+  double bitrate = Encode(&rc, 4 * kKeyPicDistance, 4);
+  EXPECT_NEAR(settings.bitrate, bitrate, 0.1 * settings.bitrate);
+  EXPECT_GE(min_vbv_fullness_, 0);
+}
+
+}   // namespace
@@ -0,0 +1,109 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+
+#include <array>
+#include <memory>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/coding_unit.h"
+#include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/quantize.h"
+#include "xvc_enc_lib/bit_writer.h"
+#include "xvc_enc_lib/rate_estimator.h"
+#include "xvc_enc_lib/syntax_writer.h"
+
+namespace {
+
+static const int kSize = 16;
+
+class RateEstimatorTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    qp_.reset(new xvc::Qp(32, xvc::ChromaFormat::k420, 8, 0));
+    writer_.reset(new xvc::SyntaxWriter(*qp_, xvc::PicturePredictionType::kUni,
+                                        &bit_writer_));
+    // Move contexts away from their initial state
+    for (int i = 0; i < 20; i++) {
+      writer_->WriteRootCbf(i % 3 != 0);
+    }
+  }
+
+  std::unique_ptr<xvc::Qp> qp_;
+  xvc::BitWriter bit_writer_;
+  std::unique_ptr<xvc::SyntaxWriter> writer_;
+};
+
+TEST_F(RateEstimatorTest, RootCbfMatchesWriter) {
+  for (bool root_cbf : { false, true }) {
+    xvc::RdoSyntaxWriter rdo_writer(*writer_, 0);
+    xvc::RateEstimator rate_estimator(rdo_writer);
+    rdo_writer.WriteRootCbf(root_cbf);
+    rate_estimator.EstimateRootCbf(root_cbf);
+    EXPECT_EQ(rdo_writer.GetNumWrittenBits(), rate_estimator.GetNumBits());
+  }
+}
+
+TEST_F(RateEstimatorTest, IntraModeMatchesWriter) {
+  xvc::IntraPredictorLuma mpm;
+  mpm[0] = xvc::IntraMode(18);
+  mpm[1] = xvc::IntraMode(50);
+  mpm[2] = xvc::IntraMode::kPlanar;
+  mpm[3] = xvc::IntraMode::kDc;
+  mpm[4] = xvc::IntraMode(2);
+  mpm[5] = xvc::IntraMode(34);
+  mpm.num_neighbor_modes = 2;
+  for (int mode = 0; mode < xvc::kNbrIntraModesExt; mode++) {
+    xvc::RdoSyntaxWriter rdo_writer(*writer_, 0);
+    xvc::RateEstimator rate_estimator(rdo_writer);
+    rdo_writer.WriteIntraMode(xvc::IntraMode(mode), mpm);
+    rate_estimator.EstimateIntraMode(xvc::IntraMode(mode), mpm);
+    EXPECT_EQ(rdo_writer.GetNumWrittenBits(), rate_estimator.GetNumBits())
+      << "mode " << mode;
+  }
+}
+
+TEST_F(RateEstimatorTest, CoefficientsIncreaseWithLevels) {
+  xvc::PictureData pic_data(xvc::ChromaFormat::k420, kSize, kSize, 8);
+  xvc::CodingUnit *cu =
+    pic_data.CreateCu(xvc::CuTree::Primary, 0, 0, 0, kSize, kSize);
+  cu->SetPredMode(xvc::PredictionMode::kInter);
+  std::array<xvc::Coeff, kSize * kSize> coeff;
+  coeff.fill(0);
+  coeff[0] = 1;
+  coeff[1] = -1;
+  coeff[kSize] = 1;
+  xvc::Bits prev_bits = 0;
+  for (int level : { 1, 2, 3, 20 }) {
+    coeff[kSize + 1] = static_cast<xvc::Coeff>(level);
+    xvc::RdoSyntaxWriter rdo_writer(*writer_, 0);
+    xvc::RateEstimator rate_estimator(rdo_writer);
+    int num_nonzero = rate_estimator.EstimateCoefficients(
+      *cu, xvc::YuvComponent::kY, &coeff[0], kSize);
+    EXPECT_EQ(4, num_nonzero);
+    EXPECT_GT(rate_estimator.GetNumBits(), prev_bits);
+    prev_bits = rate_estimator.GetNumBits();
+  }
+  pic_data.ReleaseCu(cu);
+}
+
+}   // namespace
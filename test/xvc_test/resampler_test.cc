@@ -259,6 +259,37 @@ TEST_P(ResamplerTest, ToRgbBytesOddResolutionWithResample_34to40to34) {
   ASSERT_LT(psnr_y, 55.0);
 }
 
+TEST_P(ResamplerTest, ToArgbBytesEqualsScalarWithThreads) {
+  const xvc::SimdFunctions scalar_simd({});
+  xvc::Resampler scalar_resampler(scalar_simd.resampler);
+  for (const xvc::PictureFormat *input_fmt :
+       { &fmt_40x40_yuv420p8, &fmt_34x34_yuv420p8 }) {
+    TestYuvPic orig_pic = CreateOrigPic(*input_fmt);
+    xvc::YuvPicture rec_pic(fmt_40x40_internal, true,
+                            fmt_40x40_internal.width - input_fmt->width,
+                            fmt_40x40_internal.height - input_fmt->height);
+    resampler_->ConvertFrom(*input_fmt, &orig_pic.GetBytes()[0], &rec_pic);
+    rec_pic.PadBorder();
+    for (int out_bitdepth : { 8, 10 }) {
+      for (xvc::ColorMatrix color_matrix :
+           { xvc::ColorMatrix::kUndefined, xvc::ColorMatrix::k601,
+             xvc::ColorMatrix::k709, xvc::ColorMatrix::k2020 }) {
+        xvc::PictureFormat output_fmt(input_fmt->width, input_fmt->height,
+                                      out_bitdepth, xvc::ChromaFormat::kArgb,
+                                      color_matrix, kOutputDither);
+        std::vector<uint8_t> ref_bytes;
+        scalar_resampler.ConvertTo(rec_pic, output_fmt, &ref_bytes);
+        for (int num_threads : { 1, 3 }) {
+          std::vector<uint8_t> out_bytes;
+          resampler_->ConvertTo(rec_pic, output_fmt, &out_bytes, num_threads);
+          ASSERT_EQ(ref_bytes, out_bytes) << "for bitdepth " << out_bitdepth <<
+            " and " << num_threads << " threads";
+        }
+      }
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(NormalBitdepth, ResamplerTest,
                         ::testing::Values(TestParam{ 8, false },
                                           TestParam{ 8, true }));
@@ -19,10 +19,12 @@
 * Please visit https://xvc.io/license/ for more information.
 ******************************************************************************/
 
+#include <random>
 #include <vector>
 
 #include "googletest/include/gtest/gtest.h"
 
+#include "xvc_enc_lib/encoder_simd_functions.h"
 #include "xvc_test/decoder_helper.h"
 #include "xvc_test/encoder_helper.h"
 #include "xvc_test/yuv_helper.h"
@@ -37,6 +39,17 @@ static constexpr int kQp = 27;
 static constexpr int kSubGopLength = 8;
 static constexpr int kSegmentLength = kSubGopLength * 3;
 
+// All runtime capabilities together followed by each one on its own
+static std::vector<std::set<xvc::CpuCapability>> GetAllCaps() {
+  std::vector<std::set<xvc::CpuCapability>> all_caps = {
+    xvc::SimdCpu::GetRuntimeCapabilities()
+  };
+  for (xvc::CpuCapability cpu_cap : xvc::SimdCpu::GetRuntimeCapabilities()) {
+    all_caps.push_back({ cpu_cap });
+  }
+  return all_caps;
+}
+
 class SimdTest : public ::testing::TestWithParam<int>,
   public ::xvc_test::EncoderHelper, public ::xvc_test::DecoderHelper {
 protected:
@@ -182,4 +195,279 @@ INSTANTIATE_TEST_CASE_P(HighBitdepth, SimdTest,
                         ::testing::Values(10, 12));
 #endif
 
+class SampleMetricSimdTest : public ::testing::TestWithParam<int> {
+protected:
+  static const int kSize = 64;
+  static const ptrdiff_t kStride = kSize + 3;
+
+  void SetUp() override {
+    const int bitdepth = GetParam();
+    const int max_val = (1 << bitdepth) - 1;
+    std::mt19937 rand(bitdepth);
+    samples1_.resize(kSize * kStride);
+    samples2_.resize(kSize * kStride);
+    residual_.resize(kSize * kStride);
+    for (size_t i = 0; i < samples1_.size(); i++) {
+      // Extreme values in parts of the block to check for overflow
+      const bool extreme = (i / kStride) < 16;
+      samples1_[i] = static_cast<xvc::Sample>(extreme ? max_val :
+                                              rand() & max_val);
+      samples2_[i] = static_cast<xvc::Sample>(extreme ? 0 : rand() & max_val);
+      residual_[i] = static_cast<int16_t>(extreme ? -max_val :
+        static_cast<int>(rand() % (2 * max_val + 1)) - max_val);
+    }
+  }
+
+  std::vector<xvc::Sample> samples1_;
+  std::vector<xvc::Sample> samples2_;
+  std::vector<int16_t> residual_;
+};
+
+TEST_P(SampleMetricSimdTest, SatdEqualsScalar) {
+  const int bitdepth = GetParam();
+  const xvc::EncoderSimdFunctions ref({}, bitdepth);
+  const int kNumSizes = xvc::SampleMetric::SimdFunc::kSatdSizes;
+  for (auto &caps : GetAllCaps()) {
+    const xvc::EncoderSimdFunctions simd(caps, bitdepth);
+    for (int w = 0; w < kNumSizes; w++) {
+      for (int h = 0; h < kNumSizes; h++) {
+        auto satd_ref = ref.sample_metric.satd_sample_sample[w][h];
+        auto satd_short_ref = ref.sample_metric.satd_short_sample[w][h];
+        auto satd = simd.sample_metric.satd_sample_sample[w][h];
+        auto satd_short = simd.sample_metric.satd_short_sample[w][h];
+        ASSERT_EQ(!satd_ref, !satd);
+        ASSERT_EQ(!satd_short_ref, !satd_short);
+        if (!satd_ref) {
+          continue;
+        }
+        for (int offset : { 0, -5, 37 }) {
+          for (int y = 0; y + (4 << h) <= kSize; y += 16) {
+            // Varying block width and unaligned start position
+            const int width = (kSize - y) & ~((4 << w) - 1);
+            const int height = 4 << h;
+            const ptrdiff_t pos = y * kStride + y % 3;
+            EXPECT_EQ(satd_ref(width, height, offset, &samples1_[pos], kStride,
+                               &samples2_[pos], kStride),
+                      satd(width, height, offset, &samples1_[pos], kStride,
+                           &samples2_[pos], kStride)) <<
+              "for tile " << w << "x" << h << " at y=" << y;
+            EXPECT_EQ(satd_short_ref(width, height, offset, &residual_[pos],
+                                     kStride, &samples2_[pos], kStride),
+                      satd_short(width, height, offset, &residual_[pos],
+                                 kStride, &samples2_[pos], kStride)) <<
+              "for tile " << w << "x" << h << " at y=" << y;
+          }
+        }
+      }
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(NormalBitdepth, SampleMetricSimdTest,
+                        ::testing::Values(8));
+#if XVC_HIGH_BITDEPTH
+INSTANTIATE_TEST_CASE_P(HighBitdepth, SampleMetricSimdTest,
+                        ::testing::Values(10, 12));
+#endif
+
+class QuantizeSimdTest : public ::testing::Test {
+protected:
+  static const int kSize = 64;
+  static const ptrdiff_t kStride = kSize + 5;
+
+  void SetUp() override {
+    std::mt19937 rand(0);
+    coeff_.resize(kSize * kStride);
+    for (size_t i = 0; i < coeff_.size(); i++) {
+      // Both full range and small coefficients to get clipped and zero levels
+      const bool small = (i / kStride) % 2 != 0;
+      coeff_[i] = static_cast<xvc::Coeff>(small ?
+        static_cast<int>(rand() % 2001) - 1000 :
+        static_cast<int>(rand() & 0xffff) - 32768);
+    }
+    coeff_[0] = xvc::constants::kInt16Min;
+    coeff_[1] = xvc::constants::kInt16Max;
+  }
+
+  std::vector<xvc::Coeff> coeff_;
+};
+
+TEST_F(QuantizeSimdTest, InverseEqualsScalar) {
+  const xvc::SimdFunctions ref({});
+  std::vector<xvc::Coeff> out_ref(kSize * kStride);
+  std::vector<xvc::Coeff> out(kSize * kStride);
+  for (auto &caps : GetAllCaps()) {
+    const xvc::SimdFunctions simd(caps);
+    for (int i = 0; i < xvc::Quantize::SimdFunc::kSize; i++) {
+      const int width = 2 << i;
+      const int height = kSize >> (i % 3);
+      for (int scale : { 40, 72 * 181, 1 << 12 }) {
+        for (int shift : { -2, 0, 1, 6, 14 }) {
+          ref.quantize.inverse[i](scale, shift, width, height, &coeff_[3],
+                                  kStride, &out_ref[0], kStride);
+          simd.quantize.inverse[i](scale, shift, width, height, &coeff_[3],
+                                   kStride, &out[0], kStride);
+          ASSERT_EQ(out_ref, out) << "for width " << width << " scale " <<
+            scale << " shift " << shift;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(QuantizeSimdTest, ForwardEqualsScalar) {
+  const xvc::SimdFunctions ref({});
+  std::vector<xvc::Coeff> out_ref(kSize * kStride);
+  std::vector<xvc::Coeff> out(kSize * kStride);
+  std::vector<xvc::Coeff> delta_ref(kSize * kStride);
+  std::vector<xvc::Coeff> delta(kSize * kStride);
+  for (auto &caps : GetAllCaps()) {
+    const xvc::SimdFunctions simd(caps);
+    for (int i = 0; i < xvc::Quantize::SimdFunc::kSize; i++) {
+      const int width = 2 << i;
+      const int height = kSize >> (i % 3);
+      for (int scale : { 26214, 16384 * 181 }) {
+        for (int shift : { 14, 22, 29 }) {
+          for (int64_t offset : { 171ll << (shift - 9), 85ll << (shift - 9),
+               1ll << (shift - 1) }) {
+            int num_ref =
+              ref.quantize.forward[i](scale, shift, offset, width, height,
+                                      &coeff_[1], kStride, &out_ref[0],
+                                      kStride, &delta_ref[0], kStride);
+            int num =
+              simd.quantize.forward[i](scale, shift, offset, width, height,
+                                       &coeff_[1], kStride, &out[0],
+                                       kStride, &delta[0], kStride);
+            ASSERT_EQ(num_ref, num);
+            ASSERT_EQ(out_ref, out) << "for width " << width << " scale " <<
+              scale << " shift " << shift;
+            ASSERT_EQ(delta_ref, delta) << "for width " << width <<
+              " scale " << scale << " shift " << shift;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(YuvPicSimdTest, PadRowsEqualsScalar) {
+  const xvc::SimdFunctions ref({});
+  const int kRowWidth = 37;
+  const int kNumRows = 5;
+  const int kMaxPad = 80;
+  const ptrdiff_t stride = kRowWidth + 2 * kMaxPad;
+  std::vector<xvc::Sample> samples(kNumRows * stride);
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i] = static_cast<xvc::Sample>((i * 7 + 3) & 0xff);
+  }
+  for (auto &caps : GetAllCaps()) {
+    const xvc::SimdFunctions simd(caps);
+    for (int pad : { 1, 5, 16, 17, 40, 80 }) {
+      std::vector<xvc::Sample> out_ref(samples);
+      std::vector<xvc::Sample> out(samples);
+      ref.yuv_picture.pad_rows(kRowWidth, kNumRows, pad, &out_ref[kMaxPad],
+                               stride);
+      simd.yuv_picture.pad_rows(kRowWidth, kNumRows, pad, &out[kMaxPad],
+                                stride);
+      ASSERT_EQ(out_ref, out) << "for pad " << pad;
+    }
+  }
+}
+
+class AffineSimdTest : public ::testing::TestWithParam<int> {
+protected:
+  static const int kRefSize = 64;
+  static const ptrdiff_t kRefStride = kRefSize + 7;
+  static const ptrdiff_t kPredStride = xvc::constants::kMaxBlockSize + 3;
+
+  void SetUp() override {
+    const int bitdepth = GetParam();
+    std::mt19937 rand(bitdepth);
+    ref_.resize(kRefSize * kRefStride);
+    for (size_t i = 0; i < ref_.size(); i++) {
+      // Saturated rows to check intermediate precision
+      const bool extreme = (i / kRefStride) % 9 == 0;
+      ref_[i] = static_cast<xvc::Sample>(extreme ? (1 << bitdepth) - 1 :
+                                         rand() & ((1 << bitdepth) - 1));
+    }
+  }
+
+  std::vector<xvc::Sample> ref_;
+};
+
+TEST_P(AffineSimdTest, MotionCompEqualsScalar) {
+  const int bitdepth = GetParam();
+  const int16_t kFilters[][8] = {
+    { 0, 0, 0, 64, 0, 0, 0, 0 },
+    { -1, 4, -10, 58, 17, -5, 1, 0 },
+    { -1, 4, -11, 40, 40, -11, 4, -1 },
+    { -4, 54, 16, -2, 0, 0, 0, 0 },
+    { -6, 46, 28, -4, 0, 0, 0, 0 },
+  };
+  const int kNumFilters = sizeof(kFilters) / sizeof(kFilters[0]);
+  const int kNumBlocks = 5;
+  const xvc::SimdFunctions ref({});
+  for (auto &caps : GetAllCaps()) {
+    const xvc::SimdFunctions simd(caps);
+    for (int lc = 0; lc < 2; lc++) {
+      const int filter_offset = lc == 0 ? 0 : 3;
+      for (int block_size : { 2, 4, 8 }) {
+        xvc::InterPrediction::AffineSubblock blocks[kNumBlocks];
+        for (int i = 0; i < kNumBlocks; i++) {
+          const int filter_hor = (filter_offset + i) % kNumFilters;
+          const int filter_ver = (filter_offset + 2 * i + 1) % kNumFilters;
+          blocks[i].ref = &ref_[(8 + 3 * i) * kRefStride + 8 + 5 * i];
+          blocks[i].filter_hor = kFilters[lc == 0 ? i % 3 : filter_hor];
+          blocks[i].filter_ver = kFilters[lc == 0 ? (i + 1) % 3 : filter_ver];
+        }
+        const int idx = block_size > 2;
+        std::vector<xvc::Sample> pred_ref(block_size * kPredStride);
+        std::vector<xvc::Sample> pred(block_size * kPredStride);
+        ref.inter_prediction.affine_sample[lc][idx](
+          kNumBlocks, block_size, block_size, bitdepth, blocks, kRefStride,
+          &pred_ref[0], kPredStride);
+        simd.inter_prediction.affine_sample[lc][idx](
+          kNumBlocks, block_size, block_size, bitdepth, blocks, kRefStride,
+          &pred[0], kPredStride);
+        EXPECT_EQ(pred_ref, pred) << "for size " << block_size;
+        std::vector<int16_t> pred_short_ref(block_size * kPredStride);
+        std::vector<int16_t> pred_short(block_size * kPredStride);
+        ref.inter_prediction.affine_short[lc][idx](
+          kNumBlocks, block_size, block_size, bitdepth, blocks, kRefStride,
+          &pred_short_ref[0], kPredStride);
+        simd.inter_prediction.affine_short[lc][idx](
+          kNumBlocks, block_size, block_size, bitdepth, blocks, kRefStride,
+          &pred_short[0], kPredStride);
+        EXPECT_EQ(pred_short_ref, pred_short) << "for size " << block_size;
+      }
+    }
+  }
+}
+
+TEST_P(AffineSimdTest, GradientEqualsScalar) {
+  const xvc::SimdFunctions ref({});
+  for (auto &caps : GetAllCaps()) {
+    const xvc::SimdFunctions simd(caps);
+    for (int size : { 4, 7, 8, 13, 16, 32, 64 }) {
+      const size_t num_grad = size * kRefStride;
+      std::vector<int16_t> hor_ref(num_grad), ver_ref(num_grad);
+      std::vector<int16_t> hor(num_grad), ver(num_grad);
+      ref.inter_prediction.affine_gradient(size, size, &ref_[0], kRefStride,
+                                           &hor_ref[0], &ver_ref[0],
+                                           kRefStride);
+      simd.inter_prediction.affine_gradient(size, size, &ref_[0], kRefStride,
+                                            &hor[0], &ver[0], kRefStride);
+      EXPECT_EQ(hor_ref, hor) << "for size " << size;
+      EXPECT_EQ(ver_ref, ver) << "for size " << size;
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(NormalBitdepth, AffineSimdTest,
+                        ::testing::Values(8));
+#if XVC_HIGH_BITDEPTH
+INSTANTIATE_TEST_CASE_P(HighBitdepth, AffineSimdTest,
+                        ::testing::Values(10, 12));
+#endif
+
 }   // namespace
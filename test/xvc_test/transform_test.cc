@@ -23,11 +23,14 @@
 #include <cassert>
 #include <cmath>
 #include <memory>
+#include <set>
 
 #include "googletest/include/gtest/gtest.h"
 
 #include "xvc_common_lib/coding_unit.h"
 #include "xvc_common_lib/picture_data.h"
+#include "xvc_common_lib/simd_cpu.h"
+#include "xvc_common_lib/simd_functions.h"
 #include "xvc_common_lib/transform.h"
 #include "xvc_test/yuv_helper.h"
 
@@ -69,10 +72,10 @@ protected:
         cu->SetTransformType(comp, static_cast<xvc::TransformType>(tx1),
                              static_cast<xvc::TransformType>(tx2));
         cu->SetDcCoeffOnly(comp, false);
-        xvc::ForwardTransform fwd_transform(bitdepth_);
+        xvc::ForwardTransform fwd_transform(simd_.fwd_transform, bitdepth_);
         fwd_transform.Transform(*cu, comp, resi_input, &coeff_buffer);
 
-        xvc::InverseTransform inv_transform(bitdepth_);
+        xvc::InverseTransform inv_transform(simd_.inv_transform, bitdepth_);
         inv_transform.Transform(*cu, comp, coeff_buffer, &resi_tmp);
 
         if (error_threshold == 0) {
@@ -147,6 +150,8 @@ protected:
   std::unique_ptr<xvc::ResidualBufferStorage> resi_tmp_;
   std::unique_ptr<xvc::CoeffBufferStorage> coef_buffer_;
 
+  const xvc::SimdFunctions simd_ =
+    xvc::SimdFunctions(xvc::SimdCpu::GetRuntimeCapabilities());
   int bitdepth_;
 };
 
@@ -169,7 +174,7 @@ TEST_P(TransformTest, IdenticalDcOnlyInvTransform) {
   static const xvc::Coeff kDcCoeff = 1024;
   xvc::PictureData pic_data(chroma_format, xvc::constants::kMaxBlockSize,
                             xvc::constants::kMaxBlockSize, bitdepth_);
-  xvc::InverseTransform inv_transform(bitdepth_);
+  xvc::InverseTransform inv_transform(simd_.inv_transform, bitdepth_);
   xvc::ResidualBufferStorage resi_slow(xvc::constants::kMaxBlockSize,
                                        xvc::constants::kMaxBlockSize);
   xvc::ResidualBufferStorage resi_fast(xvc::constants::kMaxBlockSize,
@@ -199,6 +204,64 @@ TEST_P(TransformTest, IdenticalDcOnlyInvTransform) {
   }
 }
 
+TEST_P(TransformTest, IdenticalSimdAndPlainTransform) {
+  const xvc::SimdFunctions simd_plain((std::set<xvc::CpuCapability>()));
+  xvc::ForwardTransform fwd_plain(simd_plain.fwd_transform, bitdepth_);
+  xvc::InverseTransform inv_plain(simd_plain.inv_transform, bitdepth_);
+  xvc::PictureData pic_data(chroma_format, kMaxCuSize, kMaxCuSize, bitdepth_);
+  xvc::ResidualBufferStorage resi_input(kMaxCuSize, kMaxCuSize);
+  xvc::ResidualBufferStorage resi_plain(kMaxCuSize, kMaxCuSize);
+  xvc::ResidualBufferStorage resi_simd(kMaxCuSize, kMaxCuSize);
+  xvc::CoeffBufferStorage coeff_plain(kMaxCuSize, kMaxCuSize);
+  xvc::CoeffBufferStorage coeff_simd(kMaxCuSize, kMaxCuSize);
+  const int max_resi = (1 << bitdepth_) - 1;
+  uint32_t seed = 1;
+  for (int y = 0; y < kMaxCuSize; y++) {
+    for (int x = 0; x < kMaxCuSize; x++) {
+      seed = seed * 1103515245 + 12345;
+      resi_input.GetDataPtr()[y * resi_input.GetStride() + x] =
+        static_cast<xvc::Residual>((seed >> 16) % (2 * max_resi + 1) -
+                                   max_resi);
+    }
+  }
+
+  // Test each instruction set separately
+  for (xvc::CpuCapability cpu_cap : xvc::SimdCpu::GetRuntimeCapabilities()) {
+    const xvc::SimdFunctions simd((std::set<xvc::CpuCapability>({ cpu_cap })));
+    xvc::ForwardTransform fwd_simd(simd.fwd_transform, bitdepth_);
+    xvc::InverseTransform inv_simd(simd.inv_transform, bitdepth_);
+    for (int height : kAllTransformSizes) {
+      for (int width : kAllTransformSizes) {
+        xvc::CodingUnit *cu =
+          pic_data.CreateCu(cu_tree, 0, 0, 0, width, height);
+        for (int tx1 = 0; tx1 < xvc::kNbrTransformTypes; tx1++) {
+          for (int tx2 = 0; tx2 < xvc::kNbrTransformTypes; tx2++) {
+            cu->SetTransformType(comp, static_cast<xvc::TransformType>(tx1),
+                                 static_cast<xvc::TransformType>(tx2));
+            cu->SetDcCoeffOnly(comp, false);
+            fwd_plain.Transform(*cu, comp, resi_input, &coeff_plain);
+            fwd_simd.Transform(*cu, comp, resi_input, &coeff_simd);
+            inv_plain.Transform(*cu, comp, coeff_plain, &resi_plain);
+            inv_simd.Transform(*cu, comp, coeff_plain, &resi_simd);
+            const ptrdiff_t stride = coeff_plain.GetStride();
+            for (int y = 0; y < height; y++) {
+              for (int x = 0; x < width; x++) {
+                ASSERT_EQ(coeff_plain.GetDataPtr()[y * stride + x],
+                          coeff_simd.GetDataPtr()[y * stride + x]) <<
+                  " tx1=" << tx1 << " tx2=" << tx2 << " x=" << x << " y=" << y;
+                ASSERT_EQ(resi_plain.GetDataPtr()[y * stride + x],
+                          resi_simd.GetDataPtr()[y * stride + x]) <<
+                  " tx1=" << tx1 << " tx2=" << tx2 << " x=" << x << " y=" << y;
+              }
+            }
+          }
+        }
+        pic_data.ReleaseCu(cu);
+      }
+    }
+  }
+}
+
 TEST_P(TransformTest, ZeroOutWidthWithDcPred) {
   static_assert(kMaxCuSize >= xvc_test::TestYuvPic::kInternalPicSize,
                 "Cannot generate orig sample data for large CU sizes");
@@ -0,0 +1,196 @@
+/******************************************************************************
+* Copyright (C) 2018, Divideon.
+*
+* This library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public
+* License as published by the Free Software Foundation; either
+* version 2.1 of the License, or (at your option) any later version.
+*
+* This library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public
+* License along with this library; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*
+* This library is also available under a commercial license.
+* Please visit https://xvc.io/license/ for more information.
+******************************************************************************/
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>   // NOLINT
+#include <vector>
+
+#include "googletest/include/gtest/gtest.h"
+
+#include "xvc_common_lib/utils.h"
+#include "xvc_common_lib/work_scheduler.h"
+
+namespace {
+
+static const int kNumJobs = 200;
+
+class WorkSchedulerTest : public ::testing::Test {
+protected:
+  xvc::WorkScheduler::JobId Job(int idx) const { return &jobs_[idx]; }
+  int JobIdx(xvc::WorkScheduler::JobId job) const {
+    return static_cast<int>(static_cast<const int*>(job) - &jobs_[0]);
+  }
+
+  int jobs_[kNumJobs] = {};
+};
+
+TEST_F(WorkSchedulerTest, DependentTakenAfterRelease) {
+  xvc::WorkScheduler scheduler;
+  scheduler.Add(Job(0), {}, 0);
+  scheduler.Add(Job(1), { Job(0) }, 0);
+  scheduler.Add(Job(2), {}, 1);
+  EXPECT_EQ(Job(0), scheduler.Take());
+  EXPECT_EQ(Job(2), scheduler.Take());
+  scheduler.Release(Job(2));
+  scheduler.Release(Job(0));
+  EXPECT_EQ(Job(1), scheduler.Take());
+  scheduler.Release(Job(1));
+}
+
+TEST_F(WorkSchedulerTest, ReleasedDependencyIsResolved) {
+  xvc::WorkScheduler scheduler;
+  scheduler.Add(Job(0), {}, 0);
+  EXPECT_EQ(Job(0), scheduler.Take());
+  scheduler.Release(Job(0));
+  // Job 0 and job 3 are both unknown to the scheduler at this point
+  scheduler.Add(Job(1), { Job(0), Job(3) }, 0);
+  EXPECT_EQ(Job(1), scheduler.Take());
+  scheduler.Release(Job(1));
+}
+
+TEST_F(WorkSchedulerTest, LowestPriorityValueFirst) {
+  xvc::WorkScheduler scheduler;
+  scheduler.Add(Job(0), {}, 0);
+  EXPECT_EQ(Job(0), scheduler.Take());
+  scheduler.Add(Job(1), { Job(0) }, 3);
+  scheduler.Add(Job(2), { Job(0) }, 1);
+  scheduler.Add(Job(3), { Job(0) }, 2);
+  scheduler.Add(Job(4), { Job(0) }, 1);
+  scheduler.Release(Job(0));
+  EXPECT_EQ(Job(2), scheduler.Take());
+  EXPECT_EQ(Job(4), scheduler.Take());
+  EXPECT_EQ(Job(3), scheduler.Take());
+  EXPECT_EQ(Job(1), scheduler.Take());
+}
+
+TEST_F(WorkSchedulerTest, StopWakesUpIdleWorkers) {
+  xvc::WorkScheduler scheduler;
+  std::vector<std::thread> workers;
+  for (int i = 0; i < 2; i++) {
+    workers.emplace_back([&scheduler] {
+      EXPECT_EQ(nullptr, scheduler.Take());
+    });
+  }
+  scheduler.Stop();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+TEST_F(WorkSchedulerTest, ParallelWorkersRespectDependencies) {
+  const int kNumWorkers = 4;
+  xvc::WorkScheduler scheduler;
+  std::vector<std::atomic<bool>> finished(kNumJobs);
+  for (auto &done : finished) {
+    done = false;
+  }
+  std::atomic<int> num_finished(0);
+  std::atomic<int> num_violations(0);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < kNumWorkers; i++) {
+    workers.emplace_back([&] {
+      while (xvc::WorkScheduler::JobId job = scheduler.Take()) {
+        const int idx = JobIdx(job);
+        if ((idx >= 1 && !finished[idx - 1]) ||
+            (idx >= 8 && !finished[idx - 8])) {
+          num_violations++;
+        }
+        finished[idx] = true;
+        scheduler.Release(job);
+        if (++num_finished == kNumJobs) {
+          scheduler.Stop();
+        }
+      }
+    });
+  }
+  for (int idx = 0; idx < kNumJobs; idx++) {
+    std::vector<xvc::WorkScheduler::JobId> deps;
+    if (idx >= 1) {
+      deps.push_back(Job(idx - 1));
+    }
+    if (idx >= 8) {
+      deps.push_back(Job(idx - 8));
+    }
+    scheduler.Add(Job(idx), deps, idx % 4);
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  EXPECT_EQ(kNumJobs, num_finished);
+  EXPECT_EQ(0, num_violations);
+}
+
+TEST(RunJobs, ConcurrentCallersRunEachJobOnce) {
+  const int kNumCallers = 3;
+  std::vector<std::atomic<int>> num_runs(kNumCallers * kNumJobs);
+  for (auto &runs : num_runs) {
+    runs = 0;
+  }
+  std::vector<std::thread> callers;
+  for (int caller = 0; caller < kNumCallers; caller++) {
+    callers.emplace_back([&, caller] {
+      xvc::util::RunJobs(kNumJobs, 4, [&](int job) {
+        num_runs[caller * kNumJobs + job]++;
+      });
+    });
+  }
+  for (auto &caller : callers) {
+    caller.join();
+  }
+  for (auto &runs : num_runs) {
+    EXPECT_EQ(1, runs);
+  }
+}
+
+TEST(RunJobs, JobsMayWaitForLowerIndex) {
+  const int kNumRows = 16;
+  std::vector<std::atomic<bool>> finished(kNumRows);
+  for (auto &done : finished) {
+    done = false;
+  }
+  xvc::util::RunJobs(kNumRows, 4, [&](int row) {
+    while (row > 0 && !finished[row - 1]) {
+      std::this_thread::yield();
+    }
+    // Nested calls are run by the calling job if no helper is available
+    std::atomic<int> num_nested(0);
+    xvc::util::RunJobs(8, 2, [&](int) { num_nested++; });
+    EXPECT_EQ(8, num_nested);
+    finished[row] = true;
+  });
+  for (auto &done : finished) {
+    EXPECT_TRUE(done);
+  }
+}
+
+TEST(RunJobs, ExceptionRethrownAfterAllJobs) {
+  std::atomic<int> num_runs(0);
+  EXPECT_THROW(xvc::util::RunJobs(kNumJobs, 4, [&](int job) {
+    num_runs++;
+    if (job == 1) {
+      throw std::runtime_error("job failed");
+    }
+  }), std::runtime_error);
+  EXPECT_EQ(kNumJobs, num_runs);
+}
+
+}   // namespace